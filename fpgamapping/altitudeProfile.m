@@ -0,0 +1,203 @@
+%% altitudeProfile.m
+% Terrain-following altitude profile with climb and descent limits
+% Lowest altitudes that keep minAGL along every leg within maxClimbAngle
+%
+% Project: Drone Pathfinding with Coverage Path Planning
+% Module: A* Pathfinding - Module 3
+% Date: 2025-12-13
+% Compatibility: MATLAB 2023b+
+
+function [z, info] = altitudeProfile(path, demData, params)
+    %ALTITUDEPROFILE Lowest climb-limited altitudes above terrain + minAGL
+    %
+    % Syntax:
+    %   z = altitudeProfile(path, demData, params)
+    %   [z, info] = altitudeProfile(path, demData, params)
+    %
+    % Inputs:
+    %   path    - [Nx2] or [Nx3] waypoint path (only X and Y are used)
+    %   demData - struct from generateSyntheticDEM
+    %   params  - struct with minAGL, and optionally maxClimbAngle
+    %             (degrees, default 20) and altitudeSampleStep (meters
+    %             between terrain samples along a leg, 0 = DEM resolution)
+    %
+    % Outputs:
+    %   z    - [Nx1] altitudes for the waypoints
+    %   info - struct with samples (terrain stations), legsLifted and
+    %          maxLift (meters)
+    %
+    % The floor terrain + minAGL is sampled along every leg, not only at
+    % the waypoints: at least every altitudeSampleStep, at every post line
+    % the leg crosses and at the terrain peak between two. One forward and
+    % one backward pass over those stations give the lowest profile above
+    % the floor whose slope stays within tan(maxClimbAngle), in time
+    % linear in the number of stations. Legs
+    % whose straight chord sags below that profile, or below the floor
+    % between two stations (a ridge in the middle of a long leg), have
+    % both ends lifted by the sag, and a last pass over the waypoints
+    % restores the climb limit. Every leg then clears the interpolated
+    % terrain by minAGL along its whole length.
+    %
+    % Runs in altitudeProfile_mex when it has been built with build_native.
+    %
+    % Example:
+    %   path(:, 3) = altitudeProfile(path, demData, params);
+
+    persistent useMex
+    if isempty(useMex)
+        useMex = (exist('altitudeProfile_mex', 'file') == 3);
+    end
+
+    if nargin < 3
+        error('altitudeProfile:MissingInput', 'Requires path, demData and params');
+    end
+    if size(path, 2) < 2
+        error('altitudeProfile:InvalidInput', 'path must be N x 2 or N x 3');
+    end
+
+    maxClimb = 20;
+    if isfield(params, 'maxClimbAngle')
+        maxClimb = params.maxClimbAngle;
+    end
+    sampleStep = 0;
+    if isfield(params, 'altitudeSampleStep')
+        sampleStep = params.altitudeSampleStep;
+    end
+
+    if useMex && isa(demData.Z, 'double') && min(size(demData.Z)) >= 2
+        [z, info] = altitudeProfile_mex(double(path(:, 1:2)), demData, ...
+                                        [params.minAGL, maxClimb, sampleStep]);
+        return;
+    end
+
+    %% MATLAB fallback (same passes as native/altitudeProfile.cpp)
+    if ~(maxClimb > 0 && maxClimb < 90)
+        error('altitudeProfile:InvalidInput', ...
+              'maxClimbAngle must be between 0 and 90 degrees');
+    end
+    if sampleStep <= 0
+        sampleStep = demData.resolution;
+    end
+    % A hair under tan(maxClimb) so rounding cannot tip a leg over it
+    g = tand(maxClimb) * (1 - 1e-9);
+
+    x = double(path(:, 1));
+    y = double(path(:, 2));
+    n = numel(x);
+    info = struct('samples', n, 'legsLifted', 0, 'maxLift', 0);
+    if n < 2
+        z = demInterpolateBatch(demData, x, y) + params.minAGL;
+        return;
+    end
+
+    % Stations: every waypoint, the even samples of its leg, every post
+    % line it crosses and the terrain peak between two crossings
+    legLen = hypot(diff(x), diff(y));
+    m = ones(n - 1, 1);
+    m(legLen > sampleStep) = ceil(legLen(legLen > sampleStep) / sampleStep);
+    legT = cell(n - 1, 1);
+    for i = 1:n - 1
+        t = sort([(0:m(i)-1)' / m(i); postCrossings(demData, x(i:i+1), y(i:i+1))]);
+        tNext = [t(2:end); 1];
+        [~, tPeak] = pieceRise(demData, x, y, i * ones(size(t)), t, tNext, 0, 0);
+        legT{i} = unique([t; tPeak(tPeak > t & tPeak < tNext)]);
+    end
+    m = cellfun(@numel, legT);
+    first = [0; cumsum(m)];                 % 0-based station of waypoint i
+    leg = repelem((1:n-1)', m);
+    t = vertcat(legT{:});
+    tNext = [t(2:end); 1];
+    tNext(first(2:end)) = 1;                % the next waypoint ends the leg
+    xs = [x(leg) + t .* (x(leg + 1) - x(leg)); x(end)];
+    ys = [y(leg) + t .* (y(leg + 1) - y(leg)); y(end)];
+    zs = demInterpolateBatch(demData, xs, ys) + params.minAGL;
+    info.samples = numel(zs);
+
+    % Envelope over the stations
+    drop = g * legLen(leg) .* (tNext - t);
+    zs = climbEnvelope(zs, drop);
+
+    % Lift both ends of a leg whose chord sags below the envelope at a
+    % station or below the floor between two
+    z0 = zs(first(leg) + 1);
+    z1 = zs(first(leg + 1) + 1);
+    chord = z0 + t .* (z1 - z0);
+    rise = pieceRise(demData, x, y, leg, t, tNext, chord, ...
+                     z0 + tNext .* (z1 - z0)) + params.minAGL;
+    sag = accumarray(leg, max(zs(1:end-1) - chord, rise), [n - 1, 1], @max);
+    sag(sag <= 1e-6) = 0;
+    z = zs(first + 1) + max([sag; 0], [0; sag]);
+    info.legsLifted = nnz(sag);
+    info.maxLift = max(sag);
+    if info.legsLifted > 0
+        z = climbEnvelope(z, g * legLen);
+    end
+end
+
+%% Helper: Post lines crossed by a leg
+function t = postCrossings(demData, x, y)
+    %POSTCROSSINGS Leg fractions in (0, 1) at post lines inside the grid
+    [rows, cols] = size(demData.Z);
+    u = (x - demData.xMin) / demData.resolution;
+    v = (y - demData.yMin) / demData.resolution;
+    t = zeros(0, 1);
+    if u(2) ~= u(1)
+        k = max(ceil(min(u)), 0):min(floor(max(u)), cols - 1);
+        t = [t; (k(:) - u(1)) / (u(2) - u(1))];
+    end
+    if v(2) ~= v(1)
+        k = max(ceil(min(v)), 0):min(floor(max(v)), rows - 1);
+        t = [t; (k(:) - v(1)) / (v(2) - v(1))];
+    end
+    t = t(t > 0 & t < 1);
+end
+
+%% Helper: Terrain above a line on pieces inside one DEM cell
+function [rise, tPeak] = pieceRise(demData, x, y, leg, ta, tb, za, zb)
+    %PIECERISE Largest terrain - line over [ta, tb] of each leg
+    %   The line runs from za at ta to zb at tb. Each piece lies inside one
+    %   cell (or beyond one edge of the grid, where the interpolation
+    %   clamps), so the bilinear terrain is a quadratic in t there.
+    Z = double(demData.Z);
+    [rows, cols] = size(Z);
+    res = demData.resolution;
+    dx = x(leg + 1) - x(leg);
+    dy = y(leg + 1) - y(leg);
+    tm = (ta + tb) / 2;
+    i = min(max(floor((x(leg) + tm .* dx - demData.xMin) / res), 0), cols - 2);
+    j = min(max(floor((y(leg) + tm .* dy - demData.yMin) / res), 0), rows - 2);
+    idx = j + 1 + rows * i;
+    fa = min(max((x(leg) + ta .* dx - demData.xMin) / res - i, 0), 1);
+    fb = min(max((x(leg) + tb .* dx - demData.xMin) / res - i, 0), 1);
+    ga = min(max((y(leg) + ta .* dy - demData.yMin) / res - j, 0), 1);
+    gb = min(max((y(leg) + tb .* dy - demData.yMin) / res - j, 0), 1);
+    df = fb - fa;
+    dg = gb - ga;
+
+    % h(s) = terrain(s) - line(s), s in [0, 1] over the piece
+    A = Z(idx + rows) - Z(idx);
+    B = Z(idx + 1) - Z(idx);
+    C = Z(idx) - Z(idx + 1) - Z(idx + rows) + Z(idx + rows + 1);
+    h0 = Z(idx) + A .* fa + B .* ga + C .* fa .* ga - za;
+    h1 = A .* df + B .* dg + C .* (fa .* dg + ga .* df) - (zb - za);
+    h2 = C .* df .* dg;
+    rise = max(h0, h0 + h1 + h2);
+    tPeak = ta;
+    tPeak(h0 + h1 + h2 > h0) = tb(h0 + h1 + h2 > h0);
+    s = -h1 ./ (2 * h2);
+    hs = h0 + s .* (h1 + s .* h2);
+    in = h2 < 0 & s > 0 & s < 1 & hs > rise;
+    rise(in) = hs(in);
+    tPeak(in) = ta(in) + s(in) .* (tb(in) - ta(in));
+end
+
+%% Helper: Lowest profile above zs with a per-step drop limit
+function zs = climbEnvelope(zs, drop)
+    %CLIMBENVELOPE Forward and backward pass, drop(k) between k and k+1
+    for k = 2:numel(zs)
+        zs(k) = max(zs(k), zs(k-1) - drop(k-1));
+    end
+    for k = numel(zs)-1:-1:1
+        zs(k) = max(zs(k), zs(k+1) - drop(k));
+    end
+end
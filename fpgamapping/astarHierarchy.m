@@ -0,0 +1,68 @@
+%% astarHierarchy.m
+% Build the HPA* abstraction used by astarPathfinding with astarMode 'hpa'
+% Pair with astarHierarchyFree once the obstacle grid changes
+%
+% Project: Drone Pathfinding with Coverage Path Planning
+% Module: A* Pathfinding - Module 3
+% Date: 2025-12-08
+% Compatibility: MATLAB 2023b+
+
+function handle = astarHierarchy(demData, obstacles, params)
+    %ASTARHIERARCHY Precompute cluster transitions and in-cluster costs
+    %
+    % Syntax:
+    %   handle = astarHierarchy(demData, obstacles, params)
+    %
+    % Inputs:
+    %   demData   - DEM structure (.Z, .resolution, .xMin/.xMax/.yMin/.yMax)
+    %   obstacles - struct with grid, resolution, bounds ([] if none)
+    %   params    - struct with maxSlope (degrees) and, optionally,
+    %               hpaClusterSize (posts per cluster edge, default 16)
+    %
+    % Outputs:
+    %   handle - uint64 hierarchy handle for obstacles.hierarchy
+    %
+    % The DEM post grid is cut into hpaClusterSize x hpaClusterSize
+    % clusters. Each open stretch of a cluster border becomes one or two
+    % transitions, and the border nodes of a cluster are linked with their
+    % exact in-cluster path costs under the same bounds, obstacle and slope
+    % rules as astarTraversability. A query then only searches this small
+    % graph and refines the clusters along the result, so build once per
+    % DEM, obstacle grid and maxSlope and reuse it for every leg. Paths
+    % start and end on the posts nearest to the query points and are
+    % near-optimal (they cross cluster borders at transitions only). Pairs
+    % the abstract graph does not connect, such as a start on an obstacle
+    % cell, fall back to A* over the whole post grid.
+    %
+    % Example:
+    %   params.astarMode = 'hpa';
+    %   obstacles.hierarchy = astarHierarchy(demData, obstacles, params);
+    %   [path, stats] = astarPathfinding(startPoint, goalPoint, demData, ...
+    %                                    obstacles, params);
+    %   astarHierarchyFree(obstacles.hierarchy);
+
+    persistent useMex
+    if isempty(useMex)
+        useMex = (exist('astarPathfinding_mex', 'file') == 3);
+    end
+
+    if nargin < 3
+        error('astarHierarchy:MissingInput', ...
+              'Requires demData, obstacles and params');
+    end
+    if ~useMex
+        error('astarHierarchy:NoNative', ...
+              'The hierarchical planner needs astarPathfinding_mex; run build_native');
+    end
+
+    clusterSize = 16;
+    if isfield(params, 'hpaClusterSize')
+        clusterSize = params.hpaClusterSize;
+    end
+
+    tic;
+    handle = astarPathfinding_mex('hierarchy', demData, obstacles, ...
+                                  params.maxSlope, clusterSize);
+    fprintf('  ✓ HPA* hierarchy built (%d-post clusters) in %.2f s\n', ...
+            clusterSize, toc);
+end
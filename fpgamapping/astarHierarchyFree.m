@@ -0,0 +1,18 @@
+%% astarHierarchyFree.m
+% Release an HPA* abstraction made by astarHierarchy
+%
+% Project: Drone Pathfinding with Coverage Path Planning
+% Module: A* Pathfinding - Module 3
+% Date: 2025-12-08
+% Compatibility: MATLAB 2023b+
+
+function astarHierarchyFree(handle)
+    %ASTARHIERARCHYFREE Release a hierarchy handle (freeing twice is harmless)
+    %
+    % Syntax:
+    %   astarHierarchyFree(handle)
+
+    if isa(handle, 'uint64')
+        astarPathfinding_mex('free', handle);
+    end
+end
@@ -0,0 +1,67 @@
+%% astarIncremental.m
+% Create an incremental (D* Lite) planner towards a fixed goal
+% Re-plan with astarIncrementalPlan as no-fly zones come and go
+%
+% Project: Drone Pathfinding with Coverage Path Planning
+% Module: A* Pathfinding - Module 3
+% Date: 2025-12-10
+% Compatibility: MATLAB 2023b+
+
+function planner = astarIncremental(goalPoint, demData, obstacles, params)
+    %ASTARINCREMENTAL Keep a search tree towards goalPoint between re-plans
+    %
+    % Syntax:
+    %   planner = astarIncremental(goalPoint, demData, obstacles, params)
+    %
+    % Inputs:
+    %   goalPoint - [X, Y] or [X, Y, Z] goal coordinate
+    %   demData   - DEM structure (.Z, .resolution, .xMin/.xMax/.yMin/.yMax)
+    %   obstacles - struct with grid, resolution, bounds ([] if none)
+    %   params    - struct with maxSlope (degrees)
+    %
+    % Outputs:
+    %   planner - struct with handle (uint64), goal and demData, for
+    %             astarIncrementalPlan and astarIncrementalFree
+    %
+    % The planner searches backwards from the goal post over the same
+    % bounds, obstacle and slope rules as astarTraversability, and keeps
+    % its distances and open list between calls. The elevations and the
+    % obstacle grid are copied at creation; later edits reach the planner
+    % only as changed cells passed to astarIncrementalPlan. The first plan
+    % is a full search, later ones repair only what the changes affect.
+    %
+    % Example:
+    %   planner = astarIncremental(goalPoint, demData, obstacles, params);
+    %   [path, stats] = astarIncrementalPlan(planner, startPoint);
+    %   % ... a no-fly zone is added mid-mission
+    %   [newGrid, ~] = obstacleGrid(demData, params, customObstacles);
+    %   [r, c] = find(newGrid ~= obstacles.grid);
+    %   changed = [r, c, newGrid(sub2ind(size(newGrid), r, c))];
+    %   [path, stats] = astarIncrementalPlan(planner, path(4, :), changed, true);
+    %   astarIncrementalFree(planner);
+
+    persistent useMex
+    if isempty(useMex)
+        useMex = (exist('astarIncremental_mex', 'file') == 3);
+    end
+
+    if nargin < 4
+        error('astarIncremental:MissingInput', ...
+              'Requires goalPoint, demData, obstacles and params');
+    end
+    if ~useMex
+        error('astarIncremental:NoNative', ...
+              'The incremental planner needs astarIncremental_mex; run build_native');
+    end
+
+    goalPoint = goalPoint(:)';
+    if length(goalPoint) < 2
+        error('astarIncremental:InvalidCoordinates', ...
+              'Goal must have at least [X, Y]');
+    end
+
+    handle = astarIncremental_mex('create', demData, obstacles, ...
+                                  params.maxSlope, goalPoint(1:2));
+    planner = struct('handle', handle, 'goal', goalPoint(1:2), ...
+                     'demData', demData);
+end
@@ -0,0 +1,19 @@
+%% astarIncrementalFree.m
+% Release an incremental planner made by astarIncremental
+%
+% Project: Drone Pathfinding with Coverage Path Planning
+% Module: A* Pathfinding - Module 3
+% Date: 2025-12-10
+% Compatibility: MATLAB 2023b+
+
+function astarIncrementalFree(planner)
+    %ASTARINCREMENTALFREE Release a planner (freeing twice is harmless)
+    %
+    % Syntax:
+    %   astarIncrementalFree(planner)
+
+    if isstruct(planner) && isfield(planner, 'handle') && ...
+       isa(planner.handle, 'uint64')
+        astarIncremental_mex('free', planner.handle);
+    end
+end
@@ -0,0 +1,81 @@
+%% astarIncrementalPlan.m
+% Re-plan from a new start after obstacle cells changed, repairing the
+% search kept by an astarIncremental planner instead of starting over
+%
+% Project: Drone Pathfinding with Coverage Path Planning
+% Module: A* Pathfinding - Module 3
+% Date: 2025-12-10
+% Compatibility: MATLAB 2023b+
+
+function [path, planStats] = astarIncrementalPlan(planner, startPoint, changedCells, compareFull)
+    %ASTARINCREMENTALPLAN Apply obstacle changes and return the new path
+    %
+    % Syntax:
+    %   [path, planStats] = astarIncrementalPlan(planner, startPoint)
+    %   [path, planStats] = astarIncrementalPlan(planner, startPoint, changedCells)
+    %   [path, planStats] = astarIncrementalPlan(planner, startPoint, changedCells, true)
+    %
+    % Inputs:
+    %   planner      - struct from astarIncremental
+    %   startPoint   - [X, Y] or [X, Y, Z] current position
+    %   changedCells - [Kx3] [row, col, blocked] obstacle grid cells that
+    %                  changed since the last call (default none)
+    %   compareFull  - also count the expansions of a from-scratch search
+    %                  over the current grid (default false)
+    %
+    % Outputs:
+    %   path      - [Nx3] waypoint path [X, Y, Z] from start to the goal
+    %               post, empty when the goal is cut off
+    %   planStats - struct with found, pathLength, nodesExpanded (queue
+    %               pops of this repair), nodesUpdated (posts whose edges
+    %               the changes touched), fullReplanExpansions (NaN unless
+    %               compareFull) and computeTime
+    %
+    % Rows and columns index the obstacle grid the planner was created
+    % with; diffing the old and new obstacleGrid outputs gives them (see
+    % astarIncremental). The start may move freely between calls.
+
+    if nargin < 2
+        error('astarIncrementalPlan:MissingInput', ...
+              'Requires planner and startPoint');
+    end
+    if nargin < 3
+        changedCells = zeros(0, 3);
+    end
+    if nargin < 4
+        compareFull = false;
+    end
+
+    startPoint = startPoint(:)';
+    if length(startPoint) < 2
+        error('astarIncrementalPlan:InvalidCoordinates', ...
+              'Start must have at least [X, Y]');
+    end
+
+    tic;
+    fullExpansions = NaN;
+    if compareFull
+        [xy, nodesExpanded, status, nodesUpdated, fullExpansions] = ...
+            astarIncremental_mex('plan', planner.handle, startPoint(1:2), ...
+                                 double(changedCells));
+    else
+        [xy, nodesExpanded, status, nodesUpdated] = ...
+            astarIncremental_mex('plan', planner.handle, startPoint(1:2), ...
+                                 double(changedCells));
+    end
+    computeTime = toc;
+
+    if status == 0
+        path = [xy, demInterpolateBatch(planner.demData, xy(:, 1), xy(:, 2))];
+        pathLength = sum(sqrt(sum(diff(path(:, 1:2)).^2, 2)));
+    else
+        path = zeros(0, 3);
+        pathLength = Inf;
+    end
+
+    planStats = struct('found', status == 0, 'pathLength', pathLength, ...
+                       'nodesExpanded', nodesExpanded, ...
+                       'nodesUpdated', nodesUpdated, ...
+                       'fullReplanExpansions', fullExpansions, ...
+                       'computeTime', computeTime);
+end
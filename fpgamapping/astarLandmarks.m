@@ -0,0 +1,118 @@
+%% astarLandmarks.m
+% Build (or load) the ALT landmark tables used by astarHeuristic 'alt'
+% Tables are cached next to the DEM file and rebuilt when the inputs change
+%
+% Project: Drone Pathfinding with Coverage Path Planning
+% Module: A* Pathfinding - Module 3
+% Date: 2025-12-12
+% Compatibility: MATLAB 2023b+
+
+function landmarks = astarLandmarks(demData, obstacles, params)
+    %ASTARLANDMARKS Landmark distance fields for ALT lower bounds
+    %
+    % Syntax:
+    %   landmarks = astarLandmarks(demData, obstacles, params)
+    %
+    % Inputs:
+    %   demData   - DEM structure (.Z, .resolution, .xMin/.xMax/.yMin/.yMax)
+    %   obstacles - struct with grid, resolution, bounds ([] if none),
+    %               optionally with a traversability mask
+    %   params    - struct with maxSlope and, optionally, altLandmarks
+    %               (count, default 8), demFile and altCacheFile ('' = no
+    %               cache, default <demFile>.alt.mat beside the DEM)
+    %
+    % Outputs:
+    %   landmarks - struct for obstacles.landmarks:
+    %               .dist  - [rows x cols x K] single, terrain distance of
+    %                        every DEM post from each landmark (Inf where
+    %                        unreachable)
+    %               .posts - [Kx1] linear DEM post indices of the landmarks
+    %               .key   - uint64 fingerprint of DEM, bounds, obstacle
+    %                        grid and maxSlope
+    %               .count - requested landmark count
+    %
+    % Landmarks are spread by farthest-point selection over the largest
+    % connected region of the traversability mask. The triangle inequality
+    % on their distance fields gives A* a lower bound that follows the
+    % obstacles, so long detours expand a fraction of the nodes, and start
+    % / goal pairs a landmark shows to be disconnected fail at once. The
+    % tables cost K full Dijkstra passes and K singles per post, so they
+    % are written to altCacheFile and reused while the fingerprint and
+    % count match. The last tables are also kept in memory, so repeated
+    % queries on the same DEM and obstacles only pay for the fingerprint.
+    %
+    % Example:
+    %   params.astarHeuristic = 'alt';
+    %   obstacles.landmarks = astarLandmarks(demData, obstacles, params);
+    %   [path, stats] = astarPathfinding(startPoint, goalPoint, demData, ...
+    %                                    obstacles, params);
+
+    persistent useMex lastLandmarks
+    if isempty(useMex)
+        useMex = (exist('astarPathfinding_mex', 'file') == 3);
+    end
+
+    if nargin < 3
+        error('astarLandmarks:MissingInput', ...
+              'Requires demData, obstacles and params');
+    end
+    if ~useMex
+        error('astarLandmarks:NoNative', ...
+              'ALT landmarks need astarPathfinding_mex; run build_native');
+    end
+
+    count = 8;
+    if isfield(params, 'altLandmarks')
+        count = params.altLandmarks;
+    end
+
+    key = astarPathfinding_mex('fingerprint', demData, obstacles, params.maxSlope);
+    if ~isempty(lastLandmarks) && lastLandmarks.key == key && ...
+       lastLandmarks.count == count
+        landmarks = lastLandmarks;
+        return;
+    end
+    cacheFile = landmarkCacheFile(params);
+
+    if ~isempty(cacheFile) && isfile(cacheFile)
+        try
+            cached = load(cacheFile, 'landmarks');
+            if cached.landmarks.key == key && cached.landmarks.count == count
+                landmarks = cached.landmarks;
+                lastLandmarks = landmarks;
+                fprintf('    ✓ ALT landmarks loaded: %s\n', cacheFile);
+                return;
+            end
+        catch
+            % Unreadable or stale layout: rebuild below
+        end
+    end
+
+    tic;
+    [dist, posts] = astarPathfinding_mex('landmarks', demData, obstacles, ...
+                                         params.maxSlope, count);
+    landmarks = struct('dist', dist, 'posts', posts, 'key', key, 'count', count);
+    lastLandmarks = landmarks;
+    fprintf('    ✓ ALT landmarks built: %d in %.2f s\n', numel(posts), toc);
+
+    if ~isempty(cacheFile)
+        try
+            save(cacheFile, 'landmarks', '-v7.3');
+        catch err
+            fprintf('    ⚠ Could not cache ALT landmarks: %s\n', err.message);
+        end
+    end
+end
+
+%% Helper: Cache file beside the DEM file
+function cacheFile = landmarkCacheFile(params)
+    %LANDMARKCACHEFILE Explicit altCacheFile, else <demFile>.alt.mat
+
+    cacheFile = '';
+    if isfield(params, 'altCacheFile')
+        cacheFile = params.altCacheFile;
+    elseif isfield(params, 'demFile') && ~isempty(params.demFile)
+        [folder, name] = fileparts(params.demFile);
+        cacheFile = fullfile(folder, [name, '.alt.mat']);
+    end
+end
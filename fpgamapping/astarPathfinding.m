@@ -19,7 +19,9 @@ function [path, pathStats] = astarPathfinding(startPoint, goalPoint, demData, ob
     %   startPoint - [X, Y] or [X, Y, Z] start coordinate
     %   goalPoint  - [X, Y] or [X, Y, Z] goal coordinate
     %   demData    - struct from generateSyntheticDEM or demImport
-    %   obstacles  - struct with obstacle info ([] if none)
+    %   obstacles  - struct with obstacle info ([] if none); an optional
+    %                traversability field (astarTraversability) replaces the
+    %                per-edge bounds/obstacle/slope tests
     %   params     - struct with A* configuration
     %
     % Outputs:
@@ -29,6 +31,42 @@ function [path, pathStats] = astarPathfinding(startPoint, goalPoint, demData, ob
     % Example:
     %   [path, stats] = astarPathfinding([500100, 5400100], [500900, 5400900], ...
     %                                     demData, obstacles, params);
+    %
+    % The search runs in astarPathfinding_mex (binary-heap open list, dense
+    % node arrays) when it has been built with build_native; otherwise the
+    % list-based search below is used. Both expand the same nodes in the
+    % same order and return the same path.
+    %
+    % params.astarMode picks the native planner:
+    %   'astar' - plain A* over the lattice (default)
+    %   'jps'   - Jump Point Search: same optimal length, a fraction of the
+    %             expansions, but it only sees bounds and obstacles.grid, so
+    %             steep ground must already be rasterised into the grid
+    %   'hpa'   - hierarchical A* over obstacles.hierarchy (astarHierarchy),
+    %             built once per obstacle grid; near-optimal, endpoints
+    %             snapped to DEM posts. Built and freed per call if absent
+    %   'ara'   - anytime ARA*: weighted A* starting at params.araWeight,
+    %             lowered by params.araWeightStep after each path until
+    %             the wall-clock budget params.astarTimeBudget (microseconds,
+    %             Inf = until optimal) runs out. Returns the best path so
+    %             far; pathStats.anytime holds the proven bound
+    %             (cost <= bound * optimal) and the improvement history
+    % All need astarPathfinding_mex; without it the list search is used.
+    %
+    % params.astarHeuristic picks the estimate of the remaining cost:
+    %   'euclidean' (default), 'manhattan' or 'diagonal' (octile), or
+    %   'alt' - Euclidean raised by the landmark tables of astarLandmarks
+    %           (obstacles.landmarks; if absent, astarLandmarks builds or
+    %           loads them once and keeps them for later queries on the
+    %           same DEM and obstacles, and runCompleteMission builds them
+    %           before Stage 6);
+    %           exact paths with far fewer expansions around large
+    %           obstacles. Plain A* from a DEM post only; needs the MEX
+    
+    persistent useMex
+    if isempty(useMex)
+        useMex = (exist('astarPathfinding_mex', 'file') == 3);
+    end
     
     %% Input validation
     if nargin < 5
@@ -52,6 +90,116 @@ function [path, pathStats] = astarPathfinding(startPoint, goalPoint, demData, ob
     tic;
     gridResolution = demData.resolution;
     
+    % Keep the terrain resident for the many slope lookups below
+    dem = demLoad(demData);
+    demCleanup = onCleanup(@() demFree(dem));
+    
+    maxExpansions = 100000;
+    if isfield(params, 'astarMaxExpansions')
+        maxExpansions = params.astarMaxExpansions;
+    end
+    
+    mode = 'astar';
+    if isfield(params, 'astarMode')
+        mode = lower(char(params.astarMode));
+    end
+    if ~ismember(mode, {'astar', 'jps', 'hpa', 'ara'})
+        error('astarPathfinding:InvalidMode', ...
+              'params.astarMode must be ''astar'', ''jps'', ''hpa'' or ''ara''');
+    end
+    if ~useMex && ~strcmp(mode, 'astar')
+        fprintf('⚠ astarMode ''%s'' needs astarPathfinding_mex, using plain A*\n', mode);
+    end
+    
+    heuristicName = 'euclidean';
+    if isfield(params, 'astarHeuristic')
+        heuristicName = lower(char(params.astarHeuristic));
+    end
+    if ~ismember(heuristicName, {'euclidean', 'manhattan', 'diagonal', 'alt'})
+        error('astarPathfinding:InvalidHeuristic', ...
+              'params.astarHeuristic must be ''euclidean'', ''manhattan'', ''diagonal'' or ''alt''');
+    end
+    if strcmp(heuristicName, 'alt') && ~useMex
+        fprintf('⚠ astarHeuristic ''alt'' needs astarPathfinding_mex, using Euclidean\n');
+        heuristicName = 'euclidean';
+    end
+    params.astarHeuristic = heuristicName;
+    
+    % Precomputed move mask, usable when the search lattice is the post grid
+    moveMask = [];
+    if isstruct(obstacles) && isfield(obstacles, 'traversability') && ...
+       ~isempty(obstacles.traversability)
+        [rows, cols] = size(demData.Z);
+        i0 = round((startPoint(1) - demData.xMin) / gridResolution);
+        j0 = round((startPoint(2) - demData.yMin) / gridResolution);
+        if demData.xMin + i0 * gridResolution == startPoint(1) && ...
+           demData.yMin + j0 * gridResolution == startPoint(2) && ...
+           i0 >= 0 && j0 >= 0 && ...
+           i0 + floor((demData.xMax - startPoint(1)) / gridResolution) <= cols - 1 && ...
+           j0 + floor((demData.yMax - startPoint(2)) / gridResolution) <= rows - 1
+            moveMask = obstacles.traversability;
+        end
+    end
+    
+    %% Native search
+    if useMex
+        if strcmp(mode, 'hpa') && ~(isstruct(obstacles) && ...
+                isfield(obstacles, 'hierarchy') && ~isempty(obstacles.hierarchy))
+            if ~isstruct(obstacles)
+                obstacles = struct();
+            end
+            obstacles.hierarchy = astarHierarchy(demData, obstacles, params);
+            hpaCleanup = onCleanup(@() astarHierarchyFree(obstacles.hierarchy));
+        end
+        if strcmp(heuristicName, 'alt') && ~(isstruct(obstacles) && ...
+                isfield(obstacles, 'landmarks') && ~isempty(obstacles.landmarks))
+            if ~isstruct(obstacles)
+                obstacles = struct();
+            end
+            obstacles.landmarks = astarLandmarks(demData, obstacles, params);
+        end
+        anytime = [];
+        if strcmp(mode, 'ara')
+            [xy, nodesExpanded, status, anytime] = astarPathfinding_mex( ...
+                startPoint(1:2), goalPoint(1:2), demData, obstacles, ...
+                params.maxSlope, maxExpansions, mode, heuristicName, ...
+                anytimeSchedule(params));
+        else
+            [xy, nodesExpanded, status] = astarPathfinding_mex(startPoint(1:2), ...
+                goalPoint(1:2), demData, obstacles, params.maxSlope, maxExpansions, ...
+                mode, heuristicName);
+        end
+        if status == 2
+            fprintf('No path found - returning direct connection\n');
+            z = demQuery(dem, [startPoint(1); goalPoint(1)], [startPoint(2); goalPoint(2)]);
+            path = [startPoint(1:2), z(1); goalPoint(1:2), z(2)];
+        else
+            if status == 0
+                fprintf('Goal found!\n');
+            elseif isempty(anytime)
+                fprintf('Warning: Maximum nodes expanded\n');
+            else
+                fprintf('Warning: Time budget or node limit reached before any path\n');
+            end
+            path = [xy, demQuery(dem, xy(:, 1), xy(:, 2))];
+        end
+        elapsed = toc;
+        pathStats = createPathStats(path, nodesExpanded, elapsed, demData, params);
+        if ~isempty(anytime)
+            pathStats.anytime = anytime;
+            if status == 0
+                fprintf('ARA*: %d weight(s) completed, cost within %.3f x optimal (%.0f us)\n', ...
+                        anytime.iterations, anytime.bound, anytime.elapsedUs);
+            end
+        end
+        if status == 0
+            fprintf('Path length: %.1f m, Nodes expanded: %d\n', ...
+                    pathStats.pathLength, nodesExpanded);
+        end
+        fprintf('===================\n\n');
+        return;
+    end
+    
     %% Initialize A* search
     % Create node at start
     startNode = struct('pos', startPoint(1:2), 'g', 0, 'h', 0, 'f', 0, 'parent', []);
@@ -73,7 +221,7 @@ function [path, pathStats] = astarPathfinding(startPoint, goalPoint, demData, ob
         % Check if goal reached
         if norm(currentNode.pos - goalPoint(1:2)) < gridResolution
             fprintf('Goal found!\n');
-            path = reconstructPath(currentNode, demData);  % FIXED: Always returns 3D
+            path = reconstructPath(currentNode, dem);  % FIXED: Always returns 3D
             elapsed = toc;
             pathStats = createPathStats(path, nodesExpanded, elapsed, demData, params);
             fprintf('Path length: %.1f m, Nodes expanded: %d\n', ...
@@ -87,7 +235,8 @@ function [path, pathStats] = astarPathfinding(startPoint, goalPoint, demData, ob
         openList(idx) = [];
         
         % Expand neighbors (8-connected grid)
-        neighbors = getNeighbors(currentNode, gridResolution, demData, obstacles, params);
+        neighbors = getNeighbors(currentNode, gridResolution, demData, dem, obstacles, ...
+                                 params, moveMask);
         
         for i = 1:size(neighbors, 1)
             neighborPos = neighbors(i, 1:2);
@@ -123,15 +272,14 @@ function [path, pathStats] = astarPathfinding(startPoint, goalPoint, demData, ob
         end
         
         % Safety check: prevent infinite loop
-        if nodesExpanded > 100000
+        if nodesExpanded > maxExpansions
             fprintf('Warning: Maximum nodes expanded\n');
             if ~isempty(closedList)
                 [~, bestIdx] = min([closedList.f]);
-                path = reconstructPath(closedList(bestIdx), demData);
+                path = reconstructPath(closedList(bestIdx), dem);
             else
-                z_start = demInterpolate(demData, startPoint(1), startPoint(2));
-                z_goal = demInterpolate(demData, goalPoint(1), goalPoint(2));
-                path = [startPoint(1:2), z_start; goalPoint(1:2), z_goal];
+                z = demQuery(dem, [startPoint(1); goalPoint(1)], [startPoint(2); goalPoint(2)]);
+                path = [startPoint(1:2), z(1); goalPoint(1:2), z(2)];
             end
             elapsed = toc;
             pathStats = createPathStats(path, nodesExpanded, elapsed, demData, params);
@@ -142,22 +290,45 @@ function [path, pathStats] = astarPathfinding(startPoint, goalPoint, demData, ob
     
     % No path found
     fprintf('No path found - returning direct connection\n');
-    z_start = demInterpolate(demData, startPoint(1), startPoint(2));
-    z_goal = demInterpolate(demData, goalPoint(1), goalPoint(2));
-    path = [startPoint(1:2), z_start; goalPoint(1:2), z_goal];
+    z = demQuery(dem, [startPoint(1); goalPoint(1)], [startPoint(2); goalPoint(2)]);
+    path = [startPoint(1:2), z(1); goalPoint(1:2), z(2)];
     elapsed = toc;
     pathStats = createPathStats(path, nodesExpanded, elapsed, demData, params);
     fprintf('===================\n\n');
 end
 
-%% Helper: Calculate heuristic (Euclidean distance)
+%% Helper: ARA* schedule [weight, weightStep, budgetUs] from params
+function schedule = anytimeSchedule(params)
+    %ANYTIMESCHEDULE Defaults: weight 3, step 0.5, no time budget
+    schedule = [3, 0.5, Inf];
+    if isfield(params, 'araWeight')
+        schedule(1) = params.araWeight;
+    end
+    if isfield(params, 'araWeightStep')
+        schedule(2) = params.araWeightStep;
+    end
+    if isfield(params, 'astarTimeBudget')
+        schedule(3) = params.astarTimeBudget;
+    end
+end
+
+%% Helper: Calculate heuristic (params.astarHeuristic)
 function h = heuristic(pos, goal, params)
-    %HEURISTIC Calculate admissible heuristic for A*
-    h = norm(pos - goal);
+    %HEURISTIC Calculate heuristic for A*, as astarEstimate in the MEX
+    d = abs(pos - goal);
+    switch params.astarHeuristic
+        case 'manhattan'
+            h = d(1) + d(2);
+        case 'diagonal'
+            h = max(d) + (sqrt(2) - 1) * min(d);
+        otherwise
+            h = norm(pos - goal);
+    end
 end
 
 %% Helper: Get neighbor nodes
-function neighbors = getNeighbors(currentNode, resolution, demData, obstacles, params)
+function neighbors = getNeighbors(currentNode, resolution, demData, dem, obstacles, ...
+                                  params, moveMask)
     %GETNEIGHBORS Get valid 8-connected neighbors
     
     pos = currentNode.pos;
@@ -174,6 +345,15 @@ function neighbors = getNeighbors(currentNode, resolution, demData, obstacles, p
         -1, -1; % Diagonal DL
     ];
     
+    % Traversability mask: bit i of the post's byte says whether move i is legal
+    if ~isempty(moveMask)
+        bits = moveMask(round((pos(2) - demData.yMin) / resolution) + 1, ...
+                        round((pos(1) - demData.xMin) / resolution) + 1);
+        legal = bitget(bits, 1:8) == 1;
+        neighbors = pos + directions(legal, :) * resolution;
+        return;
+    end
+    
     neighbors = [];
     
     for i = 1:size(directions, 1)
@@ -193,7 +373,7 @@ function neighbors = getNeighbors(currentNode, resolution, demData, obstacles, p
         end
         
         % Check terrain slope
-        if isTerrainTooSteep(currentNode.pos, newPos, demData, params)
+        if isTerrainTooSteep(currentNode.pos, newPos, dem, params)
             continue;
         end
         
@@ -224,29 +404,33 @@ function isObstacle = isObstacleAtPoint(pos, obstacles, params)
 end
 
 %% Helper: Check terrain slope
-function tooSteep = isTerrainTooSteep(p1, p2, demData, params)
+function tooSteep = isTerrainTooSteep(p1, p2, dem, params)
     %ISTERRAINTOOSTEEP Check if terrain slope exceeds threshold
     
     tooSteep = false;
     maxSlope = params.maxSlope;
     
-    % Get elevations at both points
-    z1 = demInterpolate(demData, p1(1), p1(2));
-    z2 = demInterpolate(demData, p2(1), p2(2));
+    % Get elevations at both points (one batched lookup)
+    zz = demQuery(dem, [p1(1); p2(1)], [p1(2); p2(2)]);
+    z1 = zz(1);
+    z2 = zz(2);
     
     if isnan(z1) || isnan(z2)
         return;
     end
     
-    % Calculate slope
-    horizontalDist = norm(p2 - p1);
-    verticalDist = abs(z2 - z1);
+    % Compare squared rise against tan(maxSlope)^2 * run^2 (no trig per edge)
+    if maxSlope < 0
+        tan2 = -1;
+    elseif ~(maxSlope < 90)
+        tan2 = Inf;
+    else
+        tan2 = tan(maxSlope * pi / 180)^2;
+    end
     
-    if horizontalDist > 0
-        slope = atan(verticalDist / horizontalDist) * 180 / pi;
-        if slope > maxSlope
-            tooSteep = true;
-        end
+    step2 = sum((p2 - p1).^2);
+    if step2 > 0
+        tooSteep = (z2 - z1)^2 > tan2 * step2;
     end
 end
 
@@ -275,25 +459,26 @@ function idx = findInList(pos, list, tolerance)
 end
 
 %% Helper: Reconstruct path - FIXED TO ALWAYS RETURN 3D
-function path = reconstructPath(node, demData)
+function path = reconstructPath(node, dem)
     %RECONSTRUCTPATH Build 3D path by following parent pointers
     %
     % ALWAYS returns [X, Y, Z] - queries DEM for elevation if needed
     
-    path = [];
+    xy = [];
     currentNode = node;
     
     while ~isempty(currentNode)
-        x = currentNode.pos(1);
-        y = currentNode.pos(2);
-        z = demInterpolate(demData, x, y);  % ALWAYS query elevation
-        path = [x, y, z; path];  % ALWAYS 3D format
+        xy = [currentNode.pos; xy];
         
         if isempty(currentNode.parent)
             break;
         end
         currentNode = currentNode.parent;
     end
+    
+    % ALWAYS query elevation - one batched lookup for the whole path
+    z = demQuery(dem, xy(:, 1), xy(:, 2));
+    path = [xy, z];  % ALWAYS 3D format
 end
 
 %% Helper: Create path statistics
@@ -0,0 +1,199 @@
+%% astarReplanSegments.m
+% Re-plan the legs of a waypoint path that cross obstacle cells with A*
+% Blocked stretches are planned independently, in parallel when native
+%
+% Project: Drone Pathfinding with Coverage Path Planning
+% Module: A* Pathfinding - Module 3
+% Date: 2025-12-09
+% Compatibility: MATLAB 2023b+
+
+function [path, replanStats] = astarReplanSegments(path, demData, obstacles, params)
+    %ASTARREPLANSEGMENTS Replace obstacle-crossing legs by A* detours
+    %
+    % Syntax:
+    %   [path, replanStats] = astarReplanSegments(path, demData, obstacles, params)
+    %
+    % Inputs:
+    %   path      - [Nx2+] waypoint path [X, Y, (Z), ...]
+    %   demData   - DEM structure (.Z, .resolution, .xMin/.xMax/.yMin/.yMax)
+    %   obstacles - struct with grid, resolution, bounds (optionally
+    %               traversability and hierarchy, see astarPathfinding)
+    %   params    - struct with maxSlope and the astar* settings
+    %
+    % Outputs:
+    %   path        - path with every blocked stretch replaced by its A*
+    %                 detour; Z of detour points is the DEM elevation and
+    %                 further columns are copied from the stretch start
+    %   replanStats - struct with legs, blockedLegs, spans, replanned,
+    %                 failed, cached, nodesExpanded, computeTime
+    %
+    % A leg is blocked when a straight line between its waypoints passes
+    % over an obstacle cell (sampled at half a cell). Consecutive blocked
+    % legs form one span, planned from the last free waypoint before it to
+    % the first free one after it; spans that A* cannot connect keep their
+    % original legs and are counted as failed.
+    %
+    % With astarPathfinding_mex the spans go to its 'batch' command: a
+    % work-stealing pool of params.astarThreads threads (0 = all cores),
+    % with results memoized per (start, goal, obstacle grid) so re-running
+    % a mission or a sweep that keeps the grid re-plans nothing; in 'hpa'
+    % mode that holds too, though each call builds its own hierarchy, as
+    % the memo knows a hierarchy by its cluster size. Without it the spans
+    % are planned one after another with astarPathfinding.
+    % With astarHeuristic 'alt' (plain A*) each span starts at the DEM
+    % post nearest its first waypoint, where the landmark bound applies.
+    %
+    % Example:
+    %   obstacles = struct('grid', obsGrid, 'resolution', obsInfo.resolution, ...
+    %                      'bounds', obsInfo.bounds);
+    %   [finalPath, stats] = astarReplanSegments(smoothedPath, demData, ...
+    %                                            obstacles, params);
+
+    persistent useMex
+    if isempty(useMex)
+        useMex = (exist('astarPathfinding_mex', 'file') == 3);
+    end
+
+    if nargin < 4
+        error('astarReplanSegments:MissingInput', ...
+              'Requires path, demData, obstacles and params');
+    end
+
+    tic;
+    numLegs = max(size(path, 1) - 1, 0);
+    replanStats = struct('legs', numLegs, 'blockedLegs', 0, 'spans', 0, ...
+                         'replanned', 0, 'failed', 0, 'cached', 0, ...
+                         'nodesExpanded', 0, 'computeTime', 0);
+    if numLegs == 0 || ~isstruct(obstacles) || ~isfield(obstacles, 'grid') || ...
+       isempty(obstacles.grid)
+        replanStats.computeTime = toc;
+        return;
+    end
+
+    %% Find blocked legs and merge them into spans
+    sampleStep = min(obstacles.resolution, demData.resolution) / 2;
+    blocked = false(numLegs, 1);
+    for i = 1:numLegs
+        p1 = path(i, 1:2);
+        p2 = path(i + 1, 1:2);
+        numSamples = max(2, ceil(norm(p2 - p1) / sampleStep) + 1);
+        t = linspace(0, 1, numSamples)';
+        blocked(i) = any(obstacleAt(p1(1) + t * (p2(1) - p1(1)), ...
+                                    p1(2) + t * (p2(2) - p1(2)), obstacles));
+    end
+
+    edges = diff([0; blocked; 0]);
+    spanFirst = find(edges == 1);          % first row of each span
+    spanLast = find(edges == -1);          % last row of each span
+    numSpans = numel(spanFirst);
+    replanStats.blockedLegs = nnz(blocked);
+    replanStats.spans = numSpans;
+    if numSpans == 0
+        replanStats.computeTime = toc;
+        return;
+    end
+
+    starts = path(spanFirst, 1:2);
+    goals = path(spanLast, 1:2);
+
+    maxExpansions = 100000;
+    if isfield(params, 'astarMaxExpansions')
+        maxExpansions = params.astarMaxExpansions;
+    end
+    mode = 'astar';
+    if isfield(params, 'astarMode')
+        mode = lower(char(params.astarMode));
+    end
+    if strcmp(mode, 'ara')
+        mode = 'astar';   % memoized detours must not depend on the clock
+    end
+    numThreads = 0;
+    if isfield(params, 'astarThreads')
+        numThreads = params.astarThreads;
+    end
+    heuristicName = 'euclidean';
+    if isfield(params, 'astarHeuristic')
+        heuristicName = lower(char(params.astarHeuristic));
+    end
+    if useMex && strcmp(heuristicName, 'alt') && strcmp(mode, 'astar')
+        % The landmark bound needs a search that starts on a DEM post:
+        % start each span at the post nearest its waypoint, one short hop
+        % (under a cell diagonal / 2) away
+        res = demData.resolution;
+        i = round((starts(:, 1) - demData.xMin) / res);
+        j = round((starts(:, 2) - demData.yMin) / res);
+        starts = [demData.xMin + res * min(max(i, 0), size(demData.Z, 2) - 1), ...
+                  demData.yMin + res * min(max(j, 0), size(demData.Z, 1) - 1)];
+    end
+
+    %% Plan every span
+    detours = cell(numSpans, 1);
+    status = 2 * ones(numSpans, 1);
+    if useMex
+        if strcmp(mode, 'hpa') && ~(isfield(obstacles, 'hierarchy') && ...
+                                    ~isempty(obstacles.hierarchy))
+            obstacles.hierarchy = astarHierarchy(demData, obstacles, params);
+            hpaCleanup = onCleanup(@() astarHierarchyFree(obstacles.hierarchy));
+        end
+        if strcmp(heuristicName, 'alt') && strcmp(mode, 'astar') && ...
+           ~(isfield(obstacles, 'landmarks') && ~isempty(obstacles.landmarks))
+            obstacles.landmarks = astarLandmarks(demData, obstacles, params);
+        end
+        [detours, nodesExpanded, status, cached] = astarPathfinding_mex('batch', ...
+            starts, goals, demData, obstacles, params.maxSlope, maxExpansions, ...
+            mode, numThreads, heuristicName);
+        replanStats.cached = nnz(cached);
+        replanStats.nodesExpanded = sum(nodesExpanded);
+    else
+        for k = 1:numSpans
+            [detour, pathStats] = astarPathfinding(starts(k, :), goals(k, :), ...
+                                                   demData, obstacles, params);
+            detours{k} = detour(:, 1:2);
+            replanStats.nodesExpanded = replanStats.nodesExpanded + ...
+                                        pathStats.nodesExpanded;
+            % The list search ends within one resolution of a reached goal
+            if norm(detour(end, 1:2) - goals(k, :)) < demData.resolution
+                status(k) = 0;
+            end
+        end
+    end
+
+    %% Splice the detours in, last span first so row indices stay valid
+    for k = numSpans:-1:1
+        if status(k) ~= 0
+            replanStats.failed = replanStats.failed + 1;
+            continue;
+        end
+        xy = detours{k};
+        if isequal(xy(end, :), goals(k, :))
+            xy(end, :) = [];                % the goal row is kept as is
+        end
+        if ~isempty(xy) && isequal(xy(1, :), path(spanFirst(k), 1:2))
+            xy(1, :) = [];                  % so is the start row
+        end
+
+        rows = repmat(path(spanFirst(k), :), size(xy, 1), 1);
+        rows(:, 1:2) = xy;
+        if size(path, 2) >= 3 && ~isempty(xy)
+            rows(:, 3) = demInterpolateBatch(demData, xy(:, 1), xy(:, 2));
+        end
+        path = [path(1:spanFirst(k), :); rows; path(spanLast(k):end, :)];
+        replanStats.replanned = replanStats.replanned + 1;
+    end
+
+    replanStats.computeTime = toc;
+end
+
+%% Helper: Obstacle cells under an array of points
+function blocked = obstacleAt(X, Y, obstacles)
+    %OBSTACLEAT Nearest-cell lookup, points outside the grid are free
+
+    xIdx = round((X - obstacles.bounds(1)) / obstacles.resolution) + 1;
+    yIdx = round((Y - obstacles.bounds(3)) / obstacles.resolution) + 1;
+    inside = xIdx >= 1 & xIdx <= size(obstacles.grid, 2) & ...
+             yIdx >= 1 & yIdx <= size(obstacles.grid, 1);
+
+    blocked = false(size(X));
+    idx = sub2ind(size(obstacles.grid), yIdx(inside), xIdx(inside));
+    blocked(inside) = obstacles.grid(idx) > 0;
+end
@@ -0,0 +1,116 @@
+%% astarTraversability.m
+% Precompute which of the 8 grid moves are legal out of every DEM post
+% Folds the bounds, obstacle and slope tests of A* into one byte per post
+%
+% Project: Drone Pathfinding with Coverage Path Planning
+% Module: A* Pathfinding - Module 3
+% Date: 2025-12-07
+% Compatibility: MATLAB 2023b+
+
+function mask = astarTraversability(demData, obstacles, params)
+    %ASTARTRAVERSABILITY Build the per-post 8-direction move mask
+    %
+    % Syntax:
+    %   mask = astarTraversability(demData, obstacles, params)
+    %
+    % Inputs:
+    %   demData   - DEM structure (.Z, .resolution, .xMin/.xMax/.yMin/.yMax)
+    %   obstacles - struct with grid, resolution, bounds ([] if none)
+    %   params    - struct with maxSlope (degrees)
+    %
+    % Outputs:
+    %   mask - [rows x cols] uint8, same size as demData.Z. Bit d (1-based,
+    %          bitget(mask, d)) is set when the move directions(d, :) of
+    %          astarPathfinding out of that post stays inside the DEM
+    %          bounds, does not land on an obstacle cell and is not
+    %          steeper than params.maxSlope.
+    %
+    % The slope test compares dz^2 with tan(maxSlope)^2 * step^2, so no
+    % trig runs per edge. Attach the result as obstacles.traversability;
+    % astarPathfinding then tests one bit per neighbour whenever the start
+    % lies on a DEM post. Rebuild it when the DEM, the obstacle grid or
+    % maxSlope change.
+    %
+    % Example:
+    %   obstacles.traversability = astarTraversability(demData, obstacles, params);
+    %   [path, stats] = astarPathfinding(startPoint, goalPoint, demData, ...
+    %                                    obstacles, params);
+
+    persistent useMex
+    if isempty(useMex)
+        useMex = (exist('astarTraversability_mex', 'file') == 3);
+    end
+
+    if nargin < 3
+        error('astarTraversability:MissingInput', ...
+              'Requires demData, obstacles and params');
+    end
+
+    if useMex
+        mask = astarTraversability_mex(demData, obstacles, params.maxSlope);
+        return;
+    end
+
+    %% Vectorized MATLAB fallback (same tests as the native builder)
+    [rows, cols] = size(demData.Z);
+    resolution = demData.resolution;
+
+    % Post positions, elevations, and whether a move may land there
+    [X, Y] = meshgrid(demData.xMin + (0:cols-1) * resolution, ...
+                      demData.yMin + (0:rows-1) * resolution);
+    Z = reshape(demInterpolateBatch(demData, X(:), Y(:)), rows, cols);
+    landable = X >= demData.xMin & X <= demData.xMax & ...
+               Y >= demData.yMin & Y <= demData.yMax & ...
+               ~obstacleAt(X, Y, obstacles);
+
+    % Same order as getNeighbors in astarPathfinding.m
+    directions = [1, 0; -1, 0; 0, 1; 0, -1; 1, 1; 1, -1; -1, 1; -1, -1];
+    tan2 = slopeTan2(params.maxSlope);
+
+    mask = zeros(rows, cols, 'uint8');
+    for d = 1:8
+        di = directions(d, 1);   % column (X) step
+        dj = directions(d, 2);   % row (Y) step
+        r = max(1, 1 - dj):min(rows, rows - dj);
+        c = max(1, 1 - di):min(cols, cols - di);
+
+        step2 = (di^2 + dj^2) * resolution^2;
+        dz = Z(r + dj, c + di) - Z(r, c);
+        legal = landable(r + dj, c + di) & ~(dz.^2 > tan2 * step2);
+
+        bit = zeros(rows, cols, 'uint8');
+        bit(r, c) = uint8(legal) * uint8(2^(d - 1));
+        mask = bitor(mask, bit);
+    end
+end
+
+%% Helper: Obstacle cells under an array of points
+function blocked = obstacleAt(X, Y, obstacles)
+    %OBSTACLEAT Nearest-cell lookup, points outside the grid are free
+
+    blocked = false(size(X));
+    if ~isstruct(obstacles) || ~isfield(obstacles, 'grid') || isempty(obstacles.grid)
+        return;
+    end
+
+    xIdx = round((X - obstacles.bounds(1)) / obstacles.resolution) + 1;
+    yIdx = round((Y - obstacles.bounds(3)) / obstacles.resolution) + 1;
+    inside = xIdx >= 1 & xIdx <= size(obstacles.grid, 2) & ...
+             yIdx >= 1 & yIdx <= size(obstacles.grid, 1);
+
+    idx = sub2ind(size(obstacles.grid), yIdx(inside), xIdx(inside));
+    blocked(inside) = obstacles.grid(idx) > 0;
+end
+
+%% Helper: Squared slope limit
+function tan2 = slopeTan2(maxSlope)
+    %SLOPETAN2 tan(maxSlope)^2, with the limits atan() would imply
+
+    if maxSlope < 0
+        tan2 = -1;       % every move is steeper than a negative limit
+    elseif ~(maxSlope < 90)
+        tan2 = Inf;      % nothing is steeper than 90 degrees
+    else
+        tan2 = tan(maxSlope * pi / 180)^2;
+    end
+end
@@ -0,0 +1,74 @@
+%% build_native.m
+% Build the hand-written native MEX kernels in native/
+% MATLAB callers fall back to their pure-MATLAB paths when a MEX is missing
+%
+% Project: Drone Pathfinding with Coverage Path Planning
+% Module: Native acceleration
+% Date: 2025-12-02
+% Compatibility: MATLAB 2023b+ (MinGW-w64, MSVC, GCC or Clang)
+
+function build_native(targets)
+    %BUILD_NATIVE Compile native MEX targets into the project folder
+    %
+    % Syntax:
+    %   build_native()            % build everything
+    %   build_native({'demInterpolateBatch_mex'})
+    %
+    % The kernels select SSE4.1/AVX2 at run time, so no ISA flags are
+    % needed here; the toolchain baseline (-msse2) is kept.
+
+    rootDir = fileparts(mfilename('fullpath'));
+    srcDir = fullfile(rootDir, 'native');
+
+    %% Target table: {mexName, {sources...}}
+    allTargets = {
+        'demInterpolateBatch_mex', {'demInterpolateBatch_mex.cpp', 'demKernel.cpp'};
+        'demHandle_mex',           {'demHandle_mex.cpp', 'demKernel.cpp', ...
+                                    'demTileFile.cpp', 'mappedFile.cpp'};
+        'demReadAscii_mex',        {'demReadAscii_mex.cpp', 'demAsciiParse.cpp', ...
+                                    'mappedFile.cpp'};
+        'demFixpt_mex',            {'demFixpt_mex.cpp', 'demFixptModel.cpp', ...
+                                    'demKernel.cpp'};
+        'astarPathfinding_mex',    {'astarPathfinding_mex.cpp', 'astarBatch.cpp', ...
+                                    'astarDistance.cpp', 'astarSearch.cpp', ...
+                                    'astarHierarchy.cpp', 'astarLandmarks.cpp', ...
+                                    'astarTraversability.cpp', 'demKernel.cpp'};
+        'astarTraversability_mex', {'astarTraversability_mex.cpp', ...
+                                    'astarTraversability.cpp', 'demKernel.cpp'};
+        'obstacleGrid_mex',        {'obstacleGrid_mex.cpp', 'obstacleKernel.cpp', ...
+                                    'astarTraversability.cpp', 'demKernel.cpp'};
+        'astarIncremental_mex',    {'astarIncremental_mex.cpp', ...
+                                    'astarIncremental.cpp', ...
+                                    'astarTraversability.cpp', 'demKernel.cpp'};
+        'obstacleZones_mex',       {'obstacleZones_mex.cpp', 'obstacleZones.cpp', ...
+                                    'astarTraversability.cpp', 'demKernel.cpp'};
+        'pathValidator_mex',       {'pathValidator_mex.cpp', 'pathValidate.cpp', ...
+                                    'astarTraversability.cpp', 'demKernel.cpp'};
+        'altitudeProfile_mex',     {'altitudeProfile_mex.cpp', 'altitudeProfile.cpp', ...
+                                    'demKernel.cpp'};
+        'tspTour_mex',             {'tspTour_mex.cpp', 'tspTour.cpp'};
+        'pathSmoother_mex',        {'pathSmoother_mex.cpp', 'pathSmooth.cpp'};
+    };
+
+    if nargin < 1
+        targets = allTargets(:, 1);
+    end
+
+    cxxFlags = 'CXXFLAGS=$CXXFLAGS -std=c++11 -O2';
+
+    fprintf('\n=== Building native MEX kernels ===\n');
+    for t = 1:size(allTargets, 1)
+        name = allTargets{t, 1};
+        if ~ismember(name, targets)
+            continue;
+        end
+        sources = fullfile(srcDir, allTargets{t, 2});
+        fprintf('  • %s\n', name);
+        mex('-R2018a', '-silent', ['-I' srcDir], cxxFlags, ...
+            '-outdir', rootDir, '-output', name, sources{:});
+    end
+
+    % Wrappers cache MEX availability in persistent variables
+    clear functions; %#ok<CLFUNC>
+    fprintf('===================================\n\n');
+end
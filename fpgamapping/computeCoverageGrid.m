@@ -115,7 +115,7 @@ function [coverageData, adjustedGrid, adjustedWaypoints] = computeCoverageGrid(w
         if useDEM
             % 3D: Add elevation for adjusted waypoints
             wp_2d = [gridX(:), gridY(:)];
-            Z = demInterpolate(demImport(params.demFile), wp_2d(:,1), wp_2d(:,2));
+            Z = demInterpolateBatch(demImport(params.demFile), wp_2d(:,1), wp_2d(:,2));
             adjustedGrid = [wp_2d, Z];
             adjustedWaypoints = adjustedGrid;
         else
@@ -5,36 +5,33 @@ function demData_fixed = convertDEMtoFixedPoint(demData)
     %   demData_fixed = convertDEMtoFixedPoint(demData)
     %
     % Inputs:
-    %   demData - Original DEM from Module 0 (floating-point)
+    %   demData - Original DEM from Module 0 (floating-point, compact or
+    %             legacy with X/Y grids)
     %
     % Outputs:
-    %   demData_fixed - DEM with fixed-point arrays
+    %   demData_fixed - DEM with a fixed-point Z grid. Coordinates stay
+    %                   implicit (origin + resolution), as in demCompact
     
     % Fixed-point type definitions
-    coord_Type = numerictype(1, 32, 16);
-    coord_F = fimath('RoundingMethod', 'Floor', 'OverflowAction', 'Saturate');
-    
     elev_Type = numerictype(1, 16, 12);
     elev_F = fimath('RoundingMethod', 'Nearest', 'OverflowAction', 'Saturate');
     
-    % Convert X grid
-    demData_fixed.X = fi(demData.X, coord_Type, coord_F);
-    
-    % Convert Y grid
-    demData_fixed.Y = fi(demData.Y, coord_Type, coord_F);
+    demData = demCompact(demData);
     
-    % Convert Z elevation
+    % Convert Z elevation (the only full-size array)
     demData_fixed.Z = fi(demData.Z, elev_Type, elev_F);
     
     % Preserve metadata
     demData_fixed.resolution = demData.resolution;
+    demData_fixed.rows = demData.rows;
+    demData_fixed.cols = demData.cols;
     demData_fixed.type = demData.type;
     
     % Store bounds
-    demData_fixed.bounds.xMin = demData.X(1, 1);
-    demData_fixed.bounds.xMax = demData.X(1, end);
-    demData_fixed.bounds.yMin = demData.Y(1, 1);
-    demData_fixed.bounds.yMax = demData.Y(end, 1);
+    demData_fixed.bounds.xMin = demData.xMin;
+    demData_fixed.bounds.xMax = demData.xMax;
+    demData_fixed.bounds.yMin = demData.yMin;
+    demData_fixed.bounds.yMax = demData.yMax;
     
     fprintf('✓ DEM converted to fixed-point:\n');
     fprintf('  X range: %.1f to %.1f\n', demData_fixed.bounds.xMin, demData_fixed.bounds.xMax);
@@ -130,9 +130,11 @@ fprintf('=== Section 4: Visualization ===\n');
 figure('Name', 'Module 3: Complete A* System', 'NumberTitle', 'off', ...
        'Position', [100 100 1400 600]);
 
+[xGrid, yGrid] = demCoordinates(demData);
+
 % Terrain with path
 subplot(2, 2, 1);
-surf(demData.X, demData.Y, demData.Z, 'EdgeColor', 'none');
+surf(xGrid, yGrid, demData.Z, 'EdgeColor', 'none');
 hold on;
 if size(path, 2) >= 3
     plot3(path(:,1), path(:,2), path(:,3), 'r-', 'LineWidth', 2, ...
@@ -151,7 +153,7 @@ view(45, 45);
 
 % 2D path with obstacles
 subplot(2, 2, 2);
-imagesc(demData.X(1,:), demData.Y(:,1), obsGrid);
+imagesc(xGrid, yGrid, obsGrid);
 colormap(gca, 'gray');
 hold on;
 plot(path(:,1), path(:,2), 'r-', 'LineWidth', 2, 'DisplayName', 'Path');
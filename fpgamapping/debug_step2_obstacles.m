@@ -69,9 +69,11 @@ try
     figure('Name', 'Obstacle Grid', 'NumberTitle', 'off', ...
            'Position', [100 100 1200 500]);
     
+    [xGrid, yGrid] = demCoordinates(demData);
+    
     % Terrain
     subplot(1, 2, 1);
-    imagesc(demData.X(1,:), demData.Y(:,1), demData.Z);
+    imagesc(xGrid, yGrid, demData.Z);
     colormap(gca, 'parula');
     colorbar;
     xlabel('UTM Easting (m)');
@@ -81,7 +83,7 @@ try
     
     % Obstacles
     subplot(1, 2, 2);
-    imagesc(demData.X(1,:), demData.Y(:,1), obsGrid);
+    imagesc(xGrid, yGrid, obsGrid);
     colormap(gca, 'gray');
     xlabel('UTM Easting (m)');
     ylabel('UTM Northing (m)');
@@ -0,0 +1,77 @@
+%% demCompact.m
+% Convert a DEM struct to the compact implicit-coordinate form
+% Drops the meshgrid X/Y matrices; coordinates follow from origin + spacing
+%
+% Project: Drone Pathfinding with Coverage Path Planning
+% Module: DEM (Digital Elevation Model) - Module 0
+% Date: 2025-12-04
+% Compatibility: MATLAB 2023b+
+
+function demData = demCompact(demData)
+    %DEMCOMPACT Strip X/Y grids and fill in origin, dimensions and stats
+    %
+    % Syntax:
+    %   demData = demCompact(demData)
+    %
+    % Inputs:
+    %   demData - DEM structure, either compact or legacy (with .X/.Y
+    %             meshgrid matrices the same size as .Z)
+    %
+    % Outputs:
+    %   demData - compact DEM structure:
+    %       .Z - elevation grid (rows x cols, meters)
+    %       .resolution - grid spacing (meters)
+    %       .xMin, .xMax, .yMin, .yMax - UTM boundaries (grid posts)
+    %       .rows, .cols - grid dimensions
+    %       .type - DEM type/source
+    %       .minElevation, .maxElevation, .meanElevation, .stdElevation
+    %
+    % Post (r, c) of Z sits at (xMin + (c-1)*resolution,
+    % yMin + (r-1)*resolution); use demCoordinates for plotting vectors.
+    % Storing Z only cuts a 4096x4096 tile from ~400 MB to ~134 MB.
+    %
+    % Example:
+    %   demData = demCompact(load('synthetic_dem_hills.mat').demData);
+
+    if ~isstruct(demData) || ~isfield(demData, 'Z')
+        error('demCompact:InvalidInput', 'demData must be a DEM struct with field Z');
+    end
+
+    [rows, cols] = size(demData.Z);
+
+    %% Recover origin and spacing from legacy coordinate grids
+    if isfield(demData, 'X') && isfield(demData, 'Y')
+        if ~isfield(demData, 'xMin')
+            demData.xMin = demData.X(1, 1);
+            demData.xMax = demData.X(1, end);
+            demData.yMin = demData.Y(1, 1);
+            demData.yMax = demData.Y(end, 1);
+        end
+        if ~isfield(demData, 'resolution') && cols > 1
+            demData.resolution = demData.X(1, 2) - demData.X(1, 1);
+        end
+    end
+    demData = rmfield(demData, intersect({'X', 'Y'}, fieldnames(demData)));
+
+    %% Dimensions and derived fields
+    demData.rows = rows;
+    demData.cols = cols;
+    if ~isfield(demData, 'type')
+        demData.type = 'unknown';
+    end
+    if ~isfield(demData, 'minElevation')
+        demData.minElevation = min(demData.Z(:));
+        demData.maxElevation = max(demData.Z(:));
+        demData.meanElevation = mean(demData.Z(:));
+        demData.stdElevation = std(demData.Z(:));
+    end
+
+    %% Canonical field order (matches generateSyntheticDEM / demImport)
+    canonical = {'Z', 'resolution', 'xMin', 'xMax', 'yMin', 'yMax', ...
+                 'rows', 'cols', 'type', 'minElevation', 'maxElevation', ...
+                 'meanElevation', 'stdElevation'};
+    if isempty(setxor(fieldnames(demData), canonical))
+        demData = orderfields(demData, canonical);
+    end
+
+end
@@ -0,0 +1,33 @@
+%% demCoordinates.m
+% Grid-post coordinate vectors for a DEM (replaces the stored X/Y grids)
+%
+% Project: Drone Pathfinding with Coverage Path Planning
+% Module: DEM (Digital Elevation Model) - Module 0
+% Date: 2025-12-04
+% Compatibility: MATLAB 2023b+
+
+function [x, y] = demCoordinates(demData)
+    %DEMCOORDINATES UTM Easting/Northing of every DEM column and row
+    %
+    % Syntax:
+    %   [x, y] = demCoordinates(demData)
+    %
+    % Inputs:
+    %   demData - DEM structure (.Z, .resolution, .xMin, .yMin)
+    %
+    % Outputs:
+    %   x - 1 x cols Easting of each column of Z
+    %   y - rows x 1 Northing of each row of Z
+    %
+    % The vectors plug straight into surf/contourf/imagesc; call
+    % meshgrid(x, y) only where full coordinate matrices are needed.
+    %
+    % Example:
+    %   [x, y] = demCoordinates(demData);
+    %   surf(x, y, demData.Z, 'EdgeColor', 'none');
+
+    [rows, cols] = size(demData.Z);
+    x = demData.xMin + (0:cols-1) * demData.resolution;
+    y = demData.yMin + (0:rows-1)' * demData.resolution;
+
+end
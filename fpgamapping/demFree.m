@@ -0,0 +1,18 @@
+%% demFree.m
+% Release a DEM made resident by demLoad
+%
+% Project: Drone Pathfinding with Coverage Path Planning
+% Module: DEM (Digital Elevation Model) - Module 0
+% Date: 2025-12-03
+% Compatibility: MATLAB 2023b+
+
+function demFree(handle)
+    %DEMFREE Release a DEM handle (freeing twice is harmless)
+    %
+    % Syntax:
+    %   demFree(handle)
+
+    if isa(handle, 'uint64')
+        demHandle_mex('free', handle);
+    end
+end
@@ -1,6 +1,6 @@
 %% demImport.m
 % Import Digital Elevation Model (DEM) from file
-% Supports MATLAB MAT files and ESRI ASCII grid format
+% Supports MATLAB MAT files, ESRI ASCII grids and .demt tile files
 %
 % Project: Drone Pathfinding with Coverage Path Planning
 % Module: DEM (Digital Elevation Model) - Module 0
@@ -8,33 +8,51 @@
 % Date: 2025-11-12
 % Compatibility: MATLAB 2023b+
 
-function demData = demImport(filename, format)
+function demData = demImport(filename, format, layout, bounds)
     %DEMIMPORT Load DEM from MAT or ASCII file
     %
     % Syntax:
     %   demData = demImport(filename)
     %   demData = demImport(filename, format)
+    %   demData = demImport(filename, format, layout)
+    %   demData = demImport(filename, format, layout, bounds)
     %
     % Inputs:
     %   filename - char/string, path to DEM file
-    %   format   - char/string (optional): 'mat', 'ascii', 'auto' (default: 'auto')
+    %   format   - char/string (optional): 'mat', 'ascii', 'tiles', 'auto'
+    %              (default: 'auto')
     %       'mat'   - MATLAB MAT file format
     %       'ascii' - ESRI ASCII grid format
+    %       'tiles' - memory-mapped .demt tile file (see demWriteTiles)
     %       'auto'  - Auto-detect from file extension
+    %   layout   - char/string (optional): resident layout for demLoad
+    %       'column' - MATLAB column-major copy (default)
+    %       'tiled'  - cache-blocked 8x8 tiles, Morton order in 64x64 pages;
+    %                  faster for path-coherent lookups on large DEMs
+    %   bounds   - struct with .xMin, .xMax, .yMin, .yMax (optional, e.g.
+    %              surveyArea); 'tiles' only: import just that area plus
+    %              one post of margin. Only the tiles covering it are read,
+    %              so cropping a national DEM is fast and small.
     %
     % Outputs:
-    %   demData - struct with standardized DEM data:
-    %       .X, .Y - coordinate grids (meshgrid format)
+    %   demData - compact DEM struct (see demCompact):
     %       .Z - elevation grid (meters)
     %       .resolution - grid spacing (meters)
     %       .xMin, .xMax, .yMin, .yMax - UTM boundaries
+    %       .rows, .cols - grid dimensions
     %       .type - DEM type/source
     %       .minElevation, .maxElevation, .meanElevation, .stdElevation
+    %       .layout - only when layout is given ('column' or 'tiled')
+    %   ASCII nodata_value posts are returned as NaN.
+    %   Legacy MAT files with X/Y meshgrids are compacted on load. Z itself
+    %   always stays column-major; demLoad re-blocks it once when tiled.
     %
     % Examples:
     %   demData = demImport('synthetic_dem_hills.mat');
     %   demData = demImport('terrain.asc', 'ascii');
     %   demData = demImport('dem.dat', 'auto');
+    %   demData = demImport('terrain.asc', 'auto', 'tiled');
+    %   demData = demImport('national.demt', 'auto', 'column', surveyArea);
     
     %% Input validation
     if nargin < 1
@@ -48,12 +66,22 @@ function demData = demImport(filename, format)
     % Convert to char if string
     filename = char(filename);
     format = lower(char(format));
+    if nargin < 4
+        bounds = [];
+    end
+    if nargin >= 3
+        layout = lower(char(layout));
+        if ~ismember(layout, {'column', 'tiled'})
+            error('demImport:InvalidLayout', ...
+                  'layout must be one of: column, tiled');
+        end
+    end
     
     % Validate format
-    validFormats = {'mat', 'ascii', 'auto'};
+    validFormats = {'mat', 'ascii', 'tiles', 'auto'};
     if ~ismember(format, validFormats)
         error('demImport:InvalidFormat', ...
-              'format must be one of: mat, ascii, auto');
+              'format must be one of: mat, ascii, tiles, auto');
     end
     
     %% Auto-detect format from extension if needed
@@ -66,6 +94,8 @@ function demData = demImport(filename, format)
                 format = 'mat';
             case '.asc'
                 format = 'ascii';
+            case '.demt'
+                format = 'tiles';
             otherwise
                 error('demImport:UnknownFormat', ...
                       'Cannot auto-detect format from extension: %s', ext);
@@ -87,6 +117,12 @@ function demData = demImport(filename, format)
             demData = importMAT(filename);
         case 'ascii'
             demData = importASCII(filename);
+        case 'tiles'
+            demData = importTiles(filename, bounds);
+    end
+    
+    if nargin >= 3
+        demData.layout = layout;
     end
     
     %% Validate output structure
@@ -103,6 +139,9 @@ function demData = demImport(filename, format)
     fprintf('  Type: %s\n', demData.type);
     fprintf('  Grid size: %d × %d points\n', size(demData.Z, 1), size(demData.Z, 2));
     fprintf('  Resolution: %.1f meters\n', demData.resolution);
+    if isfield(demData, 'layout')
+        fprintf('  Layout: %s\n', demData.layout);
+    end
     fprintf('  Bounds: (%.0f, %.0f) to (%.0f, %.0f)\n', ...
             demData.xMin, demData.yMin, demData.xMax, demData.yMax);
     fprintf('  Elevation: %.1f to %.1f m (μ=%.1f, σ=%.1f)\n', ...
@@ -136,6 +175,9 @@ function demData = importMAT(filename)
             error('MAT file does not contain demData struct or Z matrix');
         end
         
+        % Drop legacy X/Y meshgrids (origin/resolution are kept)
+        demData = demCompact(demData);
+        
     catch ME
         error('demImport:MATLoadError', ...
               'Failed to load MAT file: %s', ME.message);
@@ -146,47 +188,21 @@ end
 %% Helper: Import ASCII Grid format
 function demData = importASCII(filename)
     %IMPORTASCII Load DEM from ESRI ASCII grid file
+    %   Uses the parallel native parser (demReadAscii_mex) when built:
+    %   the file is memory-mapped, parsed in row-aligned chunks on all
+    %   cores and written straight into the flipped Z. Otherwise falls
+    %   back to a single fscanf over the body.
+    
+    persistent useMex
+    if isempty(useMex)
+        useMex = (exist('demReadAscii_mex', 'file') == 3);
+    end
     
     try
-        fid = fopen(filename, 'r');
-        if fid == -1
-            error('Cannot open file');
-        end
-        
-        % Read header
-        header = struct();
-        headerLines = {};
-        
-        % Expected ESRI ASCII header fields
-        expectedHeaders = {'ncols', 'nrows', 'xllcorner', 'yllcorner', 'cellsize'};
-        
-        for i = 1:10  % Read up to 10 header lines
-            line = fgetl(fid);
-            if ischar(line) && ~iseof(fid)
-                parts = strsplit(line);
-                if length(parts) >= 2
-                    key = lower(parts{1});
-                    value = str2double(parts{2});
-                    
-                    if ismember(key, expectedHeaders) || strcmp(key, 'nodata_value')
-                        header.(key) = value;
-                        headerLines{end+1} = line;
-                    else
-                        % End of header
-                        break;
-                    end
-                end
-            else
-                break;
-            end
-        end
-        
-        % Validate required header fields
-        requiredFields = {'ncols', 'nrows', 'xllcorner', 'yllcorner', 'cellsize'};
-        for i = 1:length(requiredFields)
-            if ~isfield(header, requiredFields{i})
-                error('Missing required header field: %s', requiredFields{i});
-            end
+        if useMex
+            [Z, header] = demReadAscii_mex(filename);
+        else
+            [Z, header] = readASCIIGrid(filename);
         end
         
         ncols = header.ncols;
@@ -195,56 +211,137 @@ function demData = importASCII(filename)
         yllcorner = header.yllcorner;
         cellsize = header.cellsize;
         
-        % Read elevation data
-        Z_flipped = zeros(nrows, ncols);
-        for i = 1:nrows
-            line = fgetl(fid);
-            values = str2num(line);
-            if length(values) ~= ncols
-                error('Row %d has %d columns, expected %d', i, length(values), ncols);
-            end
-            Z_flipped(i, :) = values;
-        end
-        
-        fclose(fid);
-        
-        % Flip Z back to original orientation (ESRI stores bottom-to-top)
-        Z = flipud(Z_flipped);
-        
-        % Create coordinate grids
-        x = xllcorner : cellsize : (xllcorner + (ncols-1)*cellsize);
-        y = yllcorner : cellsize : (yllcorner + (nrows-1)*cellsize);
-        [X, Y] = meshgrid(x, y);
-        
-        % Build demData struct
+        % Build compact demData struct (coordinates are implicit)
         demData = struct();
-        demData.X = X;
-        demData.Y = Y;
         demData.Z = Z;
         demData.resolution = cellsize;
         demData.xMin = xllcorner;
         demData.xMax = xllcorner + (ncols-1)*cellsize;
         demData.yMin = yllcorner;
         demData.yMax = yllcorner + (nrows-1)*cellsize;
+        demData.rows = nrows;
+        demData.cols = ncols;
         demData.type = 'imported_ascii';
         demData.minElevation = min(Z(:));
         demData.maxElevation = max(Z(:));
-        demData.meanElevation = mean(Z(:));
-        demData.stdElevation = std(Z(:));
+        demData.meanElevation = mean(Z(:), 'omitnan');
+        demData.stdElevation = std(Z(:), 'omitnan');
         
     catch ME
-        fclose(fid);
         error('demImport:ASCIILoadError', ...
               'Failed to load ASCII grid file: %s', ME.message);
     end
     
 end
 
+%% Helper: Read ESRI ASCII grid without the native parser
+function [Z, header] = readASCIIGrid(filename)
+    %READASCIIGRID Header lines, then the whole body in one fscanf
+    
+    fid = fopen(filename, 'r');
+    if fid == -1
+        error('Cannot open file');
+    end
+    closer = onCleanup(@() fclose(fid));
+    
+    % Read header (ESRI ASCII keys, case-insensitive)
+    header = struct('nodata_value', NaN);
+    headerKeys = {'ncols', 'nrows', 'xllcorner', 'yllcorner', 'cellsize', ...
+                  'xllcenter', 'yllcenter', 'nodata_value'};
+    
+    while true
+        pos = ftell(fid);
+        line = fgetl(fid);
+        if ~ischar(line)
+            break;
+        end
+        parts = strsplit(strtrim(line));
+        key = lower(parts{1});
+        if length(parts) < 2 || ~ismember(key, headerKeys)
+            % First data row: rewind so fscanf sees it
+            fseek(fid, pos, 'bof');
+            break;
+        end
+        key = strrep(key, 'center', 'corner');
+        header.(key) = str2double(parts{2});
+    end
+    
+    % Validate required header fields
+    requiredFields = {'ncols', 'nrows', 'xllcorner', 'yllcorner', 'cellsize'};
+    for i = 1:length(requiredFields)
+        if ~isfield(header, requiredFields{i})
+            error('Missing required header field: %s', requiredFields{i});
+        end
+    end
+    
+    % Read elevation data (file rows run north to south)
+    values = fscanf(fid, '%f', [header.ncols, header.nrows]);
+    if numel(values) ~= header.ncols * header.nrows
+        error('File has %d values, expected %d x %d', numel(values), ...
+              header.nrows, header.ncols);
+    end
+    
+    % Flip Z back to original orientation (ESRI stores bottom-to-top)
+    Z = flipud(values');
+    Z(Z == header.nodata_value) = NaN;
+    
+end
+
+%% Helper: Import .demt tile file
+function demData = importTiles(filename, bounds)
+    %IMPORTTILES Crop a memory-mapped .demt file to bounds (or read it all)
+    
+    try
+        [h, info] = demLoad(filename);
+        cleanup = onCleanup(@() demFree(h));
+        
+        r0 = 1;
+        c0 = 1;
+        r1 = info.rows;
+        c1 = info.cols;
+        if ~isempty(bounds)
+            % Posts bracketing the bounds, plus one post of margin
+            c0 = max(1, floor((bounds.xMin - info.xMin) / info.resolution));
+            c1 = min(info.cols, ceil((bounds.xMax - info.xMin) / info.resolution) + 2);
+            r0 = max(1, floor((bounds.yMin - info.yMin) / info.resolution));
+            r1 = min(info.rows, ceil((bounds.yMax - info.yMin) / info.resolution) + 2);
+            if c1 - c0 < 1 || r1 - r0 < 1
+                error('Bounds do not overlap the DEM');
+            end
+        end
+        
+        % Only the tiles under the window are paged in
+        Z = demHandle_mex('window', h, r0, c0, r1 - r0 + 1, c1 - c0 + 1);
+        
+        demData = struct();
+        demData.Z = Z;
+        demData.resolution = info.resolution;
+        demData.xMin = info.xMin + (c0 - 1) * info.resolution;
+        demData.xMax = info.xMin + (c1 - 1) * info.resolution;
+        demData.yMin = info.yMin + (r0 - 1) * info.resolution;
+        demData.yMax = info.yMin + (r1 - 1) * info.resolution;
+        demData.rows = size(Z, 1);
+        demData.cols = size(Z, 2);
+        demData.type = 'imported_tiles';
+        demData.minElevation = min(Z(:));
+        demData.maxElevation = max(Z(:));
+        demData.meanElevation = mean(Z(:), 'omitnan');
+        demData.stdElevation = std(Z(:), 'omitnan');
+        clear cleanup;
+        
+    catch ME
+        error('demImport:TilesLoadError', ...
+              'Failed to load tile file: %s', ME.message);
+    end
+    
+end
+
 %% Helper: Validate DEM structure
 function validateDEMStructure(demData)
     %VALIDATEDEMSTRUCTURE Check demData has all required fields and proper format
     
-    requiredFields = {'X', 'Y', 'Z', 'resolution', 'xMin', 'xMax', 'yMin', 'yMax', 'type'};
+    requiredFields = {'Z', 'resolution', 'xMin', 'xMax', 'yMin', 'yMax', ...
+                      'rows', 'cols', 'type'};
     
     for i = 1:length(requiredFields)
         if ~isfield(demData, requiredFields{i})
@@ -252,12 +349,12 @@ function validateDEMStructure(demData)
         end
     end
     
-    % Check matrix dimensions
-    if ~(size(demData.X, 1) == size(demData.Y, 1) && ...
-         size(demData.X, 1) == size(demData.Z, 1) && ...
-         size(demData.X, 2) == size(demData.Y, 2) && ...
-         size(demData.X, 2) == size(demData.Z, 2))
-        error('X, Y, Z matrices have inconsistent dimensions');
+    % Check grid dimensions (at least one full interpolation cell)
+    if ~ismatrix(demData.Z) || ~isequal(size(demData.Z), [demData.rows, demData.cols])
+        error('Z size does not match rows/cols');
+    end
+    if demData.rows < 2 || demData.cols < 2
+        error('Z must be at least 2x2');
     end
     
     % Check numeric fields
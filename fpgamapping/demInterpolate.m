@@ -23,9 +23,8 @@ function z = demInterpolate(demData, x, y)
     %
     % Inputs:
     %   demData - DEM structure with fields:
-    %             .X (101x101 grid of X coordinates)
-    %             .Y (101x101 grid of Y coordinates)
-    %             .Z (101x101 grid of elevations)
+    %             .Z (rows x cols grid of elevations, any size >= 2x2)
+    %             .xMin, .yMin (UTM coordinates of Z(1,1))
     %             .resolution (grid spacing, e.g., 10 meters)
     %   x - UTM X coordinate (scalar)
     %   y - UTM Y coordinate (scalar)
@@ -48,14 +47,13 @@ function z = demInterpolate(demData, x, y)
     % This function assumes valid inputs
     
     %% Extract grid data
-    X_grid = demData.X;
-    Y_grid = demData.Y;
     Z_grid = demData.Z;
     resolution = demData.resolution;
+    [rows, cols] = size(Z_grid);
     
     %% Grid bounds
-    x_min = X_grid(1, 1);
-    y_min = Y_grid(1, 1);
+    x_min = demData.xMin;
+    y_min = demData.yMin;
     
     %% Calculate grid position
     % Position in grid coordinates (floating-point)
@@ -66,7 +64,7 @@ function z = demInterpolate(demData, x, y)
     i = floor(i_float);
     j = floor(j_float);
     
-    %% Bounds checking (clamp to valid range for 101x101 grid)
+    %% Bounds checking (clamp to the last full cell of the grid)
     % This prevents out-of-bounds access and is HDL-compatible
     if i < 0
         i = 0;
@@ -74,11 +72,11 @@ function z = demInterpolate(demData, x, y)
     if j < 0
         j = 0;
     end
-    if i >= 100
-        i = 99;
+    if i >= cols - 1
+        i = cols - 2;
     end
-    if j >= 100
-        j = 99;
+    if j >= rows - 1
+        j = rows - 2;
     end
     
     %% Calculate fractional offsets (interpolation weights)
@@ -0,0 +1,73 @@
+%% demInterpolateBatch.m
+% Batched bilinear DEM interpolation - many (x, y) queries per call
+% Uses the native SIMD kernel (demInterpolateBatch_mex) when it is built
+%
+% Project: Drone Pathfinding with Coverage Path Planning
+% Module: DEM (Digital Elevation Model) - Module 0
+% Date: 2025-12-02
+% Compatibility: MATLAB 2023b+
+
+function z = demInterpolateBatch(demData, x, y)
+    %DEMINTERPOLATEBATCH Bilinear interpolation for arrays of DEM queries
+    %
+    % Syntax:
+    %   z = demInterpolateBatch(demData, x, y)
+    %
+    % Inputs:
+    %   demData - DEM structure (.Z, .resolution, .xMin, .yMin)
+    %   x, y    - UTM coordinate arrays of the same size
+    %
+    % Outputs:
+    %   z - Interpolated elevations, same size as x (NaN where x or y is NaN)
+    %
+    % Results match demInterpolate(demData, x(k), y(k)) for every k.
+    % Run build_native() once to compile the MEX kernel; without it the
+    % vectorized MATLAB path below is used.
+    %
+    % Example:
+    %   z = demInterpolateBatch(demData, path(:,1), path(:,2));
+
+    persistent useMex
+    if isempty(useMex)
+        useMex = (exist('demInterpolateBatch_mex', 'file') == 3);
+    end
+
+    if numel(x) ~= numel(y)
+        error('demInterpolateBatch:InvalidInput', ...
+              'x and y must have the same number of elements');
+    end
+
+    if useMex
+        z = demInterpolateBatch_mex(demData, double(x), double(y));
+        return;
+    end
+
+    %% Vectorized MATLAB fallback (same arithmetic as demInterpolate)
+    Z_grid = demData.Z;
+    [rows, cols] = size(Z_grid);
+    resolution = demData.resolution;
+
+    i_float = (x - demData.xMin) / resolution;
+    j_float = (y - demData.yMin) / resolution;
+
+    % NaN queries produce NaN instead of an indexing error
+    valid = ~(isnan(i_float) | isnan(j_float));
+    i_float(~valid) = 0;
+    j_float(~valid) = 0;
+
+    i = min(max(floor(i_float), 0), cols - 2);
+    j = min(max(floor(j_float), 0), rows - 2);
+
+    dx = min(max(i_float - i, 0), 1);
+    dy = min(max(j_float - j, 0), 1);
+
+    % Linear index of the bottom-left corner Z(j+1, i+1)
+    idx = j + 1 + rows * i;
+
+    z = Z_grid(idx) .* (1 - dx) .* (1 - dy) + ...
+        Z_grid(idx + rows) .* dx .* (1 - dy) + ...
+        Z_grid(idx + 1) .* (1 - dx) .* dy + ...
+        Z_grid(idx + rows + 1) .* dx .* dy;
+    z(~valid) = NaN;
+
+end
@@ -6,7 +6,8 @@ function z = demInterpolate_hdl(x, y)
     %DEMINTERPOLATE_HDL HDL-only version for FPGA
     %
     % DEM grid is embedded as constants (becomes Block RAM in hardware)
-    % Only coordinates are inputs
+    % Only coordinates are inputs; grid size, origin and resolution are
+    % read from the DEM file at compile time
     %
     % Inputs:
     %   x, y - UTM coordinates (doubles)
@@ -15,19 +16,18 @@ function z = demInterpolate_hdl(x, y)
     
     %#codegen
     
-    %% Grid parameters (constants)
-    persistent DEM_Z
-    
-    if isempty(DEM_Z)
-        % Load DEM data ONCE (at compile time)
-        demData = coder.load('synthetic_dem_hills.mat');
-        DEM_Z = demData.demData.Z;
-    end
-    
-    % Constants
-    X_MIN = 500000;
-    Y_MIN = 5400000;
-    RESOLUTION = 10;
+    %% Grid parameters (compile-time constants)
+    % coder.load is evaluated during code generation, so the grid size,
+    % origin and resolution below all come from the DEM file and fold into
+    % the generated hardware. Point DEM_FILE at another survey tile (any
+    % size) to generate a core specialized for it.
+    DEM_FILE = 'synthetic_dem_hills.mat';
+    dem = coder.load(DEM_FILE, 'demData');
+    DEM_Z = dem.demData.Z;
+    X_MIN = dem.demData.xMin;
+    Y_MIN = dem.demData.yMin;
+    RESOLUTION = dem.demData.resolution;
+    [ROWS, COLS] = size(DEM_Z);
     
     %% Calculate grid position
     i_float = (x - X_MIN) / RESOLUTION;
@@ -37,11 +37,11 @@ function z = demInterpolate_hdl(x, y)
     i = floor(i_float);
     j = floor(j_float);
     
-    %% Bounds checking
+    %% Bounds checking (clamp to the last full cell)
     if i < 0, i = 0; end
     if j < 0, j = 0; end
-    if i >= 100, i = 99; end
-    if j >= 100, j = 99; end
+    if i >= COLS - 1, i = COLS - 2; end
+    if j >= ROWS - 1, j = ROWS - 2; end
     
     %% Fractional offsets
     dx = i_float - i;
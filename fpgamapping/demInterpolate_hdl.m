@@ -2,27 +2,35 @@ function z = demInterpolate_hdl(Z_grid, x_norm, y_norm)
 %DEMINTERPOLATE_HDL HDL-compatible bilinear interpolation kernel
 %
 % Inputs:
-%   Z_grid  - [101x101] fixed-point elevation grid (fi)
-%   x_norm  - normalized X position in [0,100], fixed-point fi
-%   y_norm  - normalized Y position in [0,100], fixed-point fi
+%   Z_grid  - [rows x cols] fixed-point elevation grid (fi), any size >= 2x2
+%   x_norm  - normalized X position in [0, cols-1], fixed-point fi
+%   y_norm  - normalized Y position in [0, rows-1], fixed-point fi
 %
 % Output:
 %   z       - interpolated elevation (fixed-point fi)
 %
-% This function follows HDL Coder constraints (fixed size, no dynamic arrays)
+% This function follows HDL Coder constraints (fixed size, no dynamic arrays).
+% The grid size is taken from Z_grid at compile time, so each DEM size
+% (101x101, 1024x1024, 4096x4096, ...) generates its own specialized core
+% with index registers just wide enough for that grid. Callers convert UTM
+% coordinates with x_norm = (x - xMin) / resolution before the kernel.
 
 %#codegen
 
+    % Grid size and index word length (compile-time constants)
+    [rows, cols] = size(Z_grid);
+    idxBits = coder.const(max(8, ceil(log2(max(rows, cols)))));
+
     % Integer indices
-    i = fi(floor(x_norm), 0, 8, 0);
-    j = fi(floor(y_norm), 0, 8, 0);
+    i = fi(floor(x_norm), 0, idxBits, 0);
+    j = fi(floor(y_norm), 0, idxBits, 0);
 
-    % Clamp indices
-    if i > 99
-        i = fi(99, 0, 8, 0);
+    % Clamp indices to the last full cell
+    if i > cols - 2
+        i = fi(cols - 2, 0, idxBits, 0);
     end
-    if j > 99
-        j = fi(99, 0, 8, 0);
+    if j > rows - 2
+        j = fi(rows - 2, 0, idxBits, 0);
     end
 
     % Fractional weights
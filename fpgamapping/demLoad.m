@@ -0,0 +1,78 @@
+%% demLoad.m
+% Load a DEM once so repeated elevation queries skip re-marshalling it
+% Pair with demQuery (lookups) and demFree (release)
+%
+% Project: Drone Pathfinding with Coverage Path Planning
+% Module: DEM (Digital Elevation Model) - Module 0
+% Date: 2025-12-03
+% Compatibility: MATLAB 2023b+
+
+function [handle, info] = demLoad(demData, layout)
+    %DEMLOAD Make a DEM resident for load-once / query-many lookups
+    %
+    % Syntax:
+    %   handle = demLoad(demData)
+    %   handle = demLoad(demData, layout)
+    %   [handle, info] = demLoad(filename)
+    %
+    % Inputs:
+    %   demData - DEM structure (.Z, .resolution, .xMin, .yMin)
+    %   filename - path of a .demt tile file (see demWriteTiles)
+    %   layout  - 'column' or 'tiled' (optional, default demData.layout
+    %             when present, else 'column')
+    %
+    % Outputs:
+    %   handle - opaque DEM handle for demQuery / demFree
+    %   info   - .demt header (.rows, .cols, .xMin, .yMin, .resolution,
+    %            .nodata, .tileSize); empty for in-memory DEMs
+    %
+    % With demHandle_mex built (build_native), Z is copied into native
+    % memory once and the handle is a uint64 id. Without it, the handle is
+    % the DEM struct itself and demQuery uses demInterpolateBatch.
+    % The 'tiled' layout stores the resident copy in 8x8-post tiles
+    % (Morton-ordered 64x64 pages) so neighbouring lookups along a path
+    % share cache lines and pages; results are identical to 'column'.
+    %
+    % A .demt file is memory-mapped instead of copied: opening it reads
+    % only the header and each query faults in just the tiles it touches,
+    % so a small mission over a national DEM starts at once and costs a
+    % few MB of RAM. Files need demHandle_mex.
+    %
+    % Example:
+    %   h = demLoad(demData);
+    %   z = demQuery(h, path(:,1), path(:,2));
+    %   demFree(h);
+    %   h = demLoad('national.demt');
+
+    persistent useMex
+    if isempty(useMex)
+        useMex = (exist('demHandle_mex', 'file') == 3);
+    end
+
+    info = [];
+    if ischar(demData) || isstring(demData)
+        if ~useMex
+            error('demLoad:NoNative', ...
+                  'Opening .demt files needs demHandle_mex; run build_native');
+        end
+        [handle, info] = demHandle_mex('open', char(demData));
+        return;
+    end
+
+    if ~isstruct(demData) || ~isfield(demData, 'Z')
+        error('demLoad:InvalidInput', 'demData must be a DEM struct with field Z');
+    end
+    if nargin >= 2
+        layout = lower(char(layout));
+        if ~ismember(layout, {'column', 'tiled'})
+            error('demLoad:InvalidLayout', 'layout must be ''column'' or ''tiled''');
+        end
+        demData.layout = layout;
+    end
+
+    if useMex
+        handle = demHandle_mex('load', demData);
+    else
+        handle = demData;
+    end
+end
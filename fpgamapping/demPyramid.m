@@ -0,0 +1,112 @@
+%% demPyramid.m
+% Multi-resolution min/max/mean elevation pyramid for coarse-to-fine queries
+% Build once per DEM; see demPyramidRange and demSegmentClear
+%
+% Project: Drone Pathfinding with Coverage Path Planning
+% Module: DEM (Digital Elevation Model) - Module 0
+% Date: 2025-12-06
+% Compatibility: MATLAB 2023b+
+
+function pyr = demPyramid(demData, numLevels)
+    %DEMPYRAMID Coarse levels of a DEM with per-cell elevation bounds
+    %
+    % Syntax:
+    %   pyr = demPyramid(demData)
+    %   pyr = demPyramid(demData, numLevels)
+    %
+    % Inputs:
+    %   demData   - DEM structure (.Z, .resolution, .xMin, .yMin)
+    %   numLevels - maximum number of levels (default: until a level would
+    %               have fewer than 2 cells along either axis)
+    %
+    % Outputs:
+    %   pyr - struct array, pyr(k) covering 2^k x 2^k DEM cells per cell
+    %         (finest first). Every level is itself a compact DEM struct,
+    %         so demInterpolate / demInterpolateBatch / demLoad work on it
+    %         directly and return the cell-mean surface:
+    %       .Z          - mean elevation per cell, posted at cell centres
+    %       .resolution - cell size (2^k * demData.resolution)
+    %       .xMin, .xMax, .yMin, .yMax, .rows, .cols, .type, stats
+    %       .Zmin, .Zmax - bounds of the interpolated terrain in each cell
+    %       .factor      - 2^k
+    %
+    % A DEM cell's bilinear surface lies between its corner extremes and
+    % averages to the mean of its corners, so Zmin/Zmax are exact bounds
+    % of what demInterpolate can return inside a cell, not approximations.
+    % NaN (nodata) posts are ignored.
+    %
+    % Example:
+    %   pyr = demPyramid(demData);
+    %   [lo, hi] = demPyramidRange(pyr(end), [x0 x1], [y0 y1]);
+    %   zCoarse = demInterpolate(pyr(3), x, y);
+
+    if nargin < 2
+        numLevels = inf;
+    end
+    if ~isstruct(demData) || ~isfield(demData, 'Z')
+        error('demPyramid:InvalidInput', 'demData must be a DEM struct with field Z');
+    end
+
+    Z = demData.Z;
+    res = demData.resolution;
+
+    %% Base cells: bounds and mean of the four corner posts
+    corners = cat(3, Z(1:end-1, 1:end-1), Z(1:end-1, 2:end), ...
+                     Z(2:end, 1:end-1), Z(2:end, 2:end));
+    cellMin = min(corners, [], 3);
+    cellMax = max(corners, [], 3);
+    cellCount = double(any(~isnan(corners), 3));
+    cellSum = mean(corners, 3, 'omitnan');
+    cellSum(cellCount == 0) = 0;
+
+    %% Halve until a level is too small to interpolate
+    pyr = struct([]);
+    k = 0;
+    while k < numLevels
+        cellMin = reduce2(cellMin, @(a) min(a, [], [1 3]), NaN);
+        cellMax = reduce2(cellMax, @(a) max(a, [], [1 3]), NaN);
+        cellSum = reduce2(cellSum, @(a) sum(a, [1 3]), 0);
+        cellCount = reduce2(cellCount, @(a) sum(a, [1 3]), 0);
+        if size(cellMin, 1) < 2 || size(cellMin, 2) < 2
+            break;
+        end
+        k = k + 1;
+
+        levelRes = res * 2^k;
+        zMean = cellSum ./ cellCount;   % NaN where a cell has no data
+        level = struct();
+        level.Z = zMean;
+        level.resolution = levelRes;
+        level.xMin = demData.xMin + levelRes / 2;
+        level.xMax = level.xMin + (size(zMean, 2) - 1) * levelRes;
+        level.yMin = demData.yMin + levelRes / 2;
+        level.yMax = level.yMin + (size(zMean, 1) - 1) * levelRes;
+        level.rows = size(zMean, 1);
+        level.cols = size(zMean, 2);
+        level.type = 'pyramid';
+        level.minElevation = min(cellMin(:));
+        level.maxElevation = max(cellMax(:));
+        level.meanElevation = mean(zMean(:), 'omitnan');
+        level.stdElevation = std(zMean(:), 'omitnan');
+        level.Zmin = cellMin;
+        level.Zmax = cellMax;
+        level.factor = 2^k;
+
+        if isempty(pyr)
+            pyr = level;
+        else
+            pyr(k) = level;
+        end
+    end
+end
+
+%% Helper: 2x2 block reduction (odd edges padded)
+function B = reduce2(A, op, padValue)
+    %REDUCE2 Combine 2x2 blocks of A with op over dimensions 1 and 3
+    [r, c] = size(A);
+    r2 = ceil(r / 2);
+    c2 = ceil(c / 2);
+    A(r+1:2*r2, :) = padValue;
+    A(:, c+1:2*c2) = padValue;
+    B = reshape(op(reshape(A, 2, r2, 2, c2)), r2, c2);
+end
@@ -0,0 +1,43 @@
+%% demPyramidRange.m
+% Conservative terrain elevation range over a box, from one pyramid level
+%
+% Project: Drone Pathfinding with Coverage Path Planning
+% Module: DEM (Digital Elevation Model) - Module 0
+% Date: 2025-12-06
+% Compatibility: MATLAB 2023b+
+
+function [zLo, zHi] = demPyramidRange(level, xRange, yRange)
+    %DEMPYRAMIDRANGE Bounds of the terrain anywhere inside a box
+    %
+    % Syntax:
+    %   [zLo, zHi] = demPyramidRange(level, xRange, yRange)
+    %
+    % Inputs:
+    %   level  - one level of demPyramid, e.g. pyr(end)
+    %   xRange - [xLow, xHigh] UTM Easting
+    %   yRange - [yLow, yHigh] UTM Northing
+    %
+    % Outputs:
+    %   zLo, zHi - demInterpolate(demData, x, y) lies in [zLo, zHi] for
+    %              every (x, y) in the box (points off the DEM clamp to
+    %              its edge, as demInterpolate does)
+    %
+    % Cost is one min/max over the level cells touching the box, so a
+    % coarse level answers "is this whole region below altitude h?" in a
+    % handful of reads.
+    %
+    % Example:
+    %   [~, hi] = demPyramidRange(pyr(4), [x0 x1], [y0 y1]);
+    %   regionSafe = hi + params.minAGL <= altitude;
+
+    x0 = level.xMin - level.resolution / 2;   % cell edge origin
+    y0 = level.yMin - level.resolution / 2;
+
+    c = floor(([min(xRange), max(xRange)] - x0) / level.resolution) + 1;
+    r = floor(([min(yRange), max(yRange)] - y0) / level.resolution) + 1;
+    c = min(max(c, 1), level.cols);
+    r = min(max(r, 1), level.rows);
+
+    zLo = min(level.Zmin(r(1):r(2), c(1):c(2)), [], 'all');
+    zHi = max(level.Zmax(r(1):r(2), c(1):c(2)), [], 'all');
+end
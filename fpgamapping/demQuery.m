@@ -0,0 +1,29 @@
+%% demQuery.m
+% Elevation lookups against a DEM made resident by demLoad
+%
+% Project: Drone Pathfinding with Coverage Path Planning
+% Module: DEM (Digital Elevation Model) - Module 0
+% Date: 2025-12-03
+% Compatibility: MATLAB 2023b+
+
+function z = demQuery(handle, x, y)
+    %DEMQUERY Bilinear elevation at (x, y) for a resident DEM
+    %
+    % Syntax:
+    %   z = demQuery(handle, x, y)
+    %
+    % Inputs:
+    %   handle - from demLoad
+    %   x, y   - UTM coordinate arrays of the same size
+    %
+    % Outputs:
+    %   z - Interpolated elevations, same size as x
+    %
+    % Results match demInterpolate(demData, x(k), y(k)) for every k.
+
+    if isstruct(handle)
+        z = demInterpolateBatch(handle, x, y);
+    else
+        z = demHandle_mex('query', handle, double(x), double(y));
+    end
+end
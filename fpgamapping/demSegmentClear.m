@@ -0,0 +1,89 @@
+%% demSegmentClear.m
+% Coarse-to-fine terrain clearance test for a straight 3-D flight segment
+%
+% Project: Drone Pathfinding with Coverage Path Planning
+% Module: DEM (Digital Elevation Model) - Module 0
+% Date: 2025-12-06
+% Compatibility: MATLAB 2023b+
+
+function [isClear, fineQueries] = demSegmentClear(pyr, demData, p1, p2, minAGL)
+    %DEMSEGMENTCLEAR True if p1->p2 keeps minAGL above the terrain
+    %
+    % Syntax:
+    %   isClear = demSegmentClear(pyr, demData, p1, p2, minAGL)
+    %   [isClear, fineQueries] = demSegmentClear(...)
+    %
+    % Inputs:
+    %   pyr     - demPyramid(demData) (may be empty for tiny DEMs)
+    %   demData - the DEM the pyramid was built from
+    %   p1, p2  - [X, Y, Z] segment end points (altitude varies linearly)
+    %   minAGL  - required clearance above terrain (meters)
+    %
+    % Outputs:
+    %   isClear     - false if any sampled point is below terrain + minAGL
+    %   fineQueries - full-resolution DEM lookups that were needed
+    %
+    % Starting at the coarsest level, a piece of the segment is accepted
+    % when the highest terrain under its bounding box plus minAGL is below
+    % its lowest altitude, rejected when the lowest terrain is above its
+    % highest altitude, and otherwise halved and retried one level finer.
+    % Only pieces that stay ambiguous down to the DEM itself are sampled,
+    % at half the DEM spacing.
+    %
+    % Example:
+    %   pyr = demPyramid(demData);
+    %   ok = demSegmentClear(pyr, demData, path(i,:), path(i+1,:), params.minAGL);
+
+    res = demData.resolution;
+    fineQueries = 0;
+
+    % Work stack rows: [x1 y1 z1 x2 y2 z2 level]
+    stack = [p1(1:3), p2(1:3), numel(pyr)];
+    while ~isempty(stack)
+        s = stack(end, :);
+        stack(end, :) = [];
+        k = s(7);
+        zLow = min(s(3), s(6));
+        zHigh = max(s(3), s(6));
+        len = hypot(s(4) - s(1), s(5) - s(2));
+
+        if k >= 1
+            [lo, hi] = demPyramidRange(pyr(k), [s(1), s(4)], [s(2), s(5)]);
+            if hi + minAGL <= zLow
+                continue;               % whole region clear
+            end
+            if lo + minAGL > zHigh
+                isClear = false;        % whole region too high
+                return;
+            end
+
+            % One level finer; halve pieces longer than two finer cells
+            if k > 1
+                nextRes = pyr(k - 1).resolution;
+            else
+                nextRes = res;
+            end
+            if len > 2 * nextRes
+                mid = (s(1:3) + s(4:6)) / 2;
+                stack(end+1, :) = [s(1:3), mid, k - 1]; %#ok<AGROW>
+                stack(end+1, :) = [mid, s(4:6), k - 1]; %#ok<AGROW>
+            else
+                stack(end+1, :) = [s(1:6), k - 1]; %#ok<AGROW>
+            end
+        else
+            % Full resolution: sample the piece at half the DEM spacing
+            n = max(2, ceil(len / (res / 2)) + 1);
+            t = linspace(0, 1, n)';
+            xs = s(1) + t * (s(4) - s(1));
+            ys = s(2) + t * (s(5) - s(2));
+            zs = s(3) + t * (s(6) - s(3));
+            terrain = demInterpolateBatch(demData, xs, ys);
+            fineQueries = fineQueries + n;
+            if any(terrain + minAGL > zs)
+                isClear = false;
+                return;
+            end
+        end
+    end
+    isClear = true;
+end
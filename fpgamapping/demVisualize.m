@@ -43,7 +43,7 @@ function fig = demVisualize(demData, surveyArea, waypoints)
         error('demVisualize:InvalidInput', 'demData must be a struct');
     end
     
-    requiredFields = {'X', 'Y', 'Z'};
+    requiredFields = {'Z', 'resolution', 'xMin', 'yMin'};
     for i = 1:length(requiredFields)
         if ~isfield(demData, requiredFields{i})
             error('demVisualize:InvalidDEM', ...
@@ -57,7 +57,8 @@ function fig = demVisualize(demData, surveyArea, waypoints)
     
     %% Plot 1: 3D Surface
     subplot(1, 2, 1);
-    surf(demData.X, demData.Y, demData.Z, 'EdgeColor', 'none', 'FaceColor', 'interp');
+    [xGrid, yGrid] = demCoordinates(demData);
+    surf(xGrid, yGrid, demData.Z, 'EdgeColor', 'none', 'FaceColor', 'interp');
     colormap(gca, 'parula');
     colorbar;
     
@@ -83,7 +84,7 @@ function fig = demVisualize(demData, surveyArea, waypoints)
     
     %% Plot 2: Contour Map
     subplot(1, 2, 2);
-    contourf(demData.X, demData.Y, demData.Z, 25, 'LineColor', 'none');
+    contourf(xGrid, yGrid, demData.Z, 25, 'LineColor', 'none');
     colormap(gca, 'parula');
     colorbar;
     
@@ -0,0 +1,46 @@
+%% demWriteTiles.m
+% Write a DEM as a .demt memory-mappable tiled container
+% Open it with demLoad (lazy paging) or crop it with demImport
+%
+% Project: Drone Pathfinding with Coverage Path Planning
+% Module: DEM (Digital Elevation Model) - Module 0
+% Date: 2025-12-05
+% Compatibility: MATLAB 2023b+ (requires build_native)
+
+function demWriteTiles(demData, filename, tileSize)
+    %DEMWRITETILES Save demData.Z as fixed-size tiles with a binary header
+    %
+    % Syntax:
+    %   demWriteTiles(demData, filename)
+    %   demWriteTiles(demData, filename, tileSize)
+    %
+    % Inputs:
+    %   demData  - DEM structure (.Z, .resolution, .xMin, .yMin; optional
+    %              .nodata, posts equal to it are stored as NaN)
+    %   filename - output path, conventionally *.demt
+    %   tileSize - tile edge in posts, power of two 8..4096 (default 256,
+    %              512 KB per tile)
+    %
+    % File layout: 72-byte header (magic 'FPGADEMT', version, tile size,
+    % rows, cols, xMin, yMin, resolution, nodata, data offset, reserved),
+    % then from byte 4096 (the data offset) the tiles as little-endian
+    % doubles, column-major inside each tile and tile by tile down each
+    % column of tiles. Edge tiles are NaN-padded.
+    %
+    % Example:
+    %   demWriteTiles(demImport('national.asc'), 'national.demt');
+    %   h = demLoad('national.demt');
+
+    if nargin < 3
+        tileSize = 256;
+    end
+    if exist('demHandle_mex', 'file') ~= 3
+        error('demWriteTiles:NoNative', ...
+              'demHandle_mex is not built; run build_native first');
+    end
+    if ~isstruct(demData) || ~isfield(demData, 'Z')
+        error('demWriteTiles:InvalidInput', 'demData must be a DEM struct with field Z');
+    end
+
+    demHandle_mex('save', char(filename), demData, double(tileSize));
+end
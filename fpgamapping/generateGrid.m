@@ -129,7 +129,7 @@ function waypoints3D = addElevationFromDEM(waypoints2D, surveyArea, params)
     %% Step 3: Interpolate elevation at each waypoint
     X_waypoints = waypoints2D(:, 1);
     Y_waypoints = waypoints2D(:, 2);
-    Z_waypoints = demInterpolate(demData, X_waypoints, Y_waypoints);
+    Z_waypoints = demInterpolateBatch(demData, X_waypoints, Y_waypoints);
     
     %% Step 4: Combine into 3D waypoints
     waypoints3D = [waypoints2D, Z_waypoints];
@@ -21,12 +21,13 @@ function demData = generateSyntheticDEM(surveyArea, resolution, demType)
     %   demType    - char array: 'flat', 'slope', 'hills', 'random'
     %
     % Outputs:
-    %   demData - struct containing:
-    %       .X, .Y - coordinate grids (meshgrid format)
+    %   demData - compact DEM struct (see demCompact) containing:
     %       .Z - elevation grid (meters)
     %       .resolution - grid spacing used
-    %       .xMin, .xMax, .yMin, .yMax - boundaries
+    %       .xMin, .xMax, .yMin, .yMax - boundaries (first/last grid posts)
+    %       .rows, .cols - grid dimensions
     %       .type - DEM type generated
+    %   Coordinates are implicit; use demCoordinates(demData) to plot.
     %
     % Examples:
     %   params = parameters();
@@ -65,27 +66,30 @@ function demData = generateSyntheticDEM(surveyArea, resolution, demType)
     fprintf('Survey Area: (%.0f, %.0f) to (%.0f, %.0f)\n', ...
             surveyArea.xMin, surveyArea.yMin, surveyArea.xMax, surveyArea.yMax);
     
-    %% Create coordinate grids
+    %% Grid post coordinates (row vector x, column vector y)
+    % Terrain formulas below use implicit expansion instead of meshgrid
+    % matrices, so only Z is ever materialized at full grid size
     x = surveyArea.xMin : resolution : surveyArea.xMax;
-    y = surveyArea.yMin : resolution : surveyArea.yMax;
-    [X, Y] = meshgrid(x, y);
+    y = (surveyArea.yMin : resolution : surveyArea.yMax)';
+    rows = numel(y);
+    cols = numel(x);
     
-    fprintf('Grid size: %d × %d points\n', size(X, 2), size(X, 1));
+    fprintf('Grid size: %d × %d points\n', cols, rows);
     
     %% Generate elevation based on terrain type
     switch demType
         case 'flat'
             % Constant elevation terrain
             baseElevation = 100;  % meters
-            Z = zeros(size(X)) + baseElevation;
+            Z = zeros(rows, cols) + baseElevation;
             fprintf('  Elevation: %.1f m (constant)\n', baseElevation);
             
         case 'slope'
             % Linear slope in east-west direction
             baseElevation = 100;
             slope = 0.1;  % 0.1 m/m slope (10% grade)
-            xNorm = (X - surveyArea.xMin) / (surveyArea.xMax - surveyArea.xMin);
-            Z = baseElevation + (slope * 100 * xNorm);  % 10m total rise
+            xNorm = (x - surveyArea.xMin) / (surveyArea.xMax - surveyArea.xMin);
+            Z = repmat(baseElevation + (slope * 100 * xNorm), rows, 1);  % 10m total rise
             fprintf('  Slope: %.3f m/m (%.1f m total rise)\n', slope, slope * 100);
             
         case 'hills'
@@ -95,8 +99,8 @@ function demData = generateSyntheticDEM(surveyArea, resolution, demType)
             amplitude2 = 15;  % Secondary wave amplitude
             
             % Normalize coordinates to [0, 1] for wave generation
-            xNorm = (X - surveyArea.xMin) / (surveyArea.xMax - surveyArea.xMin);
-            yNorm = (Y - surveyArea.yMin) / (surveyArea.yMax - surveyArea.yMin);
+            xNorm = (x - surveyArea.xMin) / (surveyArea.xMax - surveyArea.xMin);
+            yNorm = (y - surveyArea.yMin) / (surveyArea.yMax - surveyArea.yMin);
             
             % Create smooth hills using sinusoidal waves
             wave1 = amplitude1 * sin(2*pi*xNorm) .* cos(2*pi*yNorm);
@@ -112,7 +116,7 @@ function demData = generateSyntheticDEM(surveyArea, resolution, demType)
             elevation_variation = 30;  % ±30m variation
             
             % Generate random elevation
-            Z = baseElevation + elevation_variation * (2*rand(size(X)) - 1);
+            Z = baseElevation + elevation_variation * (2*rand(rows, cols) - 1);
             
             % Apply Gaussian smoothing for realistic terrain
             smoothingFactor = 5;
@@ -137,14 +141,14 @@ function demData = generateSyntheticDEM(surveyArea, resolution, demType)
     
     %% Build output structure
     demData = struct(...
-        'X', X, ...
-        'Y', Y, ...
         'Z', Z, ...
         'resolution', resolution, ...
-        'xMin', surveyArea.xMin, ...
-        'xMax', surveyArea.xMax, ...
-        'yMin', surveyArea.yMin, ...
-        'yMax', surveyArea.yMax, ...
+        'xMin', x(1), ...
+        'xMax', x(end), ...
+        'yMin', y(1), ...
+        'yMax', y(end), ...
+        'rows', rows, ...
+        'cols', cols, ...
         'type', demType, ...
         'minElevation', minElevation, ...
         'maxElevation', maxElevation, ...
@@ -168,7 +172,7 @@ function demData = generateSyntheticDEM(surveyArea, resolution, demType)
     
     % 3D surface plot
     subplot(1, 2, 1);
-    surf(X, Y, Z, 'EdgeColor', 'none', 'FaceColor', 'interp');
+    surf(x, y, Z, 'EdgeColor', 'none', 'FaceColor', 'interp');
     colorbar;
     colormap(gca, 'parula');
     xlabel('UTM Easting (m)');
@@ -181,7 +185,7 @@ function demData = generateSyntheticDEM(surveyArea, resolution, demType)
     
     % Contour plot
     subplot(1, 2, 2);
-    contourf(X, Y, Z, 20, 'LineColor', 'none');
+    contourf(x, y, Z, 20, 'LineColor', 'none');
     colorbar;
     colormap(gca, 'parula');
     xlabel('UTM Easting (m)');
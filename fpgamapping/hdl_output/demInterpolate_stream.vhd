@@ -0,0 +1,305 @@
+-- demInterpolate_stream.vhd
+-- Fully pipelined DEM bilinear interpolation core, one query per clock
+-- AXI4-Stream style valid/ready on both sides, DEM held in block RAM
+--
+-- Arithmetic is the AWS F1 type system of fixpt_config_aws.m and is
+-- bit-exact with native/demFixptModel.cpp (profile 'aws'):
+--   s_axis_tdata  x_norm (21:0) and y_norm (53:32), grid_coord u22.12
+--                 (x_norm = (x - xMin) / resolution)
+--   weights       u16.15, corner weights rounded to nearest
+--   products      elevation s18.7 x weight u16.15 = (34,22), summed exactly
+--   m_axis_tdata  z (17:0), elevation s18.7, sign-extended to 24 bits
+--
+-- DEM storage: even rows in one dual-port BRAM bank, odd rows in another.
+-- Rows j and j+1 always sit in different banks, and each bank reads
+-- columns i and i+1 on its two ports, so the 2x2 stencil is fetched in a
+-- single cycle. Columns are padded to 2^COL_BITS so a post address is a
+-- bit concatenation (no multiplier): each bank holds
+-- 2^(ROW_BITS-1) x 2^COL_BITS x 18 bits.
+--
+-- Pipeline (latency 8, initiation interval 1):
+--   1 input register        5 corner select, 4 x DSP multiply
+--   2 index clamp, weights  6 pairwise sums
+--   3 BRAM read, w products 7 final sum
+--   4 BRAM output register, 8 round to nearest, saturate
+--     weights to u16.15
+-- All stages advance together when m_axis_tready is high or the output
+-- register is empty, so s_axis_tready = m_axis_tready or not m_axis_tvalid
+-- and a stall freezes the whole pipe, BRAM outputs included.
+--
+-- DEM loading: write one post per clock through dem_wr_* (row 0 is the
+-- southern row, as in demData.Z). Do not stream queries while loading.
+--
+-- Target: AWS F1 xcvu9p @ 250 MHz (fixpt_config_aws.m)
+
+library IEEE;
+use IEEE.STD_LOGIC_1164.ALL;
+use IEEE.NUMERIC_STD.ALL;
+
+entity demInterpolate_stream is
+    Generic (
+        ROWS     : positive := 101;  -- DEM posts along Y
+        COLS     : positive := 101;  -- DEM posts along X
+        ROW_BITS : positive := 7;    -- ceil(log2(ROWS)), at least 2
+        COL_BITS : positive := 7     -- ceil(log2(COLS))
+    );
+    Port (
+        clk           : in  std_logic;
+        reset         : in  std_logic;
+
+        -- DEM load port
+        dem_wr_en     : in  std_logic;
+        dem_wr_row    : in  unsigned(ROW_BITS-1 downto 0);
+        dem_wr_col    : in  unsigned(COL_BITS-1 downto 0);
+        dem_wr_data   : in  signed(17 downto 0);
+
+        -- Query stream
+        s_axis_tvalid : in  std_logic;
+        s_axis_tready : out std_logic;
+        s_axis_tdata  : in  std_logic_vector(63 downto 0);
+        s_axis_tlast  : in  std_logic;
+
+        -- Result stream
+        m_axis_tvalid : out std_logic;
+        m_axis_tready : in  std_logic;
+        m_axis_tdata  : out std_logic_vector(23 downto 0);
+        m_axis_tlast  : out std_logic
+    );
+end demInterpolate_stream;
+
+architecture Behavioral of demInterpolate_stream is
+
+    constant LATENCY   : positive := 8;
+    constant HALF_BITS : positive := ROW_BITS - 1;
+    constant ADDR_BITS : positive := HALF_BITS + COL_BITS;
+    constant ONE       : unsigned(16 downto 0) := to_unsigned(32768, 17);
+
+    type bank_t is array (0 to 2**ADDR_BITS - 1) of signed(17 downto 0);
+    type corner_t is array (0 to 3) of signed(17 downto 0);
+    type weight_t is array (0 to 3) of unsigned(15 downto 0);
+    type wprod_t is array (0 to 3) of unsigned(33 downto 0);
+    type prod_t is array (0 to 3) of signed(34 downto 0);
+
+    signal bank_even : bank_t;
+    signal bank_odd  : bank_t;
+
+    -- Pipeline control
+    signal ce        : std_logic;
+    signal valid     : std_logic_vector(1 to LATENCY) := (others => '0');
+    signal last      : std_logic_vector(1 to LATENCY) := (others => '0');
+
+    -- Stage 1
+    signal x1, y1    : unsigned(21 downto 0);
+    -- Stage 2
+    signal i2        : unsigned(COL_BITS-1 downto 0);
+    signal j2        : unsigned(ROW_BITS-1 downto 0);
+    signal dx2, dy2  : unsigned(15 downto 0);
+    -- Stage 3 (BRAM addresses are combinational from stage 2)
+    signal addr_ea   : unsigned(ADDR_BITS-1 downto 0);
+    signal addr_eb   : unsigned(ADDR_BITS-1 downto 0);
+    signal addr_oa   : unsigned(ADDR_BITS-1 downto 0);
+    signal addr_ob   : unsigned(ADDR_BITS-1 downto 0);
+    signal wr_addr   : unsigned(ADDR_BITS-1 downto 0);
+    signal ea3, eb3, oa3, ob3 : signed(17 downto 0);
+    signal wp3       : wprod_t;
+    signal odd3      : std_logic;
+    -- Stage 4
+    signal ea4, eb4, oa4, ob4 : signed(17 downto 0);
+    signal w4        : weight_t;
+    signal odd4      : std_logic;
+    -- Stages 5-8
+    signal p5        : prod_t;
+    signal s6a, s6b  : signed(36 downto 0);
+    signal acc7      : signed(37 downto 0);
+    signal z8        : signed(17 downto 0);
+
+begin
+
+    ce <= m_axis_tready or not valid(LATENCY);
+    s_axis_tready <= ce;
+
+    m_axis_tvalid <= valid(LATENCY);
+    m_axis_tlast  <= last(LATENCY);
+    m_axis_tdata  <= std_logic_vector(resize(z8, 24));
+
+    -- Valid / last shift registers
+    ctrl_proc: process(clk)
+    begin
+        if rising_edge(clk) then
+            if reset = '1' then
+                valid <= (others => '0');
+                last  <= (others => '0');
+            elsif ce = '1' then
+                valid <= s_axis_tvalid & valid(1 to LATENCY-1);
+                last  <= s_axis_tlast & last(1 to LATENCY-1);
+            end if;
+        end if;
+    end process;
+
+    -- Stage 1: input register
+    stage1_proc: process(clk)
+    begin
+        if rising_edge(clk) then
+            if ce = '1' then
+                x1 <= unsigned(s_axis_tdata(21 downto 0));
+                y1 <= unsigned(s_axis_tdata(53 downto 32));
+            end if;
+        end if;
+    end process;
+
+    -- Stage 2: clamp the cell index, weight = fraction (u22.12 -> u16.15)
+    -- clamped to [0, 1]
+    stage2_proc: process(clk)
+        variable i_raw, j_raw : unsigned(9 downto 0);
+        variable fx, fy       : unsigned(21 downto 0);
+    begin
+        if rising_edge(clk) then
+            if ce = '1' then
+                i_raw := x1(21 downto 12);
+                j_raw := y1(21 downto 12);
+                if i_raw > COLS - 2 then
+                    i_raw := to_unsigned(COLS - 2, 10);
+                end if;
+                if j_raw > ROWS - 2 then
+                    j_raw := to_unsigned(ROWS - 2, 10);
+                end if;
+                fx := x1 - shift_left(resize(i_raw, 22), 12);
+                fy := y1 - shift_left(resize(j_raw, 22), 12);
+                if fx >= 4096 then
+                    dx2 <= ONE(15 downto 0);
+                else
+                    dx2 <= fx(12 downto 0) & "000";
+                end if;
+                if fy >= 4096 then
+                    dy2 <= ONE(15 downto 0);
+                else
+                    dy2 <= fy(12 downto 0) & "000";
+                end if;
+                i2 <= resize(i_raw, COL_BITS);
+                j2 <= resize(j_raw, ROW_BITS);
+            end if;
+        end if;
+    end process;
+
+    -- Row j+1 is in the other bank: the odd bank holds row j or j+1 at
+    -- half-row j/2, the even bank holds the other one at (j+1)/2
+    addr_oa <= j2(ROW_BITS-1 downto 1) & i2;
+    addr_ob <= j2(ROW_BITS-1 downto 1) & (i2 + 1);
+    addr_ea <= (j2(ROW_BITS-1 downto 1) + j2(0 downto 0)) & i2;
+    addr_eb <= (j2(ROW_BITS-1 downto 1) + j2(0 downto 0)) & (i2 + 1);
+    wr_addr <= dem_wr_row(ROW_BITS-1 downto 1) & dem_wr_col;
+
+    -- Stage 3: dual-port BRAM banks (port A read/write, port B read)
+    bank_even_proc: process(clk)
+        variable a : unsigned(ADDR_BITS-1 downto 0);
+    begin
+        if rising_edge(clk) then
+            if dem_wr_en = '1' then
+                a := wr_addr;
+            else
+                a := addr_ea;
+            end if;
+            if dem_wr_en = '1' and dem_wr_row(0) = '0' then
+                bank_even(to_integer(a)) <= dem_wr_data;
+            end if;
+            if ce = '1' then
+                ea3 <= bank_even(to_integer(a));
+                eb3 <= bank_even(to_integer(addr_eb));
+            end if;
+        end if;
+    end process;
+
+    bank_odd_proc: process(clk)
+        variable a : unsigned(ADDR_BITS-1 downto 0);
+    begin
+        if rising_edge(clk) then
+            if dem_wr_en = '1' then
+                a := wr_addr;
+            else
+                a := addr_oa;
+            end if;
+            if dem_wr_en = '1' and dem_wr_row(0) = '1' then
+                bank_odd(to_integer(a)) <= dem_wr_data;
+            end if;
+            if ce = '1' then
+                oa3 <= bank_odd(to_integer(a));
+                ob3 <= bank_odd(to_integer(addr_ob));
+            end if;
+        end if;
+    end process;
+
+    -- Stage 3 (parallel): corner weight products, u32.30
+    stage3_proc: process(clk)
+        variable mx, my : unsigned(16 downto 0);
+    begin
+        if rising_edge(clk) then
+            if ce = '1' then
+                mx := ONE - dx2;
+                my := ONE - dy2;
+                wp3(0) <= mx * my;
+                wp3(1) <= resize(dx2, 17) * my;
+                wp3(2) <= mx * resize(dy2, 17);
+                wp3(3) <= resize(dx2, 17) * resize(dy2, 17);
+                odd3 <= j2(0);
+            end if;
+        end if;
+    end process;
+
+    -- Stage 4: BRAM output register; corner weights to u16.15 (Nearest;
+    -- the products never exceed 2^30, so saturation cannot trigger)
+    stage4_proc: process(clk)
+    begin
+        if rising_edge(clk) then
+            if ce = '1' then
+                ea4 <= ea3;
+                eb4 <= eb3;
+                oa4 <= oa3;
+                ob4 <= ob3;
+                for k in 0 to 3 loop
+                    w4(k) <= resize(shift_right(wp3(k) + 16384, 15), 16);
+                end loop;
+                odd4 <= odd3;
+            end if;
+        end if;
+    end process;
+
+    -- Stage 5: order corners as z11, z21, z12, z22 and multiply
+    stage5_proc: process(clk)
+        variable c : corner_t;
+    begin
+        if rising_edge(clk) then
+            if ce = '1' then
+                if odd4 = '0' then
+                    c := (ea4, eb4, oa4, ob4);
+                else
+                    c := (oa4, ob4, ea4, eb4);
+                end if;
+                for k in 0 to 3 loop
+                    p5(k) <= c(k) * signed('0' & w4(k));
+                end loop;
+            end if;
+        end if;
+    end process;
+
+    -- Stages 6-8: exact sum in s36.22 (plus carry), round to s18.7
+    sum_proc: process(clk)
+        variable r : signed(37 downto 0);
+    begin
+        if rising_edge(clk) then
+            if ce = '1' then
+                s6a <= resize(p5(0), 37) + resize(p5(1), 37);
+                s6b <= resize(p5(2), 37) + resize(p5(3), 37);
+                acc7 <= resize(s6a, 38) + resize(s6b, 38);
+                r := shift_right(acc7 + 16384, 15);
+                if r > 131071 then
+                    z8 <= to_signed(131071, 18);
+                elsif r < -131072 then
+                    z8 <= to_signed(-131072, 18);
+                else
+                    z8 <= resize(r, 18);
+                end if;
+            end if;
+        end if;
+    end process;
+
+end Behavioral;
@@ -0,0 +1,326 @@
+-- demInterpolate_stream_tb.vhd
+-- VHDL Testbench for the pipelined streaming DEM interpolation core
+--
+-- Golden data comes from the bit-exact C model (native/demFixptVectors):
+--   demFixptVectors synthetic_dem_hills.asc -p aws -n 2000 \
+--       -o stream_vectors.csv -w stream_dem_words.txt
+--
+-- Phase 1 streams every vector back-to-back with m_axis_tready held high
+-- and requires one accepted query and one result per clock (II = 1).
+-- Phase 2 streams them again with gaps on s_axis_tvalid and random
+-- backpressure on m_axis_tready. Every result is compared word for word.
+
+library IEEE;
+use IEEE.STD_LOGIC_1164.ALL;
+use IEEE.NUMERIC_STD.ALL;
+use STD.TEXTIO.ALL;
+
+entity demInterpolate_stream_tb is
+    Generic (
+        DEM_FILE    : string   := "stream_dem_words.txt";
+        VEC_FILE    : string   := "stream_vectors.csv";
+        MAX_VECTORS : positive := 4096;
+        ROWS        : positive := 101;
+        COLS        : positive := 101;
+        ROW_BITS    : positive := 7;
+        COL_BITS    : positive := 7
+    );
+end demInterpolate_stream_tb;
+
+architecture Behavioral of demInterpolate_stream_tb is
+
+    -- Component declaration
+    component demInterpolate_stream is
+        Generic (
+            ROWS     : positive;
+            COLS     : positive;
+            ROW_BITS : positive;
+            COL_BITS : positive
+        );
+        Port (
+            clk           : in  std_logic;
+            reset         : in  std_logic;
+            dem_wr_en     : in  std_logic;
+            dem_wr_row    : in  unsigned(ROW_BITS-1 downto 0);
+            dem_wr_col    : in  unsigned(COL_BITS-1 downto 0);
+            dem_wr_data   : in  signed(17 downto 0);
+            s_axis_tvalid : in  std_logic;
+            s_axis_tready : out std_logic;
+            s_axis_tdata  : in  std_logic_vector(63 downto 0);
+            s_axis_tlast  : in  std_logic;
+            m_axis_tvalid : out std_logic;
+            m_axis_tready : in  std_logic;
+            m_axis_tdata  : out std_logic_vector(23 downto 0);
+            m_axis_tlast  : out std_logic
+        );
+    end component;
+
+    type int_array is array (0 to MAX_VECTORS - 1) of integer;
+
+    -- Signals
+    signal clk           : std_logic := '0';
+    signal reset         : std_logic := '1';
+    signal dem_wr_en     : std_logic := '0';
+    signal dem_wr_row    : unsigned(ROW_BITS-1 downto 0) := (others => '0');
+    signal dem_wr_col    : unsigned(COL_BITS-1 downto 0) := (others => '0');
+    signal dem_wr_data   : signed(17 downto 0) := (others => '0');
+    signal s_axis_tvalid : std_logic := '0';
+    signal s_axis_tready : std_logic;
+    signal s_axis_tdata  : std_logic_vector(63 downto 0) := (others => '0');
+    signal s_axis_tlast  : std_logic := '0';
+    signal m_axis_tvalid : std_logic;
+    signal m_axis_tready : std_logic := '1';
+    signal m_axis_tdata  : std_logic_vector(23 downto 0);
+    signal m_axis_tlast  : std_logic;
+
+    signal sim_done      : boolean := false;
+    signal cycle         : natural := 0;
+    signal phase1_go     : boolean := false;  -- DEM loaded (stimulus)
+    signal phase2_go     : boolean := false;  -- phase 1 drained (checker)
+
+    -- Clock period
+    constant clk_period : time := 4 ns;  -- 250 MHz
+
+    -- Golden vectors: TestID,X_in,Y_in,Z_out (header line skipped)
+    procedure load_vectors(xs, ys, zs : out int_array; n : out natural) is
+        file vec_f     : text open read_mode is VEC_FILE;
+        variable L     : line;
+        variable comma : character;
+        variable id    : integer;
+        variable k     : natural := 0;
+    begin
+        readline(vec_f, L);
+        while not endfile(vec_f) and k < MAX_VECTORS loop
+            readline(vec_f, L);
+            if L'length > 0 then
+                read(L, id);
+                read(L, comma);
+                read(L, xs(k));
+                read(L, comma);
+                read(L, ys(k));
+                read(L, comma);
+                read(L, zs(k));
+                k := k + 1;
+            end if;
+        end loop;
+        n := k;
+    end procedure;
+
+begin
+
+    -- Clock generation
+    clk_process: process
+    begin
+        while not sim_done loop
+            clk <= '0';
+            wait for clk_period/2;
+            clk <= '1';
+            wait for clk_period/2;
+        end loop;
+        wait;
+    end process;
+
+    cycle_counter: process(clk)
+    begin
+        if rising_edge(clk) then
+            cycle <= cycle + 1;
+        end if;
+    end process;
+
+    -- DUT instantiation
+    DUT: demInterpolate_stream
+        generic map (
+            ROWS     => ROWS,
+            COLS     => COLS,
+            ROW_BITS => ROW_BITS,
+            COL_BITS => COL_BITS
+        )
+        port map (
+            clk           => clk,
+            reset         => reset,
+            dem_wr_en     => dem_wr_en,
+            dem_wr_row    => dem_wr_row,
+            dem_wr_col    => dem_wr_col,
+            dem_wr_data   => dem_wr_data,
+            s_axis_tvalid => s_axis_tvalid,
+            s_axis_tready => s_axis_tready,
+            s_axis_tdata  => s_axis_tdata,
+            s_axis_tlast  => s_axis_tlast,
+            m_axis_tvalid => m_axis_tvalid,
+            m_axis_tready => m_axis_tready,
+            m_axis_tdata  => m_axis_tdata,
+            m_axis_tlast  => m_axis_tlast
+        );
+
+    -- Stimulus process
+    stim_proc: process
+        file dem_f      : text;
+        variable L      : line;
+        variable v      : integer;
+        variable r, c   : integer;
+        variable x_vec, y_vec, z_vec : int_array;
+        variable num_vec : natural;
+        variable first  : natural := 0;
+        variable lfsr   : unsigned(15 downto 0) := x"ACE1";
+    begin
+        -- Reset
+        reset <= '1';
+        wait for clk_period*5;
+        wait until rising_edge(clk);
+        reset <= '0';
+
+        -- Load the DEM, one post per clock
+        file_open(dem_f, DEM_FILE, read_mode);
+        readline(dem_f, L);
+        read(L, r);
+        read(L, c);
+        assert r = ROWS and c = COLS
+            report "DEM file size does not match ROWS/COLS generics"
+            severity failure;
+        for row in 0 to ROWS - 1 loop
+            for col in 0 to COLS - 1 loop
+                readline(dem_f, L);
+                read(L, v);
+                dem_wr_en   <= '1';
+                dem_wr_row  <= to_unsigned(row, ROW_BITS);
+                dem_wr_col  <= to_unsigned(col, COL_BITS);
+                dem_wr_data <= to_signed(v, 18);
+                wait until rising_edge(clk);
+            end loop;
+        end loop;
+        dem_wr_en <= '0';
+        file_close(dem_f);
+
+        load_vectors(x_vec, y_vec, z_vec, num_vec);
+        report "Starting streaming testbench with " &
+               integer'image(num_vec) & " vectors";
+
+        -- Phase 1: back-to-back, no backpressure
+        phase1_go <= true;
+        for k in 0 to num_vec - 1 loop
+            s_axis_tvalid <= '1';
+            s_axis_tdata  <= (others => '0');
+            s_axis_tdata(21 downto 0)  <=
+                std_logic_vector(to_unsigned(x_vec(k), 22));
+            s_axis_tdata(53 downto 32) <=
+                std_logic_vector(to_unsigned(y_vec(k), 22));
+            if k = num_vec - 1 then
+                s_axis_tlast <= '1';
+            else
+                s_axis_tlast <= '0';
+            end if;
+            wait until rising_edge(clk);
+            assert s_axis_tready = '1'
+                report "Phase 1: core stalled its input at vector " &
+                       integer'image(k)
+                severity error;
+            if k = 0 then
+                first := cycle;
+            end if;
+        end loop;
+        s_axis_tvalid <= '0';
+        s_axis_tlast  <= '0';
+        assert cycle - first = num_vec - 1
+            report "Phase 1: accepting " & integer'image(num_vec) &
+                   " queries took " & integer'image(cycle - first + 1) &
+                   " cycles"
+            severity error;
+        wait until phase2_go;
+
+        -- Phase 2: gaps on the input, random backpressure on the output
+        for k in 0 to num_vec - 1 loop
+            lfsr := lfsr(14 downto 0) & (lfsr(15) xor lfsr(13) xor
+                                         lfsr(12) xor lfsr(10));
+            if lfsr(0) = '1' and lfsr(1) = '1' then
+                s_axis_tvalid <= '0';
+                wait until rising_edge(clk);
+            end if;
+            s_axis_tvalid <= '1';
+            s_axis_tdata  <= (others => '0');
+            s_axis_tdata(21 downto 0)  <=
+                std_logic_vector(to_unsigned(x_vec(k), 22));
+            s_axis_tdata(53 downto 32) <=
+                std_logic_vector(to_unsigned(y_vec(k), 22));
+            loop
+                wait until rising_edge(clk);
+                exit when s_axis_tready = '1';
+            end loop;
+        end loop;
+        s_axis_tvalid <= '0';
+        wait;
+    end process;
+
+    -- Output checker: consumes and compares every result in order
+    check_proc: process
+        variable x_vec, y_vec, z_vec : int_array;
+        variable num_vec  : natural;
+        variable got      : integer;
+        variable idx      : natural := 0;
+        variable errors   : natural := 0;
+        variable first    : natural := 0;
+        variable lfsr     : unsigned(15 downto 0) := x"B400";
+    begin
+        load_vectors(x_vec, y_vec, z_vec, num_vec);
+        wait until phase1_go;
+        while idx < num_vec loop
+            wait until rising_edge(clk);
+            if m_axis_tvalid = '1' then
+                got := to_integer(signed(m_axis_tdata));
+                if idx = 0 then
+                    first := cycle;
+                end if;
+                if got /= z_vec(idx) then
+                    errors := errors + 1;
+                    report "Vector " & integer'image(idx + 1) &
+                           " FAILED: got " & integer'image(got) &
+                           ", expected " & integer'image(z_vec(idx))
+                        severity error;
+                end if;
+                idx := idx + 1;
+            end if;
+        end loop;
+        assert m_axis_tlast = '1'
+            report "Phase 1: tlast not on the last result" severity error;
+        assert cycle - first = num_vec - 1
+            report "Phase 1: results were not back-to-back (" &
+                   integer'image(cycle - first + 1) & " cycles for " &
+                   integer'image(num_vec) & ")"
+            severity error;
+        report "Phase 1: " & integer'image(num_vec) &
+               " results in " & integer'image(cycle - first + 1) &
+               " consecutive cycles";
+
+        -- Phase 2: toggle m_axis_tready from an LFSR
+        phase2_go <= true;
+        idx := 0;
+        while idx < num_vec loop
+            lfsr := lfsr(14 downto 0) & (lfsr(15) xor lfsr(13) xor
+                                         lfsr(12) xor lfsr(10));
+            m_axis_tready <= lfsr(0) or lfsr(2);
+            wait until rising_edge(clk);
+            if m_axis_tvalid = '1' and m_axis_tready = '1' then
+                got := to_integer(signed(m_axis_tdata));
+                if got /= z_vec(idx) then
+                    errors := errors + 1;
+                    report "Vector " & integer'image(idx + 1) &
+                           " FAILED under backpressure: got " &
+                           integer'image(got) & ", expected " &
+                           integer'image(z_vec(idx))
+                        severity error;
+                end if;
+                idx := idx + 1;
+            end if;
+        end loop;
+        m_axis_tready <= '1';
+
+        if errors = 0 then
+            report "ALL TESTS PASSED (" & integer'image(2 * num_vec) &
+                   " results)";
+        else
+            report integer'image(errors) & " TESTS FAILED" severity error;
+        end if;
+        sim_done <= true;
+        wait;
+    end process;
+
+end Behavioral;
@@ -0,0 +1,342 @@
+/*
+ * altitudeProfile.cpp
+ *
+ * Envelope passes for altitudeProfile.m (see altitudeProfile.h).
+ *
+ */
+
+/* Include files */
+#include "altitudeProfile.h"
+#include <algorithm>
+#include <cmath>
+#include <new>
+#include <vector>
+
+/* Variable Definitions */
+static const std::size_t altitudeBlock = 2048; /* stations per batch */
+static const double altitudeSagTol = 1e-6;     /* meters of rounding */
+
+/* Function Declarations */
+static double altitudeLegLength(const double *x, const double *y,
+                                std::size_t i);
+static double altitudeClamp01(double v);
+static double altitudePieceRise(const DemGrid &dem, const double *x,
+                                const double *y, std::size_t i, double ta,
+                                double tb, double za, double zb,
+                                double &tPeak);
+static void altitudeCrossings(const DemGrid &dem, const double *x,
+                              const double *y, std::size_t i,
+                              std::vector<double> &legT);
+static void altitudeEnvelope(const double *x, const double *y,
+                             const std::size_t *first, const double *ts,
+                             std::size_t n, double g, double *zs);
+
+/* Function Definitions */
+static double altitudeLegLength(const double *x, const double *y,
+                                std::size_t i)
+{
+  const double dx = x[i + 1] - x[i];
+  const double dy = y[i + 1] - y[i];
+  return std::sqrt(dx * dx + dy * dy);
+}
+
+static double altitudeClamp01(double v)
+{
+  return v < 0.0 ? 0.0 : (v > 1.0 ? 1.0 : v);
+}
+
+/*
+ * Largest terrain - line over t in [ta, tb] of leg i, the line running
+ * from za at ta to zb at tb; tPeak receives where. The piece lies inside
+ * one DEM cell (or beyond one edge of the grid, where the interpolation
+ * clamps), so terrain is a quadratic in t there.
+ */
+static double altitudePieceRise(const DemGrid &dem, const double *x,
+                                const double *y, std::size_t i, double ta,
+                                double tb, double za, double zb,
+                                double &tPeak)
+{
+  const double tm = 0.5 * (ta + tb);
+  const double um = (x[i] + tm * (x[i + 1] - x[i]) - dem.xMin) /
+                    dem.resolution;
+  const double vm = (y[i] + tm * (y[i + 1] - y[i]) - dem.yMin) /
+                    dem.resolution;
+  const int32_t ci = (int32_t)std::min(std::max(std::floor(um), 0.0),
+                                       (double)dem.cols - 2.0);
+  const int32_t cj = (int32_t)std::min(std::max(std::floor(vm), 0.0),
+                                       (double)dem.rows - 2.0);
+  double c[4]; /* Z(j, i), Z(j + 1, i), Z(j, i + 1), Z(j + 1, i + 1) */
+  double fa;
+  double fb;
+  double ga;
+  double gb;
+  double df;
+  double dg;
+  double A;
+  double B;
+  double C;
+  double h0;
+  double h1;
+  double h2;
+  double s;
+  double hs;
+  double best;
+
+  demGridWindow(dem, cj, ci, 2, 2, c);
+
+  /*  Cell fractions at both ends; linear in t within the piece */
+  fa = altitudeClamp01((x[i] + ta * (x[i + 1] - x[i]) - dem.xMin) /
+                           dem.resolution -
+                       (double)ci);
+  fb = altitudeClamp01((x[i] + tb * (x[i + 1] - x[i]) - dem.xMin) /
+                           dem.resolution -
+                       (double)ci);
+  ga = altitudeClamp01((y[i] + ta * (y[i + 1] - y[i]) - dem.yMin) /
+                           dem.resolution -
+                       (double)cj);
+  gb = altitudeClamp01((y[i] + tb * (y[i + 1] - y[i]) - dem.yMin) /
+                           dem.resolution -
+                       (double)cj);
+  df = fb - fa;
+  dg = gb - ga;
+
+  /*  h(s) = terrain(s) - line(s), s in [0, 1] over the piece */
+  A = c[2] - c[0];
+  B = c[1] - c[0];
+  C = c[0] - c[1] - c[2] + c[3];
+  h0 = (c[0] + A * fa + B * ga + C * fa * ga) - za;
+  h1 = (A * df + B * dg + C * (fa * dg + ga * df)) - (zb - za);
+  h2 = C * df * dg;
+  best = h0;
+  tPeak = ta;
+  if (h0 + h1 + h2 > best) {
+    best = h0 + h1 + h2;
+    tPeak = tb;
+  }
+  if (h2 < 0.0) {
+    s = -h1 / (2.0 * h2);
+    hs = h0 + s * (h1 + s * h2);
+    if (s > 0.0 && s < 1.0 && hs > best) {
+      best = hs;
+      tPeak = ta + s * (tb - ta);
+    }
+  }
+  return best;
+}
+
+/*
+ *  Append the t in (0, 1) where leg i crosses a post line inside the grid
+ */
+static void altitudeCrossings(const DemGrid &dem, const double *x,
+                              const double *y, std::size_t i,
+                              std::vector<double> &legT)
+{
+  const double u1 = (x[i] - dem.xMin) / dem.resolution;
+  const double v1 = (y[i] - dem.yMin) / dem.resolution;
+  const double du = (x[i + 1] - dem.xMin) / dem.resolution - u1;
+  const double dv = (y[i + 1] - dem.yMin) / dem.resolution - v1;
+  double k;
+  double kEnd;
+  double t;
+  if (du != 0.0) {
+    k = std::max(std::ceil(std::min(u1, u1 + du)), 0.0);
+    kEnd = std::min(std::floor(std::max(u1, u1 + du)), (double)dem.cols - 1.0);
+    for (; k <= kEnd; k += 1.0) {
+      t = (k - u1) / du;
+      if (t > 0.0 && t < 1.0) {
+        legT.push_back(t);
+      }
+    }
+  }
+  if (dv != 0.0) {
+    k = std::max(std::ceil(std::min(v1, v1 + dv)), 0.0);
+    kEnd = std::min(std::floor(std::max(v1, v1 + dv)), (double)dem.rows - 1.0);
+    for (; k <= kEnd; k += 1.0) {
+      t = (k - v1) / dv;
+      if (t > 0.0 && t < 1.0) {
+        legT.push_back(t);
+      }
+    }
+  }
+}
+
+/*
+ * Raise zs to the lowest profile above it whose slope stays within g,
+ * stations of leg i from first[i] to first[i + 1] at fractions ts of the
+ * leg (the station first[i + 1] ends the leg at 1)
+ */
+static void altitudeEnvelope(const double *x, const double *y,
+                             const std::size_t *first, const double *ts,
+                             std::size_t n, double g, double *zs)
+{
+  std::size_t i;
+  std::size_t s;
+  double gl;
+  double drop;
+  for (i = 0; i + 1 < n; i++) {
+    gl = g * altitudeLegLength(x, y, i);
+    for (s = first[i] + 1; s <= first[i + 1]; s++) {
+      drop = gl * ((s < first[i + 1] ? ts[s] : 1.0) - ts[s - 1]);
+      zs[s] = std::max(zs[s], zs[s - 1] - drop);
+    }
+  }
+  for (i = n - 1; i-- > 0;) {
+    gl = g * altitudeLegLength(x, y, i);
+    for (s = first[i + 1]; s-- > first[i];) {
+      drop = gl * ((s + 1 < first[i + 1] ? ts[s + 1] : 1.0) - ts[s]);
+      zs[s] = std::max(zs[s], zs[s + 1] - drop);
+    }
+  }
+}
+
+bool altitudeProfile(const DemGrid &dem, const double *x, const double *y,
+                     std::size_t n, const AltitudeLimits &lim, double *z,
+                     AltitudeReport &rep, const char **err)
+{
+  static const double deg = 3.14159265358979323846 / 180.0;
+  std::vector<std::size_t> first;
+  std::vector<std::size_t> vertex;
+  std::vector<double> ts;
+  std::vector<double> legT;
+  std::vector<double> zs;
+  std::vector<double> lift;
+  double bx[altitudeBlock];
+  double by[altitudeBlock];
+  double step;
+  double g;
+  double len;
+  double t;
+  double ta;
+  double tb;
+  double d;
+  double ca;
+  double cb;
+  std::size_t i;
+  std::size_t j;
+  std::size_t m;
+  std::size_t k;
+  std::size_t s;
+  std::size_t done;
+  rep.samples = 0;
+  rep.legsLifted = 0;
+  rep.maxLift = 0.0;
+  if (!(lim.maxClimb > 0.0 && lim.maxClimb < 90.0)) {
+    *err = "maxClimbAngle must be between 0 and 90 degrees";
+    return false;
+  }
+  if (!std::isfinite(lim.minAGL)) {
+    *err = "minAGL must be finite";
+    return false;
+  }
+  if (n == 0) {
+    return true;
+  }
+  for (i = 0; i < n; i++) {
+    if (!std::isfinite(x[i]) || !std::isfinite(y[i])) {
+      *err = "path coordinates must be finite";
+      return false;
+    }
+  }
+  step = lim.sampleStep > 0.0 ? lim.sampleStep : dem.resolution;
+  /*  A hair under tan(maxClimb) so rounding cannot tip a leg over it */
+  g = std::tan(lim.maxClimb * deg) * (1.0 - 1e-9);
+
+  try {
+    /*  Stations: every vertex, the even samples of its leg, every post
+        line the leg crosses and the terrain peak between two crossings */
+    first.resize(n);
+    first[0] = 0;
+    for (i = 0; i + 1 < n; i++) {
+      len = altitudeLegLength(x, y, i);
+      m = len > step ? (std::size_t)std::ceil(len / step) : 1;
+      legT.clear();
+      for (j = 0; j < m; j++) {
+        legT.push_back((double)j / (double)m);
+      }
+      altitudeCrossings(dem, x, y, i, legT);
+      std::sort(legT.begin(), legT.end());
+      m = legT.size();
+      for (j = 0; j < m; j++) {
+        tb = j + 1 < m ? legT[j + 1] : 1.0;
+        altitudePieceRise(dem, x, y, i, legT[j], tb, 0.0, 0.0, t);
+        if (t > legT[j] && t < tb) {
+          legT.push_back(t);
+        }
+      }
+      std::sort(legT.begin(), legT.end());
+      legT.erase(std::unique(legT.begin(), legT.end()), legT.end());
+      ts.insert(ts.end(), legT.begin(), legT.end());
+      first[i + 1] = first[i] + legT.size();
+    }
+    ts.push_back(0.0);
+    zs.resize(first[n - 1] + 1);
+    lift.assign(n, 0.0);
+  } catch (const std::bad_alloc &) {
+    *err = "out of memory";
+    return false;
+  }
+  rep.samples = (int64_t)zs.size();
+
+  /*  Floor at every station, terrain batched block by block */
+  k = 0;
+  done = 0;
+  i = 0;
+  for (s = 0; s < zs.size(); s++) {
+    while (i + 1 < n && s >= first[i + 1]) {
+      i++;
+    }
+    bx[k] = i + 1 < n ? x[i] + ts[s] * (x[i + 1] - x[i]) : x[i];
+    by[k] = i + 1 < n ? y[i] + ts[s] * (y[i + 1] - y[i]) : y[i];
+    if (++k == altitudeBlock || s + 1 == zs.size()) {
+      demInterpolateBatch(dem, bx, by, &zs[done], k);
+      done += k;
+      k = 0;
+    }
+  }
+  for (k = 0; k < zs.size(); k++) {
+    zs[k] += lim.minAGL;
+  }
+
+  altitudeEnvelope(x, y, first.data(), ts.data(), n, g, zs.data());
+
+  /*  Lift both ends of a leg whose chord sags below the envelope at a
+      station or below the floor between two */
+  for (i = 0; i + 1 < n; i++) {
+    d = 0.0;
+    for (s = first[i]; s < first[i + 1]; s++) {
+      ta = ts[s];
+      tb = s + 1 < first[i + 1] ? ts[s + 1] : 1.0;
+      ca = zs[first[i]] + ta * (zs[first[i + 1]] - zs[first[i]]);
+      cb = zs[first[i]] + tb * (zs[first[i + 1]] - zs[first[i]]);
+      d = std::max(d, zs[s] - ca);
+      d = std::max(d, altitudePieceRise(dem, x, y, i, ta, tb, ca, cb, t) +
+                          lim.minAGL);
+    }
+    if (d > altitudeSagTol) {
+      lift[i] = std::max(lift[i], d);
+      lift[i + 1] = std::max(lift[i + 1], d);
+      rep.legsLifted++;
+      rep.maxLift = std::max(rep.maxLift, d);
+    }
+  }
+
+  for (i = 0; i < n; i++) {
+    z[i] = zs[first[i]] + lift[i];
+  }
+  if (rep.legsLifted > 0) {
+    try {
+      vertex.resize(n);
+      ts.assign(n, 0.0);
+    } catch (const std::bad_alloc &) {
+      *err = "out of memory";
+      return false;
+    }
+    for (i = 0; i < n; i++) {
+      vertex[i] = i;
+    }
+    altitudeEnvelope(x, y, vertex.data(), ts.data(), n, g, z);
+  }
+  return true;
+}
+
+/* End of altitudeProfile.cpp */
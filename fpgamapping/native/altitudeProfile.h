@@ -0,0 +1,55 @@
+/*
+ * altitudeProfile.h
+ *
+ * Lowest terrain-following altitude profile for a horizontal path that
+ * keeps minAGL above the terrain and climbs or descends no steeper than
+ * maxClimb.
+ *
+ * Every leg is sampled along its length (at most sampleStep apart), at
+ * every post line it crosses and at the terrain peak between two
+ * crossings, so the floor terrain + minAGL is known at the vertices and
+ * between them. The lowest slope-limited profile over those stations is
+ * the upper envelope of cones max_k(floor_k - g |s - s_k|), g =
+ * tan(maxClimb), which one forward and one backward pass produce in
+ * O(stations).
+ *
+ * The path flies straight legs, so only the vertex values are free. Where
+ * the chord of a leg sags below the envelope at a station, or below the
+ * floor between two (the bilinear terrain is a quadratic there, checked
+ * exactly), both ends are lifted by the sag, and a last forward/backward
+ * pass over the vertices restores the climb limit. The result clears the
+ * interpolated terrain everywhere along every leg and meets the limit on
+ * every leg; without sags it is exactly the envelope at the vertices.
+ *
+ */
+
+#pragma once
+
+/* Include files */
+#include "demKernel.h"
+#include <cstddef>
+#include <cstdint>
+
+/* Type Definitions */
+struct AltitudeLimits {
+  double minAGL;     /* meters above the terrain */
+  double maxClimb;   /* degrees, climb and descent, in (0, 90) */
+  double sampleStep; /* meters between leg samples, <= 0 for the DEM
+                        resolution */
+};
+
+struct AltitudeReport {
+  int64_t samples;    /* terrain stations, vertices included */
+  int32_t legsLifted; /* legs whose sag lifted their ends */
+  double maxLift;     /* largest sag, meters */
+};
+
+/* Function Declarations */
+/*
+ * x and y are the n path coordinates; z receives the n altitudes.
+ */
+bool altitudeProfile(const DemGrid &dem, const double *x, const double *y,
+                     std::size_t n, const AltitudeLimits &lim, double *z,
+                     AltitudeReport &rep, const char **err);
+
+/* End of altitudeProfile.h */
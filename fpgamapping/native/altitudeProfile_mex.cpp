@@ -0,0 +1,68 @@
+/*
+ * altitudeProfile_mex.cpp
+ *
+ * MEX gateway: [z, info] = altitudeProfile_mex(xy, demData, limits)
+ *
+ * xy is N x 2 (further columns are ignored), limits is [minAGL,
+ * maxClimbAngle, sampleStep] (meters, degrees, meters; sampleStep <= 0
+ * samples at the DEM resolution). z is the N x 1 lowest altitude profile
+ * that keeps every leg minAGL above the terrain within the climb limit
+ * (altitudeProfile.cpp). info has samples, legsLifted and maxLift.
+ *
+ */
+
+/* Include files */
+#include "altitudeProfile.h"
+#include "mexUtil.h"
+
+/* Function Definitions */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  static const char *errId = "altitudeProfile:InvalidInput";
+  static const char *fields[] = {"samples", "legsLifted", "maxLift"};
+  AltitudeLimits lim;
+  AltitudeReport rep;
+  DemGrid dem;
+  const double *xy;
+  const double *limits;
+  const char *err = "";
+  std::size_t n;
+  if (nrhs != 3) {
+    mexErrMsgIdAndTxt(errId, "Usage: [z, info] = altitudeProfile_mex(xy, "
+                             "demData, limits)");
+  }
+  if (nlhs > 2) {
+    mexErrMsgIdAndTxt(errId, "Too many output arguments");
+  }
+  xy = mexDoubleArray(prhs[0], "xy", errId);
+  n = mxGetM(prhs[0]);
+  if (mxGetNumberOfDimensions(prhs[0]) != 2 || mxGetN(prhs[0]) < 2) {
+    mexErrMsgIdAndTxt(errId, "xy must be N x 2");
+  }
+  dem = mexDemGridFromStruct(prhs[1], errId);
+  limits = mexDoubleArray(prhs[2], "limits", errId);
+  if (mxGetNumberOfElements(prhs[2]) != 3) {
+    mexErrMsgIdAndTxt(errId, "limits must be [minAGL, maxClimbAngle, "
+                             "sampleStep]");
+  }
+  lim.minAGL = limits[0];
+  lim.maxClimb = limits[1];
+  lim.sampleStep = limits[2];
+
+  plhs[0] = mxCreateDoubleMatrix(n, 1, mxREAL);
+  if (!altitudeProfile(dem, xy, xy + n, n, lim, mxGetDoubles(plhs[0]), rep,
+                       &err)) {
+    mxDestroyArray(plhs[0]);
+    mexErrMsgIdAndTxt(errId, "%s", err);
+  }
+  if (nlhs < 2) {
+    return;
+  }
+  plhs[1] = mxCreateStructMatrix(1, 1, 3, fields);
+  mxSetField(plhs[1], 0, "samples", mxCreateDoubleScalar((double)rep.samples));
+  mxSetField(plhs[1], 0, "legsLifted",
+             mxCreateDoubleScalar((double)rep.legsLifted));
+  mxSetField(plhs[1], 0, "maxLift", mxCreateDoubleScalar(rep.maxLift));
+}
+
+/* End of altitudeProfile_mex.cpp */
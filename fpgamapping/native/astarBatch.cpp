@@ -0,0 +1,311 @@
+/*
+ * astarBatch.cpp
+ *
+ * Work-stealing batch planner and result memo (see astarBatch.h).
+ *
+ */
+
+/* Include files */
+#include "astarBatch.h"
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <thread>
+
+/* Type Definitions */
+struct AstarWorker {
+  std::mutex lock;
+  std::deque<std::size_t> jobs; /* indices into AstarPool::todo */
+  AstarArena arena;
+  AstarLocalScratch local;
+};
+
+struct AstarPool {
+  const AstarBatch *batch;
+  const std::vector<AstarQuery> *queries;
+  std::vector<std::size_t> todo;      /* queries that must be searched */
+  std::vector<AstarResult> *results;
+  std::vector<AstarWorker> workers;
+  std::atomic<bool> failed;
+  std::mutex errLock;
+  const char *err;
+
+  explicit AstarPool(std::size_t n) : workers(n), failed(false), err("") {}
+};
+
+/* Function Declarations */
+static uint64_t astarHashWords(uint64_t h, const void *data, std::size_t n);
+static uint64_t astarBits(double v);
+static bool astarTakeJob(AstarPool *pool, std::size_t self, std::size_t &job);
+static void astarRunWorker(AstarPool *pool, std::size_t self);
+
+/* Function Definitions */
+/*  FNV-1a over 8-byte words (plus the tail), multiply-xorshift mixed */
+static uint64_t astarHashWords(uint64_t h, const void *data, std::size_t n)
+{
+  const unsigned char *p = (const unsigned char *)data;
+  uint64_t w;
+  std::size_t k;
+  for (k = 0; k + 8 <= n; k += 8) {
+    std::memcpy(&w, p + k, 8);
+    h = (h ^ w) * 0x100000001b3ULL;
+    h ^= h >> 29;
+  }
+  for (; k < n; k++) {
+    h = (h ^ p[k]) * 0x100000001b3ULL;
+  }
+  return h;
+}
+
+static uint64_t astarBits(double v)
+{
+  uint64_t b;
+  if (v == 0.0) {
+    v = 0.0; /* -0 and +0 are the same point */
+  }
+  std::memcpy(&b, &v, 8);
+  return b;
+}
+
+bool AstarMemoKey::operator==(const AstarMemoKey &o) const
+{
+  return version == o.version && start[0] == o.start[0] &&
+         start[1] == o.start[1] && goal[0] == o.goal[0] &&
+         goal[1] == o.goal[1] && maxExpansions == o.maxExpansions &&
+         mode == o.mode;
+}
+
+std::size_t AstarMemoKeyHash::operator()(const AstarMemoKey &k) const
+{
+  uint64_t h = 0xcbf29ce484222325ULL;
+  h = astarHashWords(h, &k.version, 8);
+  h = astarHashWords(h, k.start, 16);
+  h = astarHashWords(h, k.goal, 16);
+  h = astarHashWords(h, &k.maxExpansions, 8);
+  h = astarHashWords(h, &k.mode, 4);
+  return (std::size_t)h;
+}
+
+AstarMemo::AstarMemo(std::size_t maxEntries) : capacity(maxEntries)
+{
+}
+
+const AstarResult *AstarMemo::find(const AstarMemoKey &key) const
+{
+  std::unordered_map<AstarMemoKey, AstarResult, AstarMemoKeyHash>::
+      const_iterator it = table.find(key);
+  return it == table.end() ? NULL : &it->second;
+}
+
+void AstarMemo::insert(const AstarMemoKey &key, const AstarResult &result)
+{
+  if (table.size() >= capacity) {
+    table.clear();
+  }
+  table[key] = result;
+}
+
+uint64_t astarProblemVersion(const AstarProblem &p, AstarMode mode,
+                             const AstarHierarchy *hierarchy)
+{
+  const std::size_t posts = (std::size_t)p.dem.rows * p.dem.cols;
+  uint64_t h = 0xcbf29ce484222325ULL;
+  double geo[9];
+  int32_t dims[7];
+  geo[0] = p.dem.xMin;
+  geo[1] = p.dem.yMin;
+  geo[2] = p.dem.resolution;
+  geo[3] = p.resolution;
+  geo[4] = p.maxSlope;
+  geo[5] = p.obs.x0;
+  geo[6] = p.obs.y0;
+  geo[7] = p.obs.res;
+  geo[8] = (double)mode;
+  dims[0] = p.dem.rows;
+  dims[1] = p.dem.cols;
+  dims[2] = p.obs.cells != NULL ? p.obs.rows : 0;
+  dims[3] = p.obs.cells != NULL ? p.obs.cols : 0;
+  /*  Landmark tables are a function of the rest, so their count will do */
+  dims[4] = (int32_t)p.heuristic;
+  dims[5] = p.landmarks != NULL ? p.landmarks->count : 0;
+  /*  So is a hierarchy, given its cluster size: a rebuilt one still hits */
+  dims[6] = hierarchy != NULL ? hierarchy->clusterSize() : 0;
+  h = astarHashWords(h, geo, sizeof(geo));
+  h = astarHashWords(h, p.bounds, sizeof(p.bounds));
+  h = astarHashWords(h, dims, sizeof(dims));
+  h = astarHashWords(h, p.dem.Z, posts * sizeof(double));
+  if (p.obs.cells != NULL) {
+    h = astarHashWords(h, p.obs.cells,
+                       (std::size_t)p.obs.rows * (std::size_t)p.obs.cols);
+  }
+  if (p.mask != NULL) {
+    h = astarHashWords(h, p.mask, posts);
+  }
+  return h;
+}
+
+/*  Own deque from the back, else steal from the front of another one */
+static bool astarTakeJob(AstarPool *pool, std::size_t self, std::size_t &job)
+{
+  const std::size_t n = pool->workers.size();
+  std::size_t v;
+  std::size_t victim;
+  for (v = 0; v < n; v++) {
+    victim = (self + v) % n;
+    std::lock_guard<std::mutex> guard(pool->workers[victim].lock);
+    std::deque<std::size_t> &q = pool->workers[victim].jobs;
+    if (q.empty()) {
+      continue;
+    }
+    if (v == 0) {
+      job = q.back();
+      q.pop_back();
+    } else {
+      job = q.front();
+      q.pop_front();
+    }
+    return true;
+  }
+  return false; /* nothing is ever queued later, so the batch is done */
+}
+
+static void astarRunWorker(AstarPool *pool, std::size_t self)
+{
+  const AstarBatch &b = *pool->batch;
+  AstarWorker &w = pool->workers[self];
+  AstarProblem p = *b.problem;
+  const char *err = "";
+  std::size_t job;
+  std::size_t q;
+  bool ok;
+  while (!pool->failed.load() && astarTakeJob(pool, self, job)) {
+    q = pool->todo[job];
+    AstarResult &out = (*pool->results)[q];
+    p.start[0] = (*pool->queries)[q].start[0];
+    p.start[1] = (*pool->queries)[q].start[1];
+    p.goal[0] = (*pool->queries)[q].goal[0];
+    p.goal[1] = (*pool->queries)[q].goal[1];
+    try {
+      if (b.mode == astarModeJump) {
+        ok = astarJumpSearch(p, w.arena, out, &err);
+      } else if (b.mode == astarModeHierarchy) {
+        ok = b.hierarchy->search(p.start, p.goal, p.maxExpansions, w.arena,
+                                 w.local, out, &err);
+      } else {
+        ok = astarSearch(p, w.arena, out, &err);
+      }
+    } catch (const std::bad_alloc &) {
+      err = "out of memory";
+      ok = false;
+    }
+    if (!ok) {
+      std::lock_guard<std::mutex> guard(pool->errLock);
+      if (!pool->failed.load()) {
+        pool->err = err;
+        pool->failed.store(true);
+      }
+    }
+  }
+}
+
+bool astarBatchSearch(const AstarBatch &batch,
+                      const std::vector<AstarQuery> &queries, int nThreads,
+                      AstarMemo *memo, std::vector<AstarResult> &results,
+                      std::vector<uint8_t> &cached, const char **err)
+{
+  std::unordered_map<AstarMemoKey, std::size_t, AstarMemoKeyHash> first;
+  std::unordered_map<AstarMemoKey, std::size_t, AstarMemoKeyHash>::iterator
+      it;
+  std::vector<AstarMemoKey> keys(queries.size());
+  std::vector<std::size_t> same(queries.size());
+  std::vector<std::thread> threads;
+  std::vector<std::size_t> todo;
+  const AstarResult *hit;
+  std::size_t nWorkers;
+  std::size_t k;
+  std::size_t t;
+
+  if (batch.mode == astarModeHierarchy && batch.hierarchy == NULL) {
+    *err = "hierarchy mode needs a built hierarchy";
+    return false;
+  }
+  results.assign(queries.size(), AstarResult());
+  cached.assign(queries.size(), 0);
+
+  /*  Memo hits and repeats are answered without searching */
+  for (k = 0; k < queries.size(); k++) {
+    keys[k].version = batch.version;
+    keys[k].start[0] = astarBits(queries[k].start[0]);
+    keys[k].start[1] = astarBits(queries[k].start[1]);
+    keys[k].goal[0] = astarBits(queries[k].goal[0]);
+    keys[k].goal[1] = astarBits(queries[k].goal[1]);
+    keys[k].maxExpansions = batch.problem->maxExpansions;
+    keys[k].mode = (int32_t)batch.mode;
+    same[k] = k;
+    hit = memo != NULL ? memo->find(keys[k]) : NULL;
+    if (hit != NULL) {
+      results[k] = *hit;
+      cached[k] = 1;
+      continue;
+    }
+    it = first.find(keys[k]);
+    if (it != first.end()) {
+      same[k] = it->second;
+      cached[k] = 1;
+      continue;
+    }
+    first[keys[k]] = k;
+    todo.push_back(k);
+  }
+
+  if (nThreads < 1) {
+    nThreads = (int)std::thread::hardware_concurrency();
+  }
+  nWorkers = nThreads < 1 ? 1 : (std::size_t)nThreads;
+  if (nWorkers > todo.size()) {
+    nWorkers = todo.size() < 1 ? 1 : todo.size();
+  }
+
+  AstarPool pool(nWorkers);
+  pool.batch = &batch;
+  pool.queries = &queries;
+  pool.results = &results;
+  pool.todo.swap(todo);
+  for (k = 0; k < pool.todo.size(); k++) {
+    pool.workers[k * nWorkers / pool.todo.size()].jobs.push_back(k);
+  }
+
+  /*  Worker 0 runs on the calling thread; if threads cannot be created the
+   *  others' deques are simply stolen by it */
+  for (t = 1; t < nWorkers; t++) {
+    try {
+      threads.push_back(std::thread(astarRunWorker, &pool, t));
+    } catch (...) {
+      break;
+    }
+  }
+  astarRunWorker(&pool, 0);
+  for (t = 0; t < threads.size(); t++) {
+    threads[t].join();
+  }
+  if (pool.failed.load()) {
+    *err = pool.err;
+    return false;
+  }
+
+  for (k = 0; k < queries.size(); k++) {
+    if (same[k] != k) {
+      results[k] = results[same[k]];
+    }
+  }
+  if (memo != NULL) {
+    for (k = 0; k < pool.todo.size(); k++) {
+      memo->insert(keys[pool.todo[k]], results[pool.todo[k]]);
+    }
+  }
+  return true;
+}
+
+/* End of astarBatch.cpp */
@@ -0,0 +1,109 @@
+/*
+ * astarBatch.h
+ *
+ * Many independent queries on one planning problem, e.g. every blocked
+ * leg of a mission path. The legs are dealt in contiguous blocks to the
+ * deques of a small thread pool; a worker takes from the back of its own
+ * deque and, once that is empty, steals from the front of the others, so
+ * a few long detours do not leave the other threads idle. Every worker
+ * owns its search arena (and HPA* scratch), and the problem, mask and
+ * hierarchy are only read.
+ *
+ * Results can be memoized in an AstarMemo keyed by the query end points,
+ * the planner mode and expansion cap, and a version hash of everything
+ * else the answer depends on (terrain, bounds, obstacle grid, maxSlope,
+ * mask, heuristic, landmarks, hierarchy). Repeating a mission or sweeping
+ * parameters that do not touch the obstacle grid then re-plans nothing.
+ *
+ */
+
+#pragma once
+
+/* Include files */
+#include "astarHierarchy.h"
+#include "astarSearch.h"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/* Type Definitions */
+enum AstarMode {
+  astarModePlain = 0,    /* astarSearch */
+  astarModeJump = 1,     /* astarJumpSearch */
+  astarModeHierarchy = 2, /* AstarHierarchy::search */
+  astarModeAnytime = 3    /* astarAnytimeSearch, single queries only */
+};
+
+struct AstarQuery {
+  double start[2];
+  double goal[2];
+};
+
+struct AstarMemoKey {
+  uint64_t version;
+  uint64_t start[2]; /* coordinate bit patterns */
+  uint64_t goal[2];
+  int64_t maxExpansions;
+  int32_t mode;
+
+  bool operator==(const AstarMemoKey &o) const;
+};
+
+struct AstarMemoKeyHash {
+  std::size_t operator()(const AstarMemoKey &k) const;
+};
+
+class AstarMemo {
+public:
+  explicit AstarMemo(std::size_t maxEntries);
+
+  const AstarResult *find(const AstarMemoKey &key) const;
+
+  /*  Store a result; a full memo is emptied first */
+  void insert(const AstarMemoKey &key, const AstarResult &result);
+
+  void clear()
+  {
+    table.clear();
+  }
+
+  std::size_t size() const
+  {
+    return table.size();
+  }
+
+private:
+  std::unordered_map<AstarMemoKey, AstarResult, AstarMemoKeyHash> table;
+  std::size_t capacity;
+};
+
+struct AstarBatch {
+  const AstarProblem *problem;       /* start / goal are ignored */
+  AstarMode mode;
+  const AstarHierarchy *hierarchy;   /* astarModeHierarchy only */
+  uint64_t version;                  /* astarProblemVersion, for the memo */
+};
+
+/* Function Declarations */
+/*
+ * Hash of the problem minus its end points (column-major dem.Z only). The
+ * heuristic is included, since it may pick a different path among equal
+ * costs. hierarchy (NULL outside astarModeHierarchy) must be built from the
+ * same problem and enters by its cluster size, so rebuilding it for the
+ * next run keeps the memo.
+ */
+uint64_t astarProblemVersion(const AstarProblem &p, AstarMode mode,
+                             const AstarHierarchy *hierarchy);
+
+/*
+ * Run every query; results[k] answers queries[k] and cached[k] is 1 when
+ * it came from the memo (or from an identical query earlier in the
+ * batch). nThreads <= 0 uses every hardware thread; memo may be NULL.
+ */
+bool astarBatchSearch(const AstarBatch &batch,
+                      const std::vector<AstarQuery> &queries, int nThreads,
+                      AstarMemo *memo, std::vector<AstarResult> &results,
+                      std::vector<uint8_t> &cached, const char **err);
+
+/* End of astarBatch.h */
@@ -0,0 +1,309 @@
+/*
+ * astarDistance.cpp
+ *
+ * Dijkstra distance fields and the k-nearest cost matrix (see
+ * astarDistance.h).
+ *
+ */
+
+/* Include files */
+#include "astarDistance.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <new>
+#include <thread>
+#include <utility>
+
+/* Type Definitions */
+typedef std::pair<double, int32_t> AstarFieldEntry; /* (cost, post) */
+
+struct AstarFieldWorker {
+  std::vector<double> dist;
+  std::vector<uint32_t> stamp; /* == gen: dist valid for this source */
+  std::vector<AstarFieldEntry> heap;
+  std::vector<AstarFieldEntry> best; /* max-heap of (cost, waypoint) */
+  uint32_t gen;
+  int64_t settled;
+
+  AstarFieldWorker() : gen(0), settled(0) {}
+};
+
+struct AstarFieldPool {
+  const AstarKnnQuery *q;
+  const uint8_t *mask;
+  std::vector<int32_t> post;   /* per waypoint, -1 when not placeable */
+  std::vector<double> off;     /* planar distance waypoint -> post */
+  std::vector<int32_t> head;   /* per post, first waypoint on it */
+  std::vector<int32_t> next;   /* per waypoint, next one on its post */
+  std::vector<std::vector<AstarKnnEdge> > rows;
+  std::vector<AstarFieldWorker> workers;
+  std::atomic<std::size_t> nextSource;
+  std::atomic<bool> failed;
+
+  explicit AstarFieldPool(std::size_t n)
+      : workers(n), nextSource(0), failed(false)
+  {
+  }
+};
+
+/* Function Declarations */
+static void astarFieldSource(AstarFieldPool *pool, AstarFieldWorker &w,
+                             std::size_t s);
+static void astarFieldRun(AstarFieldPool *pool, std::size_t self);
+
+/* Function Definitions */
+static void astarFieldSource(AstarFieldPool *pool, AstarFieldWorker &w,
+                             std::size_t s)
+{
+  const AstarKnnQuery &q = *pool->q;
+  const int32_t rows = q.dem.rows;
+  const double step[2] = {q.dem.resolution,
+                          q.dem.resolution * std::sqrt(2.0)};
+  const std::size_t k = (std::size_t)q.k;
+  std::greater<AstarFieldEntry> later;
+  std::vector<AstarKnnEdge> &out = pool->rows[s];
+  AstarFieldEntry top;
+  AstarKnnEdge e;
+  double d;
+  double c;
+  uint8_t bits;
+  int32_t u;
+  int32_t v;
+  int32_t j;
+  int32_t dir;
+
+  out.clear();
+  if (pool->post[s] < 0) {
+    return;
+  }
+  if (++w.gen == 0) {
+    std::fill(w.stamp.begin(), w.stamp.end(), 0u);
+    w.gen = 1;
+  }
+  w.heap.clear();
+  w.best.clear();
+  u = pool->post[s];
+  w.dist[u] = pool->off[s];
+  w.stamp[u] = w.gen;
+  w.heap.push_back(AstarFieldEntry(w.dist[u], u));
+
+  while (!w.heap.empty()) {
+    std::pop_heap(w.heap.begin(), w.heap.end(), later);
+    top = w.heap.back();
+    w.heap.pop_back();
+    d = top.first;
+    u = top.second;
+    if (d > w.dist[u]) {
+      continue; /* stale entry */
+    }
+    /*  Every later waypoint costs at least d */
+    if (d > q.radius || (w.best.size() == k && d >= w.best.front().first)) {
+      break;
+    }
+    w.settled++;
+
+    for (j = pool->head[u]; j >= 0; j = pool->next[j]) {
+      if ((std::size_t)j == s) {
+        continue;
+      }
+      c = d + pool->off[j];
+      if (c > q.radius) {
+        continue;
+      }
+      if (w.best.size() < k) {
+        w.best.push_back(AstarFieldEntry(c, j));
+        std::push_heap(w.best.begin(), w.best.end());
+      } else if (c < w.best.front().first) {
+        std::pop_heap(w.best.begin(), w.best.end());
+        w.best.back() = AstarFieldEntry(c, j);
+        std::push_heap(w.best.begin(), w.best.end());
+      }
+    }
+
+    bits = pool->mask[u];
+    for (dir = 0; dir < 8; dir++) {
+      if (!((bits >> dir) & 1u)) {
+        continue;
+      }
+      v = u + astarMoveDirs[dir][0] * rows + astarMoveDirs[dir][1];
+      c = d + step[dir >= 4];
+      if (w.stamp[v] != w.gen || c < w.dist[v]) {
+        w.stamp[v] = w.gen;
+        w.dist[v] = c;
+        w.heap.push_back(AstarFieldEntry(c, v));
+        std::push_heap(w.heap.begin(), w.heap.end(), later);
+      }
+    }
+  }
+
+  std::sort_heap(w.best.begin(), w.best.end());
+  out.reserve(w.best.size());
+  for (j = 0; j < (int32_t)w.best.size(); j++) {
+    e.from = (int32_t)s;
+    e.to = w.best[j].second;
+    e.cost = w.best[j].first;
+    out.push_back(e);
+  }
+}
+
+static void astarFieldRun(AstarFieldPool *pool, std::size_t self)
+{
+  AstarFieldWorker &w = pool->workers[self];
+  const std::size_t nPosts =
+      (std::size_t)pool->q->dem.rows * pool->q->dem.cols;
+  std::size_t s;
+  try {
+    w.dist.resize(nPosts);
+    w.stamp.assign(nPosts, 0u);
+    while (!pool->failed.load() &&
+           (s = pool->nextSource.fetch_add(1)) < pool->q->n) {
+      astarFieldSource(pool, w, s);
+    }
+  } catch (const std::bad_alloc &) {
+    pool->failed.store(true);
+  }
+}
+
+void astarDistanceField(const uint8_t *mask, int32_t rows, int32_t cols,
+                        double res, int32_t source, std::vector<double> &dist)
+{
+  const double step[2] = {res, res * std::sqrt(2.0)};
+  std::greater<AstarFieldEntry> later;
+  std::vector<AstarFieldEntry> heap;
+  AstarFieldEntry top;
+  double c;
+  uint8_t bits;
+  int32_t u;
+  int32_t v;
+  int32_t dir;
+
+  dist.assign((std::size_t)rows * cols,
+              std::numeric_limits<double>::infinity());
+  dist[source] = 0.0;
+  heap.push_back(AstarFieldEntry(0.0, source));
+  while (!heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end(), later);
+    top = heap.back();
+    heap.pop_back();
+    u = top.second;
+    if (top.first > dist[u]) {
+      continue; /* stale entry */
+    }
+    bits = mask[u];
+    for (dir = 0; dir < 8; dir++) {
+      if (!((bits >> dir) & 1u)) {
+        continue;
+      }
+      v = u + astarMoveDirs[dir][0] * rows + astarMoveDirs[dir][1];
+      c = top.first + step[dir >= 4];
+      if (c < dist[v]) {
+        dist[v] = c;
+        heap.push_back(AstarFieldEntry(c, v));
+        std::push_heap(heap.begin(), heap.end(), later);
+      }
+    }
+  }
+}
+
+bool astarKnnCostMatrix(const AstarKnnQuery &q, int nThreads,
+                        std::vector<AstarKnnEdge> &edges, int64_t &settled,
+                        const char **err)
+{
+  const double res = q.dem.resolution;
+  std::vector<uint8_t> ownMask;
+  std::vector<std::thread> threads;
+  std::size_t nPosts;
+  std::size_t nWorkers;
+  std::size_t s;
+  std::size_t t;
+  double i;
+  double j;
+
+  edges.clear();
+  settled = 0;
+  if (q.dem.rows < 2 || q.dem.cols < 2 ||
+      (int64_t)q.dem.rows * q.dem.cols >= (int64_t)INT32_MAX) {
+    *err = "DEM grid size is not supported";
+    return false;
+  }
+  if (!(res > 0.0)) {
+    *err = "DEM resolution must be positive";
+    return false;
+  }
+  if (q.k < 1 || q.n >= (std::size_t)INT32_MAX) {
+    *err = "k must be at least 1 and the waypoints fewer than 2^31";
+    return false;
+  }
+  nPosts = (std::size_t)q.dem.rows * q.dem.cols;
+  if (nThreads < 1) {
+    nThreads = (int)std::thread::hardware_concurrency();
+  }
+  nWorkers = nThreads < 1 ? 1 : (std::size_t)nThreads;
+  if (nWorkers > q.n) {
+    nWorkers = q.n < 1 ? 1 : q.n;
+  }
+
+  AstarFieldPool pool(nWorkers);
+  pool.q = &q;
+  pool.mask = q.mask;
+  if (pool.mask == NULL) {
+    ownMask.resize(nPosts);
+    if (!astarTraversabilityBuild(q.dem, q.bounds, q.obs, q.maxSlope,
+                                  &ownMask[0], err)) {
+      return false;
+    }
+    pool.mask = &ownMask[0];
+  }
+
+  /*  Snap waypoints to posts and chain them per post */
+  pool.post.assign(q.n, -1);
+  pool.off.assign(q.n, 0.0);
+  pool.head.assign(nPosts, -1);
+  pool.next.assign(q.n, -1);
+  for (s = q.n; s-- > 0;) {
+    i = std::round((q.x[s] - q.dem.xMin) / res);
+    j = std::round((q.y[s] - q.dem.yMin) / res);
+    if (std::isnan(i) || std::isnan(j)) {
+      continue;
+    }
+    i = std::min(std::max(i, 0.0), (double)(q.dem.cols - 1));
+    j = std::min(std::max(j, 0.0), (double)(q.dem.rows - 1));
+    pool.post[s] = (int32_t)i * q.dem.rows + (int32_t)j;
+    pool.off[s] = std::hypot(q.x[s] - (q.dem.xMin + i * res),
+                             q.y[s] - (q.dem.yMin + j * res));
+    pool.next[s] = pool.head[pool.post[s]];
+    pool.head[pool.post[s]] = (int32_t)s;
+  }
+  pool.rows.resize(q.n);
+
+  /*  Worker 0 runs on the calling thread; sources go to whichever worker
+   *  asks next, so threads that cannot be created just leave more to it */
+  for (t = 1; t < nWorkers; t++) {
+    try {
+      threads.push_back(std::thread(astarFieldRun, &pool, t));
+    } catch (...) {
+      break;
+    }
+  }
+  astarFieldRun(&pool, 0);
+  for (t = 0; t < threads.size(); t++) {
+    threads[t].join();
+  }
+  if (pool.failed.load()) {
+    *err = "out of memory";
+    return false;
+  }
+
+  for (t = 0; t < pool.workers.size(); t++) {
+    settled += pool.workers[t].settled;
+  }
+  for (s = 0; s < q.n; s++) {
+    edges.insert(edges.end(), pool.rows[s].begin(), pool.rows[s].end());
+  }
+  return true;
+}
+
+/* End of astarDistance.cpp */
@@ -0,0 +1,70 @@
+/*
+ * astarDistance.h
+ *
+ * One-to-many terrain distances for ordering waypoints. From every
+ * waypoint a Dijkstra distance field grows over the DEM posts along the
+ * moves of the traversability mask (astarTraversability.h), with the
+ * lattice costs of the A* planners: res straight, res * sqrt(2) diagonal.
+ * Obstacles and steep ground are therefore routed around exactly as
+ * astarPathfinding would, instead of being cut through by a straight line.
+ *
+ * Only the k nearest other waypoints are kept per source, and a field
+ * stops growing once those k are settled or its radius is exhausted, so
+ * the cost of a source is bounded by its neighbourhood rather than by the
+ * DEM. Waypoints snap to their nearest posts; the planar distance to the
+ * post is added at both ends. Sources are independent and run on a small
+ * thread pool, each worker with its own distance array stamped per source.
+ *
+ * astarDistanceField grows one unbounded field over the whole grid, as
+ * the landmark tables of astarLandmarks.h need.
+ *
+ */
+
+#pragma once
+
+/* Include files */
+#include "astarTraversability.h"
+#include "demKernel.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Type Definitions */
+/*  One entry of the k-nearest cost matrix, 0-based waypoint indices */
+struct AstarKnnEdge {
+  int32_t from;
+  int32_t to;
+  double cost;
+};
+
+struct AstarKnnQuery {
+  DemGrid dem;
+  double bounds[4];     /* xMin, xMax, yMin, yMax */
+  AstarObstacles obs;
+  double maxSlope;      /* degrees */
+  const uint8_t *mask;  /* traversability per DEM post, or NULL to build */
+  const double *x;      /* waypoints */
+  const double *y;
+  std::size_t n;
+  int32_t k;            /* neighbours kept per source */
+  double radius;        /* search radius in metres, Inf = unbounded */
+};
+
+/* Function Declarations */
+/*
+ * Full distance field from one post over the moves of mask (rows x cols
+ * posts, column-major); unreached posts get Inf.
+ */
+void astarDistanceField(const uint8_t *mask, int32_t rows, int32_t cols,
+                        double res, int32_t source, std::vector<double> &dist);
+
+/*
+ * edges holds, for every source in order, its up to k nearest reachable
+ * waypoints by increasing cost; settled counts the posts settled over all
+ * fields. nThreads <= 0 uses every hardware thread.
+ */
+bool astarKnnCostMatrix(const AstarKnnQuery &q, int nThreads,
+                        std::vector<AstarKnnEdge> &edges, int64_t &settled,
+                        const char **err);
+
+/* End of astarDistance.h */
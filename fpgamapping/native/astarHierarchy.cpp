@@ -0,0 +1,648 @@
+/*
+ * astarHierarchy.cpp
+ *
+ * HPA*-style abstraction and query (see astarHierarchy.h). Posts are
+ * column-major cells i * rows + j (i along X, j along Y), as in demData.Z
+ * and the traversability mask. Cluster c covers posts
+ * i in [cx * csize, cx * csize + csize), j likewise, with c = cx * cRows + cy.
+ *
+ */
+
+/* Include files */
+#include "astarHierarchy.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+
+/* Type Definitions */
+struct AstarRawEdge {
+  int32_t from;
+  int32_t to;
+  double cost;
+};
+
+/* Variable Definitions */
+static const double astarInf = std::numeric_limits<double>::infinity();
+
+/* Function Declarations */
+static int32_t astarNodeFor(std::unordered_map<int32_t, int32_t> &nodeOf,
+                            std::vector<int32_t> &nodeCell, int32_t cell);
+static bool astarBorderJoined(const std::vector<uint8_t> &mask, int32_t a,
+                              int32_t b, int32_t step, int32_t t);
+
+/* Function Definitions */
+static int32_t astarNodeFor(std::unordered_map<int32_t, int32_t> &nodeOf,
+                            std::vector<int32_t> &nodeCell, int32_t cell)
+{
+  std::unordered_map<int32_t, int32_t>::iterator it = nodeOf.find(cell);
+  if (it != nodeOf.end()) {
+    return it->second;
+  }
+  nodeOf[cell] = (int32_t)nodeCell.size();
+  nodeCell.push_back(cell);
+  return (int32_t)nodeCell.size() - 1;
+}
+
+/*
+ *  Whether the straight crossings a | b and a - step | b - step of border
+ *  t are both open and each side can move between them, so the two lie
+ *  on one stretch and reach its transitions
+ */
+static bool astarBorderJoined(const std::vector<uint8_t> &mask, int32_t a,
+                              int32_t b, int32_t step, int32_t t)
+{
+  const int32_t along = t == 0 ? 2 : 0;
+  return ((mask[a] >> (2 * t)) & 1u) && ((mask[b] >> (2 * t + 1)) & 1u) &&
+         ((mask[a - step] >> (2 * t)) & 1u) &&
+         ((mask[b - step] >> (2 * t + 1)) & 1u) &&
+         ((mask[a - step] >> along) & 1u) &&
+         ((mask[a] >> (along + 1)) & 1u) &&
+         ((mask[b - step] >> along) & 1u) &&
+         ((mask[b] >> (along + 1)) & 1u);
+}
+
+AstarHierarchy::AstarHierarchy()
+    : rows(0), cols(0), csize(0), cRows(0), cCols(0), xMin(0.0), yMin(0.0),
+      res(1.0)
+{
+}
+
+int32_t AstarHierarchy::clusterOf(int32_t cell) const
+{
+  return (cell / rows) / csize * cRows + (cell % rows) / csize;
+}
+
+int32_t AstarHierarchy::nearestPost(const double pt[2]) const
+{
+  double i = std::round((pt[0] - xMin) / res);
+  double j = std::round((pt[1] - yMin) / res);
+  if (std::isnan(i) || std::isnan(j)) {
+    return 0;
+  }
+  i = std::min(std::max(i, 0.0), (double)(cols - 1));
+  j = std::min(std::max(j, 0.0), (double)(rows - 1));
+  return (int32_t)i * rows + (int32_t)j;
+}
+
+/*
+ * Dijkstra from src over the posts of one cluster. Forward: along legal
+ * moves out of each post; reverse: along legal moves into it, giving the
+ * cost from every post to src. Stops early once target is settled.
+ */
+int64_t AstarHierarchy::localSearch(AstarLocalScratch &s, int32_t src,
+                                    int32_t cluster, bool reverse,
+                                    int32_t target) const
+{
+  const double step[2] = {res, res * std::sqrt(2.0)};
+  const int32_t i0 = cluster / cRows * csize;
+  const int32_t j0 = cluster % cRows * csize;
+  const int32_t i1 = std::min(cols, i0 + csize);
+  const int32_t j1 = std::min(rows, j0 + csize);
+  std::greater<std::pair<double, int32_t> > later;
+  std::pair<double, int32_t> top;
+  int64_t pops = 0;
+  int32_t u;
+  int32_t v;
+  int32_t lu;
+  int32_t lv;
+  int32_t i;
+  int32_t j;
+  int32_t ni;
+  int32_t nj;
+  int32_t d;
+  double nd;
+
+  if (s.seen.size() != (std::size_t)csize * csize) {
+    s.dist.assign((std::size_t)csize * csize, 0.0);
+    s.prev.assign((std::size_t)csize * csize, -1);
+    s.seen.assign((std::size_t)csize * csize, 0);
+    s.seenGen = 0;
+  }
+  if (++s.seenGen == 0) {
+    s.seen.assign(s.seen.size(), 0);
+    s.seenGen = 1;
+  }
+  s.winI0 = i0;
+  s.winJ0 = j0;
+  lu = (src / rows - i0) * csize + src % rows - j0;
+  s.seen[lu] = s.seenGen;
+  s.dist[lu] = 0.0;
+  s.prev[lu] = -1;
+  s.pq.clear();
+  s.pq.push_back(std::make_pair(0.0, src));
+
+  while (!s.pq.empty()) {
+    std::pop_heap(s.pq.begin(), s.pq.end(), later);
+    top = s.pq.back();
+    s.pq.pop_back();
+    u = top.second;
+    i = u / rows;
+    j = u % rows;
+    lu = (i - i0) * csize + j - j0;
+    if (top.first > s.dist[lu]) {
+      continue; /* stale entry */
+    }
+    pops++;
+    if (u == target) {
+      break;
+    }
+    for (d = 0; d < 8; d++) {
+      if (reverse) {
+        ni = i - astarMoveDirs[d][0];
+        nj = j - astarMoveDirs[d][1];
+      } else {
+        if (!((mask[u] >> d) & 1u)) {
+          continue;
+        }
+        ni = i + astarMoveDirs[d][0];
+        nj = j + astarMoveDirs[d][1];
+      }
+      if (ni < i0 || ni >= i1 || nj < j0 || nj >= j1) {
+        continue;
+      }
+      v = ni * rows + nj;
+      if (reverse && !((mask[v] >> d) & 1u)) {
+        continue;
+      }
+      lv = (ni - i0) * csize + nj - j0;
+      nd = top.first + step[d >= 4];
+      if (s.seen[lv] != s.seenGen || nd < s.dist[lv]) {
+        s.seen[lv] = s.seenGen;
+        s.dist[lv] = nd;
+        s.prev[lv] = u;
+        s.pq.push_back(std::make_pair(nd, v));
+        std::push_heap(s.pq.begin(), s.pq.end(), later);
+      }
+    }
+  }
+  return pops;
+}
+
+/*  Cost found by the last localSearch (infinite if unreached) */
+double AstarHierarchy::localDist(const AstarLocalScratch &s,
+                                 int32_t cell) const
+{
+  int32_t l = (cell / rows - s.winI0) * csize + cell % rows - s.winJ0;
+  return s.seen[l] == s.seenGen ? s.dist[l] : astarInf;
+}
+
+bool AstarHierarchy::build(const DemGrid &dem, const double bounds[4],
+                           const AstarObstacles &obs, double maxSlope,
+                           int32_t clusterSize, const char **err)
+{
+  std::unordered_map<int32_t, int32_t> nodeOf;
+  std::vector<AstarRawEdge> raw;
+  std::vector<int32_t> fill;
+  AstarRawEdge e;
+  int32_t cx;
+  int32_t cy;
+  int32_t c;
+  int32_t k;
+  int32_t m;
+  int32_t t;
+  int32_t a;
+  int32_t b;
+  int32_t lo;
+  int32_t hi;
+  int32_t run;
+  int32_t pick[2];
+  int32_t nPick;
+  int32_t u;
+  int32_t step;
+  int32_t fwd;
+  double dc;
+  bool open;
+  bool split = false;
+
+  if (clusterSize < 2) {
+    *err = "clusterSize must be at least 2";
+    return false;
+  }
+  if (dem.rows < 2 || dem.cols < 2 ||
+      (int64_t)dem.rows * dem.cols >= (int64_t)INT32_MAX) {
+    *err = "DEM grid size is not supported";
+    return false;
+  }
+  rows = dem.rows;
+  cols = dem.cols;
+  csize = clusterSize;
+  cRows = (rows + csize - 1) / csize;
+  cCols = (cols + csize - 1) / csize;
+  xMin = dem.xMin;
+  yMin = dem.yMin;
+  res = dem.resolution;
+  mask.assign((std::size_t)rows * cols, 0);
+  if (!astarTraversabilityBuild(dem, bounds, obs, maxSlope, &mask[0], err)) {
+    return false;
+  }
+  nodeCell.clear();
+
+  /*  Transitions on the border between clusters (c) and (c + 1), along X
+   *  (t = 0: posts i | i + 1, moves 0 and 1) and along Y (t = 1) */
+  for (t = 0; t < 2; t++) {
+    for (cx = 0; cx < (t == 0 ? cCols - 1 : cCols); cx++) {
+      for (cy = 0; cy < (t == 0 ? cRows : cRows - 1); cy++) {
+        lo = (t == 0 ? cy : cx) * csize;
+        hi = std::min(t == 0 ? rows : cols, lo + csize);
+        run = -1;
+        for (k = lo; k <= hi; k++) {
+          if (k < hi) {
+            if (t == 0) {
+              a = ((cx + 1) * csize - 1) * rows + k;
+              b = a + rows;
+            } else {
+              a = k * rows + (cy + 1) * csize - 1;
+              b = a + 1;
+            }
+            open = ((mask[a] >> (2 * t)) & 1u) &&
+                   ((mask[b] >> (2 * t + 1)) & 1u);
+          } else {
+            open = false;
+          }
+          /*  A stretch also ends where a side cannot move along the border
+           *  (steep ground), so every post of it reaches its transition */
+          step = t == 0 ? 1 : rows;
+          if (open && run >= 0 && k > run &&
+              !astarBorderJoined(mask, a, b, step, t)) {
+            split = true;
+          }
+          /*  A diagonal crossing to post k + 1 or k - 1 that does not lie
+           *  on one stretch with k (closed straight crossing at either
+           *  end, steep ground, a cluster corner) gets its own link */
+          for (m = 0; m < 2 && k < hi; m++) {
+            fwd = m == 0 ? 4 : (t == 0 ? 5 : 6);
+            e.to = m == 0 ? b + step : b - step;
+            if (((mask[a] >> fwd) & 1u) &&
+                ((mask[e.to] >> (11 - fwd)) & 1u) &&
+                !(m == 0 ? k + 1 < hi &&
+                               astarBorderJoined(mask, a + step, b + step,
+                                                 step, t)
+                         : k > lo && astarBorderJoined(mask, a, b, step, t))) {
+                e.from = astarNodeFor(nodeOf, nodeCell, a);
+              e.to = astarNodeFor(nodeOf, nodeCell, e.to);
+              e.cost = res * 1.4142135623730951;
+              raw.push_back(e);
+              std::swap(e.from, e.to);
+              raw.push_back(e);
+            }
+          }
+          if (open && run < 0) {
+            run = k;
+          }
+          if ((open && !split) || run < 0) {
+            continue;
+          }
+          /*  Open stretch [run, k - 1]: middle, or both ends if long */
+          nPick = 0;
+          if (k - run < 6) {
+            pick[nPick++] = (run + k - 1) / 2;
+          } else {
+            pick[nPick++] = run;
+            pick[nPick++] = k - 1;
+          }
+          for (m = 0; m < nPick; m++) {
+            if (t == 0) {
+              a = ((cx + 1) * csize - 1) * rows + pick[m];
+              b = a + rows;
+            } else {
+              a = pick[m] * rows + (cy + 1) * csize - 1;
+              b = a + 1;
+            }
+            e.from = astarNodeFor(nodeOf, nodeCell, a);
+            e.to = astarNodeFor(nodeOf, nodeCell, b);
+            e.cost = res;
+            raw.push_back(e);
+            std::swap(e.from, e.to);
+            raw.push_back(e);
+          }
+          run = (open && split) ? k : -1;
+          split = false;
+        }
+      }
+    }
+  }
+
+  /*  Nodes grouped by cluster */
+  clusterFirst.assign((std::size_t)cRows * cCols + 1, 0);
+  for (u = 0; u < (int32_t)nodeCell.size(); u++) {
+    clusterFirst[clusterOf(nodeCell[u]) + 1]++;
+  }
+  for (c = 0; c < cRows * cCols; c++) {
+    clusterFirst[c + 1] += clusterFirst[c];
+  }
+  clusterNodes.resize(nodeCell.size());
+  fill.assign(clusterFirst.begin(), clusterFirst.end() - 1);
+  for (u = 0; u < (int32_t)nodeCell.size(); u++) {
+    clusterNodes[fill[clusterOf(nodeCell[u])]++] = u;
+  }
+
+  /*  Intra-cluster edges: exact in-cluster cost between border nodes */
+  for (c = 0; c < cRows * cCols; c++) {
+    for (k = clusterFirst[c]; k < clusterFirst[c + 1]; k++) {
+      u = clusterNodes[k];
+      localSearch(local, nodeCell[u], c, false, -1);
+      for (m = clusterFirst[c]; m < clusterFirst[c + 1]; m++) {
+        dc = localDist(local, nodeCell[clusterNodes[m]]);
+        if (m != k && dc < astarInf) {
+          e.from = u;
+          e.to = clusterNodes[m];
+          e.cost = dc;
+          raw.push_back(e);
+        }
+      }
+    }
+  }
+
+  /*  Out-edges as CSR */
+  edgeFirst.assign(nodeCell.size() + 1, 0);
+  for (k = 0; k < (int32_t)raw.size(); k++) {
+    edgeFirst[raw[k].from + 1]++;
+  }
+  for (u = 0; u < (int32_t)nodeCell.size(); u++) {
+    edgeFirst[u + 1] += edgeFirst[u];
+  }
+  edges.resize(raw.size());
+  fill.assign(edgeFirst.begin(), edgeFirst.end() - 1);
+  for (k = 0; k < (int32_t)raw.size(); k++) {
+    edges[fill[raw[k].from]].to = raw[k].to;
+    edges[fill[raw[k].from]++].cost = raw[k].cost;
+  }
+  return true;
+}
+
+/*
+ * Concrete posts along a chain of abstract cells: border crossings are a
+ * single step, everything else is a path inside one cluster.
+ */
+bool AstarHierarchy::refine(AstarLocalScratch &s,
+                            const std::vector<int32_t> &cells, int64_t &pops,
+                            AstarResult &out) const
+{
+  std::vector<int32_t> seg;
+  std::size_t k;
+  int32_t a;
+  int32_t b;
+  int32_t v;
+  int32_t l;
+  out.x.assign(1, xMin + (double)(cells[0] / rows) * res);
+  out.y.assign(1, yMin + (double)(cells[0] % rows) * res);
+  for (k = 1; k < cells.size(); k++) {
+    a = cells[k - 1];
+    b = cells[k];
+    seg.clear();
+    if (a == b) {
+      continue;
+    }
+    if (clusterOf(a) != clusterOf(b)) {
+      seg.push_back(b);
+    } else {
+      pops += localSearch(s, a, clusterOf(a), false, b);
+      if (!(localDist(s, b) < astarInf)) {
+        return false;
+      }
+      for (v = b; v != a;) {
+        seg.push_back(v);
+        l = (v / rows - s.winI0) * csize + v % rows - s.winJ0;
+        v = s.prev[l];
+      }
+      std::reverse(seg.begin(), seg.end());
+    }
+    for (v = 0; v < (int32_t)seg.size(); v++) {
+      out.x.push_back(xMin + (double)(seg[v] / rows) * res);
+      out.y.push_back(yMin + (double)(seg[v] % rows) * res);
+    }
+  }
+  return true;
+}
+
+/*
+ * A* over every post of the grid from src to dst along the mask, for
+ * queries the abstract graph does not connect. Fills out with the posts
+ * (up to the best closed one after maxExpansions pops) and its status.
+ */
+void AstarHierarchy::gridSearch(int32_t src, int32_t dst,
+                                int64_t maxExpansions, AstarArena &a,
+                                int64_t &pops, AstarResult &out) const
+{
+  const double step[2] = {res, res * std::sqrt(2.0)};
+  const double gi = (double)(dst / rows);
+  const double gj = (double)(dst % rows);
+  int64_t popped = 0;
+  int32_t bestClosed = -1;
+  int32_t cur = -1;
+  int32_t v;
+  int32_t i;
+  int32_t j;
+  int32_t ni;
+  int32_t nj;
+  int32_t d;
+  double cost;
+
+  a.begin((std::size_t)rows * cols);
+  a.relax(src, -1, 0.0,
+          res * std::hypot((double)(src / rows) - gi,
+                           (double)(src % rows) - gj));
+  while (!a.heap.empty()) {
+    cur = a.pop();
+    popped++;
+    if (cur == dst) {
+      break;
+    }
+    if (bestClosed < 0 || a.f[cur] < a.f[bestClosed]) {
+      bestClosed = cur;
+    }
+    if (popped > maxExpansions) {
+      cur = -1;
+      break;
+    }
+    i = cur / rows;
+    j = cur % rows;
+    for (d = 0; d < 8; d++) {
+      if (!((mask[cur] >> d) & 1u)) {
+        continue;
+      }
+      ni = i + astarMoveDirs[d][0];
+      nj = j + astarMoveDirs[d][1];
+      v = ni * rows + nj;
+      if (!a.closed(v)) {
+        cost = a.g[cur] + step[d >= 4];
+        a.relax(v, cur, cost,
+                cost + res * std::hypot((double)ni - gi, (double)nj - gj));
+      }
+    }
+  }
+  pops += popped;
+  out.x.clear();
+  out.y.clear();
+  if (cur >= 0 && cur != dst) {
+    out.status = astarNoPath; /* open list ran empty */
+    return;
+  }
+  for (v = cur == dst ? dst : bestClosed; v >= 0; v = a.parent[v]) {
+    out.x.push_back(xMin + (double)(v / rows) * res);
+    out.y.push_back(yMin + (double)(v % rows) * res);
+  }
+  std::reverse(out.x.begin(), out.x.end());
+  std::reverse(out.y.begin(), out.y.end());
+  out.status = cur == dst ? astarFound : astarCapped;
+}
+
+bool AstarHierarchy::search(const double start[2], const double goal[2],
+                            int64_t maxExpansions, AstarArena &arena,
+                            AstarResult &out, const char **err)
+{
+  return search(start, goal, maxExpansions, arena, local, out, err);
+}
+
+bool AstarHierarchy::search(const double start[2], const double goal[2],
+                            int64_t maxExpansions, AstarArena &arena,
+                            AstarLocalScratch &local, AstarResult &out,
+                            const char **err) const
+{
+  const int32_t n = (int32_t)nodeCell.size();
+  const int32_t S = n;
+  const int32_t G = n + 1;
+  std::vector<std::pair<int32_t, double> > startEdges;
+  std::vector<std::pair<int32_t, double> > goalEdges;
+  std::vector<int32_t> cells;
+  AstarArena &a = arena;
+  int64_t pops = 0;
+  int64_t expanded = 0;
+  int32_t sCell;
+  int32_t gCell;
+  int32_t sCluster;
+  int32_t gCluster;
+  int32_t bestClosed = -1;
+  int32_t cur;
+  int32_t cell;
+  int32_t v;
+  int32_t k;
+  double gi;
+  double gj;
+  double cost;
+  bool found = false;
+
+  if (rows == 0) {
+    *err = "hierarchy has not been built";
+    return false;
+  }
+  sCell = nearestPost(start);
+  gCell = nearestPost(goal);
+  sCluster = clusterOf(sCell);
+  gCluster = clusterOf(gCell);
+  gi = (double)(gCell / rows);
+  gj = (double)(gCell % rows);
+
+  if (sCell == gCell) {
+    cells.push_back(sCell);
+    found = true;
+  } else if (sCluster == gCluster) {
+    /*  Same cluster: an in-cluster path, when there is one, is used */
+    pops += localSearch(local, sCell, sCluster, false, gCell);
+    if (localDist(local, gCell) < astarInf) {
+      cells.push_back(sCell);
+      cells.push_back(gCell);
+      found = true;
+    }
+  }
+
+  if (!found) {
+    pops += localSearch(local, sCell, sCluster, false, -1);
+    for (k = clusterFirst[sCluster]; k < clusterFirst[sCluster + 1]; k++) {
+      cost = localDist(local, nodeCell[clusterNodes[k]]);
+      if (cost < astarInf) {
+        startEdges.push_back(std::make_pair(clusterNodes[k], cost));
+      }
+    }
+    pops += localSearch(local, gCell, gCluster, true, -1);
+    for (k = clusterFirst[gCluster]; k < clusterFirst[gCluster + 1]; k++) {
+      cost = localDist(local, nodeCell[clusterNodes[k]]);
+      if (cost < astarInf) {
+        goalEdges.push_back(std::make_pair(clusterNodes[k], cost));
+      }
+    }
+
+    /*  A* over the border nodes plus the temporary start and goal */
+    a.begin((std::size_t)n + 2);
+    a.relax(S, -1, 0.0,
+            res * std::hypot((double)(sCell / rows) - gi,
+                             (double)(sCell % rows) - gj));
+    while (!a.heap.empty()) {
+      cur = a.pop();
+      expanded++;
+      if (cur == G) {
+        found = true;
+        break;
+      }
+      if (bestClosed < 0 || a.f[cur] < a.f[bestClosed]) {
+        bestClosed = cur;
+      }
+      if (cur == S) {
+        for (k = 0; k < (int32_t)startEdges.size(); k++) {
+          v = startEdges[k].first;
+          if (!a.closed(v)) {
+            cost = a.g[cur] + startEdges[k].second;
+            a.relax(v, cur, cost,
+                    cost + res * std::hypot((double)(nodeCell[v] / rows) - gi,
+                                            (double)(nodeCell[v] % rows) -
+                                                gj));
+          }
+        }
+      } else {
+        for (k = edgeFirst[cur]; k < edgeFirst[cur + 1]; k++) {
+          v = edges[k].to;
+          if (!a.closed(v)) {
+            cost = a.g[cur] + edges[k].cost;
+            a.relax(v, cur, cost,
+                    cost + res * std::hypot((double)(nodeCell[v] / rows) - gi,
+                                            (double)(nodeCell[v] % rows) -
+                                                gj));
+          }
+        }
+        for (k = 0; k < (int32_t)goalEdges.size(); k++) {
+          if (goalEdges[k].first == cur) {
+            a.relax(G, cur, a.g[cur] + goalEdges[k].second,
+                    a.g[cur] + goalEdges[k].second);
+          }
+        }
+      }
+      if (expanded > maxExpansions) {
+        break;
+      }
+    }
+
+    if (found || (expanded > maxExpansions && bestClosed >= 0)) {
+      for (v = found ? G : bestClosed; v >= 0; v = a.parent[v]) {
+        cell = v == S ? sCell : (v == G ? gCell : nodeCell[v]);
+        cells.push_back(cell);
+      }
+      std::reverse(cells.begin(), cells.end());
+    }
+  }
+
+  if (!found && !(expanded > maxExpansions)) {
+    /*  The abstract graph does not connect them: search the post grid */
+    gridSearch(sCell, gCell, maxExpansions - expanded - pops, a, pops, out);
+  } else if (cells.empty() || !refine(local, cells, pops, out)) {
+    out.x.clear();
+    out.y.clear();
+    out.status = astarNoPath;
+  } else {
+    out.status = found ? astarFound : astarCapped;
+  }
+  out.nodesExpanded = expanded + pops;
+  if (out.status == astarNoPath) {
+    return true;
+  }
+
+  /*  Start from the query point itself when it is off the post grid */
+  if (out.x[0] != start[0] || out.y[0] != start[1]) {
+    out.x.insert(out.x.begin(), start[0]);
+    out.y.insert(out.y.begin(), start[1]);
+  }
+  return true;
+}
+
+/* End of astarHierarchy.cpp */
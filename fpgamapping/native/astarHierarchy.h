@@ -0,0 +1,116 @@
+/*
+ * astarHierarchy.h
+ *
+ * HPA*-style hierarchical planner over the DEM post grid. The grid is cut
+ * into square clusters; every maximal open stretch of a cluster border
+ * gets one transition (two when it is 6 posts or longer), and each
+ * cluster links its border nodes with the exact in-cluster path costs.
+ * Edge legality is the traversability mask (bounds, obstacle cells and
+ * maxSlope), so the abstraction is built once per DEM, obstacle grid and
+ * maxSlope and then shared by every query.
+ *
+ * A query snaps the start and goal to their nearest posts, connects them
+ * to the border nodes of their clusters, runs A* on the small abstract
+ * graph and refines only the abstract edges on the result, one cluster at
+ * a time. Paths are near-optimal rather than optimal: they cross cluster
+ * borders only at transitions. When the abstract graph cannot connect the
+ * two posts (a start on an obstacle cell may be left by a one-way move
+ * that no transition records) the query falls back to A* over the whole
+ * post grid, so it fails only where astarSearch does.
+ *
+ */
+
+#pragma once
+
+/* Include files */
+#include "astarSearch.h"
+#include "astarTraversability.h"
+#include "demKernel.h"
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/* Type Definitions */
+/*  Cluster-local Dijkstra state, indexed by (i - i0) * csize + j - j0. One
+ *  per thread: queries only read the hierarchy itself. */
+struct AstarLocalScratch {
+  AstarLocalScratch() : seenGen(0), winI0(0), winJ0(0) {}
+
+  std::vector<double> dist;
+  std::vector<int32_t> prev;
+  std::vector<uint32_t> seen;
+  uint32_t seenGen;
+  int32_t winI0;
+  int32_t winJ0;
+  std::vector<std::pair<double, int32_t> > pq;
+};
+
+class AstarHierarchy {
+public:
+  AstarHierarchy();
+
+  bool build(const DemGrid &dem, const double bounds[4],
+             const AstarObstacles &obs, double maxSlope, int32_t clusterSize,
+             const char **err);
+
+  /*  out as astarSearch; nodesExpanded counts abstract and local pops */
+  bool search(const double start[2], const double goal[2],
+              int64_t maxExpansions, AstarArena &arena, AstarResult &out,
+              const char **err);
+
+  /*  Same, with caller-owned scratch; safe to run concurrently */
+  bool search(const double start[2], const double goal[2],
+              int64_t maxExpansions, AstarArena &arena,
+              AstarLocalScratch &local, AstarResult &out,
+              const char **err) const;
+
+  std::size_t numNodes() const
+  {
+    return nodeCell.size();
+  }
+
+  std::size_t numEdges() const
+  {
+    return edges.size();
+  }
+
+  int32_t clusterSize() const
+  {
+    return csize;
+  }
+
+private:
+  struct Edge {
+    int32_t to;
+    double cost;
+  };
+
+  int32_t clusterOf(int32_t cell) const;
+  int32_t nearestPost(const double pt[2]) const;
+  int64_t localSearch(AstarLocalScratch &s, int32_t src, int32_t cluster,
+                      bool reverse, int32_t target) const;
+  double localDist(const AstarLocalScratch &s, int32_t cell) const;
+  bool refine(AstarLocalScratch &s, const std::vector<int32_t> &cells,
+              int64_t &pops, AstarResult &out) const;
+  void gridSearch(int32_t src, int32_t dst, int64_t maxExpansions,
+                  AstarArena &a, int64_t &pops, AstarResult &out) const;
+
+  int32_t rows;
+  int32_t cols;
+  int32_t csize;          /* cluster edge, in posts */
+  int32_t cRows;          /* clusters along Y */
+  int32_t cCols;          /* clusters along X */
+  double xMin;
+  double yMin;
+  double res;
+  std::vector<uint8_t> mask;         /* traversability, column-major */
+  std::vector<int32_t> nodeCell;     /* post of each abstract node */
+  std::vector<int32_t> clusterFirst; /* nodes of cluster c: CSR */
+  std::vector<int32_t> clusterNodes;
+  std::vector<int32_t> edgeFirst;    /* out-edges of node u: CSR */
+  std::vector<Edge> edges;
+  AstarLocalScratch local; /* build and single-threaded queries */
+};
+
+/* End of astarHierarchy.h */
@@ -0,0 +1,464 @@
+/*
+ * astarIncremental.cpp
+ *
+ * D* Lite (Koenig & Likhachev, optimized version) over the post grid, see
+ * astarIncremental.h. Posts are column-major cells i * rows + j. A post
+ * whose traversability byte changes has its rhs re-derived from its
+ * successors, which covers every changed out-edge at once.
+ *
+ */
+
+/* Include files */
+#include "astarIncremental.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/* Variable Definitions */
+static const double astarInf = std::numeric_limits<double>::infinity();
+
+/* Function Declarations */
+static int32_t astarClampPost(double v, int32_t n);
+
+/* Function Definitions */
+static int32_t astarClampPost(double v, int32_t n)
+{
+  if (!(v > 0.0)) {
+    return 0; /* incl. NaN */
+  }
+  return v < (double)(n - 1) ? (int32_t)v : n - 1;
+}
+
+AstarIncremental::AstarIncremental()
+    : maxSlope(90.0), rows(0), cols(0), sStart(0), sLast(0), sGoal(0),
+      km(0.0), planned(false)
+{
+  step[0] = 1.0;
+  step[1] = std::sqrt(2.0);
+}
+
+int32_t AstarIncremental::nearestPost(const double pt[2]) const
+{
+  double i = std::round((pt[0] - dem.xMin) / dem.resolution);
+  double j = std::round((pt[1] - dem.yMin) / dem.resolution);
+  if (std::isnan(i) || std::isnan(j)) {
+    return 0;
+  }
+  i = std::min(std::max(i, 0.0), (double)(cols - 1));
+  j = std::min(std::max(j, 0.0), (double)(rows - 1));
+  return (int32_t)i * rows + (int32_t)j;
+}
+
+/*  Octile distance: exact for an open 8-connected grid, so consistent */
+double AstarIncremental::heuristic(int32_t a, int32_t b) const
+{
+  int32_t di = std::abs(a / rows - b / rows);
+  int32_t dj = std::abs(a % rows - b % rows);
+  return (double)std::abs(di - dj) * step[0] +
+         (double)std::min(di, dj) * step[1];
+}
+
+AstarIncremental::Key AstarIncremental::calcKey(int32_t s) const
+{
+  Key k;
+  k.k2 = std::min(g[s], rhs[s]);
+  k.k1 = k.k2 + heuristic(sStart, s) + km;
+  return k;
+}
+
+bool AstarIncremental::less(const Key &a, const Key &b) const
+{
+  return a.k1 < b.k1 || (a.k1 == b.k1 && a.k2 < b.k2);
+}
+
+/*
+ *  Termination test. Keys are sums of step costs and octile distances that
+ *  tie exactly in theory along straight stretches, so a post on the start's
+ *  own path can land an ulp above the start key and be left queued with a
+ *  stale g. The heap orders on exact k1 first, so near-ties are popped
+ *  whatever their k2; that costs a few extra pops and is always safe.
+ */
+bool AstarIncremental::keyBelowStart(const Key &k) const
+{
+  const Key ks = calcKey(sStart);
+  if (!(ks.k1 < astarInf)) {
+    return true;
+  }
+  return k.k1 <= ks.k1 + 1e-9 * (1.0 + std::fabs(ks.k1));
+}
+
+/*  min over legal moves u -> v of c(u, v) + g(v) */
+double AstarIncremental::minSucc(int32_t u) const
+{
+  const uint8_t bits = mask[u];
+  double best = astarInf;
+  double c;
+  int32_t d;
+  for (d = 0; d < 8; d++) {
+    if ((bits >> d) & 1u) {
+      c = step[d >= 4] +
+          g[u + astarMoveDirs[d][0] * rows + astarMoveDirs[d][1]];
+      if (c < best) {
+        best = c;
+      }
+    }
+  }
+  return best;
+}
+
+void AstarIncremental::updateVertex(int32_t u)
+{
+  if (g[u] != rhs[u]) {
+    heapSet(u, calcKey(u));
+  } else if (heapPos[u] >= 0) {
+    heapRemove(u);
+  }
+}
+
+void AstarIncremental::restart()
+{
+  const std::size_t n = (std::size_t)rows * cols;
+  g.assign(n, astarInf);
+  rhs.assign(n, astarInf);
+  key.resize(n);
+  heapPos.assign(n, -1);
+  heap.clear();
+  km = 0.0;
+  sLast = sStart;
+  rhs[sGoal] = 0.0;
+  heapSet(sGoal, calcKey(sGoal));
+}
+
+int64_t AstarIncremental::computeShortestPath()
+{
+  int64_t pops = 0;
+  int32_t u;
+  int32_t s;
+  int32_t d;
+  double gOld;
+  double c;
+  Key kOld;
+  Key kNew;
+  while (!heap.empty() &&
+         (keyBelowStart(key[heap[0]]) || rhs[sStart] > g[sStart])) {
+    u = heap[0];
+    kOld = key[u];
+    kNew = calcKey(u);
+    pops++;
+    if (less(kOld, kNew)) {
+      heapSet(u, kNew);
+    } else if (g[u] > rhs[u]) {
+      /*  Overconsistent: settle u and relax its predecessors */
+      g[u] = rhs[u];
+      heapRemove(u);
+      for (d = 0; d < 8; d++) {
+        s = u - astarMoveDirs[d][0] * rows - astarMoveDirs[d][1];
+        if (s == sGoal || s < 0 || s >= rows * cols ||
+            !((mask[s] >> d) & 1u)) {
+          continue;
+        }
+        c = step[d >= 4] + g[u];
+        if (c < rhs[s]) {
+          rhs[s] = c;
+          updateVertex(s);
+        }
+      }
+    } else {
+      /*  Underconsistent: u got dearer; predecessors that used it look
+       *  again */
+      gOld = g[u];
+      g[u] = astarInf;
+      for (d = 0; d < 8; d++) {
+        s = u - astarMoveDirs[d][0] * rows - astarMoveDirs[d][1];
+        if (s == sGoal || s < 0 || s >= rows * cols ||
+            !((mask[s] >> d) & 1u)) {
+          continue;
+        }
+        if (rhs[s] == step[d >= 4] + gOld) {
+          rhs[s] = minSucc(s);
+        }
+        updateVertex(s);
+      }
+      if (u != sGoal) {
+        rhs[u] = minSucc(u);
+      }
+      updateVertex(u);
+    }
+  }
+  return pops;
+}
+
+/*  Flip one obstacle cell and re-evaluate the posts whose edges changed */
+void AstarIncremental::applyChange(const AstarCellChange &c, int64_t &updated)
+{
+  const double res = dem.resolution;
+  const double xc = obs.x0 + (double)c.col * obs.res;
+  const double yc = obs.y0 + (double)c.row * obs.res;
+  std::vector<uint8_t> before;
+  int32_t i0;
+  int32_t i1;
+  int32_t j0;
+  int32_t j1;
+  int32_t i;
+  int32_t j;
+  int32_t u;
+  std::size_t w;
+
+  if (cells[(std::size_t)c.col * obs.rows + c.row] == (c.blocked != 0)) {
+    return;
+  }
+  cells[(std::size_t)c.col * obs.rows + c.row] = c.blocked != 0;
+
+  /*  Posts that snap to this cell (plus rounding slack), and their
+   *  neighbours, whose moves into them may have changed */
+  i0 = astarClampPost(
+      std::floor((xc - 0.5 * obs.res - dem.xMin) / res) - 2.0, cols);
+  i1 = astarClampPost(
+      std::ceil((xc + 0.5 * obs.res - dem.xMin) / res) + 2.0, cols);
+  j0 = astarClampPost(
+      std::floor((yc - 0.5 * obs.res - dem.yMin) / res) - 2.0, rows);
+  j1 = astarClampPost(
+      std::ceil((yc + 0.5 * obs.res - dem.yMin) / res) + 2.0, rows);
+  if (i0 > i1 || j0 > j1) {
+    return;
+  }
+
+  for (i = i0; i <= i1; i++) {
+    for (j = j0; j <= j1; j++) {
+      before.push_back(mask[i * rows + j]);
+    }
+  }
+  astarTraversabilityPatch(dem, bounds, obs, maxSlope, i0, i1, j0, j1,
+                           &mask[0]);
+  w = 0;
+  for (i = i0; i <= i1; i++) {
+    for (j = j0; j <= j1; j++) {
+      u = i * rows + j;
+      if (mask[u] != before[w++] && u != sGoal) {
+        rhs[u] = minSucc(u);
+        updateVertex(u);
+        updated++;
+      }
+    }
+  }
+}
+
+/*  Greedy descent of c + g from the start; empty when unreachable */
+bool AstarIncremental::extractPath(AstarResult &out) const
+{
+  const int64_t maxSteps = (int64_t)rows * cols;
+  int64_t steps = 0;
+  int32_t s = sStart;
+  int32_t v;
+  int32_t next;
+  int32_t d;
+  double best;
+  double c;
+  out.x.clear();
+  out.y.clear();
+  /*  The search may stop with the start still overconsistent, so its
+   *  distance is rhs, not g */
+  if (!(rhs[s] < astarInf)) {
+    return false;
+  }
+  out.x.push_back(dem.xMin + (double)(s / rows) * dem.resolution);
+  out.y.push_back(dem.yMin + (double)(s % rows) * dem.resolution);
+  while (s != sGoal) {
+    best = astarInf;
+    next = -1;
+    for (d = 0; d < 8; d++) {
+      if (!((mask[s] >> d) & 1u)) {
+        continue;
+      }
+      v = s + astarMoveDirs[d][0] * rows + astarMoveDirs[d][1];
+      c = step[d >= 4] + g[v];
+      if (c < best) {
+        best = c;
+        next = v;
+      }
+    }
+    if (next < 0 || ++steps > maxSteps) {
+      out.x.clear();
+      out.y.clear();
+      return false;
+    }
+    s = next;
+    out.x.push_back(dem.xMin + (double)(s / rows) * dem.resolution);
+    out.y.push_back(dem.yMin + (double)(s % rows) * dem.resolution);
+  }
+  return true;
+}
+
+bool AstarIncremental::init(const DemGrid &grid, const double box[4],
+                            const AstarObstacles &obstacles, double slope,
+                            const double goal[2], const char **err)
+{
+  std::size_t n;
+  if (grid.rows < 2 || grid.cols < 2 ||
+      (int64_t)grid.rows * grid.cols >= (int64_t)INT32_MAX) {
+    *err = "DEM grid size is not supported";
+    return false;
+  }
+  if (grid.rowOffset != NULL) {
+    *err = "the incremental planner needs a column-major DEM";
+    return false;
+  }
+  rows = grid.rows;
+  cols = grid.cols;
+  n = (std::size_t)rows * cols;
+  Z.assign(grid.Z, grid.Z + n);
+  dem = grid;
+  dem.Z = &Z[0];
+  obs = obstacles;
+  if (obstacles.cells != NULL) {
+    cells.assign(obstacles.cells,
+                 obstacles.cells + (std::size_t)obs.rows * obs.cols);
+    obs.cells = &cells[0];
+  }
+  std::copy(box, box + 4, bounds);
+  maxSlope = slope;
+  step[0] = dem.resolution;
+  step[1] = dem.resolution * std::sqrt(2.0);
+
+  mask.assign(n, 0);
+  if (!astarTraversabilityBuild(dem, bounds, obs, maxSlope, &mask[0], err)) {
+    return false;
+  }
+  sGoal = nearestPost(goal);
+  sStart = sGoal;
+  restart();
+  planned = false;
+  return true;
+}
+
+bool AstarIncremental::plan(const double start[2],
+                            const std::vector<AstarCellChange> &changes,
+                            AstarResult &out, int64_t &updated,
+                            const char **err)
+{
+  std::size_t k;
+  int32_t s;
+  updated = 0;
+  if (rows == 0) {
+    *err = "planner has not been initialised";
+    return false;
+  }
+  if (!changes.empty() && obs.cells == NULL) {
+    *err = "planner was created without an obstacle grid";
+    return false;
+  }
+  for (k = 0; k < changes.size(); k++) {
+    if (changes[k].row < 0 || changes[k].row >= obs.rows ||
+        changes[k].col < 0 || changes[k].col >= obs.cols) {
+      *err = "changed cell is outside the obstacle grid";
+      return false;
+    }
+  }
+
+  /*  The start moved: keys already queued stay lower bounds via km. The
+   *  first plan seeds the queue from its own start instead. */
+  s = nearestPost(start);
+  if (!planned) {
+    sStart = s;
+    restart();
+    planned = true;
+  } else if (s != sLast) {
+    km += heuristic(sLast, s);
+    sLast = s;
+  }
+  sStart = s;
+
+  for (k = 0; k < changes.size(); k++) {
+    applyChange(changes[k], updated);
+  }
+  out.nodesExpanded = computeShortestPath();
+  out.status = extractPath(out) ? astarFound : astarNoPath;
+
+  /*  Start from the query point itself when it is off the post grid */
+  if (out.status == astarFound &&
+      (out.x[0] != start[0] || out.y[0] != start[1])) {
+    out.x.insert(out.x.begin(), start[0]);
+    out.y.insert(out.y.begin(), start[1]);
+  }
+  return true;
+}
+
+int64_t AstarIncremental::fullReplanExpansions() const
+{
+  AstarIncremental fresh(*this);
+  fresh.dem.Z = &fresh.Z[0];
+  if (fresh.obs.cells != NULL) {
+    fresh.obs.cells = &fresh.cells[0];
+  }
+  fresh.restart();
+  return fresh.computeShortestPath();
+}
+
+void AstarIncremental::heapSet(int32_t s, const Key &k)
+{
+  std::size_t i;
+  key[s] = k;
+  if (heapPos[s] < 0) {
+    heapPos[s] = (int32_t)heap.size();
+    heap.push_back(s);
+    siftUp(heap.size() - 1);
+  } else {
+    i = (std::size_t)heapPos[s];
+    siftUp(i);
+    siftDown((std::size_t)heapPos[s]);
+  }
+}
+
+void AstarIncremental::heapRemove(int32_t s)
+{
+  std::size_t i = (std::size_t)heapPos[s];
+  int32_t last = heap.back();
+  heap.pop_back();
+  heapPos[s] = -1;
+  if (last == s) {
+    return;
+  }
+  heap[i] = last;
+  heapPos[last] = (int32_t)i;
+  siftUp(i);
+  siftDown((std::size_t)heapPos[last]);
+}
+
+void AstarIncremental::siftUp(std::size_t i)
+{
+  int32_t s = heap[i];
+  std::size_t parent;
+  while (i > 0) {
+    parent = (i - 1) / 2;
+    if (!less(key[s], key[heap[parent]])) {
+      break;
+    }
+    heap[i] = heap[parent];
+    heapPos[heap[i]] = (int32_t)i;
+    i = parent;
+  }
+  heap[i] = s;
+  heapPos[s] = (int32_t)i;
+}
+
+void AstarIncremental::siftDown(std::size_t i)
+{
+  const std::size_t n = heap.size();
+  int32_t s = heap[i];
+  std::size_t child;
+  while ((child = 2 * i + 1) < n) {
+    if (child + 1 < n && less(key[heap[child + 1]], key[heap[child]])) {
+      child++;
+    }
+    if (!less(key[heap[child]], key[s])) {
+      break;
+    }
+    heap[i] = heap[child];
+    heapPos[heap[i]] = (int32_t)i;
+    i = child;
+  }
+  heap[i] = s;
+  heapPos[s] = (int32_t)i;
+}
+
+/* End of astarIncremental.cpp */
@@ -0,0 +1,107 @@
+/*
+ * astarIncremental.h
+ *
+ * D* Lite over the DEM post grid for re-planning while the obstacle grid
+ * changes (no-fly zones added or lifted mid-mission). The search runs
+ * backwards from a fixed goal, so g(s) is the cost from s to the goal and
+ * stays valid as the start moves along the path. Between calls the
+ * planner keeps g, rhs and its priority queue; a change to obstacle
+ * cells re-derives only the traversability bytes around those cells,
+ * re-evaluates the posts whose edges changed and lets the next plan
+ * repair just the part of the search tree that depended on them.
+ *
+ * Edges are those of the traversability mask (bounds, obstacle cells,
+ * maxSlope), unit cost res straight and res * sqrt(2) diagonal, and the
+ * heuristic is the octile distance. Start and goal snap to their nearest
+ * posts, as for the HPA* planner. The planner owns copies of the
+ * elevations and obstacle cells, so MATLAB arrays may change or go away
+ * after init.
+ *
+ */
+
+#pragma once
+
+/* Include files */
+#include "astarSearch.h"
+#include "astarTraversability.h"
+#include "demKernel.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Type Definitions */
+/*  One changed obstacle cell, 0-based in obstacles.grid */
+struct AstarCellChange {
+  int32_t row;
+  int32_t col;
+  uint8_t blocked;
+};
+
+class AstarIncremental {
+public:
+  AstarIncremental();
+
+  bool init(const DemGrid &dem, const double bounds[4],
+            const AstarObstacles &obs, double maxSlope, const double goal[2],
+            const char **err);
+
+  /*
+   * Move the start, apply obstacle changes and repair the search. out is
+   * the post path from start to goal (status 0) or empty (status 2);
+   * nodesExpanded counts the queue pops of this repair and updated the
+   * posts re-evaluated because one of their edges changed.
+   */
+  bool plan(const double start[2], const std::vector<AstarCellChange> &changes,
+            AstarResult &out, int64_t &updated, const char **err);
+
+  /*  Pops a from-scratch search would need for the current start and grid */
+  int64_t fullReplanExpansions() const;
+
+private:
+  struct Key {
+    double k1;
+    double k2;
+  };
+
+  int32_t nearestPost(const double pt[2]) const;
+  double heuristic(int32_t a, int32_t b) const;
+  Key calcKey(int32_t s) const;
+  bool less(const Key &a, const Key &b) const;
+  bool keyBelowStart(const Key &k) const;
+  double minSucc(int32_t u) const;
+  void updateVertex(int32_t u);
+  void restart();
+  int64_t computeShortestPath();
+  void applyChange(const AstarCellChange &c, int64_t &updated);
+  bool extractPath(AstarResult &out) const;
+
+  /*  Indexed binary heap on Key */
+  void heapSet(int32_t s, const Key &k);
+  void heapRemove(int32_t s);
+  void siftUp(std::size_t i);
+  void siftDown(std::size_t i);
+
+  std::vector<double> Z;        /* own copy of demData.Z */
+  std::vector<uint8_t> cells;   /* own copy of obstacles.grid */
+  DemGrid dem;
+  AstarObstacles obs;
+  double bounds[4];
+  double maxSlope;
+  double step[2];               /* straight, diagonal */
+  int32_t rows;
+  int32_t cols;
+
+  std::vector<uint8_t> mask;    /* traversability, column-major */
+  std::vector<double> g;
+  std::vector<double> rhs;
+  std::vector<Key> key;         /* valid while the post is queued */
+  std::vector<int32_t> heapPos; /* -1 when not queued */
+  std::vector<int32_t> heap;
+  int32_t sStart;
+  int32_t sLast;
+  int32_t sGoal;
+  double km;
+  bool planned;                 /* false until the first plan */
+};
+
+/* End of astarIncremental.h */
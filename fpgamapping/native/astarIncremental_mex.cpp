@@ -0,0 +1,199 @@
+/*
+ * astarIncremental_mex.cpp
+ *
+ * MEX gateway for the D* Lite planner of astarIncremental.h (see
+ * astarIncremental.m, astarIncrementalPlan.m, astarIncrementalFree.m):
+ *
+ *   h = astarIncremental_mex('create', demData, obstacles, maxSlope, goal)
+ *   [xy, nodesExpanded, status, nodesUpdated, fullExpansions] =
+ *       astarIncremental_mex('plan', h, start, changes)
+ *   astarIncremental_mex('free', h)
+ *
+ * changes is K x 3 [row, col, blocked] with 1-based obstacles.grid
+ * indices and blocked 0 or 1 (empty when only the start moved). xy is the
+ * N x 2 path from start to the goal post, status 0 (found) or 2 (no path,
+ * xy empty). nodesExpanded counts the queue pops of this repair and
+ * nodesUpdated the posts whose edges the changes touched; fullExpansions,
+ * only computed when requested, is what a from-scratch search over the
+ * current grid would pop.
+ *
+ * Handles are uint64 ids into a table owned by this MEX file. The MEX is
+ * locked while any planner is alive; the rest are released at MATLAB exit.
+ *
+ */
+
+/* Include files */
+#include "astarIncremental.h"
+#include "mexUtil.h"
+#include <cmath>
+#include <cstring>
+#include <map>
+
+/* Variable Definitions */
+static std::map<uint64_t, AstarIncremental *> incTable;
+static uint64_t incNextId = 1;
+static const char *incErrId = "astarIncremental:InvalidInput";
+
+/* Function Declarations */
+static void incFreeAll(void);
+static AstarIncremental *incLookup(const mxArray *h);
+static void incChanges(const mxArray *a, std::vector<AstarCellChange> &out);
+
+/* Function Definitions */
+static void incFreeAll(void)
+{
+  std::map<uint64_t, AstarIncremental *>::iterator it;
+  for (it = incTable.begin(); it != incTable.end(); ++it) {
+    delete it->second;
+  }
+  incTable.clear();
+}
+
+static AstarIncremental *incLookup(const mxArray *h)
+{
+  std::map<uint64_t, AstarIncremental *>::iterator it;
+  if (!mxIsUint64(h) || mxGetNumberOfElements(h) != 1) {
+    mexErrMsgIdAndTxt(incErrId, "Planner handle must be a uint64 scalar");
+  }
+  it = incTable.find(*mxGetUint64s(h));
+  if (it == incTable.end()) {
+    mexErrMsgIdAndTxt("astarIncremental:InvalidHandle",
+                      "Planner handle is not alive (already freed?)");
+  }
+  return it->second;
+}
+
+/*  K x 3 [row, col, blocked], 1-based, to 0-based cell changes */
+static void incChanges(const mxArray *a, std::vector<AstarCellChange> &out)
+{
+  const double *v;
+  std::size_t n;
+  std::size_t k;
+  out.clear();
+  if (mxIsEmpty(a)) {
+    return;
+  }
+  v = mexDoubleArray(a, "changes", incErrId);
+  n = mxGetM(a);
+  if (mxGetN(a) != 3) {
+    mexErrMsgIdAndTxt(incErrId, "changes must be K x 3 [row, col, blocked]");
+  }
+  out.resize(n);
+  for (k = 0; k < n; k++) {
+    if (!(v[k] >= 1.0 && v[k] <= (double)INT32_MAX) ||
+        !(v[n + k] >= 1.0 && v[n + k] <= (double)INT32_MAX) ||
+        v[k] != std::floor(v[k]) || v[n + k] != std::floor(v[n + k])) {
+      mexErrMsgIdAndTxt(incErrId, "changes rows and cols must be positive "
+                                  "integers");
+    }
+    out[k].row = (int32_t)v[k] - 1;
+    out[k].col = (int32_t)v[n + k] - 1;
+    out[k].blocked = v[2 * n + k] > 0;
+  }
+}
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  std::map<uint64_t, AstarIncremental *>::iterator it;
+  std::vector<AstarCellChange> changes;
+  std::vector<uint8_t> cells;
+  AstarIncremental *planner;
+  AstarObstacles obs;
+  AstarResult out;
+  DemGrid dem;
+  double bounds[4];
+  double *xy;
+  const double *v;
+  const char *err = "";
+  int64_t updated;
+  std::size_t n;
+  std::size_t k;
+  char cmd[7];
+  mexAtExit(&incFreeAll);
+  if (nrhs < 1 || !mxIsChar(prhs[0]) ||
+      mxGetString(prhs[0], cmd, sizeof(cmd)) != 0) {
+    cmd[0] = '\0';
+  }
+
+  if (std::strcmp(cmd, "create") == 0) {
+    if (nrhs != 5 || nlhs > 1) {
+      mexErrMsgIdAndTxt(incErrId, "Usage: h = astarIncremental_mex('create',"
+                                  " demData, obstacles, maxSlope, goal)");
+    }
+    dem = mexDemGridFromStruct(prhs[1], incErrId);
+    bounds[0] = mexScalarField(prhs[1], "xMin", incErrId);
+    bounds[1] = mexScalarField(prhs[1], "xMax", incErrId);
+    bounds[2] = mexScalarField(prhs[1], "yMin", incErrId);
+    bounds[3] = mexScalarField(prhs[1], "yMax", incErrId);
+    obs = mexAstarObstacles(prhs[2], cells, incErrId);
+    v = mexDoubleArray(prhs[4], "goal", incErrId);
+    if (mxGetNumberOfElements(prhs[4]) < 2) {
+      mexErrMsgIdAndTxt(incErrId, "goal must have at least [X, Y]");
+    }
+    planner = new AstarIncremental();
+    if (!planner->init(dem, bounds, obs, mxGetScalar(prhs[3]), v, &err)) {
+      delete planner;
+      mexErrMsgIdAndTxt(incErrId, "%s", err);
+    }
+    incTable[incNextId] = planner;
+    mexLock();
+    plhs[0] = mxCreateNumericMatrix(1, 1, mxUINT64_CLASS, mxREAL);
+    *mxGetUint64s(plhs[0]) = incNextId++;
+
+  } else if (std::strcmp(cmd, "plan") == 0) {
+    if (nrhs != 4 || nlhs > 5) {
+      mexErrMsgIdAndTxt(incErrId, "Usage: [xy, nodesExpanded, status, "
+                                  "nodesUpdated, fullExpansions] = "
+                                  "astarIncremental_mex('plan', h, start, "
+                                  "changes)");
+    }
+    planner = incLookup(prhs[1]);
+    v = mexDoubleArray(prhs[2], "start", incErrId);
+    if (mxGetNumberOfElements(prhs[2]) < 2) {
+      mexErrMsgIdAndTxt(incErrId, "start must have at least [X, Y]");
+    }
+    incChanges(prhs[3], changes);
+    if (!planner->plan(v, changes, out, updated, &err)) {
+      mexErrMsgIdAndTxt(incErrId, "%s", err);
+    }
+
+    n = out.x.size();
+    plhs[0] = mxCreateDoubleMatrix(n, 2, mxREAL);
+    xy = mxGetDoubles(plhs[0]);
+    for (k = 0; k < n; k++) {
+      xy[k] = out.x[k];
+      xy[n + k] = out.y[k];
+    }
+    if (nlhs > 1) {
+      plhs[1] = mxCreateDoubleScalar((double)out.nodesExpanded);
+    }
+    if (nlhs > 2) {
+      plhs[2] = mxCreateDoubleScalar((double)out.status);
+    }
+    if (nlhs > 3) {
+      plhs[3] = mxCreateDoubleScalar((double)updated);
+    }
+    if (nlhs > 4) {
+      plhs[4] = mxCreateDoubleScalar((double)planner->fullReplanExpansions());
+    }
+
+  } else if (std::strcmp(cmd, "free") == 0) {
+    if (nrhs != 2) {
+      mexErrMsgIdAndTxt(incErrId, "Usage: astarIncremental_mex('free', h)");
+    }
+    /*  Freeing an unknown or already freed handle is a no-op */
+    if (mxIsUint64(prhs[1]) && mxGetNumberOfElements(prhs[1]) == 1) {
+      it = incTable.find(*mxGetUint64s(prhs[1]));
+      if (it != incTable.end()) {
+        delete it->second;
+        incTable.erase(it);
+        mexUnlock();
+      }
+    }
+
+  } else {
+    mexErrMsgIdAndTxt(incErrId, "Command must be 'create', 'plan' or 'free'");
+  }
+}
+
+/* End of astarIncremental_mex.cpp */
@@ -0,0 +1,142 @@
+/*
+ * astarLandmarks.cpp
+ *
+ * Landmark selection and distance tables (see astarLandmarks.h).
+ *
+ */
+
+/* Include files */
+#include "astarLandmarks.h"
+#include "astarDistance.h"
+#include <algorithm>
+#include <limits>
+
+/* Function Declarations */
+static int32_t astarLandmarkSeed(const uint8_t *mask, int32_t rows,
+                                 int32_t cols);
+
+/* Function Definitions */
+/*
+ * Post closest to the grid centre within the largest region connected by
+ * the moves of mask, or -1 when no post has a legal move. Landmarks only
+ * help queries inside the region they are placed in.
+ */
+static int32_t astarLandmarkSeed(const uint8_t *mask, int32_t rows,
+                                 int32_t cols)
+{
+  const std::size_t n = (std::size_t)rows * cols;
+  std::vector<uint8_t> seen(n, 0);
+  std::vector<int32_t> stack;
+  std::size_t size;
+  std::size_t bestSize = 0;
+  int32_t seed = -1;
+  int32_t near;
+  int32_t u;
+  int32_t v;
+  int32_t s;
+  int32_t dir;
+  double r;
+  double rNear;
+
+  for (s = 0; s < (int32_t)n; s++) {
+    if (seen[s] || mask[s] == 0) {
+      continue;
+    }
+    size = 0;
+    near = s;
+    rNear = std::numeric_limits<double>::infinity();
+    seen[s] = 1;
+    stack.push_back(s);
+    while (!stack.empty()) {
+      u = stack.back();
+      stack.pop_back();
+      size++;
+      r = std::hypot(u / rows - 0.5 * (cols - 1),
+                     u % rows - 0.5 * (rows - 1));
+      if (r < rNear) {
+        rNear = r;
+        near = u;
+      }
+      for (dir = 0; dir < 8; dir++) {
+        if (!((mask[u] >> dir) & 1u)) {
+          continue;
+        }
+        v = u + astarMoveDirs[dir][0] * rows + astarMoveDirs[dir][1];
+        if (!seen[v]) {
+          seen[v] = 1;
+          stack.push_back(v);
+        }
+      }
+    }
+    if (size > bestSize) {
+      bestSize = size;
+      seed = near;
+    }
+  }
+  return seed;
+}
+
+bool astarLandmarksBuild(const uint8_t *mask, int32_t rows, int32_t cols,
+                         double res, int32_t count, std::vector<float> &dist,
+                         std::vector<int32_t> &posts, const char **err)
+{
+  const double inf = std::numeric_limits<double>::infinity();
+  const std::size_t n = (std::size_t)rows * cols;
+  std::vector<double> field;
+  std::vector<double> nearest; /* distance to the closest landmark so far */
+  std::size_t u;
+  std::size_t far;
+  int32_t seed;
+  int32_t k;
+  double best;
+
+  dist.clear();
+  posts.clear();
+  if (rows < 2 || cols < 2 || (int64_t)rows * cols >= (int64_t)INT32_MAX) {
+    *err = "DEM grid size is not supported";
+    return false;
+  }
+  if (!(res > 0.0)) {
+    *err = "DEM resolution must be positive";
+    return false;
+  }
+  if (count < 1 || count > 64) {
+    *err = "landmark count must be in 1..64";
+    return false;
+  }
+
+  seed = astarLandmarkSeed(mask, rows, cols);
+  if (seed < 0) {
+    *err = "no post has a legal move, so no landmark can be placed";
+    return false;
+  }
+  astarDistanceField(mask, rows, cols, res, seed, nearest);
+
+  /*  Farthest-point selection over the seed's region */
+  for (k = 0; k < count; k++) {
+    far = n;
+    best = 0.0;
+    for (u = 0; u < n; u++) {
+      if (nearest[u] < inf && nearest[u] > best) {
+        best = nearest[u];
+        far = u;
+      }
+    }
+    if (far == n) {
+      break; /* every reachable post is already a landmark */
+    }
+    astarDistanceField(mask, rows, cols, res, (int32_t)far, field);
+    if (k == 0) {
+      nearest = field; /* the seed itself is no landmark */
+    } else {
+      for (u = 0; u < n; u++) {
+        nearest[u] = std::min(nearest[u], field[u]);
+      }
+    }
+    posts.push_back((int32_t)far);
+    dist.insert(dist.end(), field.begin(), field.end());
+  }
+  return true;
+}
+
+/* End of astarLandmarks.cpp */
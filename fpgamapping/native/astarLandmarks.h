@@ -0,0 +1,101 @@
+/*
+ * astarLandmarks.h
+ *
+ * ALT lower bounds (A*, landmarks, triangle inequality) for repeated
+ * queries on one DEM, obstacle grid and maxSlope. A few landmark posts
+ * are picked far apart (farthest-point selection: each new landmark is
+ * the reachable post farthest from all earlier ones) and a full distance
+ * field over the traversability mask is stored for each, as float.
+ *
+ * A post is enterable when it lies inside the bounds and off the obstacle
+ * cells. A move between two enterable posts is legal both ways (the slope
+ * test is symmetric), so for enterable posts n and t that a landmark L
+ * reaches, d(n, t) >= |D_L(t) - D_L(n)|. The bound is the largest of
+ * these over the landmarks, and over several goal posts the smallest. It
+ * never exceeds the true lattice cost, which on terrain with large
+ * blocked regions is far above the straight-line distance, so A* opens a
+ * fraction of the nodes. A landmark that reaches only one of n and t
+ * proves them disconnected, and the bound is then Inf; posts it reaches
+ * neither of add nothing.
+ *
+ * Moves out of a blocked post are legal but moves into it are not, so the
+ * tables, which hold distances from each landmark, say nothing about a
+ * blocked start: callers must bound only enterable posts and fall back to
+ * the plain heuristic elsewhere.
+ *
+ */
+
+#pragma once
+
+/* Include files */
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/* Type Definitions */
+/*  View of a landmark table: count pages of rows x cols DEM posts */
+struct AstarLandmarks {
+  const float *dist; /* page k = distances from landmark k, Inf unreached */
+  int32_t count;
+};
+
+/* Function Declarations */
+/*
+ * Pick up to count landmarks on mask and fill their distance pages; posts
+ * gets their 0-based post indices. Fewer are returned when the reachable
+ * region runs out of distinct posts.
+ */
+bool astarLandmarksBuild(const uint8_t *mask, int32_t rows, int32_t cols,
+                         double res, int32_t count, std::vector<float> &dist,
+                         std::vector<int32_t> &posts, const char **err);
+
+/* Function Definitions */
+/*
+ *  ALT bound from post u to the nearest of nTargets goal posts, Inf when
+ *  none is connected to u. The float tables round to 2^-24, so each
+ *  difference gives up 2^-23 of its terms to stay a lower bound.
+ */
+static inline double astarLandmarkBound(const AstarLandmarks &lm,
+                                        std::size_t nPosts, std::size_t u,
+                                        const std::size_t *targets,
+                                        int32_t nTargets)
+{
+  const double inf = std::numeric_limits<double>::infinity();
+  const float *page;
+  double best = inf;
+  double h;
+  double du;
+  double dt;
+  double b;
+  int32_t t;
+  int32_t k;
+  if (nTargets < 1) {
+    return 0.0;
+  }
+  for (t = 0; t < nTargets; t++) {
+    h = 0.0;
+    for (k = 0, page = lm.dist; k < lm.count; k++, page += nPosts) {
+      du = page[u];
+      dt = page[targets[t]];
+      if (!(du < inf && dt < inf)) {
+        if ((du < inf) != (dt < inf)) {
+          h = inf;
+          break;
+        }
+        continue;
+      }
+      b = std::fabs(dt - du) - 1.2e-7 * (du + dt);
+      if (b > h) {
+        h = b;
+      }
+    }
+    if (h < best) {
+      best = h;
+    }
+  }
+  return best;
+}
+
+/* End of astarLandmarks.h */
@@ -0,0 +1,625 @@
+/*
+ * astarPathfinding_mex.cpp
+ *
+ * MEX gateway: [xy, nodesExpanded, status, anytime] =
+ *                  astarPathfinding_mex(start, goal, demData, obstacles,
+ *                  maxSlope, maxExpansions, mode, heuristic, schedule)
+ *
+ *   [paths, nodesExpanded, status, cached] = astarPathfinding_mex('batch',
+ *       starts, goals, demData, obstacles, maxSlope, maxExpansions, mode,
+ *       nThreads, heuristic)                many legs on a thread pool
+ *   astarPathfinding_mex('clearcache')      drop memoized batch results
+ *   [I, J, C, settled] = astarPathfinding_mex('knn', points, demData,
+ *       obstacles, maxSlope, k, radius, nThreads)
+ *                                           terrain k-nearest cost matrix
+ *   [dist, posts] = astarPathfinding_mex('landmarks', demData, obstacles,
+ *                                        maxSlope, count)   ALT tables
+ *   key = astarPathfinding_mex('fingerprint', demData, obstacles,
+ *                              maxSlope)    uint64 hash the tables depend on
+ *   h = astarPathfinding_mex('hierarchy', demData, obstacles, maxSlope,
+ *                            clusterSize)   build an HPA* abstraction
+ *   astarPathfinding_mex('free', h)         release it
+ *
+ * mode is 'astar' (default: the indexed-heap A* of astarSearch.cpp),
+ * 'jps' (Jump Point Search, occupancy only) or 'hpa' (the abstraction
+ * obstacles.hierarchy of astarHierarchy.cpp, see astarHierarchy.m) or
+ * 'ara' (anytime ARA*, single queries only). schedule is [weight,
+ * weightStep, budgetUs] for 'ara' (default [3, 0.5, Inf]), and anytime
+ * reports its iterations, weight, bound, cost, elapsedUs and history
+ * (one [elapsedUs, g, bound] row per improved path).
+ * obstacles is [] or the obstacleGrid struct (grid, resolution, bounds),
+ * optionally carrying the traversability mask of astarTraversability.m.
+ * heuristic is 'euclidean' (default), 'manhattan', 'diagonal' or 'alt';
+ * 'alt' is Euclidean raised by the landmark tables in obstacles.landmarks
+ * (astarLandmarks.m) and applies to plain A* only.
+ * xy is the N x 2 lattice path from start to goal; status is 0 when the
+ * goal was reached, 1 when maxExpansions was hit (xy ends at the closed
+ * node with the lowest f) and 2 when the open list ran dry (xy is empty).
+ *
+ * 'batch' takes N x 2 starts and goals and returns N x 1 cells of xy and
+ * N x 1 nodesExpanded / status / cached, where cached is true for legs
+ * answered from the memo of astarBatch.h. The memo lives as long as this
+ * MEX file and is keyed by a hash of the terrain, obstacle grid, maxSlope
+ * and mask, so a changed grid never returns a stale detour.
+ *
+ * 'knn' grows a bounded Dijkstra field from each of the N x 2 points
+ * (astarDistance.h) and returns, per point, its up to k nearest others
+ * within radius as 1-based I (source), J (target) and lattice cost C,
+ * sorted by source and then cost; settled counts the posts visited.
+ *
+ * The search arena is static, so repeated queries (mission legs, Stage 6
+ * replanning) reuse its memory instead of reallocating per call.
+ * Hierarchies are uint64 ids into a table owned by this MEX file, which
+ * stays locked while any is alive; the rest are released at MATLAB exit.
+ *
+ */
+
+/* Include files */
+#include "astarBatch.h"
+#include "astarDistance.h"
+#include "astarHierarchy.h"
+#include "astarSearch.h"
+#include "mexUtil.h"
+#include <cstring>
+#include <limits>
+#include <map>
+
+/* Variable Definitions */
+static AstarArena astarArena;
+static AstarMemo astarMemo(1 << 16);
+static std::vector<uint8_t> astarObstacleCells;
+static std::map<uint64_t, AstarHierarchy *> astarHierarchies;
+static uint64_t astarNextId = 1;
+static const char *errId = "astarPathfinding:InvalidInput";
+
+/* Function Declarations */
+static void astarFreeAll(void);
+static AstarHierarchy *astarLookup(const mxArray *h);
+static AstarMode astarModeArg(const mxArray *a);
+static void astarProblemArgs(const mxArray *const args[4],
+                             const mxArray *heuristic, AstarProblem &p,
+                             AstarLandmarks &lm);
+static mxArray *astarXyArray(const AstarResult &out);
+static mxArray *astarAnytimeArray(const AstarAnytimeStats &stats);
+static void astarBatchCommand(int nlhs, mxArray *plhs[], int nrhs,
+                              const mxArray *prhs[]);
+static void astarKnnCommand(int nlhs, mxArray *plhs[], int nrhs,
+                            const mxArray *prhs[]);
+static void astarLandmarkCommand(const char *cmd, int nlhs, mxArray *plhs[],
+                                 int nrhs, const mxArray *prhs[]);
+static void astarCommand(int nlhs, mxArray *plhs[], int nrhs,
+                         const mxArray *prhs[]);
+
+/* Function Definitions */
+static void astarFreeAll(void)
+{
+  std::map<uint64_t, AstarHierarchy *>::iterator it;
+  for (it = astarHierarchies.begin(); it != astarHierarchies.end(); ++it) {
+    delete it->second;
+  }
+  astarHierarchies.clear();
+  astarMemo.clear();
+}
+
+static AstarHierarchy *astarLookup(const mxArray *h)
+{
+  std::map<uint64_t, AstarHierarchy *>::iterator it;
+  if (h == NULL || !mxIsUint64(h) || mxGetNumberOfElements(h) != 1) {
+    mexErrMsgIdAndTxt(errId, "mode 'hpa' needs obstacles.hierarchy, a "
+                             "uint64 handle from astarHierarchy");
+  }
+  it = astarHierarchies.find(*mxGetUint64s(h));
+  if (it == astarHierarchies.end()) {
+    mexErrMsgIdAndTxt("astarPathfinding:InvalidHandle",
+                      "Hierarchy handle is not built (already freed?)");
+  }
+  return it->second;
+}
+
+static AstarMode astarModeArg(const mxArray *a)
+{
+  char mode[6];
+  if (!mxIsChar(a) || mxGetString(a, mode, sizeof(mode)) != 0) {
+    mode[0] = '\0';
+  }
+  if (std::strcmp(mode, "astar") == 0) {
+    return astarModePlain;
+  }
+  if (std::strcmp(mode, "jps") == 0) {
+    return astarModeJump;
+  }
+  if (std::strcmp(mode, "hpa") == 0) {
+    return astarModeHierarchy;
+  }
+  if (std::strcmp(mode, "ara") == 0) {
+    return astarModeAnytime;
+  }
+  mexErrMsgIdAndTxt(errId, "mode must be 'astar', 'jps', 'hpa' or 'ara'");
+  return astarModePlain;
+}
+
+/*
+ * demData, obstacles, maxSlope, maxExpansions and the heuristic name (NULL
+ * for the default); start / goal are not set. lm backs p.landmarks.
+ */
+static void astarProblemArgs(const mxArray *const args[4],
+                             const mxArray *heuristic, AstarProblem &p,
+                             AstarLandmarks &lm)
+{
+  char name[10];
+  double limit;
+  if (heuristic == NULL) {
+    std::strcpy(name, "euclidean");
+  } else if (!mxIsChar(heuristic) ||
+             mxGetString(heuristic, name, sizeof(name)) != 0) {
+    name[0] = '\0';
+  }
+  p.dem = mexDemGridFromStruct(args[0], errId);
+  p.resolution = p.dem.resolution;
+  p.bounds[0] = mexScalarField(args[0], "xMin", errId);
+  p.bounds[1] = mexScalarField(args[0], "xMax", errId);
+  p.bounds[2] = mexScalarField(args[0], "yMin", errId);
+  p.bounds[3] = mexScalarField(args[0], "yMax", errId);
+
+  p.obs = mexAstarObstacles(args[1], astarObstacleCells, errId);
+  p.mask = mexTraversability(args[1], p.dem, errId);
+
+  p.maxSlope = mxGetScalar(args[2]);
+  limit = mxGetScalar(args[3]);
+  if (!(limit >= 0.0)) {
+    mexErrMsgIdAndTxt(errId, "maxExpansions must be a non-negative number "
+                             "or Inf");
+  }
+  p.maxExpansions = limit >= 9.2e18 ? INT64_MAX : (int64_t)limit;
+
+  p.heuristic = astarHeuristicEuclidean;
+  p.landmarks = NULL;
+  if (std::strcmp(name, "manhattan") == 0) {
+    p.heuristic = astarHeuristicManhattan;
+  } else if (std::strcmp(name, "diagonal") == 0) {
+    p.heuristic = astarHeuristicDiagonal;
+  } else if (std::strcmp(name, "alt") == 0) {
+    if (!mexAstarLandmarks(mxIsStruct(args[1])
+                               ? mxGetField(args[1], 0, "landmarks")
+                               : NULL,
+                           p.dem, lm, errId)) {
+      mexErrMsgIdAndTxt(errId, "heuristic 'alt' needs obstacles.landmarks "
+                               "from astarLandmarks");
+    }
+    p.landmarks = &lm;
+  } else if (std::strcmp(name, "euclidean") != 0) {
+    mexErrMsgIdAndTxt(errId, "heuristic must be 'euclidean', 'manhattan', "
+                             "'diagonal' or 'alt'");
+  }
+}
+
+static mxArray *astarXyArray(const AstarResult &out)
+{
+  const std::size_t n = out.x.size();
+  mxArray *a = mxCreateDoubleMatrix(n, 2, mxREAL);
+  double *xy = mxGetDoubles(a);
+  std::size_t k;
+  for (k = 0; k < n; k++) {
+    xy[k] = out.x[k];
+    xy[n + k] = out.y[k];
+  }
+  return a;
+}
+
+/*  anytime output struct; history is one [elapsedUs, g, bound] row each */
+static mxArray *astarAnytimeArray(const AstarAnytimeStats &stats)
+{
+  static const char *fields[] = {"iterations", "weight",    "bound",
+                                 "cost",       "elapsedUs", "history"};
+  const std::size_t n = stats.history.size() / 3;
+  mxArray *s = mxCreateStructMatrix(1, 1, 6, fields);
+  mxArray *h = mxCreateDoubleMatrix(n, 3, mxREAL);
+  double *v = mxGetDoubles(h);
+  std::size_t k;
+  for (k = 0; k < n; k++) {
+    v[k] = stats.history[3 * k];
+    v[n + k] = stats.history[3 * k + 1];
+    v[2 * n + k] = stats.history[3 * k + 2];
+  }
+  mxSetField(s, 0, "iterations", mxCreateDoubleScalar(stats.iterations));
+  mxSetField(s, 0, "weight", mxCreateDoubleScalar(stats.weight));
+  mxSetField(s, 0, "bound", mxCreateDoubleScalar(stats.bound));
+  mxSetField(s, 0, "cost", mxCreateDoubleScalar(stats.cost));
+  mxSetField(s, 0, "elapsedUs", mxCreateDoubleScalar(stats.elapsedUs));
+  mxSetField(s, 0, "history", h);
+  return s;
+}
+
+static void astarBatchCommand(int nlhs, mxArray *plhs[], int nrhs,
+                              const mxArray *prhs[])
+{
+  std::vector<AstarQuery> queries;
+  std::vector<AstarResult> results;
+  std::vector<uint8_t> cached;
+  AstarProblem p;
+  AstarLandmarks lm;
+  AstarBatch batch;
+  const double *s;
+  const double *g;
+  const char *err = "";
+  double *expanded;
+  double *status;
+  mxLogical *hit;
+  std::size_t n;
+  std::size_t k;
+  if (nrhs != 9 && nrhs != 10) {
+    mexErrMsgIdAndTxt(errId, "Usage: [paths, nodesExpanded, status, cached]"
+                             " = astarPathfinding_mex('batch', starts, "
+                             "goals, demData, obstacles, maxSlope, "
+                             "maxExpansions, mode, nThreads, heuristic)");
+  }
+  if (nlhs > 4) {
+    mexErrMsgIdAndTxt(errId, "Too many output arguments");
+  }
+  s = mexDoubleArray(prhs[1], "starts", errId);
+  g = mexDoubleArray(prhs[2], "goals", errId);
+  n = mxGetM(prhs[1]);
+  if (mxGetN(prhs[1]) != 2 || mxGetN(prhs[2]) != 2 ||
+      mxGetM(prhs[2]) != n) {
+    mexErrMsgIdAndTxt(errId, "starts and goals must both be N x 2");
+  }
+  queries.resize(n);
+  for (k = 0; k < n; k++) {
+    queries[k].start[0] = s[k];
+    queries[k].start[1] = s[n + k];
+    queries[k].goal[0] = g[k];
+    queries[k].goal[1] = g[n + k];
+  }
+
+  astarProblemArgs(&prhs[3], nrhs == 10 ? prhs[9] : NULL, p, lm);
+  batch.problem = &p;
+  batch.mode = astarModeArg(prhs[7]);
+  if (batch.mode == astarModeAnytime) {
+    mexErrMsgIdAndTxt(errId, "mode 'ara' runs single queries only");
+  }
+  batch.hierarchy = NULL;
+  if (batch.mode == astarModeHierarchy) {
+    batch.hierarchy = astarLookup(mxIsStruct(prhs[4])
+                                      ? mxGetField(prhs[4], 0, "hierarchy")
+                                      : NULL);
+  }
+  batch.version = astarProblemVersion(p, batch.mode, batch.hierarchy);
+
+  if (!astarBatchSearch(batch, queries, (int)mxGetScalar(prhs[8]),
+                        &astarMemo, results, cached, &err)) {
+    mexErrMsgIdAndTxt(errId, "%s", err);
+  }
+
+  plhs[0] = mxCreateCellMatrix(n, 1);
+  for (k = 0; k < n; k++) {
+    mxSetCell(plhs[0], k, astarXyArray(results[k]));
+  }
+  if (nlhs > 1) {
+    plhs[1] = mxCreateDoubleMatrix(n, 1, mxREAL);
+    expanded = mxGetDoubles(plhs[1]);
+    for (k = 0; k < n; k++) {
+      expanded[k] = (double)results[k].nodesExpanded;
+    }
+  }
+  if (nlhs > 2) {
+    plhs[2] = mxCreateDoubleMatrix(n, 1, mxREAL);
+    status = mxGetDoubles(plhs[2]);
+    for (k = 0; k < n; k++) {
+      status[k] = (double)results[k].status;
+    }
+  }
+  if (nlhs > 3) {
+    plhs[3] = mxCreateLogicalMatrix(n, 1);
+    hit = mxGetLogicals(plhs[3]);
+    for (k = 0; k < n; k++) {
+      hit[k] = cached[k] != 0;
+    }
+  }
+}
+
+static void astarKnnCommand(int nlhs, mxArray *plhs[], int nrhs,
+                            const mxArray *prhs[])
+{
+  std::vector<AstarKnnEdge> edges;
+  AstarKnnQuery q;
+  const double *pts;
+  const char *err = "";
+  double *I;
+  double *J;
+  double *C;
+  double k;
+  int64_t settled;
+  std::size_t e;
+  if (nrhs != 8) {
+    mexErrMsgIdAndTxt(errId, "Usage: [I, J, C, settled] = "
+                             "astarPathfinding_mex('knn', points, demData, "
+                             "obstacles, maxSlope, k, radius, nThreads)");
+  }
+  if (nlhs > 4) {
+    mexErrMsgIdAndTxt(errId, "Too many output arguments");
+  }
+  pts = mexDoubleArray(prhs[1], "points", errId);
+  if (mxGetN(prhs[1]) != 2) {
+    mexErrMsgIdAndTxt(errId, "points must be N x 2");
+  }
+  q.n = mxGetM(prhs[1]);
+  q.x = pts;
+  q.y = pts + q.n;
+
+  q.dem = mexDemGridFromStruct(prhs[2], errId);
+  q.bounds[0] = mexScalarField(prhs[2], "xMin", errId);
+  q.bounds[1] = mexScalarField(prhs[2], "xMax", errId);
+  q.bounds[2] = mexScalarField(prhs[2], "yMin", errId);
+  q.bounds[3] = mexScalarField(prhs[2], "yMax", errId);
+  q.obs = mexAstarObstacles(prhs[3], astarObstacleCells, errId);
+  q.mask = mexTraversability(prhs[3], q.dem, errId);
+  q.maxSlope = mxGetScalar(prhs[4]);
+  k = mxGetScalar(prhs[5]);
+  if (!(k >= 1.0)) {
+    mexErrMsgIdAndTxt(errId, "k must be at least 1");
+  }
+  q.k = k < (double)INT32_MAX ? (int32_t)k : INT32_MAX;
+  q.radius = mxGetScalar(prhs[6]);
+  if (!(q.radius >= 0.0)) {
+    mexErrMsgIdAndTxt(errId, "radius must be non-negative (Inf = none)");
+  }
+
+  if (!astarKnnCostMatrix(q, (int)mxGetScalar(prhs[7]), edges, settled,
+                          &err)) {
+    mexErrMsgIdAndTxt(errId, "%s", err);
+  }
+
+  plhs[0] = mxCreateDoubleMatrix(edges.size(), 1, mxREAL);
+  I = mxGetDoubles(plhs[0]);
+  for (e = 0; e < edges.size(); e++) {
+    I[e] = (double)edges[e].from + 1.0;
+  }
+  if (nlhs > 1) {
+    plhs[1] = mxCreateDoubleMatrix(edges.size(), 1, mxREAL);
+    J = mxGetDoubles(plhs[1]);
+    for (e = 0; e < edges.size(); e++) {
+      J[e] = (double)edges[e].to + 1.0;
+    }
+  }
+  if (nlhs > 2) {
+    plhs[2] = mxCreateDoubleMatrix(edges.size(), 1, mxREAL);
+    C = mxGetDoubles(plhs[2]);
+    for (e = 0; e < edges.size(); e++) {
+      C[e] = edges[e].cost;
+    }
+  }
+  if (nlhs > 3) {
+    plhs[3] = mxCreateDoubleScalar((double)settled);
+  }
+}
+
+/*
+ * 'fingerprint': hash of terrain, bounds, obstacle grid and maxSlope, the
+ * inputs a landmark table depends on. 'landmarks': build the table.
+ */
+static void astarLandmarkCommand(const char *cmd, int nlhs, mxArray *plhs[],
+                                 int nrhs, const mxArray *prhs[])
+{
+  std::vector<uint8_t> ownMask;
+  std::vector<float> dist;
+  std::vector<int32_t> posts;
+  const mxArray *args[4];
+  AstarProblem p;
+  AstarLandmarks lm;
+  mwSize dims[3];
+  double *v;
+  const char *err = "";
+  std::size_t k;
+  const bool build = std::strcmp(cmd, "landmarks") == 0;
+  if (nrhs != (build ? 5 : 4) || nlhs > (build ? 2 : 1)) {
+    mexErrMsgIdAndTxt(errId, build
+                                 ? "Usage: [dist, posts] = astarPathfinding_"
+                                   "mex('landmarks', demData, obstacles, "
+                                   "maxSlope, count)"
+                                 : "Usage: key = astarPathfinding_mex("
+                                   "'fingerprint', demData, obstacles, "
+                                   "maxSlope)");
+  }
+  args[0] = prhs[1];
+  args[1] = prhs[2];
+  args[2] = prhs[3];
+  args[3] = prhs[3]; /* maxExpansions is not used */
+  astarProblemArgs(args, NULL, p, lm);
+
+  if (!build) {
+    p.mask = NULL; /* derived from the rest, and optional */
+    plhs[0] = mxCreateNumericMatrix(1, 1, mxUINT64_CLASS, mxREAL);
+    *mxGetUint64s(plhs[0]) = astarProblemVersion(p, astarModePlain, NULL);
+    return;
+  }
+
+  if (p.mask == NULL) {
+    ownMask.resize((std::size_t)p.dem.rows * p.dem.cols);
+    if (!astarTraversabilityBuild(p.dem, p.bounds, p.obs, p.maxSlope,
+                                  &ownMask[0], &err)) {
+      mexErrMsgIdAndTxt(errId, "%s", err);
+    }
+    p.mask = &ownMask[0];
+  }
+  if (!astarLandmarksBuild(p.mask, p.dem.rows, p.dem.cols, p.dem.resolution,
+                           (int32_t)mxGetScalar(prhs[4]), dist, posts,
+                           &err)) {
+    mexErrMsgIdAndTxt(errId, "%s", err);
+  }
+
+  dims[0] = (mwSize)p.dem.rows;
+  dims[1] = (mwSize)p.dem.cols;
+  dims[2] = (mwSize)posts.size();
+  plhs[0] = mxCreateNumericArray(3, dims, mxSINGLE_CLASS, mxREAL);
+  if (!dist.empty()) {
+    std::memcpy(mxGetSingles(plhs[0]), &dist[0], dist.size() * sizeof(float));
+  }
+  if (nlhs > 1) {
+    plhs[1] = mxCreateDoubleMatrix(posts.size(), 1, mxREAL);
+    v = mxGetDoubles(plhs[1]);
+    for (k = 0; k < posts.size(); k++) {
+      v[k] = (double)posts[k] + 1.0;
+    }
+  }
+}
+
+static void astarCommand(int nlhs, mxArray *plhs[], int nrhs,
+                         const mxArray *prhs[])
+{
+  std::map<uint64_t, AstarHierarchy *>::iterator it;
+  AstarHierarchy *h;
+  AstarObstacles obs;
+  std::vector<uint8_t> cells;
+  DemGrid dem;
+  double bounds[4];
+  double clusterSize;
+  const char *err = "";
+  char cmd[12];
+  if (mxGetString(prhs[0], cmd, sizeof(cmd)) != 0) {
+    cmd[0] = '\0';
+  }
+
+  if (std::strcmp(cmd, "batch") == 0) {
+    astarBatchCommand(nlhs, plhs, nrhs, prhs);
+
+  } else if (std::strcmp(cmd, "clearcache") == 0) {
+    astarMemo.clear();
+
+  } else if (std::strcmp(cmd, "knn") == 0) {
+    astarKnnCommand(nlhs, plhs, nrhs, prhs);
+
+  } else if (std::strcmp(cmd, "landmarks") == 0 ||
+             std::strcmp(cmd, "fingerprint") == 0) {
+    astarLandmarkCommand(cmd, nlhs, plhs, nrhs, prhs);
+
+  } else if (std::strcmp(cmd, "hierarchy") == 0) {
+    if (nrhs != 5 || nlhs > 1) {
+      mexErrMsgIdAndTxt(errId, "Usage: h = astarPathfinding_mex("
+                               "'hierarchy', demData, obstacles, maxSlope, "
+                               "clusterSize)");
+    }
+    dem = mexDemGridFromStruct(prhs[1], errId);
+    bounds[0] = mexScalarField(prhs[1], "xMin", errId);
+    bounds[1] = mexScalarField(prhs[1], "xMax", errId);
+    bounds[2] = mexScalarField(prhs[1], "yMin", errId);
+    bounds[3] = mexScalarField(prhs[1], "yMax", errId);
+    obs = mexAstarObstacles(prhs[2], cells, errId);
+    clusterSize = mxGetScalar(prhs[4]);
+    if (!(clusterSize >= 2.0 && clusterSize <= 1024.0)) {
+      mexErrMsgIdAndTxt(errId, "clusterSize must be in 2..1024");
+    }
+    h = new AstarHierarchy();
+    if (!h->build(dem, bounds, obs, mxGetScalar(prhs[3]),
+                  (int32_t)clusterSize, &err)) {
+      delete h;
+      mexErrMsgIdAndTxt(errId, "%s", err);
+    }
+    astarHierarchies[astarNextId] = h;
+    mexLock();
+    plhs[0] = mxCreateNumericMatrix(1, 1, mxUINT64_CLASS, mxREAL);
+    *mxGetUint64s(plhs[0]) = astarNextId++;
+
+  } else if (std::strcmp(cmd, "free") == 0) {
+    if (nrhs != 2) {
+      mexErrMsgIdAndTxt(errId, "Usage: astarPathfinding_mex('free', h)");
+    }
+    /*  Freeing an unknown or already freed handle is a no-op */
+    if (mxIsUint64(prhs[1]) && mxGetNumberOfElements(prhs[1]) == 1) {
+      it = astarHierarchies.find(*mxGetUint64s(prhs[1]));
+      if (it != astarHierarchies.end()) {
+        delete it->second;
+        astarHierarchies.erase(it);
+        mexUnlock();
+      }
+    }
+
+  } else {
+    mexErrMsgIdAndTxt(errId, "Command must be 'batch', 'clearcache', "
+                             "'knn', 'landmarks', 'fingerprint', "
+                             "'hierarchy' or 'free'");
+  }
+}
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  AstarProblem p;
+  AstarLandmarks lm;
+  AstarResult out;
+  AstarAnytime schedule = {3.0, 0.5,
+                           std::numeric_limits<double>::infinity()};
+  AstarAnytimeStats anytime;
+  AstarMode mode = astarModePlain;
+  const double *v;
+  const char *err = "";
+  bool ok;
+  mexAtExit(&astarFreeAll);
+  if (nrhs >= 1 && mxIsChar(prhs[0])) {
+    astarCommand(nlhs, plhs, nrhs, prhs);
+    return;
+  }
+  if (nrhs < 6 || nrhs > 9) {
+    mexErrMsgIdAndTxt(errId, "Usage: [xy, nodesExpanded, status, anytime] "
+                             "= astarPathfinding_mex(start, goal, demData, "
+                             "obstacles, maxSlope, maxExpansions, mode, "
+                             "heuristic, schedule)");
+  }
+  if (nrhs >= 7) {
+    mode = astarModeArg(prhs[6]);
+  }
+  if (nlhs > (mode == astarModeAnytime ? 4 : 3)) {
+    mexErrMsgIdAndTxt(errId, "Too many output arguments");
+  }
+  if (nrhs == 9) {
+    v = mexDoubleArray(prhs[8], "schedule", errId);
+    if (mxGetNumberOfElements(prhs[8]) != 3) {
+      mexErrMsgIdAndTxt(errId, "schedule must be [weight, weightStep, "
+                               "budgetUs]");
+    }
+    schedule.weight = v[0];
+    schedule.weightStep = v[1];
+    schedule.budgetUs = v[2];
+  }
+  v = mexDoubleArray(prhs[0], "start", errId);
+  if (mxGetNumberOfElements(prhs[0]) < 2) {
+    mexErrMsgIdAndTxt(errId, "start must have at least [X, Y]");
+  }
+  p.start[0] = v[0];
+  p.start[1] = v[1];
+  v = mexDoubleArray(prhs[1], "goal", errId);
+  if (mxGetNumberOfElements(prhs[1]) < 2) {
+    mexErrMsgIdAndTxt(errId, "goal must have at least [X, Y]");
+  }
+  p.goal[0] = v[0];
+  p.goal[1] = v[1];
+  astarProblemArgs(&prhs[2], nrhs >= 8 ? prhs[7] : NULL, p, lm);
+
+  if (mode == astarModeJump) {
+    ok = astarJumpSearch(p, astarArena, out, &err);
+  } else if (mode == astarModeHierarchy) {
+    ok = astarLookup(mxIsStruct(prhs[3])
+                         ? mxGetField(prhs[3], 0, "hierarchy")
+                         : NULL)
+             ->search(p.start, p.goal, p.maxExpansions, astarArena, out,
+                      &err);
+  } else if (mode == astarModeAnytime) {
+    ok = astarAnytimeSearch(p, schedule, astarArena, out, anytime, &err);
+  } else {
+    ok = astarSearch(p, astarArena, out, &err);
+  }
+  if (!ok) {
+    mexErrMsgIdAndTxt(errId, "%s", err);
+  }
+
+  plhs[0] = astarXyArray(out);
+  if (nlhs > 1) {
+    plhs[1] = mxCreateDoubleScalar((double)out.nodesExpanded);
+  }
+  if (nlhs > 2) {
+    plhs[2] = mxCreateDoubleScalar((double)out.status);
+  }
+  if (nlhs > 3) {
+    plhs[3] = astarAnytimeArray(anytime);
+  }
+}
+
+/* End of astarPathfinding_mex.cpp */
@@ -0,0 +1,1046 @@
+/*
+ * astarSearch.cpp
+ *
+ * Indexed-heap grid A* (see astarSearch.h). The lattice covers every
+ * node the search may reach: all start + k * resolution inside the
+ * bounds, plus the start itself if it lies outside them.
+ *
+ */
+
+/* Include files */
+#include "astarSearch.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+/* Type Definitions */
+struct AstarLattice {
+  int64_t kLo[2];  /* in-bounds steps from the start, per axis */
+  int64_t kHi[2];
+  int64_t aLo[2];  /* array origin (includes the start) */
+  int32_t width;
+  int32_t height;
+};
+
+/*  Goal posts and landmarks behind the astarAnytimeSearch estimate */
+struct AstarGoalBound {
+  const AstarLandmarks *alt;
+  std::size_t nPosts;
+  std::size_t posts[9];
+  int32_t nGoalPosts;
+  std::ptrdiff_t i0;
+  std::ptrdiff_t j0;
+};
+
+/* Function Declarations */
+static void astarAxis(double origin, double lo, double hi, double res,
+                      int64_t &kLo, int64_t &kHi);
+static bool astarLatticeInit(const AstarProblem &p, AstarLattice &L,
+                             const char **err);
+static bool astarPostOrigin(const AstarProblem &p, const AstarLattice &L,
+                            std::ptrdiff_t &i0, std::ptrdiff_t &j0);
+static const uint8_t *astarMaskAt(const AstarProblem &p,
+                                  const AstarLattice &L);
+static inline double astarEstimate(const AstarProblem &p, double x,
+                                   double y);
+static inline bool astarEnterable(const AstarProblem &p,
+                                  const AstarLattice &L, int64_t kx,
+                                  int64_t ky);
+static int32_t astarGoalPosts(const AstarProblem &p, const AstarLattice &L,
+                              std::ptrdiff_t i0, std::ptrdiff_t j0,
+                              std::size_t posts[9]);
+static double astarTerrain(const AstarProblem &p, AstarArena &a, int32_t id,
+                           double x, double y);
+static void astarTrace(const AstarProblem &p, const AstarLattice &L,
+                       const AstarArena &a, int32_t id, AstarResult &out);
+static inline bool astarJumpBlocked(const AstarProblem &p,
+                                    const AstarLattice &L, int64_t kx,
+                                    int64_t ky);
+static inline bool astarJumpGoal(const AstarProblem &p, const int64_t kg[2],
+                                 int64_t kx, int64_t ky);
+static bool astarJumpStraight(const AstarProblem &p, const AstarLattice &L,
+                              const int64_t kg[2], int64_t &kx, int64_t &ky,
+                              int32_t dx, int32_t dy);
+static bool astarJump(const AstarProblem &p, const AstarLattice &L,
+                      const int64_t kg[2], int64_t &kx, int64_t &ky,
+                      int32_t dx, int32_t dy);
+static void astarJumpTrace(const AstarProblem &p, const AstarLattice &L,
+                           const AstarArena &a, int32_t id,
+                           AstarResult &out);
+static double astarGoalEstimate(const AstarProblem &p,
+                                const AstarLattice &L,
+                                const AstarGoalBound &gb, int32_t id);
+static double astarOpenBound(const AstarProblem &p, const AstarLattice &L,
+                             const AstarGoalBound &gb, const AstarArena &a,
+                             const std::vector<int32_t> &incons);
+
+/* Function Definitions */
+AstarArena::AstarArena() : gen(0), nextSeq(0)
+{
+}
+
+void AstarArena::begin(std::size_t n)
+{
+  if (stamp.size() < n) {
+    g.resize(n);
+    f.resize(n);
+    z.resize(n);
+    parent.resize(n);
+    heapPos.resize(n);
+    seq.resize(n);
+    stamp.resize(n, 0);
+    zStamp.resize(n, 0);
+    round.resize(n);
+  }
+  heap.clear();
+  nextSeq = 0;
+  if (++gen == 0) {
+    /*  Generation counter wrapped: forget every stale stamp */
+    stamp.assign(stamp.size(), 0);
+    zStamp.assign(zStamp.size(), 0);
+    gen = 1;
+  }
+}
+
+/*  Steps k with lo <= origin + k * res <= hi, as the position is computed */
+static void astarAxis(double origin, double lo, double hi, double res,
+                      int64_t &kLo, int64_t &kHi)
+{
+  kLo = (int64_t)std::ceil((lo - origin) / res);
+  while (origin + (double)kLo * res < lo) {
+    kLo++;
+  }
+  while (origin + (double)(kLo - 1) * res >= lo) {
+    kLo--;
+  }
+  kHi = (int64_t)std::floor((hi - origin) / res);
+  while (origin + (double)kHi * res > hi) {
+    kHi--;
+  }
+  while (origin + (double)(kHi + 1) * res <= hi) {
+    kHi++;
+  }
+}
+
+void AstarArena::relax(int32_t id, int32_t from, double gNew, double fNew)
+{
+  if (stamp[id] == gen) {
+    if (fNew < f[id]) {
+      g[id] = gNew;
+      f[id] = fNew;
+      parent[id] = from;
+      siftUp(heapPos[id]);
+    }
+    return;
+  }
+  stamp[id] = gen;
+  g[id] = gNew;
+  f[id] = fNew;
+  parent[id] = from;
+  seq[id] = nextSeq++;
+  heap.push_back(id);
+  siftUp((int32_t)heap.size() - 1);
+}
+
+int32_t AstarArena::pop()
+{
+  int32_t top = heap[0];
+  heap[0] = heap.back();
+  heap.pop_back();
+  if (!heap.empty()) {
+    siftDown(0);
+  }
+  heapPos[top] = -1; /* closed */
+  return top;
+}
+
+void AstarArena::reopen(int32_t id)
+{
+  seq[id] = nextSeq++;
+  heap.push_back(id);
+  siftUp((int32_t)heap.size() - 1);
+}
+
+void AstarArena::reorder()
+{
+  int32_t pos;
+  for (pos = 0; pos < (int32_t)heap.size(); pos++) {
+    heapPos[heap[pos]] = pos;
+  }
+  for (pos = (int32_t)heap.size() / 2 - 1; pos >= 0; pos--) {
+    siftDown(pos);
+  }
+}
+
+bool AstarArena::before(int32_t u, int32_t v) const
+{
+  return f[u] < f[v] || (f[u] == f[v] && seq[u] < seq[v]);
+}
+
+void AstarArena::siftUp(int32_t pos)
+{
+  int32_t id = heap[pos];
+  int32_t up;
+  while (pos > 0) {
+    up = (pos - 1) >> 1;
+    if (!before(id, heap[up])) {
+      break;
+    }
+    heap[pos] = heap[up];
+    heapPos[heap[pos]] = pos;
+    pos = up;
+  }
+  heap[pos] = id;
+  heapPos[id] = pos;
+}
+
+void AstarArena::siftDown(int32_t pos)
+{
+  int32_t n = (int32_t)heap.size();
+  int32_t id = heap[pos];
+  int32_t child;
+  for (;;) {
+    child = 2 * pos + 1;
+    if (child >= n) {
+      break;
+    }
+    if (child + 1 < n && before(heap[child + 1], heap[child])) {
+      child++;
+    }
+    if (!before(heap[child], id)) {
+      break;
+    }
+    heap[pos] = heap[child];
+    heapPos[heap[pos]] = pos;
+    pos = child;
+  }
+  heap[pos] = id;
+  heapPos[id] = pos;
+}
+
+/*  Lattice of steps from the start that stay inside p.bounds */
+static bool astarLatticeInit(const AstarProblem &p, AstarLattice &L,
+                             const char **err)
+{
+  int32_t axis;
+  if (!(p.resolution > 0.0)) {
+    *err = "resolution must be positive";
+    return false;
+  }
+  for (axis = 0; axis < 2; axis++) {
+    astarAxis(p.start[axis], p.bounds[2 * axis], p.bounds[2 * axis + 1],
+              p.resolution, L.kLo[axis], L.kHi[axis]);
+    L.aLo[axis] = L.kLo[axis] < 0 ? L.kLo[axis] : 0;
+    if ((L.kHi[axis] > 0 ? L.kHi[axis] : 0) - L.aLo[axis] + 1 >
+        (int64_t)INT32_MAX) {
+      *err = "search lattice is too large";
+      return false;
+    }
+  }
+  L.width = (int32_t)((L.kHi[0] > 0 ? L.kHi[0] : 0) - L.aLo[0] + 1);
+  L.height = (int32_t)((L.kHi[1] > 0 ? L.kHi[1] : 0) - L.aLo[1] + 1);
+  if ((int64_t)L.width * L.height >= (int64_t)INT32_MAX) {
+    *err = "search lattice is too large";
+    return false;
+  }
+  return true;
+}
+
+/*
+ * Post of lattice step (0, 0) when the lattice is the DEM post grid and
+ * lies inside it; false otherwise.
+ */
+static bool astarPostOrigin(const AstarProblem &p, const AstarLattice &L,
+                            std::ptrdiff_t &i0, std::ptrdiff_t &j0)
+{
+  const double res = p.resolution;
+  double i;
+  double j;
+  if (res != p.dem.resolution) {
+    return false;
+  }
+  i = std::round((p.start[0] - p.dem.xMin) / res);
+  j = std::round((p.start[1] - p.dem.yMin) / res);
+  if (p.dem.xMin + i * res != p.start[0] ||
+      p.dem.yMin + j * res != p.start[1]) {
+    return false;
+  }
+  if (i + (double)L.aLo[0] < 0 || i + (double)L.kHi[0] >= p.dem.cols ||
+      j + (double)L.aLo[1] < 0 || j + (double)L.kHi[1] >= p.dem.rows) {
+    return false;
+  }
+  i0 = (std::ptrdiff_t)i;
+  j0 = (std::ptrdiff_t)j;
+  return true;
+}
+
+/*
+ * Mask byte of the start post, or NULL when the mask cannot stand in for
+ * the edge tests: the lattice must be the DEM post grid and lie inside it.
+ */
+static const uint8_t *astarMaskAt(const AstarProblem &p,
+                                  const AstarLattice &L)
+{
+  std::ptrdiff_t i0;
+  std::ptrdiff_t j0;
+  if (p.mask == NULL || !astarPostOrigin(p, L, i0, j0)) {
+    return NULL;
+  }
+  return p.mask + i0 * p.dem.rows + j0;
+}
+
+/*  params.astarHeuristic from (x, y) to the goal point */
+static inline double astarEstimate(const AstarProblem &p, double x,
+                                   double y)
+{
+  const double dx = std::fabs(x - p.goal[0]);
+  const double dy = std::fabs(y - p.goal[1]);
+  if (p.heuristic == astarHeuristicManhattan) {
+    return dx + dy;
+  }
+  if (p.heuristic == astarHeuristicDiagonal) {
+    return std::max(dx, dy) + (std::sqrt(2.0) - 1.0) * std::min(dx, dy);
+  }
+  return std::hypot(x - p.goal[0], y - p.goal[1]);
+}
+
+/*
+ *  Whether a move can end on lattice step (kx, ky): inside the bounds and
+ *  off the obstacle cells. Only such posts have in-edges, so only they
+ *  get an ALT bound (a blocked start may still be left).
+ */
+static inline bool astarEnterable(const AstarProblem &p,
+                                  const AstarLattice &L, int64_t kx,
+                                  int64_t ky)
+{
+  return kx >= L.kLo[0] && kx <= L.kHi[0] && ky >= L.kLo[1] &&
+         ky <= L.kHi[1] &&
+         !astarObstacleAt(p.obs, p.start[0] + (double)kx * p.resolution,
+                          p.start[1] + (double)ky * p.resolution);
+}
+
+/*  Enterable posts of the lattice nodes that pass the goal test (at most
+ *  3 x 3) */
+static int32_t astarGoalPosts(const AstarProblem &p, const AstarLattice &L,
+                              std::ptrdiff_t i0, std::ptrdiff_t j0,
+                              std::size_t posts[9])
+{
+  const double res = p.resolution;
+  const double gx = std::round((p.goal[0] - p.start[0]) / res);
+  const double gy = std::round((p.goal[1] - p.start[1]) / res);
+  int32_t n = 0;
+  int64_t kx;
+  int64_t ky;
+  if (!(std::fabs(gx) < 1e15 && std::fabs(gy) < 1e15)) {
+    return 0;
+  }
+  for (kx = (int64_t)gx - 1; kx <= (int64_t)gx + 1; kx++) {
+    for (ky = (int64_t)gy - 1; ky <= (int64_t)gy + 1; ky++) {
+      if (!astarEnterable(p, L, kx, ky) ||
+          !(std::hypot(p.start[0] + (double)kx * res - p.goal[0],
+                       p.start[1] + (double)ky * res - p.goal[1]) < res)) {
+        continue;
+      }
+      posts[n++] = (std::size_t)((i0 + kx) * p.dem.rows + j0 + ky);
+    }
+  }
+  return n;
+}
+
+static double astarTerrain(const AstarProblem &p, AstarArena &a, int32_t id,
+                           double x, double y)
+{
+  if (a.zStamp[id] != a.gen) {
+    a.z[id] = demInterpolatePoint(p.dem, x, y);
+    a.zStamp[id] = a.gen;
+  }
+  return a.z[id];
+}
+
+static void astarTrace(const AstarProblem &p, const AstarLattice &L,
+                       const AstarArena &a, int32_t id, AstarResult &out)
+{
+  std::size_t n = 0;
+  std::size_t k;
+  int32_t v;
+  for (v = id; v >= 0; v = a.parent[v]) {
+    n++;
+  }
+  out.x.resize(n);
+  out.y.resize(n);
+  for (v = id, k = n; v >= 0; v = a.parent[v]) {
+    k--;
+    out.x[k] = p.start[0] + (double)(L.aLo[0] + v % L.width) * p.resolution;
+    out.y[k] = p.start[1] + (double)(L.aLo[1] + v / L.width) * p.resolution;
+  }
+}
+
+bool astarSearch(const AstarProblem &p, AstarArena &arena, AstarResult &out,
+                 const char **err)
+{
+  const double res = p.resolution;
+  const double tan2 = astarSlopeTan2(p.maxSlope);
+  const double step2[2] = {res * res, 2.0 * res * res};
+  const uint8_t *mask;
+  const AstarLandmarks *alt = NULL;
+  AstarLattice L;
+  AstarArena &a = arena;
+  std::size_t nodes;
+  std::size_t nPosts = 0;
+  std::size_t goalPosts[9];
+  std::ptrdiff_t i0 = 0;
+  std::ptrdiff_t j0 = 0;
+  int32_t nGoalPosts = 0;
+  int32_t startId;
+  int32_t bestClosed = -1;
+  int32_t cur;
+  int32_t nb;
+  int32_t d;
+  uint32_t bits = 0xFF;
+  int64_t kx;
+  int64_t ky;
+  int64_t nx;
+  int64_t ny;
+  double x;
+  double y;
+  double px;
+  double py;
+  double zc = 0.0;
+  double zn;
+  double step;
+  double g;
+  double h;
+  const double diag = res * std::sqrt(2.0);
+
+  if (!astarLatticeInit(p, L, err)) {
+    return false;
+  }
+  nodes = (std::size_t)L.width * (std::size_t)L.height;
+  a.begin(nodes);
+  mask = astarMaskAt(p, L);
+  if (p.landmarks != NULL && p.landmarks->count > 0 &&
+      astarPostOrigin(p, L, i0, j0)) {
+    alt = p.landmarks;
+    nPosts = (std::size_t)p.dem.rows * p.dem.cols;
+    nGoalPosts = astarGoalPosts(p, L, i0, j0, goalPosts);
+  }
+
+  startId = (int32_t)((0 - L.aLo[1]) * L.width + (0 - L.aLo[0]));
+  h = astarEstimate(p, p.start[0], p.start[1]);
+  if (alt != NULL && nGoalPosts > 0 && astarEnterable(p, L, 0, 0)) {
+    h = std::max(h, astarLandmarkBound(*alt, nPosts,
+                                       (std::size_t)(i0 * p.dem.rows + j0),
+                                       goalPosts, nGoalPosts));
+  }
+  if (!(h < std::numeric_limits<double>::infinity())) {
+    out.nodesExpanded = 0; /* a landmark separates start and goal */
+    out.x.clear();
+    out.y.clear();
+    out.status = astarNoPath;
+    return true;
+  }
+  a.relax(startId, -1, 0.0, h);
+
+  out.nodesExpanded = 0;
+  while (!a.heap.empty()) {
+    cur = a.pop();
+    out.nodesExpanded++;
+    kx = L.aLo[0] + cur % L.width;
+    ky = L.aLo[1] + cur / L.width;
+    px = p.start[0] + (double)kx * res;
+    py = p.start[1] + (double)ky * res;
+
+    if (std::hypot(px - p.goal[0], py - p.goal[1]) < res) {
+      astarTrace(p, L, a, cur, out);
+      out.status = astarFound;
+      return true;
+    }
+    if (bestClosed < 0 || a.f[cur] < a.f[bestClosed]) {
+      bestClosed = cur;
+    }
+
+    if (mask != NULL) {
+      bits = mask[(std::ptrdiff_t)kx * p.dem.rows + (std::ptrdiff_t)ky];
+    } else {
+      zc = astarTerrain(p, a, cur, px, py);
+    }
+    for (d = 0; d < 8; d++) {
+      if (!((bits >> d) & 1u)) {
+        continue;
+      }
+      nx = kx + astarMoveDirs[d][0];
+      ny = ky + astarMoveDirs[d][1];
+      if (nx < L.kLo[0] || nx > L.kHi[0] || ny < L.kLo[1] ||
+          ny > L.kHi[1]) {
+        continue;
+      }
+      nb = (int32_t)((ny - L.aLo[1]) * L.width + (nx - L.aLo[0]));
+      if (a.closed(nb)) {
+        continue;
+      }
+      x = p.start[0] + (double)nx * res;
+      y = p.start[1] + (double)ny * res;
+      if (mask == NULL) {
+        if (astarObstacleAt(p.obs, x, y)) {
+          continue;
+        }
+        zn = astarTerrain(p, a, nb, x, y);
+        if (astarTooSteep(zc, zn, step2[d >= 4], tan2)) {
+          continue;
+        }
+      }
+      step = (d < 4) ? res : diag;
+
+      g = a.g[cur] + step;
+      h = astarEstimate(p, x, y);
+      if (alt != NULL && nGoalPosts > 0) { /* neighbours are enterable */
+        h = std::max(h, astarLandmarkBound(
+                            *alt, nPosts,
+                            (std::size_t)((i0 + nx) * p.dem.rows + j0 + ny),
+                            goalPosts, nGoalPosts));
+        if (!(h < std::numeric_limits<double>::infinity())) {
+          continue;
+        }
+      }
+      a.relax(nb, cur, g, g + h);
+    }
+
+    if (out.nodesExpanded > p.maxExpansions) {
+      astarTrace(p, L, a, bestClosed, out);
+      out.status = astarCapped;
+      return true;
+    }
+  }
+  out.x.clear();
+  out.y.clear();
+  out.status = astarNoPath;
+  return true;
+}
+
+/*  Jump point search: off the lattice or on an obstacle cell */
+static inline bool astarJumpBlocked(const AstarProblem &p,
+                                    const AstarLattice &L, int64_t kx,
+                                    int64_t ky)
+{
+  if (kx < L.kLo[0] || kx > L.kHi[0] || ky < L.kLo[1] || ky > L.kHi[1]) {
+    return true;
+  }
+  return astarObstacleAt(p.obs, p.start[0] + (double)kx * p.resolution,
+                         p.start[1] + (double)ky * p.resolution);
+}
+
+/*  Goal test of astarSearch; only the lattice nodes next to kg can pass */
+static inline bool astarJumpGoal(const AstarProblem &p, const int64_t kg[2],
+                                 int64_t kx, int64_t ky)
+{
+  if (kx < kg[0] - 1 || kx > kg[0] + 1 || ky < kg[1] - 1 ||
+      ky > kg[1] + 1) {
+    return false;
+  }
+  return std::hypot(p.start[0] + (double)kx * p.resolution - p.goal[0],
+                    p.start[1] + (double)ky * p.resolution - p.goal[1]) <
+         p.resolution;
+}
+
+/*  Straight run along (dx, dy) until a jump point, left in (kx, ky) */
+static bool astarJumpStraight(const AstarProblem &p, const AstarLattice &L,
+                              const int64_t kg[2], int64_t &kx, int64_t &ky,
+                              int32_t dx, int32_t dy)
+{
+  for (;;) {
+    kx += dx;
+    ky += dy;
+    if (astarJumpBlocked(p, L, kx, ky)) {
+      return false;
+    }
+    if (astarJumpGoal(p, kg, kx, ky)) {
+      return true;
+    }
+    /*  Forced neighbour: a blocked side cell with free space beyond it */
+    if ((astarJumpBlocked(p, L, kx + dy, ky + dx) &&
+         !astarJumpBlocked(p, L, kx + dx + dy, ky + dy + dx)) ||
+        (astarJumpBlocked(p, L, kx - dy, ky - dx) &&
+         !astarJumpBlocked(p, L, kx + dx - dy, ky + dy - dx))) {
+      return true;
+    }
+  }
+}
+
+/*
+ * Move from (kx, ky) along (dx, dy) until a jump point: the goal, a node
+ * with a forced neighbour, or (diagonally) a node whose straight runs
+ * reach one. Leaves the jump point in (kx, ky); false if the run is cut.
+ */
+static bool astarJump(const AstarProblem &p, const AstarLattice &L,
+                      const int64_t kg[2], int64_t &kx, int64_t &ky,
+                      int32_t dx, int32_t dy)
+{
+  int64_t sx;
+  int64_t sy;
+  if (dx == 0 || dy == 0) {
+    return astarJumpStraight(p, L, kg, kx, ky, dx, dy);
+  }
+  for (;;) {
+    kx += dx;
+    ky += dy;
+    if (astarJumpBlocked(p, L, kx, ky)) {
+      return false;
+    }
+    if (astarJumpGoal(p, kg, kx, ky)) {
+      return true;
+    }
+    if ((astarJumpBlocked(p, L, kx - dx, ky) &&
+         !astarJumpBlocked(p, L, kx - dx, ky + dy)) ||
+        (astarJumpBlocked(p, L, kx, ky - dy) &&
+         !astarJumpBlocked(p, L, kx + dx, ky - dy))) {
+      return true;
+    }
+    sx = kx;
+    sy = ky;
+    if (astarJumpStraight(p, L, kg, sx, sy, dx, 0)) {
+      return true;
+    }
+    sx = kx;
+    sy = ky;
+    if (astarJumpStraight(p, L, kg, sx, sy, 0, dy)) {
+      return true;
+    }
+  }
+}
+
+/*  Jump points back to the start, filled in with every lattice step */
+static void astarJumpTrace(const AstarProblem &p, const AstarLattice &L,
+                           const AstarArena &a, int32_t id, AstarResult &out)
+{
+  std::size_t n = 1;
+  std::size_t k;
+  int32_t v;
+  int64_t kx;
+  int64_t ky;
+  int64_t px;
+  int64_t py;
+  for (v = id; a.parent[v] >= 0; v = a.parent[v]) {
+    kx = v % L.width - a.parent[v] % L.width;
+    ky = v / L.width - a.parent[v] / L.width;
+    n += (std::size_t)std::max(std::abs(kx), std::abs(ky));
+  }
+  out.x.resize(n);
+  out.y.resize(n);
+  k = n;
+  for (v = id; v >= 0; v = a.parent[v]) {
+    kx = L.aLo[0] + v % L.width;
+    ky = L.aLo[1] + v / L.width;
+    if (a.parent[v] < 0) {
+      px = kx - 1; /* emit the start itself */
+      py = ky;
+    } else {
+      px = L.aLo[0] + a.parent[v] % L.width;
+      py = L.aLo[1] + a.parent[v] / L.width;
+    }
+    while (kx != px || ky != py) {
+      k--;
+      out.x[k] = p.start[0] + (double)kx * p.resolution;
+      out.y[k] = p.start[1] + (double)ky * p.resolution;
+      if (a.parent[v] < 0) {
+        break;
+      }
+      kx += (px > kx) - (px < kx);
+      ky += (py > ky) - (py < ky);
+    }
+  }
+}
+
+bool astarJumpSearch(const AstarProblem &p, AstarArena &arena,
+                     AstarResult &out, const char **err)
+{
+  const double res = p.resolution;
+  const double diag = res * std::sqrt(2.0);
+  AstarLattice L;
+  AstarArena &a = arena;
+  int64_t kg[2];
+  int32_t dirs[8][2];
+  int32_t nDirs;
+  int32_t startId;
+  int32_t bestClosed = -1;
+  int32_t cur;
+  int32_t nb;
+  int32_t d;
+  int32_t dx;
+  int32_t dy;
+  int64_t kx;
+  int64_t ky;
+  int64_t jx;
+  int64_t jy;
+  int64_t steps;
+  double g;
+
+  if (!astarLatticeInit(p, L, err)) {
+    return false;
+  }
+  a.begin((std::size_t)L.width * (std::size_t)L.height);
+  kg[0] = (int64_t)std::round((p.goal[0] - p.start[0]) / res);
+  kg[1] = (int64_t)std::round((p.goal[1] - p.start[1]) / res);
+
+  startId = (int32_t)((0 - L.aLo[1]) * L.width + (0 - L.aLo[0]));
+  a.relax(startId, -1, 0.0,
+          std::hypot(p.start[0] - p.goal[0], p.start[1] - p.goal[1]));
+
+  out.nodesExpanded = 0;
+  while (!a.heap.empty()) {
+    cur = a.pop();
+    out.nodesExpanded++;
+    kx = L.aLo[0] + cur % L.width;
+    ky = L.aLo[1] + cur / L.width;
+    if (astarJumpGoal(p, kg, kx, ky)) {
+      astarJumpTrace(p, L, a, cur, out);
+      out.status = astarFound;
+      return true;
+    }
+    if (bestClosed < 0 || a.f[cur] < a.f[bestClosed]) {
+      bestClosed = cur;
+    }
+
+    /*  Pruned neighbours: natural moves plus those forced by obstacles */
+    nDirs = 0;
+    if (a.parent[cur] < 0) {
+      for (d = 0; d < 8; d++) {
+        dirs[nDirs][0] = astarMoveDirs[d][0];
+        dirs[nDirs++][1] = astarMoveDirs[d][1];
+      }
+    } else {
+      jx = L.aLo[0] + a.parent[cur] % L.width;
+      jy = L.aLo[1] + a.parent[cur] / L.width;
+      dx = (kx > jx) - (kx < jx);
+      dy = (ky > jy) - (ky < jy);
+      if (dx != 0 && dy != 0) {
+        dirs[nDirs][0] = dx;
+        dirs[nDirs++][1] = 0;
+        dirs[nDirs][0] = 0;
+        dirs[nDirs++][1] = dy;
+        dirs[nDirs][0] = dx;
+        dirs[nDirs++][1] = dy;
+        if (astarJumpBlocked(p, L, kx - dx, ky)) {
+          dirs[nDirs][0] = -dx;
+          dirs[nDirs++][1] = dy;
+        }
+        if (astarJumpBlocked(p, L, kx, ky - dy)) {
+          dirs[nDirs][0] = dx;
+          dirs[nDirs++][1] = -dy;
+        }
+      } else {
+        /*  Side cells (kx + dy, ky + dx) and (kx - dy, ky - dx) */
+        dirs[nDirs][0] = dx;
+        dirs[nDirs++][1] = dy;
+        if (astarJumpBlocked(p, L, kx + dy, ky + dx)) {
+          dirs[nDirs][0] = dx + dy;
+          dirs[nDirs++][1] = dy + dx;
+        }
+        if (astarJumpBlocked(p, L, kx - dy, ky - dx)) {
+          dirs[nDirs][0] = dx - dy;
+          dirs[nDirs++][1] = dy - dx;
+        }
+      }
+    }
+
+    for (d = 0; d < nDirs; d++) {
+      jx = kx;
+      jy = ky;
+      if (!astarJump(p, L, kg, jx, jy, dirs[d][0], dirs[d][1])) {
+        continue;
+      }
+      nb = (int32_t)((jy - L.aLo[1]) * L.width + (jx - L.aLo[0]));
+      if (a.closed(nb)) {
+        continue;
+      }
+      steps = std::max(std::abs(jx - kx), std::abs(jy - ky));
+      g = a.g[cur] +
+          (double)steps * (dirs[d][0] != 0 && dirs[d][1] != 0 ? diag : res);
+      a.relax(nb, cur, g,
+              g + std::hypot(p.start[0] + (double)jx * res - p.goal[0],
+                             p.start[1] + (double)jy * res - p.goal[1]));
+    }
+
+    if (out.nodesExpanded > p.maxExpansions) {
+      astarJumpTrace(p, L, a, bestClosed, out);
+      out.status = astarCapped;
+      return true;
+    }
+  }
+  out.x.clear();
+  out.y.clear();
+  out.status = astarNoPath;
+  return true;
+}
+
+/*
+ *  Euclidean distance to the goal circle (radius one resolution, the goal
+ *  test) raised to the ALT bound; 0 on every node that passes the goal
+ *  test, so it stays consistent. Inf when a landmark separates the node
+ *  from the goal.
+ */
+static double astarGoalEstimate(const AstarProblem &p,
+                                const AstarLattice &L,
+                                const AstarGoalBound &gb, int32_t id)
+{
+  const int64_t kx = L.aLo[0] + id % L.width;
+  const int64_t ky = L.aLo[1] + id / L.width;
+  double h = std::hypot(p.start[0] + (double)kx * p.resolution - p.goal[0],
+                        p.start[1] + (double)ky * p.resolution - p.goal[1]) -
+             p.resolution;
+  if (h < 0.0) {
+    h = 0.0;
+  }
+  if (gb.alt != NULL && gb.nGoalPosts > 0 && astarEnterable(p, L, kx, ky)) {
+    h = std::max(h, astarLandmarkBound(
+                        *gb.alt, gb.nPosts,
+                        (std::size_t)((gb.i0 + kx) * p.dem.rows + gb.j0 + ky),
+                        gb.posts, gb.nGoalPosts));
+  }
+  return h;
+}
+
+/*  min(g + h) over OPEN and INCONS, a lower bound on the optimal cost */
+static double astarOpenBound(const AstarProblem &p, const AstarLattice &L,
+                             const AstarGoalBound &gb, const AstarArena &a,
+                             const std::vector<int32_t> &incons)
+{
+  double lo = std::numeric_limits<double>::infinity();
+  std::size_t k;
+  for (k = 0; k < a.heap.size(); k++) {
+    lo = std::min(lo, a.g[a.heap[k]] + astarGoalEstimate(p, L, gb,
+                                                         a.heap[k]));
+  }
+  for (k = 0; k < incons.size(); k++) {
+    lo = std::min(lo, a.g[incons[k]] + astarGoalEstimate(p, L, gb,
+                                                         incons[k]));
+  }
+  return lo;
+}
+
+bool astarAnytimeSearch(const AstarProblem &p, const AstarAnytime &opt,
+                        AstarArena &arena, AstarResult &out,
+                        AstarAnytimeStats &stats, const char **err)
+{
+  const double inf = std::numeric_limits<double>::infinity();
+  const double res = p.resolution;
+  const double tan2 = astarSlopeTan2(p.maxSlope);
+  const double step2[2] = {res * res, 2.0 * res * res};
+  const double diag = res * std::sqrt(2.0);
+  const std::chrono::steady_clock::time_point t0 =
+      std::chrono::steady_clock::now();
+  std::vector<int32_t> incons; /* improved after closing, this iteration */
+  const uint8_t *mask;
+  AstarLattice L;
+  AstarGoalBound gb;
+  AstarArena &a = arena;
+  std::size_t k;
+  uint32_t iter = 1;
+  uint32_t bits = 0xFF;
+  int32_t startId;
+  int32_t goalId = -1;
+  int32_t bestClosed = -1;
+  int32_t cur;
+  int32_t nb;
+  int32_t d;
+  int64_t kx;
+  int64_t ky;
+  int64_t nx;
+  int64_t ny;
+  double w;
+  double wDone;
+  double gGoal = inf;
+  double lo;
+  double x;
+  double y;
+  double px;
+  double py;
+  double zc = 0.0;
+  double zn;
+  double g;
+  double h;
+  bool outOfBudget = false;
+
+  if (!(opt.weight >= 1.0) || !(opt.weightStep > 0.0)) {
+    *err = "anytime weight must be >= 1 and its step positive";
+    return false;
+  }
+  if (!astarLatticeInit(p, L, err)) {
+    return false;
+  }
+  a.begin((std::size_t)L.width * (std::size_t)L.height);
+  mask = astarMaskAt(p, L);
+  gb.alt = NULL;
+  gb.nPosts = 0;
+  gb.nGoalPosts = 0;
+  if (p.landmarks != NULL && p.landmarks->count > 0 &&
+      astarPostOrigin(p, L, gb.i0, gb.j0)) {
+    gb.alt = p.landmarks;
+    gb.nPosts = (std::size_t)p.dem.rows * p.dem.cols;
+    gb.nGoalPosts = astarGoalPosts(p, L, gb.i0, gb.j0, gb.posts);
+  }
+
+  stats.iterations = 0;
+  stats.weight = inf;
+  stats.bound = inf;
+  stats.cost = inf;
+  stats.history.clear();
+  out.nodesExpanded = 0;
+
+  w = opt.weight;
+  wDone = inf;
+  startId = (int32_t)((0 - L.aLo[1]) * L.width + (0 - L.aLo[0]));
+  h = astarGoalEstimate(p, L, gb, startId);
+  if (h < inf) {
+    a.relax(startId, -1, 0.0, w * h);
+    a.round[startId] = 0;
+    if (std::hypot(p.start[0] - p.goal[0], p.start[1] - p.goal[1]) < res) {
+      gGoal = 0.0;
+      goalId = startId;
+    }
+  }
+
+  for (;;) {
+    /*  ImprovePath: expand while some open key is below the goal's g */
+    while (!a.heap.empty() && a.f[a.heap[0]] < gGoal) {
+      if (out.nodesExpanded > p.maxExpansions ||
+          ((out.nodesExpanded & 255) == 0 && opt.budgetUs < inf &&
+           std::chrono::duration<double, std::micro>(
+               std::chrono::steady_clock::now() - t0)
+                   .count() > opt.budgetUs)) {
+        outOfBudget = true;
+        break;
+      }
+      cur = a.pop();
+      a.round[cur] = iter;
+      out.nodesExpanded++;
+      if (bestClosed < 0 || a.f[cur] < a.f[bestClosed]) {
+        bestClosed = cur;
+      }
+      kx = L.aLo[0] + cur % L.width;
+      ky = L.aLo[1] + cur / L.width;
+      px = p.start[0] + (double)kx * res;
+      py = p.start[1] + (double)ky * res;
+      if (mask != NULL) {
+        bits = mask[(std::ptrdiff_t)kx * p.dem.rows + (std::ptrdiff_t)ky];
+      } else {
+        zc = astarTerrain(p, a, cur, px, py);
+      }
+      for (d = 0; d < 8; d++) {
+        if (!((bits >> d) & 1u)) {
+          continue;
+        }
+        nx = kx + astarMoveDirs[d][0];
+        ny = ky + astarMoveDirs[d][1];
+        if (nx < L.kLo[0] || nx > L.kHi[0] || ny < L.kLo[1] ||
+            ny > L.kHi[1]) {
+          continue;
+        }
+        nb = (int32_t)((ny - L.aLo[1]) * L.width + (nx - L.aLo[0]));
+        g = a.g[cur] + ((d < 4) ? res : diag);
+        if (a.stamp[nb] == a.gen && !(g < a.g[nb])) {
+          continue;
+        }
+        x = p.start[0] + (double)nx * res;
+        y = p.start[1] + (double)ny * res;
+        if (mask == NULL) {
+          if (astarObstacleAt(p.obs, x, y)) {
+            continue;
+          }
+          zn = astarTerrain(p, a, nb, x, y);
+          if (astarTooSteep(zc, zn, step2[d >= 4], tan2)) {
+            continue;
+          }
+        }
+        h = astarGoalEstimate(p, L, gb, nb);
+        if (!(h < inf)) {
+          continue;
+        }
+        if (a.stamp[nb] != a.gen) {
+          a.relax(nb, cur, g, g + w * h);
+          a.round[nb] = 0;
+        } else if (a.heapPos[nb] >= 0) {
+          a.relax(nb, cur, g, g + w * h);
+        } else {
+          /*  Closed: reopen now, or in the next iteration if this one
+           *  already expanded it */
+          a.g[nb] = g;
+          a.f[nb] = g + w * h;
+          a.parent[nb] = cur;
+          if (a.round[nb] == iter) {
+            incons.push_back(nb);
+          } else {
+            a.reopen(nb);
+          }
+        }
+        if (g < gGoal && std::hypot(x - p.goal[0], y - p.goal[1]) < res) {
+          gGoal = g;
+          goalId = nb;
+        }
+      }
+    }
+
+    stats.elapsedUs = std::chrono::duration<double, std::micro>(
+                          std::chrono::steady_clock::now() - t0)
+                          .count();
+    if (goalId < 0) {
+      break; /* no path yet: out of budget, or none exists */
+    }
+    if (!outOfBudget) {
+      stats.iterations++;
+      wDone = w;
+    }
+    lo = astarOpenBound(p, L, gb, a, incons);
+    stats.cost = gGoal;
+    stats.weight = wDone;
+    stats.bound = std::max(1.0, std::min(wDone, lo > 0.0 ? gGoal / lo : inf));
+    if (stats.history.empty() ||
+        stats.history[stats.history.size() - 2] > gGoal ||
+        stats.history.back() > stats.bound) {
+      stats.history.push_back(stats.elapsedUs);
+      stats.history.push_back(gGoal);
+      stats.history.push_back(stats.bound);
+    }
+    if (outOfBudget || stats.bound <= 1.0 || w <= 1.0) {
+      break;
+    }
+
+    /*  Lower the weight and resume: INCONS rejoins OPEN, keys recomputed */
+    w = std::max(1.0, std::min(w - opt.weightStep, stats.bound));
+    iter++;
+    for (k = 0; k < incons.size(); k++) {
+      if (a.heapPos[incons[k]] < 0) {
+        a.reopen(incons[k]);
+      }
+    }
+    incons.clear();
+    for (k = 0; k < a.heap.size(); k++) {
+      a.f[a.heap[k]] =
+          a.g[a.heap[k]] + w * astarGoalEstimate(p, L, gb, a.heap[k]);
+    }
+    a.reorder();
+  }
+
+  if (goalId >= 0) {
+    /*  Ancestors improved since gGoal was set can only shorten the path */
+    astarTrace(p, L, a, goalId, out);
+    out.status = astarFound;
+    stats.cost = 0.0;
+    for (k = 1; k < out.x.size(); k++) {
+      stats.cost += (out.x[k] != out.x[k - 1] && out.y[k] != out.y[k - 1])
+                        ? diag
+                        : res;
+    }
+  } else if (outOfBudget && bestClosed >= 0) {
+    astarTrace(p, L, a, bestClosed, out);
+    out.status = astarCapped;
+  } else {
+    out.x.clear();
+    out.y.clear();
+    out.status = astarNoPath;
+  }
+  return true;
+}
+
+/* End of astarSearch.cpp */
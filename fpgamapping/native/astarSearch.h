@@ -0,0 +1,165 @@
+/*
+ * astarSearch.h
+ *
+ * Grid A* engine behind astarPathfinding_mex. Same search as
+ * astarPathfinding.m: an 8-connected lattice of spacing resolution
+ * anchored at the start point, Euclidean heuristic, neighbours rejected
+ * when outside the DEM bounds, on an obstacle cell or steeper than
+ * maxSlope, and the goal reached when a popped node is within one
+ * resolution of it. Ties on f pop in insertion order, as min() over the
+ * MATLAB open list does.
+ *
+ * Nodes are lattice indices, the open list is an indexed binary heap with
+ * decrease-key, and g / f / parent live in flat arrays. All per-node
+ * state sits in an AstarArena whose arrays are stamped with a query
+ * generation, so a new query costs nothing to reset and the memory is
+ * reused for as long as the arena lives.
+ *
+ * With a traversability mask (astarTraversability.h) the bounds, obstacle
+ * and slope tests become one bit test per neighbour. The mask is indexed
+ * by DEM post, so it is used when the start sits on a post and the
+ * lattice is the post grid; otherwise the edges are tested directly.
+ *
+ * The heuristic is params.astarHeuristic to the goal point. With a
+ * landmark table (astarLandmarks.h) it is raised to the ALT bound
+ * wherever the lattice is the post grid, whether or not a mask is given;
+ * the bound is admissible, so paths keep their optimal length.
+ *
+ * astarJumpSearch is Jump Point Search over the same lattice for uniform
+ * cost grids: only the bounds and obstacle cells decide where a move may
+ * go (maxSlope and the mask are not consulted, so steep ground has to be
+ * in the obstacle grid, as obstacleGrid.m puts it). Straight and diagonal
+ * runs through open space are scanned without touching the open list,
+ * and only jump points are expanded (always with the Euclidean
+ * heuristic); the returned path is still every lattice step and has the
+ * optimal length.
+ *
+ * astarAnytimeSearch is ARA* for a wall-clock budget: weighted A* with
+ * f = g + w * h finds a first path quickly, then w is lowered step by
+ * step and the search resumes from the same arena. Nodes whose g drops
+ * after they were closed wait in an INCONS list, and at each new weight
+ * they rejoin the open list and every open key is recomputed in place
+ * (one heapify), so nothing is searched twice from scratch. Its estimate
+ * is the Euclidean distance to the goal circle (less one resolution),
+ * raised to the ALT bound when landmarks apply; being consistent, it
+ * makes cost / min(g + h over OPEN and INCONS) a proven suboptimality
+ * bound on whatever path is returned when the budget runs out.
+ *
+ */
+
+#pragma once
+
+/* Include files */
+#include "astarLandmarks.h"
+#include "astarTraversability.h"
+#include "demKernel.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Type Definitions */
+/*  params.astarHeuristic; the estimate is to the goal point */
+enum AstarHeuristic {
+  astarHeuristicEuclidean = 0,
+  astarHeuristicManhattan = 1, /* |dx| + |dy|, overestimates diagonals */
+  astarHeuristicDiagonal = 2   /* octile distance */
+};
+
+struct AstarProblem {
+  DemGrid dem;          /* terrain for the slope test */
+  double bounds[4];     /* xMin, xMax, yMin, yMax the path must stay in */
+  AstarObstacles obs;
+  double maxSlope;      /* degrees */
+  const uint8_t *mask;  /* traversability per DEM post, or NULL */
+  double start[2];
+  double goal[2];
+  double resolution;    /* lattice spacing */
+  int64_t maxExpansions;
+  AstarHeuristic heuristic;
+  const AstarLandmarks *landmarks; /* ALT tables per DEM post, or NULL */
+};
+
+enum AstarStatus { astarFound = 0, astarCapped = 1, astarNoPath = 2 };
+
+struct AstarAnytime {
+  double weight;     /* first heuristic weight, >= 1 */
+  double weightStep; /* taken off the weight after each solution */
+  double budgetUs;   /* wall clock in microseconds, Inf = none */
+};
+
+struct AstarAnytimeStats {
+  int32_t iterations;          /* weights searched to completion */
+  double weight;               /* last weight completed */
+  double bound;                /* cost <= bound * optimal cost */
+  double cost;                 /* of the returned path, Inf if none */
+  double elapsedUs;
+  std::vector<double> history; /* per solution: elapsedUs, g, bound */
+};
+
+struct AstarResult {
+  std::vector<double> x; /* start to end, lattice positions */
+  std::vector<double> y;
+  int64_t nodesExpanded;
+  AstarStatus status;
+};
+
+class AstarArena {
+public:
+  AstarArena();
+
+  /*  Size the arrays for n nodes and open a new query generation */
+  void begin(std::size_t n);
+
+  /*  Open id with (g, f) via parent, or lower it if it is already open */
+  void relax(int32_t id, int32_t from, double gNew, double fNew);
+
+  /*  Remove and close the open node with the lowest f */
+  int32_t pop();
+
+  /*  Put a closed node back on the open list at its current f */
+  void reopen(int32_t id);
+
+  /*  Restore heap order after f was rewritten for open nodes */
+  void reorder();
+
+  bool closed(int32_t id) const
+  {
+    return stamp[id] == gen && heapPos[id] < 0;
+  }
+
+  std::vector<double> g;
+  std::vector<double> f;
+  std::vector<double> z;        /* terrain under the node (zStamp) */
+  std::vector<int32_t> parent;
+  std::vector<int32_t> heapPos; /* index in heap, or -1 when closed */
+  std::vector<uint32_t> seq;    /* insertion order, breaks f ties */
+  std::vector<uint32_t> stamp;  /* == gen: node seen this query */
+  std::vector<uint32_t> zStamp; /* == gen: z cached this query */
+  std::vector<uint32_t> round;  /* anytime search: iteration closing it */
+  std::vector<int32_t> heap;
+  uint32_t gen;
+  uint32_t nextSeq;
+
+private:
+  bool before(int32_t u, int32_t v) const;
+  void siftUp(int32_t pos);
+  void siftDown(int32_t pos);
+};
+
+/* Function Declarations */
+bool astarSearch(const AstarProblem &p, AstarArena &arena, AstarResult &out,
+                 const char **err);
+
+bool astarJumpSearch(const AstarProblem &p, AstarArena &arena,
+                     AstarResult &out, const char **err);
+
+/*
+ * Anytime search; status is astarCapped only when the budget or
+ * p.maxExpansions ran out before any path was found (out is then the
+ * lowest-f closed node, as in astarSearch).
+ */
+bool astarAnytimeSearch(const AstarProblem &p, const AstarAnytime &opt,
+                        AstarArena &arena, AstarResult &out,
+                        AstarAnytimeStats &stats, const char **err);
+
+/* End of astarSearch.h */
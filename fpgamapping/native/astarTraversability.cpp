@@ -0,0 +1,184 @@
+/*
+ * astarTraversability.cpp
+ *
+ * Traversability mask over the DEM posts (see astarTraversability.h).
+ * Columns are swept west to east with the elevation and obstacle state
+ * of three neighbouring columns held in rolling buffers, so each post is
+ * interpolated and looked up once.
+ *
+ */
+
+/* Include files */
+#include "astarTraversability.h"
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+/* Variable Definitions */
+const int32_t astarMoveDirs[8][2] = {{1, 0},  {-1, 0}, {0, 1},  {0, -1},
+                                     {1, 1},  {1, -1}, {-1, 1}, {-1, -1}};
+
+/* Function Definitions */
+double astarSlopeTan2(double maxSlope)
+{
+  double t;
+  if (maxSlope < 0.0) {
+    return -1.0; /* even flat moves exceed a negative limit */
+  }
+  if (!(maxSlope < 90.0)) {
+    return std::numeric_limits<double>::infinity(); /* incl. NaN */
+  }
+  t = std::tan(maxSlope * 3.14159265358979323846 / 180.0);
+  return t * t;
+}
+
+bool astarTraversabilityBuild(const DemGrid &dem, const double bounds[4],
+                              const AstarObstacles &obs, double maxSlope,
+                              uint8_t *mask, const char **err)
+{
+  const std::ptrdiff_t rows = dem.rows;
+  const std::ptrdiff_t cols = dem.cols;
+  const double res = dem.resolution;
+  const double tan2 = astarSlopeTan2(maxSlope);
+  const double step2[2] = {res * res, 2.0 * res * res};
+  std::vector<double> zBuf(3 * (std::size_t)rows);
+  std::vector<uint8_t> okBuf(3 * (std::size_t)rows);
+  const double *z[3];
+  const uint8_t *ok[3];
+  double *zc;
+  uint8_t *oc;
+  std::ptrdiff_t i;
+  std::ptrdiff_t j;
+  std::ptrdiff_t c;
+  std::ptrdiff_t ni;
+  std::ptrdiff_t nj;
+  int32_t d;
+  uint8_t bits;
+  double x;
+  double y;
+
+  if (!(res > 0.0)) {
+    *err = "resolution must be positive";
+    return false;
+  }
+
+  /*  Column c lives in slot c % 3; ok = inside the bounds and free */
+  for (i = 0; i <= cols; i++) {
+    if (i < cols) {
+      zc = &zBuf[(std::size_t)(i % 3) * rows];
+      oc = &okBuf[(std::size_t)(i % 3) * rows];
+      x = dem.xMin + (double)i * res;
+      for (j = 0; j < rows; j++) {
+        y = dem.yMin + (double)j * res;
+        zc[j] = demInterpolatePoint(dem, x, y);
+        oc[j] = x >= bounds[0] && x <= bounds[1] && y >= bounds[2] &&
+                y <= bounds[3] && !astarObstacleAt(obs, x, y);
+      }
+    }
+    if (i == 0) {
+      continue;
+    }
+
+    /*  Emit column i - 1 now that columns i - 2 .. i are available */
+    ni = i - 1;
+    for (d = 0; d < 3; d++) {
+      c = (ni + 2 + d) % 3; /* slot of column ni - 1 + d */
+      z[d] = &zBuf[(std::size_t)c * rows];
+      ok[d] = &okBuf[(std::size_t)c * rows];
+    }
+    for (j = 0; j < rows; j++) {
+      bits = 0;
+      for (d = 0; d < 8; d++) {
+        c = ni + astarMoveDirs[d][0];
+        nj = j + astarMoveDirs[d][1];
+        if (c < 0 || c >= cols || nj < 0 || nj >= rows) {
+          continue;
+        }
+        if (!ok[1 + astarMoveDirs[d][0]][nj]) {
+          continue;
+        }
+        if (astarTooSteep(z[1][j], z[1 + astarMoveDirs[d][0]][nj],
+                          step2[d >= 4], tan2)) {
+          continue;
+        }
+        bits |= (uint8_t)(1u << d);
+      }
+      mask[ni * rows + j] = bits;
+    }
+  }
+  return true;
+}
+
+void astarTraversabilityPatch(const DemGrid &dem, const double bounds[4],
+                              const AstarObstacles &obs, double maxSlope,
+                              int32_t i0, int32_t i1, int32_t j0, int32_t j1,
+                              uint8_t *mask)
+{
+  const double res = dem.resolution;
+  const double tan2 = astarSlopeTan2(maxSlope);
+  const double step2[2] = {res * res, 2.0 * res * res};
+  std::vector<double> z;
+  std::vector<uint8_t> ok;
+  std::ptrdiff_t wi0;
+  std::ptrdiff_t wj0;
+  std::ptrdiff_t wRows;
+  std::ptrdiff_t wCols;
+  std::ptrdiff_t w;
+  std::ptrdiff_t nw;
+  std::ptrdiff_t i;
+  std::ptrdiff_t j;
+  std::ptrdiff_t ni;
+  std::ptrdiff_t nj;
+  int32_t d;
+  uint8_t bits;
+  double x;
+  double y;
+
+  i0 = std::max(i0, (int32_t)0);
+  j0 = std::max(j0, (int32_t)0);
+  i1 = std::min(i1, dem.cols - 1);
+  j1 = std::min(j1, dem.rows - 1);
+  if (i0 > i1 || j0 > j1) {
+    return;
+  }
+
+  /*  Elevation and landability of the window plus a one-post margin */
+  wi0 = std::max(i0 - 1, 0);
+  wj0 = std::max(j0 - 1, 0);
+  wCols = std::min(i1 + 1, dem.cols - 1) - wi0 + 1;
+  wRows = std::min(j1 + 1, dem.rows - 1) - wj0 + 1;
+  z.resize((std::size_t)(wRows * wCols));
+  ok.resize((std::size_t)(wRows * wCols));
+  for (i = 0; i < wCols; i++) {
+    x = dem.xMin + (double)(wi0 + i) * res;
+    for (j = 0; j < wRows; j++) {
+      y = dem.yMin + (double)(wj0 + j) * res;
+      w = i * wRows + j;
+      z[w] = demInterpolatePoint(dem, x, y);
+      ok[w] = x >= bounds[0] && x <= bounds[1] && y >= bounds[2] &&
+              y <= bounds[3] && !astarObstacleAt(obs, x, y);
+    }
+  }
+
+  for (i = i0; i <= i1; i++) {
+    for (j = j0; j <= j1; j++) {
+      w = (i - wi0) * wRows + j - wj0;
+      bits = 0;
+      for (d = 0; d < 8; d++) {
+        ni = i + astarMoveDirs[d][0];
+        nj = j + astarMoveDirs[d][1];
+        if (ni < 0 || ni >= dem.cols || nj < 0 || nj >= dem.rows) {
+          continue;
+        }
+        nw = (ni - wi0) * wRows + nj - wj0;
+        if (!ok[nw] || astarTooSteep(z[w], z[nw], step2[d >= 4], tan2)) {
+          continue;
+        }
+        bits |= (uint8_t)(1u << d);
+      }
+      mask[i * (std::ptrdiff_t)dem.rows + j] = bits;
+    }
+  }
+}
+
+/* End of astarTraversability.cpp */
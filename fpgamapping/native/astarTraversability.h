@@ -0,0 +1,82 @@
+/*
+ * astarTraversability.h
+ *
+ * Edge legality for the 8-connected planners. A traversability mask holds
+ * one byte per DEM post; bit d is set when the move astarMoveDirs[d] out
+ * of that post is allowed: the neighbour post lies inside the bounds, is
+ * not an obstacle cell and the climb to it is not steeper than maxSlope.
+ * Built once per (DEM, obstacle grid, maxSlope), it turns neighbour
+ * expansion into a single byte load.
+ *
+ * The slope test compares dz^2 against tan(maxSlope)^2 * step^2, so no
+ * trig runs per edge. A NaN elevation at either end never counts as steep,
+ * as in astarPathfinding.m.
+ *
+ */
+
+#pragma once
+
+/* Include files */
+#include "demKernel.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/* Type Definitions */
+/*  obstacles.grid view: column-major, nonzero = blocked */
+struct AstarObstacles {
+  const uint8_t *cells; /* NULL when there is no obstacle grid */
+  int32_t rows;
+  int32_t cols;
+  double x0; /* obstacles.bounds(1) and (3) */
+  double y0;
+  double res;
+};
+
+/* Variable Definitions */
+/*  Move order of astarPathfinding.m getNeighbors; bit d of a mask byte */
+extern const int32_t astarMoveDirs[8][2];
+
+/* Function Declarations */
+/*  Threshold for astarTooSteep: tan(maxSlope)^2 for maxSlope in degrees */
+double astarSlopeTan2(double maxSlope);
+
+bool astarTraversabilityBuild(const DemGrid &dem, const double bounds[4],
+                              const AstarObstacles &obs, double maxSlope,
+                              uint8_t *mask, const char **err);
+
+/*  Rebuild the bytes of posts i0..i1 x j0..j1 (clamped) after obstacle
+ *  cells changed; the result matches a full build bit for bit */
+void astarTraversabilityPatch(const DemGrid &dem, const double bounds[4],
+                              const AstarObstacles &obs, double maxSlope,
+                              int32_t i0, int32_t i1, int32_t j0, int32_t j1,
+                              uint8_t *mask);
+
+/* Function Definitions */
+/*  isObstacleAtPoint: nearest obstacle cell, outside the grid is free */
+static inline bool astarObstacleAt(const AstarObstacles &obs, double x,
+                                   double y)
+{
+  double xi;
+  double yi;
+  if (obs.cells == NULL) {
+    return false;
+  }
+  xi = std::round((x - obs.x0) / obs.res);
+  yi = std::round((y - obs.y0) / obs.res);
+  if (!(xi >= 0 && xi < obs.cols && yi >= 0 && yi < obs.rows)) {
+    return false;
+  }
+  return obs.cells[(std::size_t)xi * (std::size_t)obs.rows +
+                   (std::size_t)yi] != 0;
+}
+
+/*  isTerrainTooSteep for a step of squared length step2 */
+static inline bool astarTooSteep(double z1, double z2, double step2,
+                                 double tan2)
+{
+  double dz = z2 - z1;
+  return dz * dz > tan2 * step2; /* false when either z is NaN */
+}
+
+/* End of astarTraversability.h */
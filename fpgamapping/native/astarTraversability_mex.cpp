@@ -0,0 +1,50 @@
+/*
+ * astarTraversability_mex.cpp
+ *
+ * MEX gateway: mask = astarTraversability_mex(demData, obstacles, maxSlope)
+ *
+ * Builds the per-post 8-direction traversability mask of
+ * astarTraversability.cpp as a uint8 array the size of demData.Z. Moves
+ * must stay inside demData.xMin/xMax/yMin/yMax.
+ *
+ */
+
+/* Include files */
+#include "astarTraversability.h"
+#include "mexUtil.h"
+
+/* Function Definitions */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  static const char *errId = "astarTraversability:InvalidInput";
+  std::vector<uint8_t> cells;
+  AstarObstacles obs;
+  DemGrid dem;
+  double bounds[4];
+  const char *err = "";
+  if (nrhs != 3) {
+    mexErrMsgIdAndTxt(errId, "Usage: mask = astarTraversability_mex("
+                             "demData, obstacles, maxSlope)");
+  }
+  if (nlhs > 1) {
+    mexErrMsgIdAndTxt(errId, "Too many output arguments");
+  }
+  dem = mexDemGridFromStruct(prhs[0], errId);
+  bounds[0] = mexScalarField(prhs[0], "xMin", errId);
+  bounds[1] = mexScalarField(prhs[0], "xMax", errId);
+  bounds[2] = mexScalarField(prhs[0], "yMin", errId);
+  bounds[3] = mexScalarField(prhs[0], "yMax", errId);
+  obs = mexAstarObstacles(prhs[1], cells, errId);
+  if (!mxIsDouble(prhs[2]) || mxGetNumberOfElements(prhs[2]) != 1) {
+    mexErrMsgIdAndTxt(errId, "maxSlope must be a double scalar");
+  }
+
+  plhs[0] = mxCreateNumericMatrix(dem.rows, dem.cols, mxUINT8_CLASS, mxREAL);
+  if (!astarTraversabilityBuild(dem, bounds, obs, mxGetScalar(prhs[2]),
+                                mxGetUint8s(plhs[0]), &err)) {
+    mxDestroyArray(plhs[0]);
+    mexErrMsgIdAndTxt(errId, "%s", err);
+  }
+}
+
+/* End of astarTraversability_mex.cpp */
@@ -0,0 +1,407 @@
+/*
+ * demAsciiParse.cpp
+ *
+ * Multi-threaded ESRI ASCII grid parser, see demAsciiParse.h.
+ *
+ * Two passes over the body, both split into the same line-aligned chunks:
+ * the first counts data lines per chunk (memchr per line) so every chunk
+ * knows the file row it starts at; the second parses the values.
+ * Numbers take an exact fast path (Clinger: <= 19 digits, mantissa below
+ * 2^53, |exponent| <= 22 is one correctly rounded multiply or divide) and
+ * fall back to strtod otherwise, so results match MATLAB's str2double.
+ *
+ */
+
+/* Include files */
+#include "demAsciiParse.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <vector>
+
+/* Type Definitions */
+struct DemAsciiChunk {
+  const char *begin;
+  const char *end;
+  int64_t firstRow; /* file row (0 = top) of the first data line */
+  int64_t rows;     /* data lines in the chunk (pass 1) */
+  int64_t badLine;  /* file row of the first error, or -1 */
+  int64_t badCount; /* values found on that line */
+  bool badNumber;   /* error was an unparsable token, not a count */
+};
+
+/* Variable Definitions */
+static const double demPow10[23] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+/*  Below this many body bytes per thread, threads cost more than they save */
+static const std::size_t demAsciiMinChunk = 1 << 20;
+
+/* Function Declarations */
+static inline bool demIsSpace(char c);
+static bool demKeyIs(const char *key, std::size_t len, const char *name);
+static const char *demParseNumber(const char *p, const char *end,
+                                  double *out);
+static void demCountRows(DemAsciiChunk *chunk);
+static void demParseRows(DemAsciiChunk *chunk, const DemAsciiHeader *hdr,
+                         double *Z);
+static void demRunChunks(std::vector<DemAsciiChunk> &chunks,
+                         const DemAsciiHeader *hdr, double *Z);
+
+/* Function Definitions */
+static inline bool demIsSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' ||
+         c == '\v';
+}
+
+/*  Case-insensitive match of a header key */
+static bool demKeyIs(const char *key, std::size_t len, const char *name)
+{
+  std::size_t k;
+  if (std::strlen(name) != len) {
+    return false;
+  }
+  for (k = 0; k < len; k++) {
+    const char c = (key[k] >= 'A' && key[k] <= 'Z') ? key[k] + 32 : key[k];
+    if (c != name[k]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Parse the number starting at p (p < end, not whitespace). Returns the
+ * first character after it, or NULL if the token is not a number.
+ */
+static const char *demParseNumber(const char *p, const char *end, double *out)
+{
+  const char *start = p;
+  const char *q;
+  uint64_t mant = 0;
+  int digits = 0;
+  int exp10 = 0;
+  int expVal = 0;
+  bool neg = false;
+  bool expNeg = false;
+  bool any = false;
+  char buf[64];
+  char *stop;
+  std::size_t len;
+  if (*p == '-' || *p == '+') {
+    neg = (*p == '-');
+    p++;
+  }
+  for (; p < end && *p >= '0' && *p <= '9'; p++) {
+    any = true;
+    if (digits < 19) {
+      mant = mant * 10 + (uint64_t)(*p - '0');
+      digits += (mant != 0);
+    } else {
+      exp10++;
+      digits++;
+    }
+  }
+  if (p < end && *p == '.') {
+    for (p++; p < end && *p >= '0' && *p <= '9'; p++) {
+      any = true;
+      if (digits < 19) {
+        mant = mant * 10 + (uint64_t)(*p - '0');
+        digits += (mant != 0);
+        exp10--;
+      } else {
+        digits++;
+      }
+    }
+  }
+  if (any && p < end && (*p == 'e' || *p == 'E')) {
+    q = p + 1;
+    if (q < end && (*q == '-' || *q == '+')) {
+      expNeg = (*q == '-');
+      q++;
+    }
+    if (q < end && *q >= '0' && *q <= '9') {
+      for (; q < end && *q >= '0' && *q <= '9'; q++) {
+        if (expVal < 100000) {
+          expVal = expVal * 10 + (*q - '0');
+        }
+      }
+      exp10 += expNeg ? -expVal : expVal;
+      p = q;
+    }
+  }
+  if (any && (p == end || demIsSpace(*p)) && digits <= 19 &&
+      mant <= ((uint64_t)1 << 53) && exp10 >= -22 && exp10 <= 22) {
+    double v = (double)mant;
+    v = exp10 < 0 ? v / demPow10[-exp10] : v * demPow10[exp10];
+    *out = neg ? -v : v;
+    return p;
+  }
+  /*  Slow path: long mantissas, big exponents, nan/inf */
+  for (q = start; q < end && !demIsSpace(*q); q++) {
+  }
+  len = (std::size_t)(q - start);
+  if (len == 0 || len >= sizeof(buf)) {
+    return NULL;
+  }
+  std::memcpy(buf, start, len);
+  buf[len] = '\0';
+  *out = std::strtod(buf, &stop);
+  return stop == buf + len ? q : NULL;
+}
+
+/*  Pass 1: data lines (lines with any non-blank character) in the chunk */
+static void demCountRows(DemAsciiChunk *chunk)
+{
+  const char *p = chunk->begin;
+  const char *end = chunk->end;
+  int64_t rows = 0;
+  while (p < end) {
+    const char *nl =
+        (const char *)std::memchr(p, '\n', (std::size_t)(end - p));
+    const char *lineEnd = nl == NULL ? end : nl;
+    while (p < lineEnd && demIsSpace(*p)) {
+      p++;
+    }
+    rows += (p < lineEnd);
+    p = lineEnd + 1;
+  }
+  chunk->rows = rows;
+}
+
+/*  Pass 2: parse the chunk's lines into their flipped rows of Z */
+static void demParseRows(DemAsciiChunk *chunk, const DemAsciiHeader *hdr,
+                         double *Z)
+{
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  const double nodata = hdr->nodata;
+  const int64_t nrows = hdr->nrows;
+  const char *p = chunk->begin;
+  const char *end = chunk->end;
+  int64_t row = chunk->firstRow;
+  while (p < end) {
+    /*  One line: Z row (nrows - 1 - row), column-major stride nrows */
+    double *dst = Z + (nrows - 1 - row);
+    int64_t col = 0;
+    for (;;) {
+      double v;
+      while (p < end && *p != '\n' && demIsSpace(*p)) {
+        p++;
+      }
+      if (p == end || *p == '\n') {
+        break;
+      }
+      p = demParseNumber(p, end, &v);
+      if (p == NULL || col >= hdr->ncols) {
+        chunk->badLine = row;
+        chunk->badCount = col + 1;
+        chunk->badNumber = (p == NULL);
+        return;
+      }
+      dst[nrows * col++] = (v == nodata) ? nan : v;
+    }
+    if (p < end) {
+      p++; /* newline */
+    }
+    if (col == 0) {
+      continue; /* blank line */
+    }
+    if (col != hdr->ncols) {
+      chunk->badLine = row;
+      chunk->badCount = col;
+      chunk->badNumber = false;
+      return;
+    }
+    row++;
+  }
+}
+
+static void demRunChunks(std::vector<DemAsciiChunk> &chunks,
+                         const DemAsciiHeader *hdr, double *Z)
+{
+  std::vector<std::thread> pool;
+  std::size_t t;
+  /*  Chunk 0 runs on the calling thread; if threads cannot be created the
+   *  remaining chunks run there too */
+  for (t = 1; t < chunks.size(); t++) {
+    try {
+      if (Z == NULL) {
+        pool.push_back(std::thread(demCountRows, &chunks[t]));
+      } else {
+        pool.push_back(std::thread(demParseRows, &chunks[t], hdr, Z));
+      }
+    } catch (...) {
+      break;
+    }
+  }
+  for (; t < chunks.size(); t++) {
+    if (Z == NULL) {
+      demCountRows(&chunks[t]);
+    } else {
+      demParseRows(&chunks[t], hdr, Z);
+    }
+  }
+  if (Z == NULL) {
+    demCountRows(&chunks[0]);
+  } else {
+    demParseRows(&chunks[0], hdr, Z);
+  }
+  for (t = 0; t < pool.size(); t++) {
+    pool[t].join();
+  }
+}
+
+/*
+ * Read the "key value" header lines. The body starts at the first line
+ * whose first token is not a recognised key.
+ */
+bool demAsciiReadHeader(const char *data, std::size_t size,
+                        DemAsciiHeader &hdr, char *err)
+{
+  const char *p = data;
+  const char *end = data + size;
+  unsigned seen = 0; /* bit per required key */
+  hdr.nodata = std::numeric_limits<double>::quiet_NaN();
+  hdr.ncols = 0;
+  hdr.nrows = 0;
+  hdr.xllcorner = 0.0;
+  hdr.yllcorner = 0.0;
+  hdr.cellsize = 0.0;
+  for (;;) {
+    const char *line;
+    const char *key;
+    std::size_t keyLen;
+    double v;
+    while (p < end && demIsSpace(*p)) {
+      p++;
+    }
+    line = p;
+    key = p;
+    while (p < end && !demIsSpace(*p)) {
+      p++;
+    }
+    keyLen = (std::size_t)(p - key);
+    while (p < end && *p != '\n' && demIsSpace(*p)) {
+      p++;
+    }
+    if (keyLen == 0 || keyLen > 13 || p == end || *p == '\n' ||
+        !(((*key | 0x20) >= 'a') && ((*key | 0x20) <= 'z')) ||
+        (p = demParseNumber(p, end, &v)) == NULL) {
+      hdr.bodyOffset = (std::size_t)(line - data);
+      break;
+    }
+    if (demKeyIs(key, keyLen, "ncols")) {
+      hdr.ncols = (v >= 1.0 && v <= 2147483647.0) ? (int32_t)v : 0;
+      seen |= 1;
+    } else if (demKeyIs(key, keyLen, "nrows")) {
+      hdr.nrows = (v >= 1.0 && v <= 2147483647.0) ? (int32_t)v : 0;
+      seen |= 2;
+    } else if (demKeyIs(key, keyLen, "xllcorner") ||
+               demKeyIs(key, keyLen, "xllcenter")) {
+      hdr.xllcorner = v;
+      seen |= 4;
+    } else if (demKeyIs(key, keyLen, "yllcorner") ||
+               demKeyIs(key, keyLen, "yllcenter")) {
+      hdr.yllcorner = v;
+      seen |= 8;
+    } else if (demKeyIs(key, keyLen, "cellsize")) {
+      hdr.cellsize = v;
+      seen |= 16;
+    } else if (demKeyIs(key, keyLen, "nodata_value")) {
+      hdr.nodata = v;
+    } else {
+      hdr.bodyOffset = (std::size_t)(line - data);
+      break;
+    }
+  }
+  if (seen != 31) {
+    std::snprintf(err, demAsciiErrLen,
+                  "Missing required header field (need ncols, nrows, "
+                  "xllcorner, yllcorner, cellsize)");
+    return false;
+  }
+  if (hdr.ncols < 1 || hdr.nrows < 1 || !(hdr.cellsize > 0.0)) {
+    std::snprintf(err, demAsciiErrLen,
+                  "Invalid header: ncols/nrows must be positive integers "
+                  "and cellsize positive");
+    return false;
+  }
+  return true;
+}
+
+bool demAsciiParseBody(const char *data, std::size_t size,
+                       const DemAsciiHeader &hdr, int nThreads, double *Z,
+                       char *err)
+{
+  std::vector<DemAsciiChunk> chunks;
+  const char *body = data + hdr.bodyOffset;
+  const char *end = data + size;
+  const std::size_t bodyLen = (std::size_t)(end - body);
+  std::size_t nChunks;
+  std::size_t c;
+  int64_t row = 0;
+  if (nThreads < 1) {
+    nThreads = (int)std::thread::hardware_concurrency();
+  }
+  nChunks = bodyLen / demAsciiMinChunk + 1;
+  if (nThreads >= 1 && nChunks > (std::size_t)nThreads) {
+    nChunks = (std::size_t)nThreads;
+  }
+  /*  Split near equal byte offsets, then move each cut past a newline */
+  chunks.resize(nChunks);
+  for (c = 0; c < nChunks; c++) {
+    const char *begin = c == 0 ? body : chunks[c - 1].end;
+    const char *cut = end;
+    if (c + 1 < nChunks) {
+      const char *nl;
+      cut = body + bodyLen / nChunks * (c + 1);
+      if (cut < begin) {
+        cut = begin;
+      }
+      nl = (const char *)std::memchr(cut, '\n', (std::size_t)(end - cut));
+      cut = nl == NULL ? end : nl + 1;
+    }
+    chunks[c].begin = begin;
+    chunks[c].end = cut;
+    chunks[c].badLine = -1;
+    chunks[c].badCount = 0;
+    chunks[c].badNumber = false;
+  }
+
+  /*  Pass 1: rows per chunk, prefix-summed into each chunk's first row */
+  demRunChunks(chunks, &hdr, NULL);
+  for (c = 0; c < nChunks; c++) {
+    chunks[c].firstRow = row;
+    row += chunks[c].rows;
+  }
+  if (row != hdr.nrows) {
+    std::snprintf(err, demAsciiErrLen, "File has %lld data rows, expected %d",
+                  (long long)row, (int)hdr.nrows);
+    return false;
+  }
+
+  /*  Pass 2: parse into place */
+  demRunChunks(chunks, &hdr, Z);
+  for (c = 0; c < nChunks; c++) {
+    if (chunks[c].badLine >= 0) {
+      if (chunks[c].badNumber) {
+        std::snprintf(err, demAsciiErrLen, "Row %lld: invalid number",
+                      (long long)chunks[c].badLine + 1);
+      } else {
+        std::snprintf(err, demAsciiErrLen,
+                      "Row %lld has %lld columns, expected %d",
+                      (long long)chunks[c].badLine + 1,
+                      (long long)chunks[c].badCount, (int)hdr.ncols);
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+/* End of demAsciiParse.cpp */
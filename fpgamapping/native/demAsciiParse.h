@@ -0,0 +1,41 @@
+/*
+ * demAsciiParse.h
+ *
+ * Multi-threaded ESRI ASCII grid parser. The caller maps the file (see
+ * mappedFile.h), reads the header, allocates the nrows x ncols output and
+ * hands both to demAsciiParseBody, which splits the body into line-aligned
+ * chunks, parses them in parallel and stores every value straight into
+ * its final column-major, bottom-row-first position (Z = flipud(file)).
+ * Values equal to nodata_value are stored as NaN.
+ *
+ */
+
+#pragma once
+
+/* Include files */
+#include <cstddef>
+#include <cstdint>
+
+/* Type Definitions */
+struct DemAsciiHeader {
+  int32_t ncols;
+  int32_t nrows;
+  double xllcorner; /* also accepts xllcenter */
+  double yllcorner; /* also accepts yllcenter */
+  double cellsize;
+  double nodata;    /* NaN when the file has no nodata_value */
+  std::size_t bodyOffset; /* byte offset of the first data row */
+};
+
+/* Variable Definitions */
+static const std::size_t demAsciiErrLen = 160;
+
+/* Function Declarations */
+bool demAsciiReadHeader(const char *data, std::size_t size,
+                        DemAsciiHeader &hdr, char *err);
+
+bool demAsciiParseBody(const char *data, std::size_t size,
+                       const DemAsciiHeader &hdr, int nThreads, double *Z,
+                       char *err);
+
+/* End of demAsciiParse.h */
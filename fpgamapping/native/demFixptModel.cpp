@@ -0,0 +1,317 @@
+/*
+ * demFixptModel.cpp
+ *
+ * Integer implementation of the fixed-point datapaths in demFixptModel.h.
+ * Rounding follows the fimath names: Floor rounds toward -Inf, Nearest
+ * rounds half-way cases toward +Inf. Wrap keeps the low WordLength bits
+ * (two's complement when signed), Saturate clamps to the type range.
+ *
+ */
+
+/* Include files */
+#include "demFixptModel.h"
+#include <cmath>
+
+/* Variable Definitions */
+/*  demInterpolate_fixpt.m types (Floor / Wrap) */
+static const FixType fixDesignX = {false, 19, 0};
+static const FixType fixDesignY = {false, 23, 0};
+static const FixType fixDesignDiff = {false, 20, 0}; /* u19 - u19 */
+static const FixType fixDesignRes = {false, 4, 0};
+static const FixType fixDesignPos = {false, 16, 9};
+static const FixType fixDesignIndex = {false, 7, 0};
+static const FixType fixDesignWeight = {false, 16, 15};
+static const FixType fixDesignElev = {false, 16, 9};
+static const int32_t fixDesignPosts = 101;
+
+/*  fixpt_config_aws.m types (Nearest / Saturate) */
+static const FixType fixAwsElev = {true, 18, 7};
+static const FixType fixAwsCoord = {false, 22, 12};
+static const FixType fixAwsWeight = {false, 16, 15};
+static const FixType fixAwsInter = {true, 36, 22};
+
+/* Function Declarations */
+static inline int64_t fixFloorShift(int64_t v, int32_t s);
+static inline int64_t fixOverflow(int64_t v, const FixType &t, FixOverflow o);
+static int64_t demFixptDesignPoint(const DemFixptModel &m, int64_t xIn,
+                                   int64_t yIn);
+static int64_t demFixptAwsPoint(const DemFixptModel &m, int64_t xIn,
+                                int64_t yIn);
+
+/* Function Definitions */
+static inline int64_t fixFloorShift(int64_t v, int32_t s)
+{
+  /*  Arithmetic right shift, i.e. floor(v / 2^s), for either sign */
+  return v >= 0 ? (v >> s) : -((-v + ((int64_t)1 << s) - 1) >> s);
+}
+
+static inline int64_t fixOverflow(int64_t v, const FixType &t, FixOverflow o)
+{
+  int64_t lo = t.isSigned ? -((int64_t)1 << (t.wordLength - 1)) : 0;
+  int64_t hi = t.isSigned ? ((int64_t)1 << (t.wordLength - 1)) - 1
+                          : ((int64_t)1 << t.wordLength) - 1;
+  uint64_t u;
+  if (v >= lo && v <= hi) {
+    return v;
+  }
+  if (o == fixSaturate) {
+    return v < lo ? lo : hi;
+  }
+  u = (uint64_t)v & (((uint64_t)1 << t.wordLength) - 1);
+  if (t.isSigned && (u >> (t.wordLength - 1)) != 0) {
+    return (int64_t)u - ((int64_t)1 << t.wordLength);
+  }
+  return (int64_t)u;
+}
+
+int64_t fixFromDouble(double v, const FixType &t, FixRounding r,
+                      FixOverflow o)
+{
+  double q;
+  double span = std::ldexp(1.0, t.wordLength);
+  if (std::isnan(v)) {
+    return 0; /* fi(NaN) stores 0 */
+  }
+  q = std::ldexp(v, t.fractionLength);
+  q = (r == fixNearest) ? std::floor(q + 0.5) : std::floor(q);
+  if (o == fixSaturate || std::isinf(q)) {
+    double lo = t.isSigned ? -span / 2 : 0.0;
+    double hi = t.isSigned ? span / 2 - 1 : span - 1;
+    q = q < lo ? lo : (q > hi ? hi : q);
+    return (int64_t)q;
+  }
+  /*  Wrap in double first: q may not fit in 64 bits */
+  q = std::fmod(q, span);
+  if (q < 0) {
+    q += span;
+  }
+  return fixOverflow((int64_t)q, t, fixWrap);
+}
+
+int64_t fixRescale(int64_t v, int32_t fractionLength, const FixType &t,
+                   FixRounding r, FixOverflow o)
+{
+  int32_t s = fractionLength - t.fractionLength;
+  if (s > 0) {
+    if (r == fixNearest) {
+      v += (int64_t)1 << (s - 1);
+    }
+    v = fixFloorShift(v, s);
+  } else if (s < 0) {
+    v = (int64_t)((uint64_t)v << -s);
+  }
+  return fixOverflow(v, t, o);
+}
+
+double fixToDouble(int64_t v, const FixType &t)
+{
+  return std::ldexp((double)v, -t.fractionLength);
+}
+
+bool demFixptModelInit(DemFixptModel &m, DemFixptProfile profile,
+                       const DemGrid &dem, const char **err)
+{
+  std::vector<double> Zcol;
+  const FixType &elev = (profile == demFixptDesign) ? fixDesignElev
+                                                    : fixAwsElev;
+  FixRounding r = (profile == demFixptDesign) ? fixFloor : fixNearest;
+  FixOverflow o = (profile == demFixptDesign) ? fixWrap : fixSaturate;
+  std::size_t k;
+  if (profile == demFixptDesign) {
+    if (dem.rows < fixDesignPosts || dem.cols < fixDesignPosts) {
+      *err = "the fixpt design addresses a 101 x 101 post grid";
+      return false;
+    }
+  } else {
+    /*  grid_coord spans [0, 1024) cells, index is 11 bits */
+    if (dem.rows < 2 || dem.cols < 2 || dem.rows > 1025 || dem.cols > 1025) {
+      *err = "grid_coord u22.12 covers grids of 2 to 1025 posts per side";
+      return false;
+    }
+  }
+  m.profile = profile;
+  m.rows = dem.rows;
+  m.cols = dem.cols;
+  m.xOrigin = dem.xMin;
+  m.yOrigin = dem.yMin;
+  m.spacing = dem.resolution;
+  m.xMin = fixFromDouble(dem.xMin, fixDesignX, fixFloor, fixWrap);
+  m.yMin = fixFromDouble(dem.yMin, fixDesignY, fixFloor, fixWrap);
+  m.resolution = fixFromDouble(dem.resolution, fixDesignRes, fixFloor,
+                               fixWrap);
+  if (profile == demFixptDesign && m.resolution == 0) {
+    *err = "resolution must be 1 to 15 m for the u4.0 design type";
+    return false;
+  }
+  Zcol.resize((std::size_t)dem.rows * (std::size_t)dem.cols);
+  demGridWindow(dem, 0, 0, dem.rows, dem.cols, &Zcol[0]);
+  m.Z.resize(Zcol.size());
+  for (k = 0; k < Zcol.size(); k++) {
+    m.Z[k] = (int32_t)fixFromDouble(Zcol[k], elev, r, o);
+  }
+  return true;
+}
+
+void demFixptQuantizeInput(const DemFixptModel &m, double x, double y,
+                           int64_t &xIn, int64_t &yIn)
+{
+  if (m.profile == demFixptDesign) {
+    /*  The testbench drives whole meters, rounded to nearest */
+    xIn = fixFromDouble(x, fixDesignX, fixNearest, fixWrap);
+    yIn = fixFromDouble(y, fixDesignY, fixNearest, fixWrap);
+  } else {
+    xIn = fixFromDouble((x - m.xOrigin) / m.spacing, fixAwsCoord,
+                        fixNearest, fixSaturate);
+    yIn = fixFromDouble((y - m.yOrigin) / m.spacing, fixAwsCoord,
+                        fixNearest, fixSaturate);
+  }
+}
+
+static int64_t demFixptDesignPoint(const DemFixptModel &m, int64_t xIn,
+                                   int64_t yIn)
+{
+  const int64_t one = (int64_t)1 << fixDesignWeight.fractionLength;
+  int64_t iFloat;
+  int64_t jFloat;
+  int64_t i;
+  int64_t j;
+  int64_t dx;
+  int64_t dy;
+  int64_t acc;
+  const int32_t *c0;
+  const int32_t *c1;
+
+  /*  fi_signed(x) - x_min is unsigned full precision, so it wraps below
+   *  x_min; divide() keeps 24 fraction bits and the u16.9 cast floors
+   *  again, which equals a single floor of the exact quotient */
+  xIn = fixOverflow(xIn, fixDesignX, fixWrap);
+  yIn = fixOverflow(yIn, fixDesignY, fixWrap);
+  iFloat = fixOverflow(xIn - m.xMin, fixDesignDiff, fixWrap);
+  jFloat = fixOverflow(yIn - m.yMin, fixDesignDiff, fixWrap);
+  iFloat = fixOverflow((iFloat << fixDesignPos.fractionLength) / m.resolution,
+                       fixDesignPos, fixWrap);
+  jFloat = fixOverflow((jFloat << fixDesignPos.fractionLength) / m.resolution,
+                       fixDesignPos, fixWrap);
+
+  i = fixOverflow(iFloat >> fixDesignPos.fractionLength, fixDesignIndex,
+                  fixWrap);
+  j = fixOverflow(jFloat >> fixDesignPos.fractionLength, fixDesignIndex,
+                  fixWrap);
+  if (i >= fixDesignPosts - 1) {
+    i = fixDesignPosts - 2;
+  }
+  if (j >= fixDesignPosts - 1) {
+    j = fixDesignPosts - 2;
+  }
+
+  dx = fixRescale(iFloat - (i << fixDesignPos.fractionLength),
+                  fixDesignPos.fractionLength, fixDesignWeight, fixFloor,
+                  fixWrap);
+  dy = fixRescale(jFloat - (j << fixDesignPos.fractionLength),
+                  fixDesignPos.fractionLength, fixDesignWeight, fixFloor,
+                  fixWrap);
+  if (dx > one) {
+    dx = one;
+  }
+  if (dy > one) {
+    dy = one;
+  }
+
+  /*  u16.9 * s17.15 * s17.15 carries 39 fraction bits; the four-term
+   *  sum stays below 2^50, so nothing is lost before the final cast */
+  c0 = &m.Z[(std::size_t)i * (std::size_t)m.rows + (std::size_t)j];
+  c1 = c0 + m.rows;
+  acc = (int64_t)c0[0] * (one - dx) * (one - dy) +
+        (int64_t)c1[0] * dx * (one - dy) + (int64_t)c0[1] * (one - dx) * dy +
+        (int64_t)c1[1] * dx * dy;
+  return fixRescale(acc,
+                    fixDesignElev.fractionLength +
+                        2 * fixDesignWeight.fractionLength,
+                    fixDesignElev, fixFloor, fixWrap);
+}
+
+static int64_t demFixptAwsPoint(const DemFixptModel &m, int64_t xIn,
+                                int64_t yIn)
+{
+  const int32_t wfl = fixAwsWeight.fractionLength;
+  const int64_t one = (int64_t)1 << wfl;
+  int64_t i;
+  int64_t j;
+  int64_t dx;
+  int64_t dy;
+  int64_t w[4];
+  int64_t acc;
+  int32_t k;
+  const int32_t *c0;
+  const int32_t *c1;
+
+  i = xIn >> fixAwsCoord.fractionLength;
+  j = yIn >> fixAwsCoord.fractionLength;
+  if (i < 0) {
+    i = 0;
+  }
+  if (j < 0) {
+    j = 0;
+  }
+  if (i > m.cols - 2) {
+    i = m.cols - 2;
+  }
+  if (j > m.rows - 2) {
+    j = m.rows - 2;
+  }
+  dx = fixRescale(xIn - (i << fixAwsCoord.fractionLength),
+                  fixAwsCoord.fractionLength, fixAwsWeight, fixNearest,
+                  fixSaturate);
+  dy = fixRescale(yIn - (j << fixAwsCoord.fractionLength),
+                  fixAwsCoord.fractionLength, fixAwsWeight, fixNearest,
+                  fixSaturate);
+  if (dx < 0) {
+    dx = 0;
+  }
+  if (dx > one) {
+    dx = one;
+  }
+  if (dy < 0) {
+    dy = 0;
+  }
+  if (dy > one) {
+    dy = one;
+  }
+
+  /*  Corner weights are products of two u16.15 weights (u32.30),
+   *  rounded back to u16.15 before meeting the elevations */
+  w[0] = (one - dx) * (one - dy);
+  w[1] = dx * (one - dy);
+  w[2] = (one - dx) * dy;
+  w[3] = dx * dy;
+  for (k = 0; k < 4; k++) {
+    w[k] = fixRescale(w[k], 2 * wfl, fixAwsWeight, fixNearest, fixSaturate);
+  }
+
+  /*  (34,22) products cast to s36.22 before the sum (exact), and the
+   *  four-term sum fits the two guard bits */
+  c0 = &m.Z[(std::size_t)i * (std::size_t)m.rows + (std::size_t)j];
+  c1 = c0 + m.rows;
+  acc = fixOverflow((int64_t)c0[0] * w[0], fixAwsInter, fixSaturate) +
+        fixOverflow((int64_t)c1[0] * w[1], fixAwsInter, fixSaturate) +
+        fixOverflow((int64_t)c0[1] * w[2], fixAwsInter, fixSaturate) +
+        fixOverflow((int64_t)c1[1] * w[3], fixAwsInter, fixSaturate);
+  return fixRescale(acc, fixAwsInter.fractionLength, fixAwsElev, fixNearest,
+                    fixSaturate);
+}
+
+int64_t demFixptInterpolate(const DemFixptModel &m, int64_t xIn, int64_t yIn)
+{
+  if (m.profile == demFixptDesign) {
+    return demFixptDesignPoint(m, xIn, yIn);
+  }
+  return demFixptAwsPoint(m, xIn, yIn);
+}
+
+double demFixptOutputValue(const DemFixptModel &m, int64_t zOut)
+{
+  return fixToDouble(zOut, m.profile == demFixptDesign ? fixDesignElev
+                                                       : fixAwsElev);
+}
+
+/* End of demFixptModel.cpp */
@@ -0,0 +1,82 @@
+/*
+ * demFixptModel.h
+ *
+ * Bit-exact integer model of the fixed-point DEM interpolation datapaths.
+ * Every quantity is held as its stored integer (value * 2^FractionLength)
+ * in an int64_t and every cast applies the same rounding and overflow
+ * rules as the MATLAB fi objects, so one lookup is a few integer
+ * operations instead of a chain of fi constructions.
+ *
+ * demFixptDesign models codegen/demInterpolate/fixpt/demInterpolate_fixpt.m
+ * (fimath Floor / Wrap, FullPrecision products and sums):
+ *   x_in, y_in   whole meters (as driven on the HDL ports)
+ *   x_min, y_min u19.0, u23.0     resolution  u4.0
+ *   i_float      u16.9  = floor((x - x_min) * 2^9 / resolution)
+ *   i            u7.0, clamped to 99 (the design addresses 101 x 101 posts)
+ *   dx           u16.15 = i_float - i, clamped to [0, 1]
+ *   Z, z_out     u16.9
+ *
+ * demFixptAws models the datapath described by fixpt_config_aws.m
+ * (fimath Nearest / Saturate, FullPrecision products, CastBeforeSum):
+ *   x_in, y_in   grid_coord u22.12 = (x - xMin) / resolution
+ *   i            index u11.0, clamped to the last full cell
+ *   dx, 1-dx     weight u16.15, clamped to [0, 1]
+ *   w = (1-dx)(1-dy) ...   weight u16.15 (one per corner)
+ *   Z * w        (18,7) x (16,15) = (34,22), summed in intermediate s36.22
+ *   Z, z_out     elevation s18.7
+ *
+ */
+
+#pragma once
+
+/* Include files */
+#include "demKernel.h"
+#include <cstdint>
+#include <vector>
+
+/* Type Definitions */
+enum FixRounding { fixFloor, fixNearest };
+
+enum FixOverflow { fixWrap, fixSaturate };
+
+struct FixType {
+  bool isSigned;
+  int32_t wordLength;
+  int32_t fractionLength;
+};
+
+enum DemFixptProfile { demFixptDesign, demFixptAws };
+
+struct DemFixptModel {
+  DemFixptProfile profile;
+  int32_t rows;
+  int32_t cols;
+  std::vector<int32_t> Z; /* stored elevation words, column-major */
+  int64_t xMin;           /* design: stored x_min / y_min / resolution */
+  int64_t yMin;
+  int64_t resolution;
+  double xOrigin;         /* real-world grid, for input quantization */
+  double yOrigin;
+  double spacing;
+};
+
+/* Function Declarations */
+int64_t fixFromDouble(double v, const FixType &t, FixRounding r,
+                      FixOverflow o);
+
+int64_t fixRescale(int64_t v, int32_t fractionLength, const FixType &t,
+                   FixRounding r, FixOverflow o);
+
+double fixToDouble(int64_t v, const FixType &t);
+
+bool demFixptModelInit(DemFixptModel &m, DemFixptProfile profile,
+                       const DemGrid &dem, const char **err);
+
+void demFixptQuantizeInput(const DemFixptModel &m, double x, double y,
+                           int64_t &xIn, int64_t &yIn);
+
+int64_t demFixptInterpolate(const DemFixptModel &m, int64_t xIn, int64_t yIn);
+
+double demFixptOutputValue(const DemFixptModel &m, int64_t zOut);
+
+/* End of demFixptModel.h */
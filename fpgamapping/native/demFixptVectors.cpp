@@ -0,0 +1,497 @@
+/*
+ * demFixptVectors.cpp
+ *
+ * Stand-alone golden vector generator and checker for the fixed-point DEM
+ * interpolation datapaths modelled in demFixptModel.h. This is a command
+ * line program, not a MEX gateway:
+ *
+ *   g++ -std=c++11 -O2 -pthread -o demFixptVectors demFixptVectors.cpp \
+ *       demFixptModel.cpp demKernel.cpp demAsciiParse.cpp demTileFile.cpp \
+ *       mappedFile.cpp
+ *
+ *   demFixptVectors DEM [-p design|aws] [-n count] [-s seed] [-t threads]
+ *                       [-o vectors.csv] [-w dem_words.txt]
+ *   demFixptVectors DEM [-p design|aws] [-t threads] -c vectors.csv
+ *
+ * DEM is an ESRI ASCII grid (.asc) or a .demt tile file. Generation draws
+ * count points uniformly over the DEM plus one cell of margin (so the
+ * edge clamps are exercised), quantizes them to the profile's input type
+ * and runs the model; vector k depends only on (seed, k), so the output is
+ * identical for any thread count. Without -o only the throughput and a
+ * checksum are printed. -c re-runs the model on an existing file and
+ * reports every mismatch count plus the first failing TestID.
+ *
+ * Vector files are CSV with the header TestID,X_in,Y_in,Z_out where the
+ * last three columns are stored integer words (value * 2^FractionLength)
+ * of the datapath ports, so they feed an HDL testbench directly. -w also
+ * writes the quantized DEM for loading into the core: a "rows cols" line,
+ * then one stored elevation word per line, row by row from the southern
+ * (first) row, west to east.
+ *
+ */
+
+/* Include files */
+#include "demAsciiParse.h"
+#include "demFixptModel.h"
+#include "demKernel.h"
+#include "demTileFile.h"
+#include "mappedFile.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+/* Type Definitions */
+struct VecJob {
+  const DemFixptModel *model;
+  uint64_t seed;
+  uint64_t first;    /* TestID - 1 of the first vector */
+  uint64_t count;
+  double box[4];     /* xLo, xHi, yLo, yHi */
+  bool format;       /* write CSV lines into text */
+  std::vector<char> text;
+  uint64_t checksum;
+};
+
+struct CheckJob {
+  const DemFixptModel *model;
+  const char *begin;
+  const char *end;
+  uint64_t checked;
+  uint64_t mismatches;
+  uint64_t malformed;
+  int64_t firstBad[5]; /* TestID, X_in, Y_in, Z_out, model */
+};
+
+/* Variable Definitions */
+static const uint64_t vecBlock = (uint64_t)1 << 18; /* vectors per thread */
+static const char *vecHeader = "TestID,X_in,Y_in,Z_out\n";
+
+/* Function Declarations */
+static inline uint64_t splitMix64(uint64_t z);
+static inline char *putInt(char *p, int64_t v);
+static inline const char *getInt(const char *p, const char *end, int64_t *v);
+static void runGenerate(VecJob *job);
+static void runCheck(CheckJob *job);
+static bool loadDem(const char *path, MappedFile &file, DemGrid &dem,
+                    std::vector<double> &Z);
+static bool writeWords(const char *path, const DemFixptModel &m);
+static int usage(void);
+
+/* Function Definitions */
+static inline uint64_t splitMix64(uint64_t z)
+{
+  z += 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+static inline char *putInt(char *p, int64_t v)
+{
+  char digits[20];
+  int32_t n = 0;
+  uint64_t u = v < 0 ? (uint64_t)0 - (uint64_t)v : (uint64_t)v;
+  if (v < 0) {
+    *p++ = '-';
+  }
+  do {
+    digits[n++] = (char)('0' + u % 10);
+    u /= 10;
+  } while (u != 0);
+  while (n > 0) {
+    *p++ = digits[--n];
+  }
+  return p;
+}
+
+/*  Parse an optionally signed decimal integer; NULL if there is none */
+static inline const char *getInt(const char *p, const char *end, int64_t *v)
+{
+  bool neg = false;
+  uint64_t u = 0;
+  const char *start;
+  if (p < end && *p == '-') {
+    neg = true;
+    p++;
+  }
+  start = p;
+  while (p < end && *p >= '0' && *p <= '9' && p - start < 19) {
+    u = u * 10 + (uint64_t)(*p - '0');
+    p++;
+  }
+  if (p == start) {
+    return NULL;
+  }
+  *v = neg ? -(int64_t)u : (int64_t)u;
+  return p;
+}
+
+static void runGenerate(VecJob *job)
+{
+  const DemFixptModel &m = *job->model;
+  const double scale = 1.0 / 9007199254740992.0; /* 2^-53 */
+  uint64_t k;
+  uint64_t h;
+  int64_t xIn;
+  int64_t yIn;
+  int64_t z;
+  double x;
+  double y;
+  char *p = NULL;
+  job->checksum = 0;
+  if (job->format) {
+    job->text.resize(job->count * 84);
+    p = &job->text[0];
+  }
+  for (k = job->first; k < job->first + job->count; k++) {
+    h = splitMix64(job->seed ^ (k * 2));
+    x = job->box[0] + (double)(h >> 11) * scale *
+                          (job->box[1] - job->box[0]);
+    h = splitMix64(job->seed ^ (k * 2 + 1));
+    y = job->box[2] + (double)(h >> 11) * scale *
+                          (job->box[3] - job->box[2]);
+    demFixptQuantizeInput(m, x, y, xIn, yIn);
+    z = demFixptInterpolate(m, xIn, yIn);
+    job->checksum += (uint64_t)z * (2 * k + 1); /* order independent */
+    if (job->format) {
+      p = putInt(p, (int64_t)(k + 1));
+      *p++ = ',';
+      p = putInt(p, xIn);
+      *p++ = ',';
+      p = putInt(p, yIn);
+      *p++ = ',';
+      p = putInt(p, z);
+      *p++ = '\n';
+    }
+  }
+  if (job->format) {
+    job->text.resize((std::size_t)(p - &job->text[0]));
+  }
+}
+
+static void runCheck(CheckJob *job)
+{
+  const char *line = job->begin;
+  const char *p;
+  const char *eol;
+  int64_t v[4];
+  int64_t z;
+  int32_t c;
+  job->checked = 0;
+  job->mismatches = 0;
+  job->malformed = 0;
+  job->firstBad[0] = -1;
+  for (; line < job->end; line = eol + 1) {
+    eol = (const char *)std::memchr(line, '\n',
+                                    (std::size_t)(job->end - line));
+    if (eol == NULL) {
+      eol = job->end;
+    }
+    p = line;
+    for (c = 0; c < 4 && p != NULL; c++) {
+      p = getInt(p, eol, &v[c]);
+      if (p != NULL && c < 3) {
+        p = (p < eol && *p == ',') ? p + 1 : NULL;
+      }
+    }
+    if (p == NULL) {
+      /*  Blank lines are skipped, anything else is reported */
+      for (p = line; p < eol && (*p == ' ' || *p == '\r'); p++) {
+      }
+      job->malformed += (p < eol);
+      continue;
+    }
+    z = demFixptInterpolate(*job->model, v[1], v[2]);
+    job->checked++;
+    if (z != v[3]) {
+      if (job->mismatches == 0) {
+        std::memcpy(job->firstBad, v, sizeof(v));
+        job->firstBad[4] = z;
+      }
+      job->mismatches++;
+    }
+  }
+}
+
+static bool loadDem(const char *path, MappedFile &file, DemGrid &dem,
+                    std::vector<double> &Z)
+{
+  const char *err = "";
+  char asciiErr[demAsciiErrLen];
+  std::size_t len = std::strlen(path);
+  DemAsciiHeader hdr;
+  DemTileHeader tileHdr;
+  if (!file.open(path, &err)) {
+    std::fprintf(stderr, "%s: %s\n", path, err);
+    return false;
+  }
+  if (len > 5 && std::strcmp(path + len - 5, ".demt") == 0) {
+    if (!demTileFileView(file.data(), file.size(), dem, tileHdr, &err)) {
+      std::fprintf(stderr, "%s: %s\n", path, err);
+      return false;
+    }
+    return true;
+  }
+  if (!demAsciiReadHeader((const char *)file.data(), file.size(), hdr,
+                          asciiErr)) {
+    std::fprintf(stderr, "%s: %s\n", path, asciiErr);
+    return false;
+  }
+  Z.resize((std::size_t)hdr.nrows * (std::size_t)hdr.ncols);
+  if (!demAsciiParseBody((const char *)file.data(), file.size(), hdr, 0,
+                         &Z[0], asciiErr)) {
+    std::fprintf(stderr, "%s: %s\n", path, asciiErr);
+    return false;
+  }
+  std::memset(&dem, 0, sizeof(dem));
+  dem.Z = &Z[0];
+  dem.rows = hdr.nrows;
+  dem.cols = hdr.ncols;
+  dem.xMin = hdr.xllcorner; /* as demImport: posts start at the corner */
+  dem.yMin = hdr.yllcorner;
+  dem.resolution = hdr.cellsize;
+  return true;
+}
+
+static bool writeWords(const char *path, const DemFixptModel &m)
+{
+  FILE *f = std::fopen(path, "w");
+  int32_t r;
+  int32_t c;
+  if (f == NULL) {
+    std::fprintf(stderr, "%s: cannot open for writing\n", path);
+    return false;
+  }
+  std::fprintf(f, "%d %d\n", m.rows, m.cols);
+  for (r = 0; r < m.rows; r++) {
+    for (c = 0; c < m.cols; c++) {
+      std::fprintf(f, "%d\n", m.Z[(std::size_t)c * m.rows + r]);
+    }
+  }
+  if (std::fclose(f) != 0) {
+    std::fprintf(stderr, "%s: write failed\n", path);
+    return false;
+  }
+  return true;
+}
+
+static int usage(void)
+{
+  std::fprintf(stderr,
+               "Usage: demFixptVectors DEM [-p design|aws] [-n count] "
+               "[-s seed] [-t threads]\n"
+               "                           [-o vectors.csv | -c vectors.csv]"
+               " [-w dem_words.txt]\n");
+  return 2;
+}
+
+int main(int argc, char **argv)
+{
+  DemFixptProfile profile = demFixptDesign;
+  uint64_t count = 100000000;
+  uint64_t seed = 1;
+  uint64_t done;
+  uint64_t checksum = 0;
+  int32_t nThreads = (int32_t)std::thread::hardware_concurrency();
+  int32_t t;
+  int32_t k;
+  int32_t spanRows;
+  int32_t spanCols;
+  const char *demPath = NULL;
+  const char *outPath = NULL;
+  const char *checkPath = NULL;
+  const char *wordsPath = NULL;
+  const char *err = "";
+  MappedFile demFile;
+  DemGrid dem;
+  std::vector<double> Zbuf;
+  DemFixptModel model;
+  FILE *out = NULL;
+  double seconds;
+  std::chrono::steady_clock::time_point t0;
+
+  for (k = 1; k < argc; k++) {
+    const char *a = argv[k];
+    const char *v = (k + 1 < argc) ? argv[k + 1] : NULL;
+    if (a[0] != '-') {
+      demPath = a;
+      continue;
+    }
+    if (v == NULL) {
+      return usage();
+    }
+    k++;
+    if (std::strcmp(a, "-p") == 0) {
+      if (std::strcmp(v, "design") == 0) {
+        profile = demFixptDesign;
+      } else if (std::strcmp(v, "aws") == 0) {
+        profile = demFixptAws;
+      } else {
+        return usage();
+      }
+    } else if (std::strcmp(a, "-n") == 0) {
+      count = std::strtoull(v, NULL, 10);
+    } else if (std::strcmp(a, "-s") == 0) {
+      seed = std::strtoull(v, NULL, 10);
+    } else if (std::strcmp(a, "-t") == 0) {
+      nThreads = std::atoi(v);
+    } else if (std::strcmp(a, "-o") == 0) {
+      outPath = v;
+    } else if (std::strcmp(a, "-c") == 0) {
+      checkPath = v;
+    } else if (std::strcmp(a, "-w") == 0) {
+      wordsPath = v;
+    } else {
+      return usage();
+    }
+  }
+  if (demPath == NULL || (outPath != NULL && checkPath != NULL)) {
+    return usage();
+  }
+  if (nThreads < 1) {
+    nThreads = 1;
+  }
+  if (!loadDem(demPath, demFile, dem, Zbuf)) {
+    return 1;
+  }
+  if (!demFixptModelInit(model, profile, dem, &err)) {
+    std::fprintf(stderr, "%s: %s\n", demPath, err);
+    return 1;
+  }
+  demFile.close();
+  if (wordsPath != NULL && !writeWords(wordsPath, model)) {
+    return 1;
+  }
+  t0 = std::chrono::steady_clock::now();
+
+  /* ---- Check an existing vector file ---- */
+  if (checkPath != NULL) {
+    MappedFile vecFile;
+    std::vector<CheckJob> jobs((std::size_t)nThreads);
+    std::vector<std::thread> pool;
+    const char *begin;
+    const char *end;
+    const char *cut;
+    uint64_t checked = 0;
+    uint64_t mismatches = 0;
+    uint64_t malformed = 0;
+    const int64_t *bad = NULL;
+    if (!vecFile.open(checkPath, &err)) {
+      std::fprintf(stderr, "%s: %s\n", checkPath, err);
+      return 1;
+    }
+    begin = (const char *)vecFile.data();
+    end = begin + vecFile.size();
+    if (begin < end && !(*begin == '-' || (*begin >= '0' && *begin <= '9'))) {
+      cut = (const char *)std::memchr(begin, '\n', vecFile.size());
+      begin = (cut == NULL) ? end : cut + 1;
+    }
+    /*  Line-aligned chunks, one per thread */
+    for (t = 0; t < nThreads; t++) {
+      jobs[t].model = &model;
+      jobs[t].begin = begin;
+      cut = begin + (std::size_t)(end - begin) / (std::size_t)(nThreads - t);
+      if (cut < end) {
+        cut = (const char *)std::memchr(cut, '\n', (std::size_t)(end - cut));
+        cut = (cut == NULL) ? end : cut + 1;
+      }
+      jobs[t].end = cut;
+      begin = cut;
+    }
+    for (t = 0; t < nThreads; t++) {
+      pool.push_back(std::thread(runCheck, &jobs[t]));
+    }
+    for (t = 0; t < nThreads; t++) {
+      pool[t].join();
+      checked += jobs[t].checked;
+      mismatches += jobs[t].mismatches;
+      malformed += jobs[t].malformed;
+      if (bad == NULL && jobs[t].mismatches > 0) {
+        bad = jobs[t].firstBad;
+      }
+    }
+    vecFile.close();
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            t0)
+                  .count();
+    std::printf("Checked %llu vectors in %.2f s (%.0f M/min), %d threads\n",
+                (unsigned long long)checked, seconds,
+                checked / seconds * 60e-6, nThreads);
+    if (malformed > 0) {
+      std::printf("  %llu malformed lines\n", (unsigned long long)malformed);
+    }
+    if (mismatches > 0) {
+      std::printf("  %llu mismatches; first: TestID %lld (%lld, %lld) "
+                  "Z_out %lld, model %lld\n",
+                  (unsigned long long)mismatches, (long long)bad[0],
+                  (long long)bad[1], (long long)bad[2], (long long)bad[3],
+                  (long long)bad[4]);
+      return 1;
+    }
+    std::printf("  all vectors match\n");
+    return malformed > 0 ? 1 : 0;
+  }
+
+  /* ---- Generate ---- */
+  if (outPath != NULL) {
+    out = std::fopen(outPath, "wb");
+    if (out == NULL) {
+      std::fprintf(stderr, "%s: cannot open for writing\n", outPath);
+      return 1;
+    }
+    std::fputs(vecHeader, out);
+  }
+  /*  The design only addresses the first 101 x 101 posts */
+  spanCols = (profile == demFixptDesign) ? 101 : dem.cols;
+  spanRows = (profile == demFixptDesign) ? 101 : dem.rows;
+  {
+    std::vector<VecJob> jobs((std::size_t)nThreads);
+    std::vector<std::thread> pool;
+    for (t = 0; t < nThreads; t++) {
+      jobs[t].model = &model;
+      jobs[t].seed = seed;
+      jobs[t].format = (out != NULL);
+      jobs[t].box[0] = dem.xMin - dem.resolution;
+      jobs[t].box[1] = dem.xMin + spanCols * dem.resolution;
+      jobs[t].box[2] = dem.yMin - dem.resolution;
+      jobs[t].box[3] = dem.yMin + spanRows * dem.resolution;
+    }
+    /*  Rounds of one block per thread, written out in TestID order */
+    for (done = 0; done < count;) {
+      pool.clear();
+      for (t = 0; t < nThreads; t++) {
+        jobs[t].first = done;
+        jobs[t].count = (count - done < vecBlock) ? count - done : vecBlock;
+        done += jobs[t].count;
+        pool.push_back(std::thread(runGenerate, &jobs[t]));
+      }
+      for (t = 0; t < nThreads; t++) {
+        pool[t].join();
+        checksum += jobs[t].checksum;
+        if (out != NULL && !jobs[t].text.empty()) {
+          std::fwrite(&jobs[t].text[0], 1, jobs[t].text.size(), out);
+        }
+      }
+    }
+  }
+  if (out != NULL && std::fclose(out) != 0) {
+    std::fprintf(stderr, "%s: write failed\n", outPath);
+    return 1;
+  }
+  seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - t0)
+          .count();
+  std::printf("Generated %llu %s vectors in %.2f s (%.0f M/min), "
+              "%d threads, checksum %016llx\n",
+              (unsigned long long)count,
+              profile == demFixptDesign ? "design" : "aws", seconds,
+              count / seconds * 60e-6, nThreads,
+              (unsigned long long)checksum);
+  return 0;
+}
+
+/* End of demFixptVectors.cpp */
@@ -0,0 +1,87 @@
+/*
+ * demFixpt_mex.cpp
+ *
+ * MEX gateway: [zOut, xIn, yIn] = demFixpt_mex(profile, demData, x, y)
+ *
+ * Runs the bit-exact fixed-point model (demFixptModel.cpp) on arrays of
+ * UTM coordinates. profile is 'design' (demInterpolate_fixpt.m) or 'aws'
+ * (fixpt_config_aws.m). x and y are quantized to the profile's input
+ * words first; all three outputs are stored integers (value *
+ * 2^FractionLength) returned as doubles, the same words the stand-alone
+ * demFixptVectors tool writes, so MATLAB fi results can be compared with
+ * storedInteger() and vectors can be spot-checked without leaving MATLAB.
+ *
+ */
+
+/* Include files */
+#include "demFixptModel.h"
+#include "demKernel.h"
+#include "mexUtil.h"
+
+/* Function Definitions */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  static const char *errId = "demFixpt:InvalidInput";
+  DemFixptModel model;
+  DemFixptProfile profile = demFixptDesign;
+  DemGrid dem;
+  const double *x;
+  const double *y;
+  mxArray *res[3];
+  double *out[3];
+  const char *err = "";
+  char *name;
+  std::size_t n;
+  std::size_t k;
+  int64_t xIn;
+  int64_t yIn;
+  int32_t o;
+  if (nrhs != 4 || !mxIsChar(prhs[0])) {
+    mexErrMsgIdAndTxt(errId, "Usage: [zOut, xIn, yIn] = demFixpt_mex("
+                             "profile, demData, x, y)");
+  }
+  if (nlhs > 3) {
+    mexErrMsgIdAndTxt(errId, "Too many output arguments");
+  }
+  name = mxArrayToString(prhs[0]);
+  if (std::strcmp(name, "design") == 0) {
+    profile = demFixptDesign;
+  } else if (std::strcmp(name, "aws") == 0) {
+    profile = demFixptAws;
+  } else {
+    mxFree(name);
+    mexErrMsgIdAndTxt(errId, "profile must be 'design' or 'aws'");
+  }
+  mxFree(name);
+  dem = mexDemGridFromStruct(prhs[1], errId);
+  x = mexDoubleArray(prhs[2], "x", errId);
+  y = mexDoubleArray(prhs[3], "y", errId);
+  n = mxGetNumberOfElements(prhs[2]);
+  if (mxGetNumberOfElements(prhs[3]) != n) {
+    mexErrMsgIdAndTxt(errId, "x and y must have the same number of elements");
+  }
+  if (!demFixptModelInit(model, profile, dem, &err)) {
+    mexErrMsgIdAndTxt(errId, "%s", err);
+  }
+  for (o = 0; o < 3; o++) {
+    res[o] = mxCreateUninitNumericArray(mxGetNumberOfDimensions(prhs[2]),
+                                        (size_t *)mxGetDimensions(prhs[2]),
+                                        mxDOUBLE_CLASS, mxREAL);
+    out[o] = mxGetDoubles(res[o]);
+  }
+  for (k = 0; k < n; k++) {
+    demFixptQuantizeInput(model, x[k], y[k], xIn, yIn);
+    out[0][k] = (double)demFixptInterpolate(model, xIn, yIn);
+    out[1][k] = (double)xIn;
+    out[2][k] = (double)yIn;
+  }
+  for (o = 0; o < 3; o++) {
+    if (o < nlhs || o == 0) {
+      plhs[o] = res[o];
+    } else {
+      mxDestroyArray(res[o]);
+    }
+  }
+}
+
+/* End of demFixpt_mex.cpp */
@@ -0,0 +1,285 @@
+/*
+ * demHandle_mex.cpp
+ *
+ * MEX gateway for resident DEMs (see demLoad.m, demQuery.m, demFree.m):
+ *
+ *   h = demHandle_mex('load', demData)   copy demData.Z once, return handle
+ *   z = demHandle_mex('query', h, x, y)  batched lookup, no DEM marshalling
+ *   demHandle_mex('free', h)             release the copy
+ *
+ *   [h, info] = demHandle_mex('open', file)      map a .demt tile file
+ *   Z = demHandle_mex('window', h, r0, c0, nr, nc)  copy out a block
+ *   demHandle_mex('save', file, demData, tileSize)  write a .demt file
+ *
+ * An opened .demt file is not copied: the handle's grid points into a
+ * read-only mapping, and tiles are paged in by the OS as queries touch
+ * them (see demTileFile.h).
+ *
+ * With demData.layout = 'tiled' the resident copy is stored in the
+ * cache-blocked layout of demKernel.h, page-aligned to 64 bytes; queries
+ * return the same values either way.
+ *
+ * Handles are uint64 ids into a table owned by this MEX file. The MEX is
+ * locked while any DEM is loaded so 'clear mex' cannot drop live handles;
+ * everything still loaded is released at MATLAB exit.
+ *
+ */
+
+/* Include files */
+#include "demKernel.h"
+#include "demTileFile.h"
+#include "mappedFile.h"
+#include "mexUtil.h"
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <vector>
+
+/* Type Definitions */
+struct ResidentDem {
+  std::vector<double> Z;   /* column-major copy, or tiled copy plus slack */
+  DemTiledIndex index;     /* offset tables (tiled layout only) */
+  MappedFile file;         /* .demt mapping (opened files only) */
+  DemGrid grid;
+};
+
+/* Variable Definitions */
+static std::map<uint64_t, ResidentDem *> demTable;
+static uint64_t demNextId = 1;
+static const char *demErrId = "demHandle:InvalidInput";
+static const std::size_t demAlignDoubles = 8; /* 64-byte cache line */
+
+/* Function Declarations */
+static void demFreeAll(void);
+static ResidentDem *demLookup(const mxArray *h);
+static mxArray *demRegister(ResidentDem *dem);
+static int32_t demIntArg(const mxArray *a, const char *name);
+
+/* Function Definitions */
+static void demFreeAll(void)
+{
+  std::map<uint64_t, ResidentDem *>::iterator it;
+  for (it = demTable.begin(); it != demTable.end(); ++it) {
+    delete it->second;
+  }
+  demTable.clear();
+}
+
+static ResidentDem *demLookup(const mxArray *h)
+{
+  std::map<uint64_t, ResidentDem *>::iterator it;
+  if (!mxIsUint64(h) || mxGetNumberOfElements(h) != 1) {
+    mexErrMsgIdAndTxt(demErrId, "DEM handle must be a uint64 scalar");
+  }
+  it = demTable.find(*mxGetUint64s(h));
+  if (it == demTable.end()) {
+    mexErrMsgIdAndTxt("demHandle:InvalidHandle",
+                      "DEM handle is not loaded (already freed?)");
+  }
+  return it->second;
+}
+
+static mxArray *demRegister(ResidentDem *dem)
+{
+  mxArray *h;
+  demTable[demNextId] = dem;
+  mexLock();
+  h = mxCreateNumericMatrix(1, 1, mxUINT64_CLASS, mxREAL);
+  *mxGetUint64s(h) = demNextId++;
+  return h;
+}
+
+static int32_t demIntArg(const mxArray *a, const char *name)
+{
+  double v;
+  if (!mxIsDouble(a) || mxIsComplex(a) || mxGetNumberOfElements(a) != 1) {
+    mexErrMsgIdAndTxt(demErrId, "%s must be a real double scalar", name);
+  }
+  v = mxGetScalar(a);
+  if (v != std::floor(v) || v < 0.0 || v > (double)INT32_MAX) {
+    mexErrMsgIdAndTxt(demErrId, "%s must be a non-negative integer", name);
+  }
+  return (int32_t)v;
+}
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  char cmd[8];
+  (void)nlhs;
+  mexAtExit(&demFreeAll);
+  if (nrhs < 1 || !mxIsChar(prhs[0]) ||
+      mxGetString(prhs[0], cmd, sizeof(cmd)) != 0) {
+    mexErrMsgIdAndTxt(demErrId, "First argument must be 'load', 'query', "
+                                "'free', 'open', 'window' or 'save'");
+  }
+
+  if (std::strcmp(cmd, "load") == 0) {
+    ResidentDem *dem;
+    DemGrid view;
+    std::size_t numel;
+    if (nrhs != 2) {
+      mexErrMsgIdAndTxt(demErrId,
+                        "Usage: h = demHandle_mex('load', demData)");
+    }
+    view = mexDemGridFromStruct(prhs[1], demErrId);
+    dem = new ResidentDem();
+    dem->grid = view;
+    if (mexDemTiledLayout(prhs[1], demErrId)) {
+      double *base;
+      numel = demTiledNumel(view.rows, view.cols);
+      if (numel == 0) {
+        delete dem;
+        mexErrMsgIdAndTxt(demErrId, "demData.Z is too large for the tiled "
+                                    "layout (2^31 posts including padding)");
+      }
+      /*  Over-allocate so tiles and pages start on a cache line */
+      dem->Z.assign(numel + demAlignDoubles - 1, 0.0);
+      base = dem->Z.data();
+      base += (demAlignDoubles -
+               ((uintptr_t)base / sizeof(double)) % demAlignDoubles) %
+              demAlignDoubles;
+      demTiledIndexInit(dem->index, view.rows, view.cols);
+      demTileCopy(view.Z, view.rows, view.cols, dem->index, base);
+      dem->grid.Z = base;
+      dem->grid.rowOffset = dem->index.rowOffset.data();
+      dem->grid.colOffset = dem->index.colOffset.data();
+    } else {
+      numel = (std::size_t)view.rows * (std::size_t)view.cols;
+      dem->Z.assign(view.Z, view.Z + numel);
+      dem->grid.Z = dem->Z.data();
+    }
+    plhs[0] = demRegister(dem);
+
+  } else if (std::strcmp(cmd, "query") == 0) {
+    const ResidentDem *dem;
+    const double *x;
+    const double *y;
+    std::size_t n;
+    if (nrhs != 4) {
+      mexErrMsgIdAndTxt(demErrId,
+                        "Usage: z = demHandle_mex('query', h, x, y)");
+    }
+    dem = demLookup(prhs[1]);
+    x = mexDoubleArray(prhs[2], "x", demErrId);
+    y = mexDoubleArray(prhs[3], "y", demErrId);
+    n = mxGetNumberOfElements(prhs[2]);
+    if (mxGetNumberOfElements(prhs[3]) != n) {
+      mexErrMsgIdAndTxt(demErrId,
+                        "x and y must have the same number of elements");
+    }
+    plhs[0] = mxCreateUninitNumericArray(mxGetNumberOfDimensions(prhs[2]),
+                                         (size_t *)mxGetDimensions(prhs[2]),
+                                         mxDOUBLE_CLASS, mxREAL);
+    demInterpolateBatch(dem->grid, x, y, mxGetDoubles(plhs[0]), n);
+
+  } else if (std::strcmp(cmd, "free") == 0) {
+    std::map<uint64_t, ResidentDem *>::iterator it;
+    if (nrhs != 2) {
+      mexErrMsgIdAndTxt(demErrId, "Usage: demHandle_mex('free', h)");
+    }
+    /*  Freeing an unknown or already freed handle is a no-op */
+    if (mxIsUint64(prhs[1]) && mxGetNumberOfElements(prhs[1]) == 1) {
+      it = demTable.find(*mxGetUint64s(prhs[1]));
+      if (it != demTable.end()) {
+        delete it->second;
+        demTable.erase(it);
+        mexUnlock();
+      }
+    }
+
+  } else if (std::strcmp(cmd, "open") == 0) {
+    static const char *infoFields[] = {"rows", "cols", "xMin", "yMin",
+                                       "resolution", "nodata", "tileSize"};
+    ResidentDem *dem;
+    DemTileHeader header;
+    const char *err = "";
+    char *path;
+    if (nrhs != 2 || !mxIsChar(prhs[1])) {
+      mexErrMsgIdAndTxt(demErrId,
+                        "Usage: [h, info] = demHandle_mex('open', file)");
+    }
+    path = mxArrayToString(prhs[1]);
+    dem = new ResidentDem();
+    if (!dem->file.open(path, &err) ||
+        !demTileFileView(dem->file.data(), dem->file.size(), dem->grid,
+                         header, &err)) {
+      delete dem;
+      mexErrMsgIdAndTxt("demHandle:FileError", "%s: %s", path, err);
+    }
+    mxFree(path);
+    plhs[0] = demRegister(dem);
+    if (nlhs > 1) {
+      plhs[1] = mxCreateStructMatrix(1, 1, 7, infoFields);
+      mxSetField(plhs[1], 0, "rows", mxCreateDoubleScalar(header.rows));
+      mxSetField(plhs[1], 0, "cols", mxCreateDoubleScalar(header.cols));
+      mxSetField(plhs[1], 0, "xMin", mxCreateDoubleScalar(header.xMin));
+      mxSetField(plhs[1], 0, "yMin", mxCreateDoubleScalar(header.yMin));
+      mxSetField(plhs[1], 0, "resolution",
+                 mxCreateDoubleScalar(header.resolution));
+      mxSetField(plhs[1], 0, "nodata", mxCreateDoubleScalar(header.nodata));
+      mxSetField(plhs[1], 0, "tileSize",
+                 mxCreateDoubleScalar((double)(1u << header.tileBits)));
+    }
+
+  } else if (std::strcmp(cmd, "window") == 0) {
+    const ResidentDem *dem;
+    int32_t r0;
+    int32_t c0;
+    int32_t nr;
+    int32_t nc;
+    if (nrhs != 6) {
+      mexErrMsgIdAndTxt(demErrId, "Usage: Z = demHandle_mex('window', h, "
+                                  "r0, c0, nr, nc)");
+    }
+    dem = demLookup(prhs[1]);
+    r0 = demIntArg(prhs[2], "r0");
+    c0 = demIntArg(prhs[3], "c0");
+    nr = demIntArg(prhs[4], "nr");
+    nc = demIntArg(prhs[5], "nc");
+    /*  r0/c0 are 1-based like MATLAB indices */
+    if (r0 < 1 || c0 < 1 || nr > dem->grid.rows - (r0 - 1) ||
+        nc > dem->grid.cols - (c0 - 1)) {
+      mexErrMsgIdAndTxt(demErrId, "Window exceeds the %d x %d grid",
+                        dem->grid.rows, dem->grid.cols);
+    }
+    plhs[0] = mxCreateUninitNumericMatrix((size_t)nr, (size_t)nc,
+                                          mxDOUBLE_CLASS, mxREAL);
+    demGridWindow(dem->grid, r0 - 1, c0 - 1, nr, nc,
+                  mxGetDoubles(plhs[0]));
+
+  } else if (std::strcmp(cmd, "save") == 0) {
+    DemGrid src;
+    const char *err = "";
+    const mxArray *nodataField;
+    double nodata = -9999.0;
+    int32_t tileSize;
+    int32_t tileBits = 0;
+    char *path;
+    if (nrhs != 4 || !mxIsChar(prhs[1])) {
+      mexErrMsgIdAndTxt(demErrId, "Usage: demHandle_mex('save', file, "
+                                  "demData, tileSize)");
+    }
+    src = mexDemGridFromStruct(prhs[2], demErrId);
+    nodataField = mxGetField(prhs[2], 0, "nodata");
+    if (nodataField != NULL) {
+      nodata = mexScalarField(prhs[2], "nodata", demErrId);
+    }
+    tileSize = demIntArg(prhs[3], "tileSize");
+    while (tileBits < 31 && ((int32_t)1 << tileBits) < tileSize) {
+      tileBits++;
+    }
+    if (((int32_t)1 << tileBits) != tileSize) {
+      mexErrMsgIdAndTxt(demErrId, "tileSize must be a power of two");
+    }
+    path = mxArrayToString(prhs[1]);
+    if (!demTileFileWrite(path, src, nodata, tileBits, &err)) {
+      mexErrMsgIdAndTxt("demHandle:FileError", "%s: %s", path, err);
+    }
+    mxFree(path);
+
+  } else {
+    mexErrMsgIdAndTxt(demErrId, "Unknown command: %s", cmd);
+  }
+}
+
+/* End of demHandle_mex.cpp */
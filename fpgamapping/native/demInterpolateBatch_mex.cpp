@@ -0,0 +1,44 @@
+/*
+ * demInterpolateBatch_mex.cpp
+ *
+ * MEX gateway: z = demInterpolateBatch_mex(demData, x, y)
+ *
+ * x and y are arrays of the same size; z has that size. demData.Z is read
+ * in place (no marshalling copy), so a call costs one struct lookup plus
+ * the vectorised kernel in demKernel.cpp.
+ *
+ */
+
+/* Include files */
+#include "demKernel.h"
+#include "mexUtil.h"
+
+/* Function Definitions */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  static const char *errId = "demInterpolateBatch:InvalidInput";
+  DemGrid dem;
+  const double *x;
+  const double *y;
+  std::size_t n;
+  if (nrhs != 3) {
+    mexErrMsgIdAndTxt(errId,
+                      "Usage: z = demInterpolateBatch_mex(demData, x, y)");
+  }
+  if (nlhs > 1) {
+    mexErrMsgIdAndTxt(errId, "Too many output arguments");
+  }
+  dem = mexDemGridFromStruct(prhs[0], errId);
+  x = mexDoubleArray(prhs[1], "x", errId);
+  y = mexDoubleArray(prhs[2], "y", errId);
+  n = mxGetNumberOfElements(prhs[1]);
+  if (mxGetNumberOfElements(prhs[2]) != n) {
+    mexErrMsgIdAndTxt(errId, "x and y must have the same number of elements");
+  }
+  plhs[0] = mxCreateUninitNumericArray(mxGetNumberOfDimensions(prhs[1]),
+                                       (size_t *)mxGetDimensions(prhs[1]),
+                                       mxDOUBLE_CLASS, mxREAL);
+  demInterpolateBatch(dem, x, y, mxGetDoubles(plhs[0]), n);
+}
+
+/* End of demInterpolateBatch_mex.cpp */
@@ -0,0 +1,735 @@
+/*
+ * demKernel.cpp
+ *
+ * Scalar and SIMD (SSE4.1 / AVX2) bilinear DEM interpolation.
+ *
+ * The vector paths are compiled with per-function target attributes and
+ * selected at run time, so the MEX files keep the plain -msse2 baseline of
+ * the MATLAB toolchain and still use AVX2 where the CPU has it. No FMA is
+ * used: every lane performs the same multiplies and adds, in the same
+ * order, as demInterpolatePoint (and demInterpolate.m).
+ *
+ * Grid size is a run-time property of DemGrid. The common survey tile
+ * sizes are additionally instantiated with compile-time rows/cols (see
+ * DemFixedShape) so the corner offsets fold into immediates; any other
+ * size takes the DemRuntimeShape instantiation of the same kernels.
+ * Tiled grids (DemGrid.rowOffset set) take DemTiledShape, whose corner
+ * addresses come from the row/column offset tables.
+ * Paged grids (DemGrid.tileBits set, mapped .demt files) take
+ * DemPagedShape, which computes 64-bit offsets with shifts.
+ *
+ */
+
+/* Include files */
+#include "demKernel.h"
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+    defined(_M_IX86)
+#define DEM_HAVE_X86_SIMD 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define DEM_TARGET(isa)
+#else
+#define DEM_TARGET(isa) __attribute__((target(isa)))
+#endif
+#else
+#define DEM_HAVE_X86_SIMD 0
+#endif
+
+/* Type Definitions */
+/*
+ * Shape policies: grid size for the clamps, plus corners(), which returns
+ * the Z offsets of Z(j+1,i+1), Z(j+1,i+2), Z(j+2,i+1) and Z(j+2,i+2).
+ */
+
+/*  Column-major grid, shape read from the DemGrid at run time */
+struct DemRuntimeShape {
+  int32_t rows;
+  int32_t cols;
+  explicit DemRuntimeShape(const DemGrid &dem)
+      : rows(dem.rows), cols(dem.cols)
+  {
+  }
+  std::ptrdiff_t offset(std::ptrdiff_t i, std::ptrdiff_t j) const
+  {
+    return j + (std::ptrdiff_t)rows * i;
+  }
+  void corners(std::ptrdiff_t i, std::ptrdiff_t j, std::ptrdiff_t c[4]) const
+  {
+    c[0] = j + (std::ptrdiff_t)rows * i;
+    c[1] = c[0] + rows;
+    c[2] = c[0] + 1;
+    c[3] = c[0] + rows + 1;
+  }
+};
+
+/*  Column-major grid, shape fixed at compile time (matching DemGrid only) */
+template <int32_t Rows, int32_t Cols> struct DemFixedShape {
+  static const int32_t rows = Rows;
+  static const int32_t cols = Cols;
+  explicit DemFixedShape(const DemGrid &)
+  {
+  }
+  std::ptrdiff_t offset(std::ptrdiff_t i, std::ptrdiff_t j) const
+  {
+    return j + (std::ptrdiff_t)Rows * i;
+  }
+  void corners(std::ptrdiff_t i, std::ptrdiff_t j, std::ptrdiff_t c[4]) const
+  {
+    c[0] = j + (std::ptrdiff_t)Rows * i;
+    c[1] = c[0] + Rows;
+    c[2] = c[0] + 1;
+    c[3] = c[0] + Rows + 1;
+  }
+};
+
+/*  Tiled grid: separable offsets, see demTiledIndexInit */
+struct DemTiledShape {
+  int32_t rows;
+  int32_t cols;
+  const int32_t *rowOffset;
+  const int32_t *colOffset;
+  explicit DemTiledShape(const DemGrid &dem)
+      : rows(dem.rows), cols(dem.cols), rowOffset(dem.rowOffset),
+        colOffset(dem.colOffset)
+  {
+  }
+  std::ptrdiff_t offset(std::ptrdiff_t i, std::ptrdiff_t j) const
+  {
+    return (std::ptrdiff_t)rowOffset[j] + colOffset[i];
+  }
+  void corners(std::ptrdiff_t i, std::ptrdiff_t j, std::ptrdiff_t c[4]) const
+  {
+    const std::ptrdiff_t r0 = rowOffset[j];
+    const std::ptrdiff_t r1 = rowOffset[j + 1];
+    c[0] = r0 + colOffset[i];
+    c[1] = r0 + colOffset[i + 1];
+    c[2] = r1 + colOffset[i];
+    c[3] = r1 + colOffset[i + 1];
+  }
+};
+
+/*
+ * Paged grid (.demt files): 2^tileBits square tiles, column-major inside
+ * and across tiles. Like the tiled layout the offset splits into a row
+ * part plus a column part, here computed with shifts.
+ */
+struct DemPagedShape {
+  int32_t rows;
+  int32_t cols;
+  int32_t tileBits;
+  std::ptrdiff_t tileMask;
+  std::ptrdiff_t tileStride; /* elements per column of tiles */
+  explicit DemPagedShape(const DemGrid &dem)
+      : rows(dem.rows), cols(dem.cols), tileBits(dem.tileBits),
+        tileMask(((std::ptrdiff_t)1 << dem.tileBits) - 1),
+        tileStride((((std::ptrdiff_t)dem.rows + tileMask) >> dem.tileBits)
+                   << (2 * dem.tileBits))
+  {
+  }
+  std::ptrdiff_t rowPart(std::ptrdiff_t j) const
+  {
+    return ((j >> tileBits) << (2 * tileBits)) + (j & tileMask);
+  }
+  std::ptrdiff_t colPart(std::ptrdiff_t i) const
+  {
+    return (i >> tileBits) * tileStride + ((i & tileMask) << tileBits);
+  }
+  std::ptrdiff_t offset(std::ptrdiff_t i, std::ptrdiff_t j) const
+  {
+    return rowPart(j) + colPart(i);
+  }
+  void corners(std::ptrdiff_t i, std::ptrdiff_t j, std::ptrdiff_t c[4]) const
+  {
+    const std::ptrdiff_t r0 = rowPart(j);
+    const std::ptrdiff_t r1 = rowPart(j + 1);
+    c[0] = r0 + colPart(i);
+    c[1] = r0 + colPart(i + 1);
+    c[2] = r1 + colPart(i);
+    c[3] = r1 + colPart(i + 1);
+  }
+};
+
+/* Variable Definitions */
+static const double demNaN = std::numeric_limits<double>::quiet_NaN();
+
+/*  Tiled layout geometry: 8x8-post tiles in 64x64-post pages */
+static const int32_t demTileBits = 3;
+static const int32_t demPageBits = 6;
+static const int32_t demPageNumel = 1 << (2 * demPageBits);
+
+/* Function Declarations */
+template <class Shape>
+static void demInterpolateShaped(const DemGrid &dem, const Shape &shape,
+                                 const double *x, const double *y, double *z,
+                                 std::size_t n);
+
+/* Function Definitions */
+template <class Shape>
+static inline double demInterpolatePointShaped(const DemGrid &dem,
+                                               const Shape &shape, double x,
+                                               double y)
+{
+  double i_float;
+  double j_float;
+  double i;
+  double j;
+  double dx;
+  double dy;
+  std::ptrdiff_t c[4];
+  const std::ptrdiff_t rows = shape.rows;
+  /*  Position in grid coordinates (floating-point) */
+  i_float = (x - dem.xMin) / dem.resolution;
+  j_float = (y - dem.yMin) / dem.resolution;
+  if (std::isnan(i_float) || std::isnan(j_float)) {
+    return demNaN;
+  }
+  /*  Integer grid indices, clamped to the last full cell */
+  i = std::floor(i_float);
+  j = std::floor(j_float);
+  if (i < 0.0) {
+    i = 0.0;
+  }
+  if (j < 0.0) {
+    j = 0.0;
+  }
+  if (i >= shape.cols - 1) {
+    i = shape.cols - 2;
+  }
+  if (j >= rows - 1) {
+    j = rows - 2;
+  }
+  /*  Fractional offsets, clamped to [0, 1] */
+  dx = i_float - i;
+  dy = j_float - j;
+  if (dx < 0.0) {
+    dx = 0.0;
+  }
+  if (dx > 1.0) {
+    dx = 1.0;
+  }
+  if (dy < 0.0) {
+    dy = 0.0;
+  }
+  if (dy > 1.0) {
+    dy = 1.0;
+  }
+  /*  Four corners: z11 = Z(j+1,i+1), z21 = Z(j+1,i+2), z12 = Z(j+2,i+1) */
+  shape.corners((std::ptrdiff_t)i, (std::ptrdiff_t)j, c);
+  return dem.Z[c[0]] * (1.0 - dx) * (1.0 - dy) +
+         dem.Z[c[1]] * dx * (1.0 - dy) + dem.Z[c[2]] * (1.0 - dx) * dy +
+         dem.Z[c[3]] * dx * dy;
+}
+
+double demInterpolatePoint(const DemGrid &dem, double x, double y)
+{
+  if (dem.tileBits != 0) {
+    return demInterpolatePointShaped(dem, DemPagedShape(dem), x, y);
+  }
+  if (dem.rowOffset != NULL) {
+    return demInterpolatePointShaped(dem, DemTiledShape(dem), x, y);
+  }
+  return demInterpolatePointShaped(dem, DemRuntimeShape(dem), x, y);
+}
+
+#if DEM_HAVE_X86_SIMD
+/*
+ * AVX2: four queries per iteration. Grid math runs in lanes; the four
+ * corners are fetched with 32-bit index gathers, so the kernel requires
+ * rows*cols < 2^31 (checked by the dispatcher).
+ */
+template <class Shape>
+DEM_TARGET("avx2")
+static std::size_t demInterpolateAvx2(const DemGrid &dem, const Shape &shape,
+                                      const double *x, const double *y,
+                                      double *z, std::size_t n)
+{
+  const __m256d xMin = _mm256_set1_pd(dem.xMin);
+  const __m256d yMin = _mm256_set1_pd(dem.yMin);
+  const __m256d res = _mm256_set1_pd(dem.resolution);
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d one = _mm256_set1_pd(1.0);
+  const __m256d iMax = _mm256_set1_pd((double)(shape.cols - 2));
+  const __m256d jMax = _mm256_set1_pd((double)(shape.rows - 2));
+  const __m256d rowsV = _mm256_set1_pd((double)shape.rows);
+  const __m256d nanV = _mm256_set1_pd(demNaN);
+  const double *z11p = dem.Z;
+  const double *z21p = dem.Z + shape.rows;
+  const double *z12p = dem.Z + 1;
+  const double *z22p = dem.Z + shape.rows + 1;
+  std::size_t k;
+  for (k = 0; k + 4 <= n; k += 4) {
+    __m256d fi =
+        _mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(x + k), xMin), res);
+    __m256d fj =
+        _mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(y + k), yMin), res);
+    const __m256d valid = _mm256_and_pd(_mm256_cmp_pd(fi, fi, _CMP_ORD_Q),
+                                        _mm256_cmp_pd(fj, fj, _CMP_ORD_Q));
+    __m256d i;
+    __m256d j;
+    __m256d dx;
+    __m256d dy;
+    __m256d omx;
+    __m256d omy;
+    __m256d z11;
+    __m256d z21;
+    __m256d z12;
+    __m256d z22;
+    __m256d acc;
+    __m128i idx;
+    /*  NaN lanes are zeroed and masked out of the gathers */
+    fi = _mm256_and_pd(fi, valid);
+    fj = _mm256_and_pd(fj, valid);
+    i = _mm256_min_pd(_mm256_max_pd(_mm256_floor_pd(fi), zero), iMax);
+    j = _mm256_min_pd(_mm256_max_pd(_mm256_floor_pd(fj), zero), jMax);
+    dx = _mm256_min_pd(_mm256_max_pd(_mm256_sub_pd(fi, i), zero), one);
+    dy = _mm256_min_pd(_mm256_max_pd(_mm256_sub_pd(fj, j), zero), one);
+    omx = _mm256_sub_pd(one, dx);
+    omy = _mm256_sub_pd(one, dy);
+    idx = _mm256_cvttpd_epi32(_mm256_add_pd(j, _mm256_mul_pd(rowsV, i)));
+    z11 = _mm256_mask_i32gather_pd(zero, z11p, idx, valid, 8);
+    z21 = _mm256_mask_i32gather_pd(zero, z21p, idx, valid, 8);
+    z12 = _mm256_mask_i32gather_pd(zero, z12p, idx, valid, 8);
+    z22 = _mm256_mask_i32gather_pd(zero, z22p, idx, valid, 8);
+    acc = _mm256_mul_pd(_mm256_mul_pd(z11, omx), omy);
+    acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_mul_pd(z21, dx), omy));
+    acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_mul_pd(z12, omx), dy));
+    acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_mul_pd(z22, dx), dy));
+    _mm256_storeu_pd(z + k, _mm256_blendv_pd(nanV, acc, valid));
+  }
+  return k;
+}
+
+/*
+ * AVX2, tiled layout: as above, but each lane's four corner offsets are
+ * gathered from the row/column offset tables first. Tiled grids are built
+ * with fewer than 2^31 elements, so 32-bit offsets always suffice.
+ */
+DEM_TARGET("avx2")
+static std::size_t demInterpolateAvx2(const DemGrid &dem,
+                                      const DemTiledShape &shape,
+                                      const double *x, const double *y,
+                                      double *z, std::size_t n)
+{
+  const __m256d xMin = _mm256_set1_pd(dem.xMin);
+  const __m256d yMin = _mm256_set1_pd(dem.yMin);
+  const __m256d res = _mm256_set1_pd(dem.resolution);
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d one = _mm256_set1_pd(1.0);
+  const __m256d iMax = _mm256_set1_pd((double)(shape.cols - 2));
+  const __m256d jMax = _mm256_set1_pd((double)(shape.rows - 2));
+  const __m256d nanV = _mm256_set1_pd(demNaN);
+  const __m128i zeroI = _mm_setzero_si128();
+  const __m128i onesI = _mm_set1_epi32(-1);
+  std::size_t k;
+  for (k = 0; k + 4 <= n; k += 4) {
+    __m256d fi =
+        _mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(x + k), xMin), res);
+    __m256d fj =
+        _mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(y + k), yMin), res);
+    const __m256d valid = _mm256_and_pd(_mm256_cmp_pd(fi, fi, _CMP_ORD_Q),
+                                        _mm256_cmp_pd(fj, fj, _CMP_ORD_Q));
+    __m256d i;
+    __m256d j;
+    __m256d dx;
+    __m256d dy;
+    __m256d omx;
+    __m256d omy;
+    __m256d z11;
+    __m256d z21;
+    __m256d z12;
+    __m256d z22;
+    __m256d acc;
+    __m128i iIdx;
+    __m128i jIdx;
+    __m128i r0;
+    __m128i r1;
+    __m128i c0;
+    __m128i c1;
+    fi = _mm256_and_pd(fi, valid);
+    fj = _mm256_and_pd(fj, valid);
+    i = _mm256_min_pd(_mm256_max_pd(_mm256_floor_pd(fi), zero), iMax);
+    j = _mm256_min_pd(_mm256_max_pd(_mm256_floor_pd(fj), zero), jMax);
+    dx = _mm256_min_pd(_mm256_max_pd(_mm256_sub_pd(fi, i), zero), one);
+    dy = _mm256_min_pd(_mm256_max_pd(_mm256_sub_pd(fj, j), zero), one);
+    omx = _mm256_sub_pd(one, dx);
+    omy = _mm256_sub_pd(one, dy);
+    /*  Invalid lanes have i = j = 0, so the table gathers stay in range */
+    iIdx = _mm256_cvttpd_epi32(i);
+    jIdx = _mm256_cvttpd_epi32(j);
+    r0 = _mm_mask_i32gather_epi32(zeroI, shape.rowOffset, jIdx, onesI, 4);
+    r1 = _mm_mask_i32gather_epi32(zeroI, shape.rowOffset + 1, jIdx, onesI, 4);
+    c0 = _mm_mask_i32gather_epi32(zeroI, shape.colOffset, iIdx, onesI, 4);
+    c1 = _mm_mask_i32gather_epi32(zeroI, shape.colOffset + 1, iIdx, onesI, 4);
+    z11 = _mm256_mask_i32gather_pd(zero, dem.Z, _mm_add_epi32(r0, c0), valid,
+                                   8);
+    z21 = _mm256_mask_i32gather_pd(zero, dem.Z, _mm_add_epi32(r0, c1), valid,
+                                   8);
+    z12 = _mm256_mask_i32gather_pd(zero, dem.Z, _mm_add_epi32(r1, c0), valid,
+                                   8);
+    z22 = _mm256_mask_i32gather_pd(zero, dem.Z, _mm_add_epi32(r1, c1), valid,
+                                   8);
+    acc = _mm256_mul_pd(_mm256_mul_pd(z11, omx), omy);
+    acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_mul_pd(z21, dx), omy));
+    acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_mul_pd(z12, omx), dy));
+    acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_mul_pd(z22, dx), dy));
+    _mm256_storeu_pd(z + k, _mm256_blendv_pd(nanV, acc, valid));
+  }
+  return k;
+}
+
+/*
+ * AVX2, paged layout: row and column parts of the four corner offsets are
+ * computed in 64-bit lanes and fed to 64-bit index gathers, so grids with
+ * more than 2^31 posts keep the vector path. _mm256_mul_epu32 multiplies
+ * the low halves only, hence the tileStride limit in demAvx2Fits.
+ */
+DEM_TARGET("avx2")
+static std::size_t demInterpolateAvx2(const DemGrid &dem,
+                                      const DemPagedShape &shape,
+                                      const double *x, const double *y,
+                                      double *z, std::size_t n)
+{
+  const __m256d xMin = _mm256_set1_pd(dem.xMin);
+  const __m256d yMin = _mm256_set1_pd(dem.yMin);
+  const __m256d res = _mm256_set1_pd(dem.resolution);
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d one = _mm256_set1_pd(1.0);
+  const __m256d iMax = _mm256_set1_pd((double)(shape.cols - 2));
+  const __m256d jMax = _mm256_set1_pd((double)(shape.rows - 2));
+  const __m256d nanV = _mm256_set1_pd(demNaN);
+  const __m128i bits = _mm_cvtsi32_si128(shape.tileBits);
+  const __m128i bits2 = _mm_cvtsi32_si128(2 * shape.tileBits);
+  const __m256i mask = _mm256_set1_epi64x((long long)shape.tileMask);
+  const __m256i stride = _mm256_set1_epi64x((long long)shape.tileStride);
+  const __m256i oneI = _mm256_set1_epi64x(1);
+  std::size_t k;
+  for (k = 0; k + 4 <= n; k += 4) {
+    __m256d fi =
+        _mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(x + k), xMin), res);
+    __m256d fj =
+        _mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(y + k), yMin), res);
+    const __m256d valid = _mm256_and_pd(_mm256_cmp_pd(fi, fi, _CMP_ORD_Q),
+                                        _mm256_cmp_pd(fj, fj, _CMP_ORD_Q));
+    __m256d i;
+    __m256d j;
+    __m256d dx;
+    __m256d dy;
+    __m256d omx;
+    __m256d omy;
+    __m256d z11;
+    __m256d z21;
+    __m256d z12;
+    __m256d z22;
+    __m256d acc;
+    __m256i iL;
+    __m256i jL;
+    __m256i r0;
+    __m256i r1;
+    __m256i c0;
+    __m256i c1;
+    fi = _mm256_and_pd(fi, valid);
+    fj = _mm256_and_pd(fj, valid);
+    i = _mm256_min_pd(_mm256_max_pd(_mm256_floor_pd(fi), zero), iMax);
+    j = _mm256_min_pd(_mm256_max_pd(_mm256_floor_pd(fj), zero), jMax);
+    dx = _mm256_min_pd(_mm256_max_pd(_mm256_sub_pd(fi, i), zero), one);
+    dy = _mm256_min_pd(_mm256_max_pd(_mm256_sub_pd(fj, j), zero), one);
+    omx = _mm256_sub_pd(one, dx);
+    omy = _mm256_sub_pd(one, dy);
+    iL = _mm256_cvtepi32_epi64(_mm256_cvttpd_epi32(i));
+    jL = _mm256_cvtepi32_epi64(_mm256_cvttpd_epi32(j));
+    /*  rowPart(j) = (j >> b << 2b) + (j & m), likewise for j + 1 */
+    r0 = _mm256_add_epi64(_mm256_sll_epi64(_mm256_srl_epi64(jL, bits), bits2),
+                          _mm256_and_si256(jL, mask));
+    jL = _mm256_add_epi64(jL, oneI);
+    r1 = _mm256_add_epi64(_mm256_sll_epi64(_mm256_srl_epi64(jL, bits), bits2),
+                          _mm256_and_si256(jL, mask));
+    /*  colPart(i) = (i >> b) * tileStride + ((i & m) << b) */
+    c0 = _mm256_add_epi64(
+        _mm256_mul_epu32(_mm256_srl_epi64(iL, bits), stride),
+        _mm256_sll_epi64(_mm256_and_si256(iL, mask), bits));
+    iL = _mm256_add_epi64(iL, oneI);
+    c1 = _mm256_add_epi64(
+        _mm256_mul_epu32(_mm256_srl_epi64(iL, bits), stride),
+        _mm256_sll_epi64(_mm256_and_si256(iL, mask), bits));
+    z11 = _mm256_mask_i64gather_pd(zero, dem.Z, _mm256_add_epi64(r0, c0),
+                                   valid, 8);
+    z21 = _mm256_mask_i64gather_pd(zero, dem.Z, _mm256_add_epi64(r0, c1),
+                                   valid, 8);
+    z12 = _mm256_mask_i64gather_pd(zero, dem.Z, _mm256_add_epi64(r1, c0),
+                                   valid, 8);
+    z22 = _mm256_mask_i64gather_pd(zero, dem.Z, _mm256_add_epi64(r1, c1),
+                                   valid, 8);
+    acc = _mm256_mul_pd(_mm256_mul_pd(z11, omx), omy);
+    acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_mul_pd(z21, dx), omy));
+    acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_mul_pd(z12, omx), dy));
+    acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_mul_pd(z22, dx), dy));
+    _mm256_storeu_pd(z + k, _mm256_blendv_pd(nanV, acc, valid));
+  }
+  return k;
+}
+
+/*
+ * SSE4.1: two queries per iteration. There is no gather instruction, so
+ * the corner loads are scalar, but the floor/clamp/weight math and the
+ * blend stay in lanes.
+ */
+template <class Shape>
+DEM_TARGET("sse4.1")
+static std::size_t demInterpolateSse41(const DemGrid &dem, const Shape &shape,
+                                       const double *x, const double *y,
+                                       double *z, std::size_t n)
+{
+  const __m128d xMin = _mm_set1_pd(dem.xMin);
+  const __m128d yMin = _mm_set1_pd(dem.yMin);
+  const __m128d res = _mm_set1_pd(dem.resolution);
+  const __m128d zero = _mm_setzero_pd();
+  const __m128d one = _mm_set1_pd(1.0);
+  const __m128d iMax = _mm_set1_pd((double)(shape.cols - 2));
+  const __m128d jMax = _mm_set1_pd((double)(shape.rows - 2));
+  const __m128d nanV = _mm_set1_pd(demNaN);
+  const double *Z = dem.Z;
+  std::size_t k;
+  for (k = 0; k + 2 <= n; k += 2) {
+    __m128d fi = _mm_div_pd(_mm_sub_pd(_mm_loadu_pd(x + k), xMin), res);
+    __m128d fj = _mm_div_pd(_mm_sub_pd(_mm_loadu_pd(y + k), yMin), res);
+    const __m128d valid =
+        _mm_and_pd(_mm_cmpord_pd(fi, fi), _mm_cmpord_pd(fj, fj));
+    __m128d i;
+    __m128d j;
+    __m128d dx;
+    __m128d dy;
+    __m128d omx;
+    __m128d omy;
+    __m128d acc;
+    double ij[4];
+    std::ptrdiff_t c0[4];
+    std::ptrdiff_t c1[4];
+    fi = _mm_and_pd(fi, valid);
+    fj = _mm_and_pd(fj, valid);
+    i = _mm_min_pd(_mm_max_pd(_mm_floor_pd(fi), zero), iMax);
+    j = _mm_min_pd(_mm_max_pd(_mm_floor_pd(fj), zero), jMax);
+    dx = _mm_min_pd(_mm_max_pd(_mm_sub_pd(fi, i), zero), one);
+    dy = _mm_min_pd(_mm_max_pd(_mm_sub_pd(fj, j), zero), one);
+    omx = _mm_sub_pd(one, dx);
+    omy = _mm_sub_pd(one, dy);
+    _mm_storeu_pd(ij, i);
+    _mm_storeu_pd(ij + 2, j);
+    shape.corners((std::ptrdiff_t)ij[0], (std::ptrdiff_t)ij[2], c0);
+    shape.corners((std::ptrdiff_t)ij[1], (std::ptrdiff_t)ij[3], c1);
+    acc = _mm_mul_pd(_mm_mul_pd(_mm_set_pd(Z[c1[0]], Z[c0[0]]), omx), omy);
+    acc = _mm_add_pd(
+        acc, _mm_mul_pd(_mm_mul_pd(_mm_set_pd(Z[c1[1]], Z[c0[1]]), dx), omy));
+    acc = _mm_add_pd(
+        acc, _mm_mul_pd(_mm_mul_pd(_mm_set_pd(Z[c1[2]], Z[c0[2]]), omx), dy));
+    acc = _mm_add_pd(
+        acc, _mm_mul_pd(_mm_mul_pd(_mm_set_pd(Z[c1[3]], Z[c0[3]]), dx), dy));
+    _mm_storeu_pd(z + k, _mm_blendv_pd(nanV, acc, valid));
+  }
+  return k;
+}
+
+/*  The generic AVX2 kernel gathers with 32-bit j + rows*i indices */
+template <class Shape> static bool demAvx2Fits(const Shape &shape)
+{
+  return (int64_t)shape.rows * (int64_t)shape.cols < (int64_t)INT32_MAX;
+}
+
+/*  Tiled grids are capped below 2^31 elements (demTiledNumel) */
+static bool demAvx2Fits(const DemTiledShape &)
+{
+  return true;
+}
+
+static bool demAvx2Fits(const DemPagedShape &shape)
+{
+  return shape.tileStride <= (std::ptrdiff_t)UINT32_MAX;
+}
+
+/*  0 = scalar, 1 = SSE4.1, 2 = AVX2 */
+static int demDetectSimdLevel(void)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  int level = 0;
+  __cpuid(info, 1);
+  if ((info[2] & (1 << 19)) != 0) {
+    level = 1;
+  }
+  /*  AVX2 needs OSXSAVE plus YMM state enabled by the OS */
+  if ((info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6) {
+    __cpuidex(info, 7, 0);
+    if ((info[1] & (1 << 5)) != 0) {
+      level = 2;
+    }
+  }
+  return level;
+#else
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return 2;
+  }
+  if (__builtin_cpu_supports("sse4.1")) {
+    return 1;
+  }
+  return 0;
+#endif
+}
+#endif /* DEM_HAVE_X86_SIMD */
+
+int demSimdLevel(void)
+{
+#if DEM_HAVE_X86_SIMD
+  static const int level = demDetectSimdLevel();
+  return level;
+#else
+  return 0;
+#endif
+}
+
+template <class Shape>
+static void demInterpolateShaped(const DemGrid &dem, const Shape &shape,
+                                 const double *x, const double *y, double *z,
+                                 std::size_t n)
+{
+  std::size_t k = 0;
+#if DEM_HAVE_X86_SIMD
+  const int simdLevel = demSimdLevel();
+  if (simdLevel >= 2 && demAvx2Fits(shape)) {
+    k = demInterpolateAvx2(dem, shape, x, y, z, n);
+  } else if (simdLevel >= 1) {
+    k = demInterpolateSse41(dem, shape, x, y, z, n);
+  }
+#endif
+  for (; k < n; k++) {
+    z[k] = demInterpolatePointShaped(dem, shape, x[k], y[k]);
+  }
+}
+
+void demInterpolateBatch(const DemGrid &dem, const double *x, const double *y,
+                         double *z, std::size_t n)
+{
+  if (dem.tileBits != 0) {
+    demInterpolateShaped(dem, DemPagedShape(dem), x, y, z, n);
+    return;
+  }
+  if (dem.rowOffset != NULL) {
+    demInterpolateShaped(dem, DemTiledShape(dem), x, y, z, n);
+    return;
+  }
+  /*  Fixed-size fast paths: legacy synthetic DEM and survey tiles */
+  if (dem.rows == 101 && dem.cols == 101) {
+    demInterpolateShaped(dem, DemFixedShape<101, 101>(dem), x, y, z, n);
+  } else if (dem.rows == 1024 && dem.cols == 1024) {
+    demInterpolateShaped(dem, DemFixedShape<1024, 1024>(dem), x, y, z, n);
+  } else if (dem.rows == 4096 && dem.cols == 4096) {
+    demInterpolateShaped(dem, DemFixedShape<4096, 4096>(dem), x, y, z, n);
+  } else {
+    demInterpolateShaped(dem, DemRuntimeShape(dem), x, y, z, n);
+  }
+}
+
+/*  Spread the low 3 bits of v to bits 0, 2 and 4 (Morton interleave) */
+static int32_t demSpread3(int32_t v)
+{
+  v &= 7;
+  v = (v | (v << 2)) & 0x13;
+  return (v | (v << 1)) & 0x15;
+}
+
+/*  Pages per axis, rounded up; grids are padded to whole pages */
+static int64_t demPages(int32_t n)
+{
+  return ((int64_t)n + (1 << demPageBits) - 1) >> demPageBits;
+}
+
+/*  Element count of the tiled layout, or 0 if it needs 2^31+ elements */
+std::size_t demTiledNumel(int32_t rows, int32_t cols)
+{
+  const int64_t numel = demPages(rows) * demPages(cols) * demPageNumel;
+  if (numel > (int64_t)INT32_MAX) {
+    return 0;
+  }
+  return (std::size_t)numel;
+}
+
+/*
+ * Tiled offset of post (j, i) is rowOffset[j] + colOffset[i]:
+ *   page   (j >> 6) + pagesY * (i >> 6)            column-major pages
+ *   tile   Morton(tj, ti) of the 8x8 tiles in a page, tj/ti in bits 0/1
+ *   post   (i & 7) * 8 + (j & 7)                   column-major in tile
+ * Page, Morton and in-tile terms each split into a row part plus a
+ * column part, which is what makes the tables separable.
+ */
+void demTiledIndexInit(DemTiledIndex &index, int32_t rows, int32_t cols)
+{
+  const int64_t pagesY = demPages(rows);
+  const int32_t tileMask = (1 << demTileBits) - 1;
+  int32_t j;
+  int32_t i;
+  index.rowOffset.resize((std::size_t)rows);
+  index.colOffset.resize((std::size_t)cols);
+  for (j = 0; j < rows; j++) {
+    index.rowOffset[(std::size_t)j] =
+        (j >> demPageBits) * demPageNumel +
+        (demSpread3(j >> demTileBits) << (2 * demTileBits)) + (j & tileMask);
+  }
+  for (i = 0; i < cols; i++) {
+    index.colOffset[(std::size_t)i] =
+        (int32_t)(pagesY * (i >> demPageBits) * demPageNumel) +
+        (demSpread3(i >> demTileBits) << (2 * demTileBits + 1)) +
+        ((i & tileMask) << demTileBits);
+  }
+}
+
+template <class Shape>
+static void demGridWindowShaped(const DemGrid &dem, const Shape &shape,
+                                int32_t r0, int32_t c0, int32_t nr,
+                                int32_t nc, double *out)
+{
+  int32_t i;
+  int32_t j;
+  for (i = 0; i < nc; i++) {
+    for (j = 0; j < nr; j++) {
+      *out++ = dem.Z[shape.offset(c0 + i, r0 + j)];
+    }
+  }
+}
+
+/*
+ * Copy the nr x nc block of posts starting at zero-based (r0, c0) into a
+ * column-major buffer, whatever the grid's layout. Only the pages holding
+ * the block are touched, which is what makes cropping a mapped file cheap.
+ * The caller keeps the block inside the grid.
+ */
+void demGridWindow(const DemGrid &dem, int32_t r0, int32_t c0, int32_t nr,
+                   int32_t nc, double *out)
+{
+  if (dem.tileBits != 0) {
+    demGridWindowShaped(dem, DemPagedShape(dem), r0, c0, nr, nc, out);
+  } else if (dem.rowOffset != NULL) {
+    demGridWindowShaped(dem, DemTiledShape(dem), r0, c0, nr, nc, out);
+  } else {
+    demGridWindowShaped(dem, DemRuntimeShape(dem), r0, c0, nr, nc, out);
+  }
+}
+
+/*  Scatter a column-major grid into its tiled layout (padding untouched) */
+void demTileCopy(const double *Zcol, int32_t rows, int32_t cols,
+                 const DemTiledIndex &index, double *Ztiled)
+{
+  int32_t i;
+  int32_t j;
+  for (i = 0; i < cols; i++) {
+    const double *src = Zcol + (std::ptrdiff_t)rows * i;
+    double *dst = Ztiled + index.colOffset[(std::size_t)i];
+    for (j = 0; j < rows; j++) {
+      dst[index.rowOffset[(std::size_t)j]] = src[j];
+    }
+  }
+}
+
+/* End of demKernel.cpp */
@@ -0,0 +1,67 @@
+/*
+ * demKernel.h
+ *
+ * Bilinear DEM interpolation kernels shared by the native MEX gateways.
+ * Same arithmetic as demInterpolate.m: floor, clamp the cell index to the
+ * last full cell, clamp the weights to [0, 1], then blend the four corners
+ * in the same operation order so batch and scalar results are bit-identical.
+ *
+ * Z is either MATLAB column-major or the cache-blocked tiled layout:
+ * 8x8-post tiles (one 64-byte line per tile column), Morton-ordered within
+ * 64x64-post pages, pages column-major. The tiled address of post (j, i)
+ * separates into rowOffset[j] + colOffset[i], so a lookup costs two small
+ * table reads and a 2x2 stencil usually spans two cache lines.
+ *
+ * The paged layout is what .demt tile files hold (see demTileFile.h):
+ * square tiles of 2^tileBits posts, column-major inside each tile and
+ * tiles column-major over the grid. Offsets are computed, not tabulated,
+ * and are 64-bit, so it also covers grids with more than 2^31 posts.
+ *
+ */
+
+#pragma once
+
+/* Include files */
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Type Definitions */
+struct DemGrid {
+  const double *Z;   /* rows x cols elevations, column-major (MATLAB order) */
+  int32_t rows;      /* samples along Y (Northing) */
+  int32_t cols;      /* samples along X (Easting) */
+  double xMin;       /* Easting of column 1 */
+  double yMin;       /* Northing of row 1 */
+  double resolution; /* grid spacing (meters) */
+  const int32_t *rowOffset; /* tiled layout: offset of row j (else NULL) */
+  const int32_t *colOffset; /* tiled layout: offset of column i (else NULL) */
+  int32_t tileBits; /* paged layout: log2 of the tile edge (else 0) */
+};
+
+/*  Offset tables for the tiled layout of a rows x cols grid */
+struct DemTiledIndex {
+  std::vector<int32_t> rowOffset;
+  std::vector<int32_t> colOffset;
+};
+
+/* Function Declarations */
+double demInterpolatePoint(const DemGrid &dem, double x, double y);
+
+void demInterpolateBatch(const DemGrid &dem, const double *x, const double *y,
+                         double *z, std::size_t n);
+
+std::size_t demTiledNumel(int32_t rows, int32_t cols);
+
+void demTiledIndexInit(DemTiledIndex &index, int32_t rows, int32_t cols);
+
+void demGridWindow(const DemGrid &dem, int32_t r0, int32_t c0, int32_t nr,
+                   int32_t nc, double *out);
+
+void demTileCopy(const double *Zcol, int32_t rows, int32_t cols,
+                 const DemTiledIndex &index, double *Ztiled);
+
+/*  Vector level of this CPU, detected once: 0 scalar, 1 SSE4.1, 2 AVX2 */
+int demSimdLevel(void);
+
+/* End of demKernel.h */
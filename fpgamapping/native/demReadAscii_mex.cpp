@@ -0,0 +1,82 @@
+/*
+ * demReadAscii_mex.cpp
+ *
+ * MEX gateway: [Z, header] = demReadAscii_mex(filename)
+ *              [Z, header] = demReadAscii_mex(filename, nThreads)
+ *
+ * Maps an ESRI ASCII grid and parses it in parallel (demAsciiParse.cpp)
+ * directly into the output array: Z is nrows x ncols with row 1 the
+ * southernmost (flipud of the file order) and nodata posts set to NaN.
+ * header has fields ncols, nrows, xllcorner, yllcorner, cellsize and
+ * nodata_value (NaN when the file has none). nThreads <= 0 or omitted
+ * uses every hardware thread.
+ *
+ */
+
+/* Include files */
+#include "demAsciiParse.h"
+#include "mappedFile.h"
+#include "mex.h"
+#include <cmath>
+
+/* Function Definitions */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  static const char *errId = "demReadAscii:InvalidInput";
+  static const char *fields[] = {"ncols",    "nrows",   "xllcorner",
+                                 "yllcorner", "cellsize", "nodata_value"};
+  MappedFile file;
+  DemAsciiHeader hdr;
+  char err[demAsciiErrLen];
+  const char *openErr = "";
+  char *path;
+  double v;
+  int nThreads = 0;
+  if (nrhs < 1 || nrhs > 2 || !mxIsChar(prhs[0])) {
+    mexErrMsgIdAndTxt(errId, "Usage: [Z, header] = demReadAscii_mex("
+                             "filename, nThreads)");
+  }
+  if (nlhs > 2) {
+    mexErrMsgIdAndTxt(errId, "Too many output arguments");
+  }
+  if (nrhs == 2) {
+    if (!mxIsNumeric(prhs[1]) || mxGetNumberOfElements(prhs[1]) != 1) {
+      mexErrMsgIdAndTxt(errId, "nThreads must be a numeric scalar");
+    }
+    v = mxGetScalar(prhs[1]);
+    if (!(v >= -1024.0 && v <= 1024.0) || v != std::floor(v)) {
+      mexErrMsgIdAndTxt(errId, "nThreads must be a whole number in "
+                               "[-1024, 1024]");
+    }
+    nThreads = (int)v;
+  }
+  path = mxArrayToString(prhs[0]);
+  if (!file.open(path, &openErr)) {
+    mexErrMsgIdAndTxt("demReadAscii:FileError", "%s: %s", path, openErr);
+  }
+  if (!demAsciiReadHeader((const char *)file.data(), file.size(), hdr, err)) {
+    file.close();
+    mexErrMsgIdAndTxt("demReadAscii:ParseError", "%s: %s", path, err);
+  }
+  plhs[0] = mxCreateUninitNumericMatrix((size_t)hdr.nrows,
+                                        (size_t)hdr.ncols, mxDOUBLE_CLASS,
+                                        mxREAL);
+  if (!demAsciiParseBody((const char *)file.data(), file.size(), hdr,
+                         nThreads, mxGetDoubles(plhs[0]), err)) {
+    file.close();
+    mexErrMsgIdAndTxt("demReadAscii:ParseError", "%s: %s", path, err);
+  }
+  file.close();
+  mxFree(path);
+  if (nlhs > 1) {
+    plhs[1] = mxCreateStructMatrix(1, 1, 6, fields);
+    mxSetField(plhs[1], 0, "ncols", mxCreateDoubleScalar(hdr.ncols));
+    mxSetField(plhs[1], 0, "nrows", mxCreateDoubleScalar(hdr.nrows));
+    mxSetField(plhs[1], 0, "xllcorner", mxCreateDoubleScalar(hdr.xllcorner));
+    mxSetField(plhs[1], 0, "yllcorner", mxCreateDoubleScalar(hdr.yllcorner));
+    mxSetField(plhs[1], 0, "cellsize", mxCreateDoubleScalar(hdr.cellsize));
+    mxSetField(plhs[1], 0, "nodata_value", mxCreateDoubleScalar(hdr.nodata));
+  }
+}
+
+/* End of demReadAscii_mex.cpp */
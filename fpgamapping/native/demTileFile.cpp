@@ -0,0 +1,189 @@
+/*
+ * demTileFile.cpp
+ *
+ * Reader (header validation over a mapping) and writer for .demt tiled
+ * DEM files, see demTileFile.h.
+ *
+ */
+
+/* Include files */
+#include "demTileFile.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+/* Variable Definitions */
+static const char demTileMagic[8] = {'F', 'P', 'G', 'A', 'D', 'E', 'M', 'T'};
+
+/*  Tile data starts on a page boundary so tiles map page-aligned */
+static const uint64_t demTileDataOffset = 4096;
+
+/* Function Declarations */
+static bool demHostIsLittleEndian(void);
+static uint64_t demTilesAlong(int32_t n, int32_t tileBits);
+
+/* Function Definitions */
+static bool demHostIsLittleEndian(void)
+{
+  const uint16_t probe = 1;
+  unsigned char first;
+  std::memcpy(&first, &probe, 1);
+  return first == 1;
+}
+
+static uint64_t demTilesAlong(int32_t n, int32_t tileBits)
+{
+  return ((uint64_t)n + ((uint64_t)1 << tileBits) - 1) >> tileBits;
+}
+
+/*
+ * Validate the header of a mapped .demt file and point grid at its posts.
+ * Nothing beyond the header is read.
+ */
+bool demTileFileView(const unsigned char *data, std::size_t size,
+                     DemGrid &grid, DemTileHeader &header, const char **err)
+{
+  const uint64_t maxBytes = UINT64_MAX;
+  uint64_t tileBytes;
+  uint64_t tiles;
+  uint64_t tilesX;
+  uint64_t tilesY;
+  uint64_t dataBytes;
+  if (!demHostIsLittleEndian()) {
+    *err = ".demt files are little-endian; big-endian hosts are unsupported";
+    return false;
+  }
+  if (size < sizeof(DemTileHeader)) {
+    *err = "file is too small for a .demt header";
+    return false;
+  }
+  std::memcpy(&header, data, sizeof(DemTileHeader));
+  if (std::memcmp(header.magic, demTileMagic, sizeof(demTileMagic)) != 0) {
+    *err = "not a .demt file (bad magic)";
+    return false;
+  }
+  if (header.version != demTileFileVersion) {
+    *err = "unsupported .demt version";
+    return false;
+  }
+  if ((int32_t)header.tileBits < demTileFileMinBits ||
+      (int32_t)header.tileBits > demTileFileMaxBits || header.rows < 2 ||
+      header.cols < 2 || !(header.resolution > 0.0) ||
+      !std::isfinite(header.resolution) || !std::isfinite(header.xMin) ||
+      !std::isfinite(header.yMin) || header.dataOffset % 64 != 0 ||
+      header.dataOffset < sizeof(DemTileHeader)) {
+    *err = "corrupt .demt header";
+    return false;
+  }
+  tileBytes = ((uint64_t)sizeof(double)) << (2 * header.tileBits);
+  tilesY = demTilesAlong(header.rows, (int32_t)header.tileBits);
+  tilesX = demTilesAlong(header.cols, (int32_t)header.tileBits);
+  if (tilesY > maxBytes / tilesX || tilesY * tilesX > maxBytes / tileBytes) {
+    *err = "corrupt .demt header (tile data size overflows)";
+    return false;
+  }
+  tiles = tilesY * tilesX;
+  dataBytes = tiles * tileBytes;
+  if (header.dataOffset > (uint64_t)size ||
+      dataBytes > (uint64_t)size - header.dataOffset) {
+    *err = ".demt file is truncated";
+    return false;
+  }
+  grid.Z = (const double *)(data + header.dataOffset);
+  grid.rows = header.rows;
+  grid.cols = header.cols;
+  grid.xMin = header.xMin;
+  grid.yMin = header.yMin;
+  grid.resolution = header.resolution;
+  grid.rowOffset = NULL;
+  grid.colOffset = NULL;
+  grid.tileBits = (int32_t)header.tileBits;
+  return true;
+}
+
+/*
+ * Write a column-major grid as a .demt file, one tile at a time. Posts
+ * equal to nodata (and NaN posts) are stored as NaN.
+ */
+bool demTileFileWrite(const char *path, const DemGrid &src, double nodata,
+                      int32_t tileBits, const char **err)
+{
+  DemTileHeader header;
+  std::vector<double> tile;
+  std::vector<unsigned char> pad;
+  const int32_t edge = (int32_t)1 << tileBits;
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  uint64_t tilesX;
+  uint64_t tilesY;
+  uint64_t tx;
+  uint64_t ty;
+  std::FILE *fid;
+  bool ok;
+  if (!demHostIsLittleEndian()) {
+    *err = ".demt files are little-endian; big-endian hosts are unsupported";
+    return false;
+  }
+  if (tileBits < demTileFileMinBits || tileBits > demTileFileMaxBits) {
+    *err = "tile size must be a power of two from 8 to 4096";
+    return false;
+  }
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, demTileMagic, sizeof(demTileMagic));
+  header.version = demTileFileVersion;
+  header.tileBits = (uint32_t)tileBits;
+  header.rows = src.rows;
+  header.cols = src.cols;
+  header.xMin = src.xMin;
+  header.yMin = src.yMin;
+  header.resolution = src.resolution;
+  header.nodata = nodata;
+  header.dataOffset = demTileDataOffset;
+  fid = std::fopen(path, "wb");
+  if (fid == NULL) {
+    *err = "cannot create output file";
+    return false;
+  }
+  pad.assign((std::size_t)demTileDataOffset - sizeof(header), 0);
+  ok = std::fwrite(&header, sizeof(header), 1, fid) == 1 &&
+       std::fwrite(pad.data(), pad.size(), 1, fid) == 1;
+  tilesX = demTilesAlong(src.cols, tileBits);
+  tilesY = demTilesAlong(src.rows, tileBits);
+  tile.resize((std::size_t)edge * (std::size_t)edge);
+  for (tx = 0; ok && tx < tilesX; tx++) {
+    for (ty = 0; ok && ty < tilesY; ty++) {
+      const int64_t c0 = (int64_t)tx << tileBits;
+      const int64_t r0 = (int64_t)ty << tileBits;
+      int32_t i;
+      int32_t j;
+      for (i = 0; i < edge; i++) {
+        double *dst = tile.data() + (std::ptrdiff_t)i * edge;
+        const int64_t c = c0 + i;
+        for (j = 0; j < edge; j++) {
+          const int64_t r = r0 + j;
+          double v = nan;
+          if (c < src.cols && r < src.rows) {
+            v = src.Z[r + (int64_t)src.rows * c];
+            if (v == nodata) {
+              v = nan;
+            }
+          }
+          dst[j] = v;
+        }
+      }
+      ok = std::fwrite(tile.data(), sizeof(double), tile.size(), fid) ==
+           tile.size();
+    }
+  }
+  if (std::fclose(fid) != 0) {
+    ok = false;
+  }
+  if (!ok) {
+    std::remove(path);
+    *err = "write failed (disk full?)";
+  }
+  return ok;
+}
+
+/* End of demTileFile.cpp */
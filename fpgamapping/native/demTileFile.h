@@ -0,0 +1,52 @@
+/*
+ * demTileFile.h
+ *
+ * .demt tiled DEM container. A 72-byte little-endian header is followed,
+ * at a page-aligned offset, by the elevation posts as IEEE doubles in the
+ * paged layout of demKernel.h: square tiles of 2^tileBits posts, posts
+ * column-major inside a tile, tiles column-major over the grid. Edge tiles
+ * are padded with NaN, and missing data (the source nodata value) is
+ * stored as NaN so lookups near holes return NaN like demInterpolate.m.
+ *
+ * The file is opened with a read-only mmap and the DemGrid points straight
+ * into the mapping: a tile is only read from disk when a query touches it.
+ *
+ */
+
+#pragma once
+
+/* Include files */
+#include "demKernel.h"
+#include <cstddef>
+#include <cstdint>
+
+/* Type Definitions */
+struct DemTileHeader {
+  char magic[8];       /* "FPGADEMT" */
+  uint32_t version;    /* demTileFileVersion */
+  uint32_t tileBits;   /* tile edge = 2^tileBits posts */
+  int32_t rows;        /* posts along Y (Northing) */
+  int32_t cols;        /* posts along X (Easting) */
+  double xMin;         /* Easting of column 1 */
+  double yMin;         /* Northing of row 1 */
+  double resolution;   /* grid spacing (meters) */
+  double nodata;       /* nodata value of the source raster */
+  uint64_t dataOffset; /* byte offset of tile 0 */
+  uint64_t reserved;
+};
+
+static_assert(sizeof(DemTileHeader) == 72, ".demt header must be 72 bytes");
+
+/* Variable Definitions */
+static const uint32_t demTileFileVersion = 1;
+static const int32_t demTileFileMinBits = 3;  /*   8 x   8 posts */
+static const int32_t demTileFileMaxBits = 12; /* 4096 x 4096 posts */
+
+/* Function Declarations */
+bool demTileFileView(const unsigned char *data, std::size_t size,
+                     DemGrid &grid, DemTileHeader &header, const char **err);
+
+bool demTileFileWrite(const char *path, const DemGrid &src, double nodata,
+                      int32_t tileBits, const char **err);
+
+/* End of demTileFile.h */
@@ -0,0 +1,126 @@
+/*
+ * mappedFile.cpp
+ *
+ * Read-only whole-file mapping, see mappedFile.h.
+ *
+ */
+
+/* Include files */
+#include "mappedFile.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* Function Definitions */
+MappedFile::MappedFile()
+    : data_(NULL), size_(0)
+#ifdef _WIN32
+      ,
+      file_(INVALID_HANDLE_VALUE), mapping_(NULL)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+  close();
+}
+
+#ifdef _WIN32
+bool MappedFile::open(const char *path, const char **err)
+{
+  LARGE_INTEGER len;
+  close();
+  file_ = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                      OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+  if (file_ == INVALID_HANDLE_VALUE) {
+    *err = "cannot open file";
+    return false;
+  }
+  if (!GetFileSizeEx(file_, &len) || len.QuadPart == 0) {
+    *err = "cannot map an empty file";
+    close();
+    return false;
+  }
+  mapping_ = CreateFileMappingA(file_, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (mapping_ != NULL) {
+    data_ = (const unsigned char *)MapViewOfFile(mapping_, FILE_MAP_READ, 0,
+                                                 0, 0);
+  }
+  if (data_ == NULL) {
+    *err = "cannot map file (32-bit address space exhausted?)";
+    close();
+    return false;
+  }
+  size_ = (std::size_t)len.QuadPart;
+  return true;
+}
+
+void MappedFile::close(void)
+{
+  if (data_ != NULL) {
+    UnmapViewOfFile(data_);
+  }
+  if (mapping_ != NULL) {
+    CloseHandle(mapping_);
+  }
+  if (file_ != INVALID_HANDLE_VALUE) {
+    CloseHandle(file_);
+  }
+  data_ = NULL;
+  size_ = 0;
+  mapping_ = NULL;
+  file_ = INVALID_HANDLE_VALUE;
+}
+
+#else
+bool MappedFile::open(const char *path, const char **err)
+{
+  struct stat st;
+  void *p;
+  int fd;
+  close();
+  fd = ::open(path, O_RDONLY);
+  if (fd < 0) {
+    *err = "cannot open file";
+    return false;
+  }
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    ::close(fd);
+    *err = "cannot map an empty file";
+    return false;
+  }
+  p = mmap(NULL, (std::size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  /*  The mapping keeps its own reference to the file */
+  ::close(fd);
+  if (p == MAP_FAILED) {
+    *err = "cannot map file";
+    return false;
+  }
+  /*  Lookups hop between tiles: no read-ahead beyond the faulting page */
+  (void)madvise(p, (std::size_t)st.st_size, MADV_RANDOM);
+  data_ = (const unsigned char *)p;
+  size_ = (std::size_t)st.st_size;
+  return true;
+}
+
+void MappedFile::close(void)
+{
+  if (data_ != NULL) {
+    munmap((void *)data_, size_);
+  }
+  data_ = NULL;
+  size_ = 0;
+}
+#endif
+
+/* End of mappedFile.cpp */
@@ -0,0 +1,47 @@
+/*
+ * mappedFile.h
+ *
+ * Read-only memory mapping of a whole file (POSIX mmap / Win32 file
+ * mapping). Nothing is read up front: pages are faulted in by the OS the
+ * first time they are touched, and clean pages can be dropped again under
+ * memory pressure, so mapping a file far larger than RAM is cheap.
+ *
+ */
+
+#pragma once
+
+/* Include files */
+#include <cstddef>
+
+/* Type Definitions */
+class MappedFile {
+public:
+  MappedFile();
+  ~MappedFile();
+
+  /*  Map path read-only; on failure returns false and sets *err */
+  bool open(const char *path, const char **err);
+  void close(void);
+
+  const unsigned char *data(void) const
+  {
+    return data_;
+  }
+  std::size_t size(void) const
+  {
+    return size_;
+  }
+
+private:
+  MappedFile(const MappedFile &);
+  MappedFile &operator=(const MappedFile &);
+
+  const unsigned char *data_;
+  std::size_t size_;
+#ifdef _WIN32
+  void *file_;
+  void *mapping_;
+#endif
+};
+
+/* End of mappedFile.h */
@@ -0,0 +1,209 @@
+/*
+ * mexUtil.h
+ *
+ * Small helpers shared by the hand-written MEX gateways in native/.
+ * Errors are raised with mexErrMsgIdAndTxt using the same
+ * 'function:Identifier' ids as the MATLAB sources.
+ *
+ */
+
+#pragma once
+
+/* Include files */
+#include "astarLandmarks.h"
+#include "astarTraversability.h"
+#include "demKernel.h"
+#include "mex.h"
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+/* Function Definitions */
+static inline const mxArray *mexRequireField(const mxArray *s,
+                                             const char *name,
+                                             const char *errId)
+{
+  const mxArray *f;
+  if (!mxIsStruct(s)) {
+    mexErrMsgIdAndTxt(errId, "Expected a struct input");
+  }
+  f = mxGetField(s, 0, name);
+  if (f == NULL) {
+    mexErrMsgIdAndTxt(errId, "Missing required field: %s", name);
+  }
+  return f;
+}
+
+static inline double mexScalarField(const mxArray *s, const char *name,
+                                    const char *errId)
+{
+  const mxArray *f = mexRequireField(s, name, errId);
+  if (!mxIsDouble(f) || mxIsComplex(f) || mxGetNumberOfElements(f) != 1) {
+    mexErrMsgIdAndTxt(errId, "Field %s must be a real double scalar", name);
+  }
+  return mxGetScalar(f);
+}
+
+static inline const double *mexDoubleArray(const mxArray *a, const char *name,
+                                           const char *errId)
+{
+  if (!mxIsDouble(a) || mxIsComplex(a) || mxIsSparse(a)) {
+    mexErrMsgIdAndTxt(errId, "%s must be a real, full double array", name);
+  }
+  return mxGetDoubles(a);
+}
+
+/*
+ * True when demData.layout asks for the tiled resident layout. A missing
+ * field means 'column'; anything else is rejected.
+ */
+static inline bool mexDemTiledLayout(const mxArray *demData, const char *errId)
+{
+  char layout[8];
+  const mxArray *f = mxGetField(demData, 0, "layout");
+  if (f == NULL) {
+    return false;
+  }
+  if (!mxIsChar(f) || mxGetString(f, layout, sizeof(layout)) != 0 ||
+      (std::strcmp(layout, "column") != 0 &&
+       std::strcmp(layout, "tiled") != 0)) {
+    mexErrMsgIdAndTxt(errId, "demData.layout must be 'column' or 'tiled'");
+  }
+  return layout[0] == 't';
+}
+
+/*
+ * Build a DemGrid view over a demData struct. Z is referenced in place;
+ * nothing is copied, so the view is only valid while demData is alive.
+ */
+static inline DemGrid mexDemGridFromStruct(const mxArray *demData,
+                                           const char *errId)
+{
+  DemGrid dem;
+  const mxArray *Z = mexRequireField(demData, "Z", errId);
+  dem.Z = mexDoubleArray(Z, "demData.Z", errId);
+  if (mxGetNumberOfDimensions(Z) != 2 || mxGetM(Z) < 2 || mxGetN(Z) < 2) {
+    mexErrMsgIdAndTxt(errId, "demData.Z must be a 2-D grid of at least 2x2");
+  }
+  if (mxGetM(Z) > (size_t)INT32_MAX || mxGetN(Z) > (size_t)INT32_MAX) {
+    mexErrMsgIdAndTxt(errId, "demData.Z has too many rows or columns");
+  }
+  dem.rows = (int32_t)mxGetM(Z);
+  dem.cols = (int32_t)mxGetN(Z);
+  dem.resolution = mexScalarField(demData, "resolution", errId);
+  dem.xMin = mexScalarField(demData, "xMin", errId);
+  dem.yMin = mexScalarField(demData, "yMin", errId);
+  dem.rowOffset = NULL;
+  dem.colOffset = NULL;
+  dem.tileBits = 0;
+  if (!(dem.resolution > 0.0)) {
+    mexErrMsgIdAndTxt(errId, "demData.resolution must be positive");
+  }
+  return dem;
+}
+
+/*
+ * View of the planners' obstacles struct (grid, resolution, bounds). []
+ * or a struct without a grid means no obstacles. Logical grids are used
+ * in place; double grids are converted (> 0 = blocked) into cells.
+ */
+static inline AstarObstacles mexAstarObstacles(const mxArray *obstacles,
+                                               std::vector<uint8_t> &cells,
+                                               const char *errId)
+{
+  AstarObstacles obs;
+  const mxArray *grid;
+  const mxArray *bounds;
+  const double *v;
+  std::size_t n;
+  std::size_t k;
+  obs.cells = NULL;
+  obs.rows = 0;
+  obs.cols = 0;
+  obs.x0 = 0.0;
+  obs.y0 = 0.0;
+  obs.res = 1.0;
+  if (!mxIsStruct(obstacles) || mxGetFieldNumber(obstacles, "grid") < 0 ||
+      mxIsEmpty(mxGetField(obstacles, 0, "grid"))) {
+    return obs;
+  }
+  grid = mxGetField(obstacles, 0, "grid");
+  n = mxGetNumberOfElements(grid);
+  if (mxIsLogical(grid)) {
+    obs.cells = (const uint8_t *)mxGetLogicals(grid);
+  } else if (mxIsDouble(grid) && !mxIsComplex(grid) && !mxIsSparse(grid)) {
+    v = mxGetDoubles(grid);
+    cells.resize(n);
+    for (k = 0; k < n; k++) {
+      cells[k] = v[k] > 0;
+    }
+    obs.cells = &cells[0];
+  } else {
+    mexErrMsgIdAndTxt(errId, "obstacles.grid must be double or logical");
+  }
+  if (mxGetM(grid) > (size_t)INT32_MAX || mxGetN(grid) > (size_t)INT32_MAX) {
+    mexErrMsgIdAndTxt(errId, "obstacles.grid has too many rows or columns");
+  }
+  obs.rows = (int32_t)mxGetM(grid);
+  obs.cols = (int32_t)mxGetN(grid);
+  obs.res = mexScalarField(obstacles, "resolution", errId);
+  bounds = mexRequireField(obstacles, "bounds", errId);
+  v = mexDoubleArray(bounds, "obstacles.bounds", errId);
+  if (mxGetNumberOfElements(bounds) < 3) {
+    mexErrMsgIdAndTxt(errId, "obstacles.bounds must be [xMin xMax yMin yMax]");
+  }
+  obs.x0 = v[0];
+  obs.y0 = v[2];
+  return obs;
+}
+
+/*
+ * obstacles.traversability (uint8, one byte per DEM post) or NULL when
+ * the field is absent or empty.
+ */
+static inline const uint8_t *mexTraversability(const mxArray *obstacles,
+                                               const DemGrid &dem,
+                                               const char *errId)
+{
+  const mxArray *f;
+  if (!mxIsStruct(obstacles)) {
+    return NULL;
+  }
+  f = mxGetField(obstacles, 0, "traversability");
+  if (f == NULL || mxIsEmpty(f)) {
+    return NULL;
+  }
+  if (!mxIsUint8(f) || mxGetM(f) != (size_t)dem.rows ||
+      mxGetN(f) != (size_t)dem.cols) {
+    mexErrMsgIdAndTxt(errId, "obstacles.traversability must be a uint8 "
+                             "array the size of demData.Z");
+  }
+  return (const uint8_t *)mxGetUint8s(f);
+}
+
+/*
+ * View of landmarks.dist (single, rows x cols x K, see astarLandmarks.m)
+ * in the struct landmarks; false when landmarks is not a struct.
+ */
+static inline bool mexAstarLandmarks(const mxArray *landmarks,
+                                     const DemGrid &dem, AstarLandmarks &lm,
+                                     const char *errId)
+{
+  const mxArray *f;
+  const mwSize *dims;
+  if (landmarks == NULL || !mxIsStruct(landmarks)) {
+    return false;
+  }
+  f = mexRequireField(landmarks, "dist", errId);
+  dims = mxGetDimensions(f);
+  if (!mxIsSingle(f) || mxIsComplex(f) || mxGetNumberOfDimensions(f) > 3 ||
+      dims[0] != (mwSize)dem.rows || dims[1] != (mwSize)dem.cols) {
+    mexErrMsgIdAndTxt(errId, "landmarks.dist must be a single array of "
+                             "size(demData.Z) x K");
+  }
+  lm.dist = mxGetSingles(f);
+  lm.count = mxGetNumberOfDimensions(f) == 3 ? (int32_t)dims[2] : 1;
+  return true;
+}
+
+/* End of mexUtil.h */
@@ -0,0 +1,81 @@
+/*
+ * obstacleGrid_mex.cpp
+ *
+ * MEX gateway: [grid, steepCells] = obstacleGrid_mex(demData, maxSlope,
+ *                                                    bufferCells, nThreads)
+ *
+ * Steps 1 and 2 of obstacleGrid.m (obstacleKernel.cpp): grid is a logical
+ * array the size of demData.Z holding the posts steeper than maxSlope
+ * (degrees), grown by a square of bufferCells posts on every side;
+ * steepCells counts the steep posts before the buffer. nThreads <= 0 uses
+ * every hardware thread.
+ *
+ */
+
+/* Include files */
+#include "mexUtil.h"
+#include "obstacleKernel.h"
+#include <cmath>
+
+/* Function Declarations */
+static double obstacleIntegerArg(const mxArray *a, double lo, double hi,
+                                 const char *name, const char *errId);
+
+/* Function Definitions */
+/*
+ * Scalar a as a whole number in [lo, hi], raising errId otherwise (NaN
+ * included)
+ */
+static double obstacleIntegerArg(const mxArray *a, double lo, double hi,
+                                 const char *name, const char *errId)
+{
+  double v;
+  if (mxGetNumberOfElements(a) != 1) {
+    mexErrMsgIdAndTxt(errId, "%s must be a scalar", name);
+  }
+  v = mexDoubleArray(a, name, errId)[0];
+  if (!(v >= lo && v <= hi) || v != std::floor(v)) {
+    mexErrMsgIdAndTxt(errId, "%s must be a whole number in [%.0f, %.0f]",
+                      name, lo, hi);
+  }
+  return v;
+}
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  static const char *errId = "obstacleGrid:InvalidInput";
+  DemGrid dem;
+  int64_t steep = 0;
+  int32_t radius;
+  int nThreads;
+  const char *err = "";
+  if (nrhs != 4) {
+    mexErrMsgIdAndTxt(errId, "Usage: [grid, steepCells] = obstacleGrid_mex("
+                             "demData, maxSlope, bufferCells, nThreads)");
+  }
+  if (nlhs > 2) {
+    mexErrMsgIdAndTxt(errId, "Too many output arguments");
+  }
+  dem = mexDemGridFromStruct(prhs[0], errId);
+  if (!mxIsDouble(prhs[1]) || mxGetNumberOfElements(prhs[1]) != 1) {
+    mexErrMsgIdAndTxt(errId, "maxSlope must be a double scalar");
+  }
+  radius = (int32_t)obstacleIntegerArg(prhs[2], 0.0, INT32_MAX, "bufferCells",
+                                      errId);
+  nThreads = (int)obstacleIntegerArg(prhs[3], -1024.0, 1024.0, "nThreads",
+                                     errId);
+
+  plhs[0] = mxCreateLogicalMatrix(dem.rows, dem.cols);
+  if (!obstacleSlopeCells(dem, mxGetScalar(prhs[1]), nThreads,
+                          (uint8_t *)mxGetLogicals(plhs[0]), steep, &err) ||
+      !obstacleDilate((uint8_t *)mxGetLogicals(plhs[0]), dem.rows, dem.cols,
+                      radius, nThreads, &err)) {
+    mxDestroyArray(plhs[0]);
+    mexErrMsgIdAndTxt(errId, "%s", err);
+  }
+  if (nlhs > 1) {
+    plhs[1] = mxCreateDoubleScalar((double)steep);
+  }
+}
+
+/* End of obstacleGrid_mex.cpp */
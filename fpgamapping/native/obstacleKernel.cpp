@@ -0,0 +1,412 @@
+/*
+ * obstacleKernel.cpp
+ *
+ * Slope cells and square buffer dilation for obstacleGrid.m (see
+ * obstacleKernel.h).
+ *
+ */
+
+/* Include files */
+#include "obstacleKernel.h"
+#include "astarTraversability.h"
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+    defined(_M_IX86)
+#define OBSTACLE_HAVE_X86_SIMD 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#define OBSTACLE_TARGET(isa)
+#else
+#define OBSTACLE_TARGET(isa) __attribute__((target(isa)))
+#endif
+#else
+#define OBSTACLE_HAVE_X86_SIMD 0
+#endif
+
+/* Type Definitions */
+enum ObstacleStep {
+  obstacleStepSlope = 0,   /* bands of columns */
+  obstacleStepColumns = 1, /* dilation down the columns, bands of columns */
+  obstacleStepRows = 2     /* dilation across the columns, bands of rows */
+};
+
+struct ObstacleJob {
+  ObstacleStep step;
+  const double *Z;
+  uint8_t *cells;
+  int32_t rows;
+  int32_t cols;
+  int32_t radius;
+  double limit; /* tan(maxSlope)^2 * (2 res)^2 */
+  int32_t bandSize;
+  int32_t nBands;
+  std::atomic<int32_t> next;
+  std::atomic<int64_t> steep;
+  std::atomic<bool> failed;
+};
+
+/* Function Declarations */
+static int64_t obstacleSlopeColumn(const double *Z, int32_t rows,
+                                   int32_t col, double limit,
+                                   uint8_t *cells);
+#if OBSTACLE_HAVE_X86_SIMD
+static int32_t obstacleSlopeSse2(const double *c, int32_t rows,
+                                 double limit, uint8_t *out);
+OBSTACLE_TARGET("avx2")
+static int32_t obstacleSlopeAvx2(const double *c, int32_t rows,
+                                 double limit, uint8_t *out);
+#endif
+static void obstacleDilateLine(uint8_t *line, int32_t n, int32_t radius,
+                               std::vector<uint8_t> &pad,
+                               std::vector<uint8_t> &g,
+                               std::vector<uint8_t> &h);
+static inline const uint8_t *obstacleBandAt(const uint8_t *cells,
+                                            int32_t rows, int32_t cols,
+                                            int32_t radius, int32_t r0,
+                                            int32_t k);
+static void obstacleDilateRows(uint8_t *cells, int32_t rows, int32_t cols,
+                               int32_t radius, int32_t r0, int32_t r1,
+                               std::vector<uint8_t> &g,
+                               std::vector<uint8_t> &h);
+static void obstacleRun(ObstacleJob *job);
+static bool obstacleRunBands(ObstacleJob &job, int nThreads,
+                             const char **err);
+
+/* Function Definitions */
+#if OBSTACLE_HAVE_X86_SIMD
+/*
+ * Posts 1 .. 2m of the column starting at c (m pairs), two at a time; the
+ * neighbouring columns are c - rows and c + rows. Returns the pairs done.
+ */
+static int32_t obstacleSlopeSse2(const double *c, int32_t rows,
+                                 double limit, uint8_t *out)
+{
+  const __m128d lim = _mm_set1_pd(limit);
+  int32_t j;
+  int bits;
+  for (j = 1; j + 2 <= rows - 1; j += 2) {
+    const __m128d gx = _mm_sub_pd(_mm_loadu_pd(c + rows + j),
+                                  _mm_loadu_pd(c - rows + j));
+    const __m128d gy =
+        _mm_sub_pd(_mm_loadu_pd(c + j + 1), _mm_loadu_pd(c + j - 1));
+    bits = _mm_movemask_pd(_mm_cmpgt_pd(
+        _mm_add_pd(_mm_mul_pd(gx, gx), _mm_mul_pd(gy, gy)), lim));
+    out[j] = (uint8_t)(bits & 1);
+    out[j + 1] = (uint8_t)((bits >> 1) & 1);
+  }
+  return j;
+}
+
+/*  As obstacleSlopeSse2, four posts at a time */
+OBSTACLE_TARGET("avx2")
+static int32_t obstacleSlopeAvx2(const double *c, int32_t rows,
+                                 double limit, uint8_t *out)
+{
+  const __m256d lim = _mm256_set1_pd(limit);
+  int32_t j;
+  int bits;
+  for (j = 1; j + 4 <= rows - 1; j += 4) {
+    const __m256d gx = _mm256_sub_pd(_mm256_loadu_pd(c + rows + j),
+                                     _mm256_loadu_pd(c - rows + j));
+    const __m256d gy = _mm256_sub_pd(_mm256_loadu_pd(c + j + 1),
+                                     _mm256_loadu_pd(c + j - 1));
+    bits = _mm256_movemask_pd(_mm256_cmp_pd(
+        _mm256_add_pd(_mm256_mul_pd(gx, gx), _mm256_mul_pd(gy, gy)), lim,
+        _CMP_GT_OQ));
+    out[j] = (uint8_t)(bits & 1);
+    out[j + 1] = (uint8_t)((bits >> 1) & 1);
+    out[j + 2] = (uint8_t)((bits >> 2) & 1);
+    out[j + 3] = (uint8_t)((bits >> 3) & 1);
+  }
+  return j;
+}
+#endif
+
+/*  One column of obstacleSlopeCells; returns its steep count */
+static int64_t obstacleSlopeColumn(const double *Z, int32_t rows,
+                                   int32_t col, double limit,
+                                   uint8_t *cells)
+{
+  const double *c = Z + (std::ptrdiff_t)col * rows;
+  uint8_t *out = cells + (std::ptrdiff_t)col * rows;
+  int64_t steep = 0;
+  int32_t j = 1;
+  double gx;
+  double gy;
+  out[0] = 0;
+  out[rows - 1] = 0;
+#if OBSTACLE_HAVE_X86_SIMD
+  if (demSimdLevel() >= 2) {
+    j = obstacleSlopeAvx2(c, rows, limit, out);
+  } else {
+    j = obstacleSlopeSse2(c, rows, limit, out);
+  }
+#endif
+  for (; j < rows - 1; j++) {
+    gx = c[rows + j] - c[j - rows];
+    gy = c[j + 1] - c[j - 1];
+    out[j] = (uint8_t)(gx * gx + gy * gy > limit);
+  }
+  for (j = 1; j < rows - 1; j++) {
+    steep += out[j];
+  }
+  return steep;
+}
+
+/*
+ * van Herk / Gil-Werman max filter of window 2 radius + 1 over one line,
+ * zero outside it. pad holds the line with radius zeros on either side;
+ * g / h are prefix / suffix maxima within blocks of one window.
+ */
+static void obstacleDilateLine(uint8_t *line, int32_t n, int32_t radius,
+                               std::vector<uint8_t> &pad,
+                               std::vector<uint8_t> &g,
+                               std::vector<uint8_t> &h)
+{
+  const int32_t w = 2 * radius + 1;
+  const int32_t m = n + 2 * radius;
+  int32_t b0;
+  int32_t b1;
+  int32_t k;
+  pad.assign((std::size_t)m, 0);
+  g.resize((std::size_t)m);
+  h.resize((std::size_t)m);
+  std::copy(line, line + n, pad.begin() + radius);
+  for (b0 = 0; b0 < m; b0 = b1) {
+    b1 = std::min(b0 + w, m);
+    g[b0] = pad[b0];
+    for (k = b0 + 1; k < b1; k++) {
+      g[k] = std::max(g[k - 1], pad[k]);
+    }
+    h[b1 - 1] = pad[b1 - 1];
+    for (k = b1 - 2; k >= b0; k--) {
+      h[k] = std::max(h[k + 1], pad[k]);
+    }
+  }
+  for (k = 0; k < n; k++) {
+    line[k] = std::max(h[k], g[k + 2 * radius]); /* window k .. k + 2r */
+  }
+}
+
+/*  Row r0 of padded column k (column k - radius), or NULL in the padding */
+static inline const uint8_t *obstacleBandAt(const uint8_t *cells,
+                                            int32_t rows, int32_t cols,
+                                            int32_t radius, int32_t r0,
+                                            int32_t k)
+{
+  if (k < radius || k >= cols + radius) {
+    return NULL;
+  }
+  return cells + (std::ptrdiff_t)(k - radius) * rows + r0;
+}
+
+/*
+ * The same filter across the columns for rows r0 .. r1 - 1: every step of
+ * the line recurrence is applied to a whole band of rows at once, so the
+ * inner loops run over contiguous bytes.
+ */
+static void obstacleDilateRows(uint8_t *cells, int32_t rows, int32_t cols,
+                               int32_t radius, int32_t r0, int32_t r1,
+                               std::vector<uint8_t> &g,
+                               std::vector<uint8_t> &h)
+{
+  const int32_t w = 2 * radius + 1;
+  const int32_t m = cols + 2 * radius;
+  const std::size_t nb = (std::size_t)(r1 - r0);
+  const uint8_t *src;
+  uint8_t *dst;
+  uint8_t *gk;
+  uint8_t *hk;
+  int32_t b0;
+  int32_t b1;
+  int32_t k;
+  std::size_t r;
+  g.resize((std::size_t)m * nb);
+  h.resize((std::size_t)m * nb);
+
+  for (b0 = 0; b0 < m; b0 = b1) {
+    b1 = std::min(b0 + w, m);
+    for (k = b0; k < b1; k++) {
+      gk = &g[(std::size_t)k * nb];
+      src = obstacleBandAt(cells, rows, cols, radius, r0, k);
+      if (k == b0) {
+        if (src != NULL) {
+          std::copy(src, src + nb, gk);
+        } else {
+          std::fill(gk, gk + nb, (uint8_t)0);
+        }
+      } else if (src != NULL) {
+        for (r = 0; r < nb; r++) {
+          gk[r] = std::max(gk[r - nb], src[r]);
+        }
+      } else {
+        std::copy(gk - nb, gk, gk);
+      }
+    }
+    for (k = b1 - 1; k >= b0; k--) {
+      hk = &h[(std::size_t)k * nb];
+      src = obstacleBandAt(cells, rows, cols, radius, r0, k);
+      if (k == b1 - 1) {
+        if (src != NULL) {
+          std::copy(src, src + nb, hk);
+        } else {
+          std::fill(hk, hk + nb, (uint8_t)0);
+        }
+      } else if (src != NULL) {
+        for (r = 0; r < nb; r++) {
+          hk[r] = std::max(hk[r + nb], src[r]);
+        }
+      } else {
+        std::copy(hk + nb, hk + 2 * nb, hk);
+      }
+    }
+  }
+  for (k = 0; k < cols; k++) {
+    hk = &h[(std::size_t)k * nb];
+    gk = &g[(std::size_t)(k + 2 * radius) * nb];
+    dst = cells + (std::ptrdiff_t)k * rows + r0;
+    for (r = 0; r < nb; r++) {
+      dst[r] = std::max(hk[r], gk[r]); /* window k .. k + 2r */
+    }
+  }
+}
+
+static void obstacleRun(ObstacleJob *job)
+{
+  std::vector<uint8_t> pad;
+  std::vector<uint8_t> g;
+  std::vector<uint8_t> h;
+  int64_t steep = 0;
+  int32_t band;
+  int32_t lo;
+  int32_t hi;
+  int32_t k;
+  try {
+    while ((band = job->next.fetch_add(1)) < job->nBands) {
+      lo = band * job->bandSize;
+      if (job->step == obstacleStepRows) {
+        hi = std::min(lo + job->bandSize, job->rows);
+        obstacleDilateRows(job->cells, job->rows, job->cols, job->radius,
+                           lo, hi, g, h);
+        continue;
+      }
+      hi = std::min(lo + job->bandSize, job->cols);
+      for (k = lo; k < hi; k++) {
+        if (job->step == obstacleStepColumns) {
+          obstacleDilateLine(job->cells + (std::ptrdiff_t)k * job->rows,
+                             job->rows, job->radius, pad, g, h);
+        } else if (k == 0 || k == job->cols - 1) {
+          std::fill(job->cells + (std::ptrdiff_t)k * job->rows,
+                    job->cells + (std::ptrdiff_t)(k + 1) * job->rows,
+                    (uint8_t)0);
+        } else {
+          steep += obstacleSlopeColumn(job->Z, job->rows, k, job->limit,
+                                       job->cells);
+        }
+      }
+    }
+  } catch (const std::bad_alloc &) {
+    job->failed.store(true);
+  }
+  job->steep.fetch_add(steep);
+}
+
+/*  Worker 0 runs on the calling thread; the others take bands as it does */
+static bool obstacleRunBands(ObstacleJob &job, int nThreads,
+                             const char **err)
+{
+  std::vector<std::thread> threads;
+  std::size_t t;
+  int n;
+  if (nThreads < 1) {
+    nThreads = (int)std::thread::hardware_concurrency();
+  }
+  n = std::min(std::max(nThreads, 1), job.nBands);
+  job.next.store(0);
+  job.steep.store(0);
+  job.failed.store(false);
+  for (; n > 1; n--) {
+    try {
+      threads.push_back(std::thread(obstacleRun, &job));
+    } catch (...) {
+      break;
+    }
+  }
+  obstacleRun(&job);
+  for (t = 0; t < threads.size(); t++) {
+    threads[t].join();
+  }
+  if (job.failed.load()) {
+    *err = "out of memory";
+    return false;
+  }
+  return true;
+}
+
+bool obstacleSlopeCells(const DemGrid &dem, double maxSlope, int nThreads,
+                        uint8_t *cells, int64_t &steep, const char **err)
+{
+  ObstacleJob job;
+  steep = 0;
+  if (dem.rows < 1 || dem.cols < 1) {
+    *err = "DEM grid is empty";
+    return false;
+  }
+  if (!(dem.resolution > 0.0)) {
+    *err = "DEM resolution must be positive";
+    return false;
+  }
+  if (dem.rows < 3 || dem.cols < 3) {
+    std::fill(cells, cells + (std::size_t)dem.rows * dem.cols, (uint8_t)0);
+    return true; /* no interior posts */
+  }
+  job.step = obstacleStepSlope;
+  job.Z = dem.Z;
+  job.cells = cells;
+  job.rows = dem.rows;
+  job.cols = dem.cols;
+  job.radius = 0;
+  job.limit = astarSlopeTan2(maxSlope) * 4.0 * dem.resolution *
+              dem.resolution;
+  job.bandSize = std::max(1, 65536 / dem.rows);
+  job.nBands = (dem.cols + job.bandSize - 1) / job.bandSize;
+  if (!obstacleRunBands(job, nThreads, err)) {
+    return false;
+  }
+  steep = job.steep.load();
+  return true;
+}
+
+bool obstacleDilate(uint8_t *cells, int32_t rows, int32_t cols,
+                    int32_t radius, int nThreads, const char **err)
+{
+  ObstacleJob job;
+  if (radius < 1 || rows < 1 || cols < 1) {
+    return true; /* an empty window range dilates nothing */
+  }
+  job.Z = NULL;
+  job.cells = cells;
+  job.rows = rows;
+  job.cols = cols;
+  job.radius = std::min(radius, std::max(rows, cols)); /* same result */
+  job.limit = 0.0;
+
+  job.step = obstacleStepColumns;
+  job.bandSize = std::max(1, 65536 / rows);
+  job.nBands = (cols + job.bandSize - 1) / job.bandSize;
+  if (!obstacleRunBands(job, nThreads, err)) {
+    return false;
+  }
+
+  job.step = obstacleStepRows;
+  job.bandSize = 64;
+  job.nBands = (rows + job.bandSize - 1) / job.bandSize;
+  return obstacleRunBands(job, nThreads, err);
+}
+
+/* End of obstacleKernel.cpp */
@@ -0,0 +1,47 @@
+/*
+ * obstacleKernel.h
+ *
+ * Steps 1 and 2 of obstacleGrid.m: steep-terrain cells and their square
+ * safety buffer, on the DEM grid (column-major, one byte per cell).
+ *
+ * Slope is the central difference of obstacleGrid.m at every interior
+ * post, and a post is steep when atan(|grad z|) > maxSlope. The test is
+ * gx^2 + gy^2 > tan(maxSlope)^2 * (2 res)^2 on the raw differences, so no
+ * division or trig runs per post, and the columns are swept two (SSE2) or
+ * four (AVX2) posts at a time. Border posts and NaN neighbourhoods are
+ * never steep.
+ *
+ * The buffer is a (2 radius + 1)^2 square dilation, made separable and
+ * linear in the grid size with the van Herk / Gil-Werman max filter: the
+ * line is cut into blocks of one window, and the maximum over any window
+ * is the larger of a suffix maximum in one block and a prefix maximum in
+ * the next. Each axis costs three comparisons per cell whatever the
+ * radius. The pass down the columns runs per column; the pass across
+ * them runs over bands of rows, so its inner loops stay contiguous.
+ *
+ * Both steps split the grid into bands that the workers of a small pool
+ * take in turn; worker 0 is the calling thread.
+ *
+ */
+
+#pragma once
+
+/* Include files */
+#include "demKernel.h"
+#include <cstddef>
+#include <cstdint>
+
+/* Function Declarations */
+/*
+ * cells[k] = 1 where post k is steeper than maxSlope (degrees), else 0;
+ * steep counts them. Only dem.Z / rows / cols / resolution are read.
+ * nThreads <= 0 uses every hardware thread.
+ */
+bool obstacleSlopeCells(const DemGrid &dem, double maxSlope, int nThreads,
+                        uint8_t *cells, int64_t &steep, const char **err);
+
+/*  Square dilation of a rows x cols 0/1 grid in place, radius in cells */
+bool obstacleDilate(uint8_t *cells, int32_t rows, int32_t cols,
+                    int32_t radius, int nThreads, const char **err);
+
+/* End of obstacleKernel.h */
@@ -0,0 +1,732 @@
+/*
+ * obstacleZones.cpp
+ *
+ * Scanline rasterizer, R-tree and tiled layer for the custom no-fly zones
+ * of obstacleGrid.m (see obstacleZones.h).
+ *
+ */
+
+/* Include files */
+#include "obstacleZones.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+/* Type Definitions */
+struct ObstacleEdge {
+  double xLo;
+  double xHi;
+  double x0; /* end with the lower x */
+  double y0;
+  double slope; /* dy / dx */
+};
+
+/* Variable Definitions */
+static const std::size_t zoneTreeMax = 16;
+static const std::size_t zoneTreeMin = 4;
+
+/* Function Declarations */
+static bool obstacleCircleIn(const ObstacleRaster &r, const double *c,
+                             double x, int32_t i);
+static bool obstacleRectRowIn(const ObstacleRaster &r, const double *q,
+                              int32_t i);
+static bool obstacleRectColIn(const ObstacleRaster &r, const double *q,
+                              int32_t j);
+static void obstacleFillCircle(const ObstacleRaster &r, const double *c,
+                               const int32_t w[4], uint8_t *cells);
+static void obstacleFillRect(const ObstacleRaster &r, const double *q,
+                             const int32_t w[4], uint8_t *cells);
+static void obstacleFillPolygon(const ObstacleRaster &r,
+                                const ObstacleZone &z, const int32_t w[4],
+                                uint8_t *cells);
+static bool obstacleEdgeOrder(const ObstacleEdge &a, const ObstacleEdge &b);
+static int32_t obstacleClampIndex(double v, int32_t lo, int32_t hi);
+static double obstacleBoxGrowth(const double *a, const double *b);
+static bool obstacleBoxOverlap(const double *a, const double *b);
+static bool obstacleBoxContains(const double *a, const double *b);
+
+/* Function Definitions */
+/*  The test of the original loop, on post (i, x) */
+static bool obstacleCircleIn(const ObstacleRaster &r, const double *c,
+                             double x, int32_t i)
+{
+  const double y = r.yMin + (double)i * r.res;
+  return std::sqrt((x - c[0]) * (x - c[0]) + (y - c[1]) * (y - c[1])) < c[2];
+}
+
+static bool obstacleRectRowIn(const ObstacleRaster &r, const double *q,
+                              int32_t i)
+{
+  const double y = r.yMin + (double)i * r.res;
+  return y >= q[1] && y <= q[1] + q[3];
+}
+
+static bool obstacleRectColIn(const ObstacleRaster &r, const double *q,
+                              int32_t j)
+{
+  const double x = r.xMin + (double)j * r.res;
+  return x >= q[0] && x <= q[0] + q[2];
+}
+
+static int32_t obstacleClampIndex(double v, int32_t lo, int32_t hi)
+{
+  if (!(v > (double)lo)) {
+    return lo; /* also NaN */
+  }
+  if (v > (double)hi) {
+    return hi;
+  }
+  return (int32_t)v;
+}
+
+/*
+ *  Per column: the half chord sqrt(r^2 - dx^2) estimates the span, then
+ *  its ends move until the original test agrees at both.
+ */
+static void obstacleFillCircle(const ObstacleRaster &r, const double *c,
+                               const int32_t w[4], uint8_t *cells)
+{
+  int32_t j;
+  int32_t lo;
+  int32_t hi;
+  double x;
+  double h2;
+  double h;
+  for (j = w[2]; j < w[3]; j++) {
+    x = r.xMin + (double)j * r.res;
+    h2 = c[2] * c[2] - (x - c[0]) * (x - c[0]);
+    h = h2 > 0.0 ? std::sqrt(h2) : 0.0;
+    lo = obstacleClampIndex(std::ceil((c[1] - h - r.yMin) / r.res), w[0],
+                            w[1] - 1);
+    hi = obstacleClampIndex(std::floor((c[1] + h - r.yMin) / r.res), w[0],
+                            w[1] - 1);
+    while (lo > w[0] && obstacleCircleIn(r, c, x, lo - 1)) {
+      lo--;
+    }
+    while (hi < w[1] - 1 && obstacleCircleIn(r, c, x, hi + 1)) {
+      hi++;
+    }
+    while (lo <= hi && !obstacleCircleIn(r, c, x, lo)) {
+      lo++;
+    }
+    while (hi >= lo && !obstacleCircleIn(r, c, x, hi)) {
+      hi--;
+    }
+    if (lo <= hi) {
+      std::memset(cells + (std::size_t)j * r.rows + lo, 1,
+                  (std::size_t)(hi - lo + 1));
+    }
+  }
+}
+
+/*  One span of rows and one of columns, each settled by the exact test */
+static void obstacleFillRect(const ObstacleRaster &r, const double *q,
+                             const int32_t w[4], uint8_t *cells)
+{
+  int32_t i0 = w[0];
+  int32_t i1 = w[1] - 1;
+  int32_t j0 = w[2];
+  int32_t j1 = w[3] - 1;
+  int32_t j;
+  while (i0 <= i1 && !obstacleRectRowIn(r, q, i0)) {
+    i0++;
+  }
+  while (i1 >= i0 && !obstacleRectRowIn(r, q, i1)) {
+    i1--;
+  }
+  while (j0 <= j1 && !obstacleRectColIn(r, q, j0)) {
+    j0++;
+  }
+  while (j1 >= j0 && !obstacleRectColIn(r, q, j1)) {
+    j1--;
+  }
+  if (i0 > i1) {
+    return;
+  }
+  for (j = j0; j <= j1; j++) {
+    std::memset(cells + (std::size_t)j * r.rows + i0, 1,
+                (std::size_t)(i1 - i0 + 1));
+  }
+}
+
+static bool obstacleEdgeOrder(const ObstacleEdge &a, const ObstacleEdge &b)
+{
+  return a.xLo < b.xLo;
+}
+
+/*
+ *  Even-odd fill, one column per scanline. An edge crosses column x when
+ *  xLo <= x < xHi, so shared vertices count once and vertical edges never;
+ *  rows between each pair of sorted crossings are inside.
+ */
+static void obstacleFillPolygon(const ObstacleRaster &r,
+                                const ObstacleZone &z, const int32_t w[4],
+                                uint8_t *cells)
+{
+  const std::size_t n = z.xy.size() / 2;
+  const double *px = z.xy.empty() ? NULL : &z.xy[0];
+  const double *py = px + n;
+  std::vector<ObstacleEdge> edges;
+  std::vector<std::size_t> active;
+  std::vector<double> cross;
+  ObstacleEdge e;
+  std::size_t first = 0;
+  std::size_t next = 0;
+  std::size_t k;
+  std::size_t b;
+  std::size_t m;
+  int32_t j;
+  int32_t lo;
+  int32_t hi;
+  double x;
+
+  /*  Edges of every ring; a NaN row closes the ring it ends */
+  for (k = 0; k <= n; k++) {
+    if (k < n && px[k] == px[k] && py[k] == py[k]) {
+      continue;
+    }
+    for (b = first; k >= first + 3 && b < k; b++) {
+      m = (b + 1 < k) ? b + 1 : first;
+      if (px[b] == px[m]) {
+        continue;
+      }
+      if (px[b] < px[m]) {
+        e.x0 = px[b];
+        e.y0 = py[b];
+        e.xHi = px[m];
+      } else {
+        e.x0 = px[m];
+        e.y0 = py[m];
+        e.xHi = px[b];
+      }
+      e.xLo = e.x0;
+      e.slope = (py[m] - py[b]) / (px[m] - px[b]);
+      edges.push_back(e);
+    }
+    first = k + 1;
+  }
+  std::sort(edges.begin(), edges.end(), obstacleEdgeOrder);
+
+  for (j = w[2]; j < w[3]; j++) {
+    x = r.xMin + (double)j * r.res;
+    while (next < edges.size() && edges[next].xLo <= x) {
+      active.push_back(next++);
+    }
+    cross.clear();
+    for (k = 0, m = 0; k < active.size(); k++) {
+      e = edges[active[k]];
+      if (e.xHi <= x) {
+        continue; /* passed: drop it */
+      }
+      active[m++] = active[k];
+      cross.push_back(e.y0 + (x - e.x0) * e.slope);
+    }
+    active.resize(m);
+    std::sort(cross.begin(), cross.end());
+    for (k = 0; k + 1 < cross.size(); k += 2) {
+      lo = obstacleClampIndex(std::ceil((cross[k] - r.yMin) / r.res), w[0],
+                              w[1]);
+      hi = obstacleClampIndex(std::floor((cross[k + 1] - r.yMin) / r.res),
+                              w[0] - 1, w[1] - 1);
+      while (lo > w[0] && r.yMin + (double)(lo - 1) * r.res >= cross[k]) {
+        lo--;
+      }
+      while (lo <= hi && r.yMin + (double)lo * r.res < cross[k]) {
+        lo++;
+      }
+      while (hi < w[1] - 1 &&
+             r.yMin + (double)(hi + 1) * r.res <= cross[k + 1]) {
+        hi++;
+      }
+      while (hi >= lo && r.yMin + (double)hi * r.res > cross[k + 1]) {
+        hi--;
+      }
+      if (lo <= hi) {
+        std::memset(cells + (std::size_t)j * r.rows + lo, 1,
+                    (std::size_t)(hi - lo + 1));
+      }
+    }
+  }
+}
+
+bool obstacleZoneMake(int kind, const double *v, std::size_t n,
+                      ObstacleZone &z, const char **err)
+{
+  const double inf = HUGE_VAL;
+  std::size_t nv;
+  std::size_t k;
+  std::size_t run = 0;
+  bool ring = false;
+  z.kind = kind;
+  z.xy.assign(v, v + n);
+  switch (kind) {
+  case obstacleZoneCircle:
+    if (n != 3 || !(v[0] == v[0] && v[1] == v[1] && v[2] == v[2])) {
+      *err = "circles must be [cx, cy, r] rows without NaN";
+      return false;
+    }
+    z.box[0] = v[0] - v[2];
+    z.box[1] = v[1] - v[2];
+    z.box[2] = v[0] + v[2];
+    z.box[3] = v[1] + v[2];
+    return true;
+  case obstacleZoneRectangle:
+    if (n != 4 ||
+        !(v[0] == v[0] && v[1] == v[1] && v[2] == v[2] && v[3] == v[3])) {
+      *err = "rectangles must be [x, y, width, height] rows without NaN";
+      return false;
+    }
+    z.box[0] = v[0];
+    z.box[1] = v[1];
+    z.box[2] = v[0] + v[2];
+    z.box[3] = v[1] + v[3];
+    return true;
+  case obstacleZonePolygon:
+    nv = n / 2;
+    z.box[0] = inf;
+    z.box[1] = inf;
+    z.box[2] = -inf;
+    z.box[3] = -inf;
+    for (k = 0; k < nv; k++) {
+      if (!(v[k] == v[k] && v[nv + k] == v[nv + k])) {
+        run = 0;
+        continue;
+      }
+      ring = ring || ++run >= 3;
+      z.box[0] = std::min(z.box[0], v[k]);
+      z.box[1] = std::min(z.box[1], v[nv + k]);
+      z.box[2] = std::max(z.box[2], v[k]);
+      z.box[3] = std::max(z.box[3], v[nv + k]);
+    }
+    if (n % 2 != 0 || !ring) {
+      *err = "polygons must be N x 2 vertex lists with at least three "
+             "vertices";
+      return false;
+    }
+    return true;
+  default:
+    *err = "unknown zone kind";
+    return false;
+  }
+}
+
+bool obstacleZoneWindow(const ObstacleRaster &r, const double box[4],
+                        int32_t w[4])
+{
+  /*  One post of slack per side: the fills settle the exact ends */
+  w[0] = obstacleClampIndex(std::floor((box[1] - r.yMin) / r.res) - 1.0, 0,
+                            r.rows);
+  w[1] = obstacleClampIndex(std::floor((box[3] - r.yMin) / r.res) + 2.0, 0,
+                            r.rows);
+  w[2] = obstacleClampIndex(std::floor((box[0] - r.xMin) / r.res) - 1.0, 0,
+                            r.cols);
+  w[3] = obstacleClampIndex(std::floor((box[2] - r.xMin) / r.res) + 2.0, 0,
+                            r.cols);
+  return w[0] < w[1] && w[2] < w[3];
+}
+
+void obstacleZoneFill(const ObstacleRaster &r, const ObstacleZone &z,
+                      const int32_t w[4], uint8_t *cells)
+{
+  if (w[0] >= w[1] || w[2] >= w[3]) {
+    return;
+  }
+  switch (z.kind) {
+  case obstacleZoneCircle:
+    obstacleFillCircle(r, &z.xy[0], w, cells);
+    break;
+  case obstacleZoneRectangle:
+    obstacleFillRect(r, &z.xy[0], w, cells);
+    break;
+  default:
+    obstacleFillPolygon(r, z, w, cells);
+    break;
+  }
+}
+
+/*  Area added to box a by growing it over box b */
+static double obstacleBoxGrowth(const double *a, const double *b)
+{
+  const double w = std::max(a[2], b[2]) - std::min(a[0], b[0]);
+  const double h = std::max(a[3], b[3]) - std::min(a[1], b[1]);
+  return w * h - (a[2] - a[0]) * (a[3] - a[1]);
+}
+
+static bool obstacleBoxOverlap(const double *a, const double *b)
+{
+  return a[0] <= b[2] && b[0] <= a[2] && a[1] <= b[3] && b[1] <= a[3];
+}
+
+static bool obstacleBoxContains(const double *a, const double *b)
+{
+  return a[0] <= b[0] && a[1] <= b[1] && a[2] >= b[2] && a[3] >= b[3];
+}
+
+ObstacleZoneTree::ObstacleZoneTree() : root(-1), count(0) {}
+
+int32_t ObstacleZoneTree::newNode(bool leaf)
+{
+  int32_t n;
+  if (!spare.empty()) {
+    n = spare.back();
+    spare.pop_back();
+  } else {
+    n = (int32_t)nodes.size();
+    nodes.push_back(Node());
+  }
+  nodes[n].leaf = leaf;
+  nodes[n].child.clear();
+  nodes[n].boxes.clear();
+  return n;
+}
+
+void ObstacleZoneTree::refit(int32_t n)
+{
+  Node &node = nodes[n];
+  std::size_t k;
+  node.box[0] = HUGE_VAL;
+  node.box[1] = HUGE_VAL;
+  node.box[2] = -HUGE_VAL;
+  node.box[3] = -HUGE_VAL;
+  for (k = 0; k < node.child.size(); k++) {
+    node.box[0] = std::min(node.box[0], node.boxes[4 * k]);
+    node.box[1] = std::min(node.box[1], node.boxes[4 * k + 1]);
+    node.box[2] = std::max(node.box[2], node.boxes[4 * k + 2]);
+    node.box[3] = std::max(node.box[3], node.boxes[4 * k + 3]);
+  }
+}
+
+/*  Move the upper half (by centre along the longer axis) to a new node */
+int32_t ObstacleZoneTree::split(int32_t n)
+{
+  std::vector<std::pair<double, std::size_t> > order;
+  std::vector<int32_t> child;
+  std::vector<double> boxes;
+  const int axis =
+      (nodes[n].box[2] - nodes[n].box[0] >= nodes[n].box[3] - nodes[n].box[1])
+          ? 0
+          : 1;
+  const int32_t m = newNode(nodes[n].leaf);
+  Node &a = nodes[n];
+  Node &b = nodes[m];
+  std::size_t k;
+  std::size_t c;
+  order.resize(a.child.size());
+  for (k = 0; k < a.child.size(); k++) {
+    order[k].first = a.boxes[4 * k + axis] + a.boxes[4 * k + axis + 2];
+    order[k].second = k;
+  }
+  std::sort(order.begin(), order.end());
+  child.swap(a.child);
+  boxes.swap(a.boxes);
+  for (k = 0; k < order.size(); k++) {
+    Node &dst = (k < order.size() / 2) ? a : b;
+    c = order[k].second;
+    dst.child.push_back(child[c]);
+    dst.boxes.insert(dst.boxes.end(), boxes.begin() + 4 * c,
+                     boxes.begin() + 4 * c + 4);
+  }
+  refit(n);
+  refit(m);
+  return m;
+}
+
+/*  Insert below n; returns the node split off n, or -1 */
+int32_t ObstacleZoneTree::insertAt(int32_t n, int32_t id, const double box[4])
+{
+  std::size_t best = 0;
+  std::size_t k;
+  double growth;
+  double bestGrowth = HUGE_VAL;
+  double area;
+  double bestArea = HUGE_VAL;
+  const double *cb;
+  int32_t c;
+  int32_t s;
+  if (nodes[n].leaf) {
+    nodes[n].child.push_back(id);
+    nodes[n].boxes.insert(nodes[n].boxes.end(), box, box + 4);
+  } else {
+    for (k = 0; k < nodes[n].child.size(); k++) {
+      cb = &nodes[n].boxes[4 * k];
+      growth = obstacleBoxGrowth(cb, box);
+      area = (cb[2] - cb[0]) * (cb[3] - cb[1]);
+      if (growth < bestGrowth || (growth == bestGrowth && area < bestArea)) {
+        best = k;
+        bestGrowth = growth;
+        bestArea = area;
+      }
+    }
+    c = nodes[n].child[best];
+    s = insertAt(c, id, box);
+    std::memcpy(&nodes[n].boxes[4 * best], nodes[c].box, sizeof(double) * 4);
+    if (s >= 0) {
+      nodes[n].child.push_back(s);
+      nodes[n].boxes.insert(nodes[n].boxes.end(), nodes[s].box,
+                            nodes[s].box + 4);
+    }
+  }
+  refit(n);
+  return nodes[n].child.size() > zoneTreeMax ? split(n) : -1;
+}
+
+void ObstacleZoneTree::insert(int32_t id, const double box[4])
+{
+  int32_t s;
+  int32_t r;
+  if (root < 0) {
+    root = newNode(true);
+  }
+  s = insertAt(root, id, box);
+  if (s >= 0) {
+    r = newNode(false);
+    nodes[r].child.push_back(root);
+    nodes[r].boxes.insert(nodes[r].boxes.end(), nodes[root].box,
+                          nodes[root].box + 4);
+    nodes[r].child.push_back(s);
+    nodes[r].boxes.insert(nodes[r].boxes.end(), nodes[s].box,
+                          nodes[s].box + 4);
+    refit(r);
+    root = r;
+  }
+  count++;
+}
+
+/*  Zone entries below n into ids / boxes; the nodes go back to spare */
+void ObstacleZoneTree::collect(int32_t n, std::vector<int32_t> &ids,
+                               std::vector<double> &boxes)
+{
+  std::size_t k;
+  if (nodes[n].leaf) {
+    ids.insert(ids.end(), nodes[n].child.begin(), nodes[n].child.end());
+    boxes.insert(boxes.end(), nodes[n].boxes.begin(), nodes[n].boxes.end());
+  } else {
+    for (k = 0; k < nodes[n].child.size(); k++) {
+      collect(nodes[n].child[k], ids, boxes);
+    }
+  }
+  spare.push_back(n);
+}
+
+/*
+ *  Remove id below n; children left underfull are dissolved into ids /
+ *  boxes for reinsertion.
+ */
+bool ObstacleZoneTree::removeFrom(int32_t n, int32_t id, const double box[4],
+                                  std::vector<int32_t> &ids,
+                                  std::vector<double> &boxes)
+{
+  std::size_t k;
+  int32_t c;
+  if (nodes[n].leaf) {
+    for (k = 0; k < nodes[n].child.size(); k++) {
+      if (nodes[n].child[k] == id) {
+        nodes[n].child.erase(nodes[n].child.begin() + k);
+        nodes[n].boxes.erase(nodes[n].boxes.begin() + 4 * k,
+                             nodes[n].boxes.begin() + 4 * k + 4);
+        refit(n);
+        return true;
+      }
+    }
+    return false;
+  }
+  for (k = 0; k < nodes[n].child.size(); k++) {
+    c = nodes[n].child[k];
+    if (!obstacleBoxContains(&nodes[n].boxes[4 * k], box) ||
+        !removeFrom(c, id, box, ids, boxes)) {
+      continue;
+    }
+    if (nodes[c].child.size() < zoneTreeMin) {
+      collect(c, ids, boxes);
+      nodes[n].child.erase(nodes[n].child.begin() + k);
+      nodes[n].boxes.erase(nodes[n].boxes.begin() + 4 * k,
+                           nodes[n].boxes.begin() + 4 * k + 4);
+    } else {
+      std::memcpy(&nodes[n].boxes[4 * k], nodes[c].box, sizeof(double) * 4);
+    }
+    refit(n);
+    return true;
+  }
+  return false;
+}
+
+bool ObstacleZoneTree::remove(int32_t id, const double box[4])
+{
+  std::vector<int32_t> ids;
+  std::vector<double> boxes;
+  std::size_t k;
+  int32_t old;
+  if (root < 0 || !removeFrom(root, id, box, ids, boxes)) {
+    return false;
+  }
+  count -= 1 + ids.size();
+  while (!nodes[root].leaf && nodes[root].child.size() <= 1) {
+    old = root;
+    root = nodes[root].child.empty() ? -1 : nodes[root].child[0];
+    spare.push_back(old);
+    if (root < 0) {
+      break;
+    }
+  }
+  for (k = 0; k < ids.size(); k++) {
+    insert(ids[k], &boxes[4 * k]);
+  }
+  return true;
+}
+
+void ObstacleZoneTree::query(const double box[4],
+                             std::vector<int32_t> &ids) const
+{
+  std::vector<int32_t> stack;
+  std::size_t k;
+  int32_t n;
+  if (root < 0) {
+    return;
+  }
+  stack.push_back(root);
+  while (!stack.empty()) {
+    n = stack.back();
+    stack.pop_back();
+    for (k = 0; k < nodes[n].child.size(); k++) {
+      if (!obstacleBoxOverlap(&nodes[n].boxes[4 * k], box)) {
+        continue;
+      }
+      if (nodes[n].leaf) {
+        ids.push_back(nodes[n].child[k]);
+      } else {
+        stack.push_back(nodes[n].child[k]);
+      }
+    }
+  }
+}
+
+bool ObstacleZoneLayer::init(const ObstacleRaster &r, int32_t tileSize,
+                             const char **err)
+{
+  if (r.rows < 1 || r.cols < 1 || !(r.res > 0.0)) {
+    *err = "zone grid must be non-empty with a positive resolution";
+    return false;
+  }
+  if (tileSize < 1) {
+    *err = "tile size must be a positive integer";
+    return false;
+  }
+  raster = r;
+  tile = tileSize;
+  tileRows = (r.rows - 1) / tileSize + 1;
+  tileCols = (r.cols - 1) / tileSize + 1;
+  nextId = 1;
+  grid.assign((std::size_t)r.rows * r.cols, 0);
+  scratch.assign(grid.size(), 0);
+  dirty.assign((std::size_t)tileRows * tileCols, 0);
+  zones.clear();
+  tree = ObstacleZoneTree();
+  return true;
+}
+
+void ObstacleZoneLayer::markDirty(const double box[4])
+{
+  int32_t w[4];
+  int32_t ti;
+  int32_t tj;
+  if (!obstacleZoneWindow(raster, box, w)) {
+    return;
+  }
+  for (tj = w[2] / tile; tj <= (w[3] - 1) / tile; tj++) {
+    for (ti = w[0] / tile; ti <= (w[1] - 1) / tile; ti++) {
+      dirty[(std::size_t)tj * tileRows + ti] = 1;
+    }
+  }
+}
+
+int32_t ObstacleZoneLayer::add(const ObstacleZone &z)
+{
+  const int32_t id = nextId++;
+  zones[id] = z;
+  tree.insert(id, z.box);
+  markDirty(z.box);
+  return id;
+}
+
+bool ObstacleZoneLayer::remove(int32_t id)
+{
+  std::map<int32_t, ObstacleZone>::iterator it = zones.find(id);
+  if (it == zones.end()) {
+    return false;
+  }
+  tree.remove(id, it->second.box);
+  markDirty(it->second.box);
+  zones.erase(it);
+  return true;
+}
+
+void ObstacleZoneLayer::update(std::vector<int32_t> &changes,
+                               std::vector<int32_t> &tiles)
+{
+  const double half = 0.5 * raster.res;
+  std::vector<int32_t> ids;
+  double box[4];
+  int32_t w[4];
+  int32_t zw[4];
+  int32_t ti;
+  int32_t tj;
+  int32_t i;
+  int32_t j;
+  std::size_t k;
+  std::size_t c;
+  changes.clear();
+  tiles.clear();
+  for (tj = 0; tj < tileCols; tj++) {
+    for (ti = 0; ti < tileRows; ti++) {
+      if (!dirty[(std::size_t)tj * tileRows + ti]) {
+        continue;
+      }
+      dirty[(std::size_t)tj * tileRows + ti] = 0;
+      w[0] = ti * tile;
+      w[1] = std::min(raster.rows, w[0] + tile);
+      w[2] = tj * tile;
+      w[3] = std::min(raster.cols, w[2] + tile);
+      for (j = w[2]; j < w[3]; j++) {
+        std::memset(&scratch[(std::size_t)j * raster.rows + w[0]], 0,
+                    (std::size_t)(w[1] - w[0]));
+      }
+
+      /*  Zones over the tile's posts, half a post of slack for rounding */
+      box[0] = raster.xMin + (double)w[2] * raster.res - half;
+      box[1] = raster.yMin + (double)w[0] * raster.res - half;
+      box[2] = raster.xMin + (double)(w[3] - 1) * raster.res + half;
+      box[3] = raster.yMin + (double)(w[1] - 1) * raster.res + half;
+      ids.clear();
+      tree.query(box, ids);
+      for (k = 0; k < ids.size(); k++) {
+        const ObstacleZone &z = zones[ids[k]];
+        if (!obstacleZoneWindow(raster, z.box, zw)) {
+          continue;
+        }
+        zw[0] = std::max(zw[0], w[0]);
+        zw[1] = std::min(zw[1], w[1]);
+        zw[2] = std::max(zw[2], w[2]);
+        zw[3] = std::min(zw[3], w[3]);
+        obstacleZoneFill(raster, z, zw, &scratch[0]);
+      }
+
+      for (j = w[2]; j < w[3]; j++) {
+        for (i = w[0]; i < w[1]; i++) {
+          c = (std::size_t)j * raster.rows + i;
+          if (grid[c] != scratch[c]) {
+            grid[c] = scratch[c];
+            changes.push_back(i);
+            changes.push_back(j);
+            changes.push_back(grid[c]);
+          }
+        }
+      }
+      tiles.push_back(w[0]);
+      tiles.push_back(w[1] - 1);
+      tiles.push_back(w[2]);
+      tiles.push_back(w[3] - 1);
+    }
+  }
+}
+
+/* End of obstacleZones.cpp */
@@ -0,0 +1,146 @@
+/*
+ * obstacleZones.h
+ *
+ * Step 3 of obstacleGrid.m: custom no-fly zones (circles, rectangles and
+ * polygons) rasterized onto the DEM posts, and a zone layer that keeps
+ * them in an R-tree so edits re-rasterize only the tiles they touch.
+ *
+ * Post (row i, col j), 0-based, sits at x = xMin + j res, y = yMin + i res.
+ * A shape is clipped to the posts of its bounding box and filled one grid
+ * column at a time (the contiguous axis) as exact spans of rows:
+ *
+ *   circle    [cx, cy, r]    sqrt((x - cx)^2 + (y - cy)^2) < r
+ *   rectangle [x, y, w, h]   x <= px <= x + w and y <= py <= y + h
+ *   polygon   vertices       even-odd rule; NaN rows split rings, so
+ *                            holes and multi-part zones are one polygon
+ *
+ * Span ends are estimated from the shape and then settled with the
+ * per-post tests above, so circles and rectangles cover the posts of the
+ * original whole-grid loops exactly. Polygon spans run between the
+ * crossings of the column with the edges (an active edge list over edges
+ * sorted by their lowest x); posts on a crossing count as inside.
+ *
+ * ObstacleZoneLayer splits the grid into square tiles. Adding or removing
+ * a zone marks the tiles under its box dirty; update() redraws each dirty
+ * tile from the zones the R-tree finds over it and reports the posts that
+ * changed, in the [row, col, blocked] form astarIncremental_mex takes.
+ *
+ */
+
+#pragma once
+
+/* Include files */
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+/* Type Definitions */
+enum ObstacleZoneKind {
+  obstacleZoneCircle = 0,
+  obstacleZoneRectangle = 1,
+  obstacleZonePolygon = 2
+};
+
+struct ObstacleZone {
+  int kind;
+  double box[4];          /* xLo, yLo, xHi, yHi */
+  std::vector<double> xy; /* circle / rectangle row, or polygon x then y */
+};
+
+struct ObstacleRaster {
+  double xMin;
+  double yMin;
+  double res;
+  int32_t rows;
+  int32_t cols;
+};
+
+/*
+ *  Dynamic R-tree of zone ids over their boxes: Guttman insertion by least
+ *  enlargement, full nodes split at the median of the longer axis, and
+ *  underfull nodes dissolved on removal with their zones reinserted.
+ */
+class ObstacleZoneTree {
+public:
+  ObstacleZoneTree();
+  void insert(int32_t id, const double box[4]);
+  bool remove(int32_t id, const double box[4]);
+  void query(const double box[4], std::vector<int32_t> &ids) const;
+  std::size_t size() const { return count; }
+
+private:
+  struct Node {
+    double box[4];
+    bool leaf;
+    std::vector<int32_t> child; /* node indices, or zone ids in a leaf */
+    std::vector<double> boxes;  /* four per child */
+  };
+  std::vector<Node> nodes;
+  std::vector<int32_t> spare;
+  int32_t root;
+  std::size_t count;
+
+  int32_t newNode(bool leaf);
+  void refit(int32_t n);
+  int32_t split(int32_t n);
+  int32_t insertAt(int32_t n, int32_t id, const double box[4]);
+  bool removeFrom(int32_t n, int32_t id, const double box[4],
+                  std::vector<int32_t> &ids, std::vector<double> &boxes);
+  void collect(int32_t n, std::vector<int32_t> &ids,
+               std::vector<double> &boxes);
+};
+
+class ObstacleZoneLayer {
+public:
+  bool init(const ObstacleRaster &r, int32_t tileSize, const char **err);
+  int32_t add(const ObstacleZone &z);
+  bool remove(int32_t id);
+  /*  Redraw the dirty tiles; changes gets (row, col, blocked) triples */
+  void update(std::vector<int32_t> &changes, std::vector<int32_t> &tiles);
+  const uint8_t *cells() const { return grid.empty() ? NULL : &grid[0]; }
+  const ObstacleRaster &geometry() const { return raster; }
+  std::size_t zoneCount() const { return zones.size(); }
+  bool contains(int32_t id) const { return zones.count(id) != 0; }
+
+private:
+  ObstacleRaster raster;
+  int32_t tile;
+  int32_t tileRows;
+  int32_t tileCols;
+  int32_t nextId;
+  std::vector<uint8_t> grid;
+  std::vector<uint8_t> dirty;
+  std::vector<uint8_t> scratch;
+  std::map<int32_t, ObstacleZone> zones;
+  ObstacleZoneTree tree;
+
+  void markDirty(const double box[4]);
+};
+
+/* Function Declarations */
+/*
+ * Zone of the given kind from its n numbers (3 for a circle, 4 for a
+ * rectangle, x then y columns of an N x 2 vertex list for a polygon).
+ * False for NaN circle / rectangle values or a polygon without a ring of
+ * three vertices.
+ */
+bool obstacleZoneMake(int kind, const double *v, std::size_t n,
+                      ObstacleZone &z, const char **err);
+
+/*
+ * Post window [w[0], w[1]) x [w[2], w[3]) (rows, then cols) of the zone's
+ * bounding box, clipped to the grid; false when it is empty.
+ */
+bool obstacleZoneWindow(const ObstacleRaster &r, const double box[4],
+                        int32_t w[4]);
+
+/*
+ * Set cells to 1 at the posts of the zone inside window w (see
+ * obstacleZoneWindow). cells is rows x cols, column-major; only the
+ * window is written.
+ */
+void obstacleZoneFill(const ObstacleRaster &r, const ObstacleZone &z,
+                      const int32_t w[4], uint8_t *cells);
+
+/* End of obstacleZones.h */
@@ -0,0 +1,322 @@
+/*
+ * obstacleZones_mex.cpp
+ *
+ * MEX gateway for the no-fly zone rasterizer and layer of obstacleZones.h
+ * (see obstacleGrid.m, obstacleZones.m, obstacleZonesUpdate.m,
+ * obstacleZonesFree.m):
+ *
+ *   grid = obstacleZones_mex('rasterize', demData, customObstacles)
+ *   h = obstacleZones_mex('create', demData, tileSize)
+ *   ids = obstacleZones_mex('add', h, customObstacles)
+ *   obstacleZones_mex('remove', h, ids)
+ *   [grid, changes, tiles] = obstacleZones_mex('update', h)
+ *   obstacleZones_mex('free', h)
+ *
+ * customObstacles holds circles (N x 3 [cx, cy, r]), rectangles (N x 4
+ * [x, y, width, height]) and polygons (a cell array of N x 2 vertex lists,
+ * NaN rows between rings, or one N x 2 array); each field is optional.
+ * Circle and rectangle rows holding a NaN are skipped, as obstacleGrid.m
+ * never drew them. grid is a logical array the size of demData.Z. ids are
+ * the layer's zone ids, circles first, then rectangles, then polygons, one
+ * per zone added. remove checks every id before it removes any, so an
+ * unknown id leaves the layer as it was. update redraws the tiles the
+ * edits since the last update touched: changes is K x 3 [row, col,
+ * blocked] over the posts that flipped (the changes input of
+ * astarIncremental_mex) and tiles is T x 4 [row0, row1, col0, col1], all
+ * 1-based and inclusive.
+ *
+ * Handles are uint64 ids into a table owned by this MEX file. The MEX is
+ * locked while any layer is alive; the rest are released at MATLAB exit.
+ *
+ */
+
+/* Include files */
+#include "mexUtil.h"
+#include "obstacleZones.h"
+#include <cmath>
+#include <cstring>
+#include <map>
+
+/* Variable Definitions */
+static std::map<uint64_t, ObstacleZoneLayer *> zoneTable;
+static uint64_t zoneNextId = 1;
+static const char *zoneErrId = "obstacleZones:InvalidInput";
+
+/* Function Declarations */
+static void zoneFreeAll(void);
+static ObstacleZoneLayer *zoneLookup(const mxArray *h);
+static ObstacleRaster zoneRaster(const mxArray *demData);
+static void zoneRows(const mxArray *s, const char *name, int kind,
+                     std::size_t width, std::vector<ObstacleZone> &out);
+static void zonePolygon(const mxArray *a, std::vector<ObstacleZone> &out);
+static void zoneList(const mxArray *s, std::vector<ObstacleZone> &out);
+static mxArray *zoneMatrix(const std::vector<int32_t> &v, std::size_t width,
+                           std::size_t indexCols);
+
+/* Function Definitions */
+static void zoneFreeAll(void)
+{
+  std::map<uint64_t, ObstacleZoneLayer *>::iterator it;
+  for (it = zoneTable.begin(); it != zoneTable.end(); ++it) {
+    delete it->second;
+  }
+  zoneTable.clear();
+}
+
+static ObstacleZoneLayer *zoneLookup(const mxArray *h)
+{
+  std::map<uint64_t, ObstacleZoneLayer *>::iterator it;
+  if (!mxIsUint64(h) || mxGetNumberOfElements(h) != 1) {
+    mexErrMsgIdAndTxt(zoneErrId, "Zone layer handle must be a uint64 scalar");
+  }
+  it = zoneTable.find(*mxGetUint64s(h));
+  if (it == zoneTable.end()) {
+    mexErrMsgIdAndTxt("obstacleZones:InvalidHandle",
+                      "Zone layer handle is not alive (already freed?)");
+  }
+  return it->second;
+}
+
+/*  Post geometry of demData; Z is only measured */
+static ObstacleRaster zoneRaster(const mxArray *demData)
+{
+  ObstacleRaster r;
+  const DemGrid dem = mexDemGridFromStruct(demData, zoneErrId);
+  r.xMin = dem.xMin;
+  r.yMin = dem.yMin;
+  r.res = dem.resolution;
+  r.rows = dem.rows;
+  r.cols = dem.cols;
+  return r;
+}
+
+/*  One zone per row of the field name, its first width columns */
+static void zoneRows(const mxArray *s, const char *name, int kind,
+                     std::size_t width, std::vector<ObstacleZone> &out)
+{
+  const mxArray *f = mxGetField(s, 0, name);
+  const double *v;
+  double row[4];
+  const char *err = "";
+  std::size_t n;
+  std::size_t k;
+  std::size_t c;
+  bool nan;
+  if (f == NULL || mxIsEmpty(f)) {
+    return;
+  }
+  v = mexDoubleArray(f, name, zoneErrId);
+  n = mxGetM(f);
+  if (mxGetN(f) < width) {
+    mexErrMsgIdAndTxt(zoneErrId, "%s must have %d columns", name,
+                      (int)width);
+  }
+  for (k = 0; k < n; k++) {
+    nan = false;
+    for (c = 0; c < width; c++) {
+      row[c] = v[c * n + k];
+      nan = nan || !(row[c] == row[c]);
+    }
+    if (nan) {
+      continue; /* blocks nothing */
+    }
+    out.push_back(ObstacleZone());
+    if (!obstacleZoneMake(kind, row, width, out.back(), &err)) {
+      mexErrMsgIdAndTxt(zoneErrId, "%s (row %d)", err, (int)(k + 1));
+    }
+  }
+}
+
+static void zonePolygon(const mxArray *a, std::vector<ObstacleZone> &out)
+{
+  const char *err = "";
+  const double *v = mexDoubleArray(a, "polygons", zoneErrId);
+  if (mxGetNumberOfDimensions(a) != 2 || mxGetN(a) != 2) {
+    mexErrMsgIdAndTxt(zoneErrId, "polygons must be N x 2 vertex lists");
+  }
+  out.push_back(ObstacleZone());
+  if (!obstacleZoneMake(obstacleZonePolygon, v, mxGetNumberOfElements(a),
+                        out.back(), &err)) {
+    mexErrMsgIdAndTxt(zoneErrId, "%s", err);
+  }
+}
+
+static void zoneList(const mxArray *s, std::vector<ObstacleZone> &out)
+{
+  const mxArray *f;
+  std::size_t k;
+  out.clear();
+  if (mxIsEmpty(s)) {
+    return;
+  }
+  if (!mxIsStruct(s)) {
+    mexErrMsgIdAndTxt(zoneErrId, "customObstacles must be a struct");
+  }
+  zoneRows(s, "circles", obstacleZoneCircle, 3, out);
+  zoneRows(s, "rectangles", obstacleZoneRectangle, 4, out);
+  f = mxGetField(s, 0, "polygons");
+  if (f == NULL || mxIsEmpty(f)) {
+    return;
+  }
+  if (mxIsCell(f)) {
+    for (k = 0; k < mxGetNumberOfElements(f); k++) {
+      if (mxGetCell(f, k) != NULL && !mxIsEmpty(mxGetCell(f, k))) {
+        zonePolygon(mxGetCell(f, k), out);
+      }
+    }
+  } else {
+    zonePolygon(f, out);
+  }
+}
+
+/*
+ *  Column-major double matrix from row-major tuples of width values; the
+ *  first indexCols columns are 0-based indices, made 1-based.
+ */
+static mxArray *zoneMatrix(const std::vector<int32_t> &v, std::size_t width,
+                           std::size_t indexCols)
+{
+  const std::size_t n = v.size() / width;
+  mxArray *a = mxCreateDoubleMatrix(n, width, mxREAL);
+  double *d = mxGetDoubles(a);
+  std::size_t k;
+  std::size_t c;
+  for (k = 0; k < n; k++) {
+    for (c = 0; c < width; c++) {
+      d[c * n + k] = (double)v[k * width + c] + (c < indexCols ? 1.0 : 0.0);
+    }
+  }
+  return a;
+}
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  std::map<uint64_t, ObstacleZoneLayer *>::iterator it;
+  std::vector<ObstacleZone> zones;
+  std::vector<int32_t> changes;
+  std::vector<int32_t> tiles;
+  ObstacleZoneLayer *layer;
+  ObstacleRaster r;
+  uint8_t *cells;
+  const double *v;
+  const char *err = "";
+  double tileSize;
+  double *ids;
+  int32_t w[4];
+  std::size_t n;
+  std::size_t k;
+  char cmd[10];
+  mexAtExit(&zoneFreeAll);
+  if (nrhs < 1 || !mxIsChar(prhs[0]) ||
+      mxGetString(prhs[0], cmd, sizeof(cmd)) != 0) {
+    cmd[0] = '\0';
+  }
+
+  if (std::strcmp(cmd, "rasterize") == 0) {
+    if (nrhs != 3 || nlhs > 1) {
+      mexErrMsgIdAndTxt(zoneErrId, "Usage: grid = obstacleZones_mex("
+                                   "'rasterize', demData, customObstacles)");
+    }
+    r = zoneRaster(prhs[1]);
+    zoneList(prhs[2], zones);
+    plhs[0] = mxCreateLogicalMatrix(r.rows, r.cols);
+    cells = (uint8_t *)mxGetLogicals(plhs[0]);
+    for (k = 0; k < zones.size(); k++) {
+      if (obstacleZoneWindow(r, zones[k].box, w)) {
+        obstacleZoneFill(r, zones[k], w, cells);
+      }
+    }
+
+  } else if (std::strcmp(cmd, "create") == 0) {
+    if (nrhs != 3 || nlhs > 1) {
+      mexErrMsgIdAndTxt(zoneErrId, "Usage: h = obstacleZones_mex('create', "
+                                   "demData, tileSize)");
+    }
+    r = zoneRaster(prhs[1]);
+    tileSize = mxGetScalar(prhs[2]);
+    if (!(tileSize >= 1.0 && tileSize <= 65536.0) ||
+        tileSize != std::floor(tileSize)) {
+      mexErrMsgIdAndTxt(zoneErrId, "tileSize must be an integer in "
+                                   "[1, 65536]");
+    }
+    layer = new ObstacleZoneLayer();
+    if (!layer->init(r, (int32_t)tileSize, &err)) {
+      delete layer;
+      mexErrMsgIdAndTxt(zoneErrId, "%s", err);
+    }
+    zoneTable[zoneNextId] = layer;
+    mexLock();
+    plhs[0] = mxCreateNumericMatrix(1, 1, mxUINT64_CLASS, mxREAL);
+    *mxGetUint64s(plhs[0]) = zoneNextId++;
+
+  } else if (std::strcmp(cmd, "add") == 0) {
+    if (nrhs != 3 || nlhs > 1) {
+      mexErrMsgIdAndTxt(zoneErrId, "Usage: ids = obstacleZones_mex('add', h,"
+                                   " customObstacles)");
+    }
+    layer = zoneLookup(prhs[1]);
+    zoneList(prhs[2], zones);
+    plhs[0] = mxCreateDoubleMatrix(zones.size(), 1, mxREAL);
+    ids = mxGetDoubles(plhs[0]);
+    for (k = 0; k < zones.size(); k++) {
+      ids[k] = (double)layer->add(zones[k]);
+    }
+
+  } else if (std::strcmp(cmd, "remove") == 0) {
+    if (nrhs != 3 || nlhs > 0) {
+      mexErrMsgIdAndTxt(zoneErrId, "Usage: obstacleZones_mex('remove', h, "
+                                   "ids)");
+    }
+    layer = zoneLookup(prhs[1]);
+    n = mxGetNumberOfElements(prhs[2]);
+    v = n > 0 ? mexDoubleArray(prhs[2], "ids", zoneErrId) : NULL;
+    for (k = 0; k < n; k++) {
+      if (!(v[k] >= 1.0 && v[k] <= (double)INT32_MAX) ||
+          v[k] != std::floor(v[k]) || !layer->contains((int32_t)v[k])) {
+        mexErrMsgIdAndTxt("obstacleZones:UnknownZone",
+                          "Zone id %g is not in the layer", v[k]);
+      }
+    }
+    for (k = 0; k < n; k++) {
+      layer->remove((int32_t)v[k]); /* false for a repeated id */
+    }
+
+  } else if (std::strcmp(cmd, "update") == 0) {
+    if (nrhs != 2 || nlhs > 3) {
+      mexErrMsgIdAndTxt(zoneErrId, "Usage: [grid, changes, tiles] = "
+                                   "obstacleZones_mex('update', h)");
+    }
+    layer = zoneLookup(prhs[1]);
+    layer->update(changes, tiles);
+    r = layer->geometry();
+    plhs[0] = mxCreateLogicalMatrix(r.rows, r.cols);
+    std::memcpy(mxGetLogicals(plhs[0]), layer->cells(),
+                (std::size_t)r.rows * r.cols);
+    if (nlhs > 1) {
+      plhs[1] = zoneMatrix(changes, 3, 2);
+    }
+    if (nlhs > 2) {
+      plhs[2] = zoneMatrix(tiles, 4, 4);
+    }
+
+  } else if (std::strcmp(cmd, "free") == 0) {
+    if (nrhs != 2 || nlhs > 0) {
+      mexErrMsgIdAndTxt(zoneErrId, "Usage: obstacleZones_mex('free', h)");
+    }
+    /*  Freeing an unknown or already freed handle is a no-op */
+    if (mxIsUint64(prhs[1]) && mxGetNumberOfElements(prhs[1]) == 1) {
+      it = zoneTable.find(*mxGetUint64s(prhs[1]));
+      if (it != zoneTable.end()) {
+        delete it->second;
+        zoneTable.erase(it);
+        mexUnlock();
+      }
+    }
+
+  } else {
+    mexErrMsgIdAndTxt(zoneErrId, "Command must be 'rasterize', 'create', "
+                                 "'add', 'remove', 'update' or 'free'");
+  }
+}
+
+/* End of obstacleZones_mex.cpp */
@@ -0,0 +1,600 @@
+/*
+ * pathSmooth.cpp
+ *
+ * Fillets, row-end Dubins turns and spaced sampling for pathSmoother.m
+ * (see pathSmooth.h).
+ *
+ */
+
+/* Include files */
+#include "pathSmooth.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <new>
+#include <vector>
+
+/* Type Definitions */
+enum SmoothCornerKind {
+  smoothPlain = 0,     /* end point, straight through or degenerate */
+  smoothFillet = 1,    /* rounded by a circular arc */
+  smoothPairStart = 2, /* first of a Dubins pair */
+  smoothPairEnd = 3,   /* second of a Dubins pair */
+  smoothReversal = 4   /* turned back on itself by a Dubins bulb */
+};
+
+struct SmoothCorner {
+  int kind;
+  double turn;    /* signed heading change, radians */
+  double tangent; /* fillet: waypoint to tangent point */
+  double radius;  /* fillet radius */
+};
+
+/*  Straight (kappa 0) or circular arc from pose (x, y, heading) */
+struct SmoothPiece {
+  double x;
+  double y;
+  double heading;
+  double kappa;
+  double length;
+  double z0;
+  double z1;
+  double u0;
+  double u1;
+};
+
+/*  Counts, or writes into the preallocated output */
+struct SmoothSink {
+  double *out;
+  double *u;
+  std::size_t count; /* rows of out */
+  std::size_t k;     /* rows emitted */
+  int dims;
+  const std::size_t *last; /* source row of each collapsed waypoint */
+  std::size_t nLast;
+};
+
+/*  Corner plans for one window of waypoints plus a margin each side */
+struct SmoothWindow {
+  std::size_t lo;
+  std::vector<double> turn;
+  std::vector<double> tangent; /* wanted at the full radius */
+  std::vector<double> leg;     /* length of leg i -> i + 1 */
+  std::vector<uint8_t> pairable;
+  std::vector<SmoothCorner> corner;
+};
+
+/* Variable Definitions */
+static const std::size_t smoothBlock = 1024; /* waypoints per window */
+static const std::size_t smoothMargin = 3;   /* reach of a corner plan */
+static const double smoothPi = 3.14159265358979323846;
+static const double smoothTiny = 1e-9;
+static const double smoothReverse = smoothPi - 1e-3; /* bulb, no fillet */
+
+/* Function Declarations */
+static double smoothMod2Pi(double a);
+static void smoothPut(SmoothSink &sink, double x, double y, double z,
+                      double u);
+static void smoothAdvance(const SmoothPiece &p, double s, double &x,
+                          double &y);
+static void smoothEmit(SmoothSink &sink, const SmoothPiece &p,
+                       const SmoothOptions &opt);
+static int smoothDubins(const double *q0, const double *q1, double rho,
+                        SmoothPiece *pieces);
+static void smoothPlan(const double *wp, std::size_t n,
+                       const SmoothOptions &opt, std::size_t w0,
+                       std::size_t w1, SmoothWindow &win);
+static bool smoothRun(const double *src, std::size_t nSrc, int dims,
+                      const SmoothOptions &opt, SmoothSink &sink,
+                      SmoothStats &stats, const char **err);
+
+/* Function Definitions */
+static double smoothMod2Pi(double a)
+{
+  return a - 2.0 * smoothPi * std::floor(a / (2.0 * smoothPi));
+}
+
+static void smoothPut(SmoothSink &sink, double x, double y, double z,
+                      double u)
+{
+  std::size_t c;
+  if (sink.out != NULL && sink.k < sink.count) {
+    if (sink.last != NULL) {
+      c = std::min((std::size_t)std::max(u, 0.0), sink.nLast - 1);
+      u = (double)sink.last[c] + (u - (double)c);
+    }
+    sink.out[sink.k] = x;
+    sink.out[sink.count + sink.k] = y;
+    if (sink.dims >= 3) {
+      sink.out[2 * sink.count + sink.k] = z;
+    }
+    sink.u[sink.k] = u;
+  }
+  sink.k++;
+}
+
+static void smoothAdvance(const SmoothPiece &p, double s, double &x,
+                          double &y)
+{
+  const double h = p.heading + p.kappa * s;
+  if (p.kappa == 0.0) {
+    x = p.x + s * std::cos(p.heading);
+    y = p.y + s * std::sin(p.heading);
+  } else {
+    x = p.x + (std::sin(h) - std::sin(p.heading)) / p.kappa;
+    y = p.y - (std::cos(h) - std::cos(p.heading)) / p.kappa;
+  }
+}
+
+/*
+ * Points along p after its start, evenly spaced at most opt.spacing apart
+ * and, on arcs, at most 0.999 maxTurn of heading apart
+ */
+static void smoothEmit(SmoothSink &sink, const SmoothPiece &p,
+                       const SmoothOptions &opt)
+{
+  const double dTurn = 0.999 * opt.maxTurn * smoothPi / 180.0;
+  double step = opt.spacing;
+  double s;
+  double x;
+  double y;
+  double m;
+  std::size_t k;
+  if (!(p.length > smoothTiny)) {
+    return;
+  }
+  if (p.kappa != 0.0) {
+    step = std::min(step, dTurn / std::fabs(p.kappa));
+  }
+  m = std::max(1.0, std::ceil(p.length / step - 1e-9));
+  for (k = 1; k <= (std::size_t)m; k++) {
+    s = p.length * (double)k / m;
+    smoothAdvance(p, s, x, y);
+    smoothPut(sink, x, y, p.z0 + (p.z1 - p.z0) * (double)k / m,
+              p.u0 + (p.u1 - p.u0) * (double)k / m);
+  }
+}
+
+/*
+ * Shortest Dubins path between poses q = [x, y, heading] at radius rho,
+ * as three pieces (z and u are left to the caller); returns the number
+ * of pieces, 0 when every word fails
+ */
+static int smoothDubins(const double *q0, const double *q1, double rho,
+                        SmoothPiece *pieces)
+{
+  /*  Curvature sign of each piece: L +1, S 0, R -1 */
+  static const int words[6][3] = {{1, 0, 1},  {-1, 0, -1}, {1, 0, -1},
+                                  {-1, 0, 1}, {-1, 1, -1}, {1, -1, 1}};
+  const double dx = q1[0] - q0[0];
+  const double dy = q1[1] - q0[1];
+  const double d = std::sqrt(dx * dx + dy * dy) / rho;
+  const double theta = smoothMod2Pi(std::atan2(dy, dx));
+  const double alpha = smoothMod2Pi(q0[2] - theta);
+  const double beta = smoothMod2Pi(q1[2] - theta);
+  const double sa = std::sin(alpha);
+  const double sb = std::sin(beta);
+  const double ca = std::cos(alpha);
+  const double cb = std::cos(beta);
+  const double cab = std::cos(alpha - beta);
+  double best = std::numeric_limits<double>::infinity();
+  double len[3] = {0.0, 0.0, 0.0};
+  double seg[3];
+  double pSq;
+  double tmp;
+  double x;
+  double y;
+  int bestWord = -1;
+  int w;
+  int k;
+  for (w = 0; w < 6; w++) {
+    switch (w) {
+    case 0: /* LSL */
+      pSq = 2.0 + d * d - 2.0 * cab + 2.0 * d * (sa - sb);
+      if (pSq < 0.0) {
+        continue;
+      }
+      tmp = std::atan2(cb - ca, d + sa - sb);
+      seg[0] = smoothMod2Pi(tmp - alpha);
+      seg[1] = std::sqrt(pSq);
+      seg[2] = smoothMod2Pi(beta - tmp);
+      break;
+    case 1: /* RSR */
+      pSq = 2.0 + d * d - 2.0 * cab + 2.0 * d * (sb - sa);
+      if (pSq < 0.0) {
+        continue;
+      }
+      tmp = std::atan2(ca - cb, d - sa + sb);
+      seg[0] = smoothMod2Pi(alpha - tmp);
+      seg[1] = std::sqrt(pSq);
+      seg[2] = smoothMod2Pi(tmp - beta);
+      break;
+    case 2: /* LSR */
+      pSq = -2.0 + d * d + 2.0 * cab + 2.0 * d * (sa + sb);
+      if (pSq < 0.0) {
+        continue;
+      }
+      seg[1] = std::sqrt(pSq);
+      tmp = std::atan2(-ca - cb, d + sa + sb) - std::atan2(-2.0, seg[1]);
+      seg[0] = smoothMod2Pi(tmp - alpha);
+      seg[2] = smoothMod2Pi(tmp - beta);
+      break;
+    case 3: /* RSL */
+      pSq = -2.0 + d * d + 2.0 * cab - 2.0 * d * (sa + sb);
+      if (pSq < 0.0) {
+        continue;
+      }
+      seg[1] = std::sqrt(pSq);
+      tmp = std::atan2(ca + cb, d - sa - sb) - std::atan2(2.0, seg[1]);
+      seg[0] = smoothMod2Pi(alpha - tmp);
+      seg[2] = smoothMod2Pi(beta - tmp);
+      break;
+    case 4: /* RLR */
+      tmp = (6.0 - d * d + 2.0 * cab + 2.0 * d * (sa - sb)) / 8.0;
+      if (std::fabs(tmp) > 1.0) {
+        continue;
+      }
+      seg[1] = smoothMod2Pi(2.0 * smoothPi - std::acos(tmp));
+      seg[0] = smoothMod2Pi(alpha - std::atan2(ca - cb, d - sa + sb) +
+                            seg[1] / 2.0);
+      seg[2] = smoothMod2Pi(alpha - beta - seg[0] + seg[1]);
+      break;
+    default: /* LRL */
+      tmp = (6.0 - d * d + 2.0 * cab + 2.0 * d * (sb - sa)) / 8.0;
+      if (std::fabs(tmp) > 1.0) {
+        continue;
+      }
+      seg[1] = smoothMod2Pi(2.0 * smoothPi - std::acos(tmp));
+      seg[0] = smoothMod2Pi(-alpha - std::atan2(ca - cb, d + sa - sb) +
+                            seg[1] / 2.0);
+      seg[2] = smoothMod2Pi(beta - alpha - seg[0] + seg[1]);
+      break;
+    }
+    if (seg[0] + seg[1] + seg[2] < best) {
+      best = seg[0] + seg[1] + seg[2];
+      bestWord = w;
+      len[0] = seg[0];
+      len[1] = seg[1];
+      len[2] = seg[2];
+    }
+  }
+  if (bestWord < 0) {
+    return 0;
+  }
+  x = q0[0];
+  y = q0[1];
+  tmp = q0[2];
+  for (k = 0; k < 3; k++) {
+    pieces[k].x = x;
+    pieces[k].y = y;
+    pieces[k].heading = tmp;
+    pieces[k].kappa = words[bestWord][k] / rho;
+    pieces[k].length = len[k] * rho;
+    smoothAdvance(pieces[k], pieces[k].length, x, y);
+    tmp += pieces[k].kappa * pieces[k].length;
+  }
+  return 3;
+}
+
+/*
+ * Corners of waypoints w0 .. w1 (inclusive). A pair is two waypoints that
+ * turn the same way by at least 150 degrees together and whose full
+ * fillets overlap on the leg between them; a pair does not start where
+ * the previous two already qualify, so no waypoint is in two pairs.
+ * Other fillets that overlap share their leg in proportion.
+ */
+static void smoothPlan(const double *wp, std::size_t n,
+                       const SmoothOptions &opt, std::size_t w0,
+                       std::size_t w1, SmoothWindow &win)
+{
+  const double *x = wp;
+  const double *y = wp + n;
+  const std::size_t lo = w0 > smoothMargin ? w0 - smoothMargin : 0;
+  const std::size_t hi = std::min(w1 + smoothMargin, n - 1);
+  const std::size_t m = hi - lo + 1;
+  std::vector<uint8_t> paired(m, 0);
+  std::vector<double> demand(m, 0.0);
+  double ein[2];
+  double eout[2];
+  double share;
+  double a;
+  std::size_t i;
+  std::size_t j;
+  win.lo = lo;
+  win.turn.assign(m, 0.0);
+  win.tangent.assign(m, 0.0);
+  win.leg.assign(m, 0.0);
+  win.pairable.assign(m, 0);
+  win.corner.assign(m, SmoothCorner());
+
+  for (i = lo; i < hi; i++) {
+    win.leg[i - lo] = std::hypot(x[i + 1] - x[i], y[i + 1] - y[i]);
+  }
+  for (i = std::max<std::size_t>(lo, 1); i <= hi && i + 1 < n; i++) {
+    ein[0] = x[i] - x[i - 1];
+    ein[1] = y[i] - y[i - 1];
+    eout[0] = x[i + 1] - x[i];
+    eout[1] = y[i + 1] - y[i];
+    if (!(std::hypot(ein[0], ein[1]) > smoothTiny) ||
+        !(std::hypot(eout[0], eout[1]) > smoothTiny)) {
+      continue;
+    }
+    a = std::atan2(ein[0] * eout[1] - ein[1] * eout[0],
+                   ein[0] * eout[0] + ein[1] * eout[1]);
+    if (std::fabs(a) > smoothTiny) {
+      win.turn[i - lo] = a;
+      win.tangent[i - lo] =
+          opt.radius * std::tan(std::min(std::fabs(a), smoothReverse) / 2.0);
+    }
+  }
+
+  /*  Pairs */
+  for (i = lo; i < hi; i++) {
+    j = i - lo;
+    win.pairable[j] =
+        win.turn[j] * win.turn[j + 1] > 0.0 &&
+        std::fabs(win.turn[j]) + std::fabs(win.turn[j + 1]) >=
+            5.0 * smoothPi / 6.0 &&
+        win.tangent[j] + win.tangent[j + 1] > win.leg[j];
+  }
+  for (i = lo + 1; i < hi; i++) {
+    j = i - lo;
+    if (win.pairable[j] && !win.pairable[j - 1]) {
+      win.corner[j].kind = smoothPairStart;
+      win.corner[j + 1].kind = smoothPairEnd;
+      paired[j] = 1;
+      paired[j + 1] = 1;
+    }
+  }
+
+  /*  Fillets, each taking at most its share of either leg; a reversal
+   *  has no fillet (its radius would vanish) and keeps both legs whole */
+  for (j = 0; j < m; j++) {
+    demand[j] = paired[j] || std::fabs(win.turn[j]) >= smoothReverse
+                    ? 0.0
+                    : win.tangent[j];
+  }
+  for (i = std::max(w0, lo + 1); i <= w1 && i < hi; i++) {
+    j = i - lo;
+    if (!paired[j] && std::fabs(win.turn[j]) >= smoothReverse) {
+      win.corner[j].kind = smoothReversal;
+      win.corner[j].turn = win.turn[j];
+      continue;
+    }
+    if (paired[j] || !(demand[j] > 0.0)) {
+      continue;
+    }
+    share = demand[j];
+    if (demand[j - 1] + demand[j] > win.leg[j - 1]) {
+      share = std::min(share, win.leg[j - 1] * demand[j] /
+                                  (demand[j - 1] + demand[j]));
+    }
+    if (demand[j] + demand[j + 1] > win.leg[j]) {
+      share = std::min(share,
+                       win.leg[j] * demand[j] / (demand[j] + demand[j + 1]));
+    }
+    win.corner[j].kind = smoothFillet;
+    win.corner[j].turn = win.turn[j];
+    win.corner[j].tangent = share;
+    win.corner[j].radius = share / std::tan(std::fabs(win.turn[j]) / 2.0);
+  }
+}
+
+static bool smoothRun(const double *src, std::size_t nSrc, int dims,
+                      const SmoothOptions &opt, SmoothSink &sink,
+                      SmoothStats &stats, const char **err)
+{
+  std::vector<double> wp;
+  std::vector<std::size_t> last;
+  const double *x;
+  const double *y;
+  const double *z;
+  SmoothWindow win;
+  SmoothPiece pieces[3];
+  SmoothPiece p;
+  const SmoothCorner *ca;
+  const SmoothCorner *cb;
+  double q0[3];
+  double q1[3];
+  double za;
+  double zb;
+  double len;
+  double hIn;
+  double hOut;
+  double total;
+  double s;
+  std::size_t n = 0;
+  std::size_t w0;
+  std::size_t w1;
+  std::size_t i;
+  std::size_t j;
+  int np;
+  int k;
+  int d;
+  stats.fillets = 0;
+  stats.tightTurns = 0;
+  stats.dubinsTurns = 0;
+  stats.minRadius = std::numeric_limits<double>::infinity();
+  sink.k = 0;
+  if (!(opt.spacing > 0.0) || !(opt.radius >= 0.0) ||
+      !std::isfinite(opt.radius) || !(opt.maxTurn > 0.0) ||
+      !(opt.maxTurn <= 180.0)) {
+    *err = "spacing and maxTurnAngle must be positive, radius finite";
+    return false;
+  }
+  for (i = 0; i < nSrc * (std::size_t)dims; i++) {
+    if (!std::isfinite(src[i])) {
+      *err = "waypoints must be finite";
+      return false;
+    }
+  }
+  if (nSrc == 0) {
+    return true;
+  }
+
+  try {
+    /*  A run of coincident waypoints (zero-length legs) collapses onto its
+     *  last one, so the turn across it is planned like any other corner;
+     *  u is mapped back to the source rows in smoothPut */
+    for (i = 0; i < nSrc; i++) {
+      if (i + 1 == nSrc || std::hypot(src[nSrc + i + 1] - src[nSrc + i],
+                                      src[i + 1] - src[i]) > smoothTiny) {
+        last.push_back(i);
+      }
+    }
+    n = last.size();
+    wp.resize(n * (std::size_t)dims);
+    for (d = 0; d < dims; d++) {
+      for (i = 0; i < n; i++) {
+        wp[d * n + i] = src[d * nSrc + last[i]];
+      }
+    }
+  } catch (const std::bad_alloc &) {
+    *err = "out of memory";
+    return false;
+  }
+  x = &wp[0];
+  y = x + n;
+  z = dims >= 3 ? x + 2 * n : NULL;
+  sink.last = &last[0];
+  sink.nLast = n;
+  smoothPut(sink, x[0], y[0], z != NULL ? z[0] : 0.0, 0.0);
+
+  try {
+    for (w0 = 0; w0 + 1 < n; w0 += smoothBlock) {
+      w1 = std::min(w0 + smoothBlock, n - 1);
+      smoothPlan(x, n, opt, w0, w1, win);
+      for (i = w0; i < w1; i++) {
+        j = i - win.lo;
+        ca = &win.corner[j];
+        cb = &win.corner[j + 1];
+        len = win.leg[j];
+        za = z != NULL ? z[i] : 0.0;
+        zb = z != NULL ? z[i + 1] : 0.0;
+        hOut = std::atan2(y[i + 1] - y[i], x[i + 1] - x[i]);
+
+        if (ca->kind == smoothPairStart) {
+          /*  Dubins turn from i along leg i - 1 to i + 1 along leg i + 1 */
+          q0[0] = x[i];
+          q0[1] = y[i];
+          q0[2] = std::atan2(y[i] - y[i - 1], x[i] - x[i - 1]);
+          q1[0] = x[i + 1];
+          q1[1] = y[i + 1];
+          q1[2] = std::atan2(y[i + 2] - y[i + 1], x[i + 2] - x[i + 1]);
+          np = opt.radius > 0.0 ? smoothDubins(q0, q1, opt.radius, pieces)
+                                : 0;
+          total = 0.0;
+          for (k = 0; k < np; k++) {
+            total += pieces[k].length;
+          }
+          s = 0.0;
+          for (k = 0; k < np && total > 0.0; k++) {
+            pieces[k].z0 = za + (zb - za) * s / total;
+            pieces[k].u0 = (double)i + s / total;
+            s += pieces[k].length;
+            pieces[k].z1 = za + (zb - za) * s / total;
+            pieces[k].u1 = (double)i + s / total;
+            smoothEmit(sink, pieces[k], opt);
+          }
+          if (np > 0) {
+            stats.dubinsTurns++;
+            continue;
+          }
+        }
+
+        /*  Straight part of the leg between the two fillets */
+        if (len > smoothTiny) {
+          p.x = x[i];
+          p.y = y[i];
+          p.heading = hOut;
+          p.kappa = 0.0;
+          s = ca->kind == smoothFillet ? ca->tangent : 0.0;
+          p.length = len - s - (cb->kind == smoothFillet ? cb->tangent : 0.0);
+          smoothAdvance(p, s, p.x, p.y);
+          p.z0 = za + (zb - za) * s / len;
+          p.u0 = (double)i + s / len;
+          p.z1 = za + (zb - za) * (s + p.length) / len;
+          p.u1 = (double)i + (s + p.length) / len;
+          smoothEmit(sink, p, opt);
+        }
+
+        /*  Fillet at i + 1 */
+        if (cb->kind == smoothFillet) {
+          hIn = hOut;
+          p.heading = hIn;
+          p.kappa = (cb->turn > 0.0 ? 1.0 : -1.0) / cb->radius;
+          p.length = cb->radius * std::fabs(cb->turn);
+          p.x = x[i + 1] - cb->tangent * std::cos(hIn);
+          p.y = y[i + 1] - cb->tangent * std::sin(hIn);
+          p.z0 = zb + (za - zb) * cb->tangent / len;
+          p.u0 = (double)(i + 1) - cb->tangent / len;
+          p.z1 = zb + ((z != NULL ? z[i + 2] : 0.0) - zb) * cb->tangent /
+                          win.leg[j + 1];
+          p.u1 = (double)(i + 1) + cb->tangent / win.leg[j + 1];
+          smoothEmit(sink, p, opt);
+          stats.fillets++;
+          stats.minRadius = std::min(stats.minRadius, cb->radius);
+          if (cb->radius < opt.radius * (1.0 - 1e-9)) {
+            stats.tightTurns++;
+          }
+        }
+
+        /*  Reversal at i + 1: Dubins bulb from the waypoint back onto it,
+         *  heading along the outgoing leg */
+        if (cb->kind == smoothReversal && opt.radius > 0.0) {
+          q0[0] = x[i + 1];
+          q0[1] = y[i + 1];
+          q0[2] = hOut;
+          q1[0] = x[i + 1];
+          q1[1] = y[i + 1];
+          q1[2] = std::atan2(y[i + 2] - y[i + 1], x[i + 2] - x[i + 1]);
+          np = smoothDubins(q0, q1, opt.radius, pieces);
+          for (k = 0; k < np; k++) {
+            pieces[k].z0 = zb;
+            pieces[k].z1 = zb;
+            pieces[k].u0 = (double)(i + 1);
+            pieces[k].u1 = (double)(i + 1);
+            smoothEmit(sink, pieces[k], opt);
+          }
+          if (np > 0) {
+            stats.dubinsTurns++;
+          }
+        }
+      }
+    }
+  } catch (const std::bad_alloc &) {
+    *err = "out of memory";
+    return false;
+  }
+  return true;
+}
+
+bool pathSmoothCount(const double *wp, std::size_t n, int dims,
+                     const SmoothOptions &opt, std::size_t &count,
+                     const char **err)
+{
+  SmoothSink sink = {NULL, NULL, 0, 0, dims, NULL, 0};
+  SmoothStats stats;
+  if (!smoothRun(wp, n, dims, opt, sink, stats, err)) {
+    return false;
+  }
+  count = sink.k;
+  return true;
+}
+
+bool pathSmooth(const double *wp, std::size_t n, int dims,
+                const SmoothOptions &opt, double *out, double *u,
+                std::size_t count, SmoothStats &stats, const char **err)
+{
+  SmoothSink sink = {out, u, count, 0, dims, NULL, 0};
+  if (!smoothRun(wp, n, dims, opt, sink, stats, err)) {
+    return false;
+  }
+  if (sink.k != count) {
+    *err = "output size does not match pathSmoothCount";
+    return false;
+  }
+  return true;
+}
+
+/* End of pathSmooth.cpp */
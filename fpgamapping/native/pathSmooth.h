@@ -0,0 +1,69 @@
+/*
+ * pathSmooth.h
+ *
+ * Turn-radius-bounded smoothing for pathSmoother.m ('dubins' method).
+ *
+ * Every interior waypoint is rounded by a circular fillet of the turn
+ * radius, tangent to both legs. Where two consecutive waypoints turn the
+ * same way by a U-turn in total (a boustrophedon row end) and their
+ * fillets do not fit on the leg between them, the pair is replaced by the
+ * shortest Dubins path (LSL, RSR, LSR, RSL, RLR or LRL at the turn
+ * radius) from the first waypoint, heading along the incoming leg, to the
+ * second, heading along the outgoing leg; this is the bulb turn a fixed
+ * radius needs when the rows are closer than two radii. A waypoint that
+ * reverses the path on its own gets the Dubins bulb from itself back onto
+ * itself. Any other fillets that do not fit share the leg in proportion
+ * and get a smaller radius. Coincident waypoints count as one (the last),
+ * so a zero-length leg does not hide the turn around it.
+ *
+ * The curve is sampled at most spacing apart along its length, and on
+ * arcs at most maxTurn of heading apart, so consecutive chords never
+ * turn by more than maxTurn. Z and the source position u (fractional,
+ * 0-based waypoint index) vary linearly along each leg, and across a
+ * fillet or Dubins turn from where it leaves one leg to where it joins
+ * the next.
+ *
+ * The waypoints are planned in fixed windows (a corner only depends on
+ * the waypoints up to three away), and pathSmoothCount gives the exact
+ * output size so the caller can preallocate it.
+ *
+ */
+
+#pragma once
+
+/* Include files */
+#include <cstddef>
+#include <cstdint>
+
+/* Type Definitions */
+struct SmoothOptions {
+  double spacing; /* meters between output points at most */
+  double radius;  /* turn radius, meters */
+  double maxTurn; /* degrees of heading between output chords at most */
+};
+
+struct SmoothStats {
+  int32_t fillets;     /* rounded corners */
+  int32_t tightTurns;  /* fillets below the turn radius */
+  int32_t dubinsTurns; /* Dubins pairs and reversal bulbs */
+  double minRadius;    /* smallest fillet radius, Inf without fillets */
+};
+
+/* Function Declarations */
+/*
+ * wp is n x dims (dims 2 or 3, column-major). Returns false on invalid
+ * options or non-finite waypoints.
+ */
+bool pathSmoothCount(const double *wp, std::size_t n, int dims,
+                     const SmoothOptions &opt, std::size_t &count,
+                     const char **err);
+
+/*
+ * out is count x dims, u count x 1 (both column-major, count from
+ * pathSmoothCount).
+ */
+bool pathSmooth(const double *wp, std::size_t n, int dims,
+                const SmoothOptions &opt, double *out, double *u,
+                std::size_t count, SmoothStats &stats, const char **err);
+
+/* End of pathSmooth.h */
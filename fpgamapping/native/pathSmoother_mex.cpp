@@ -0,0 +1,78 @@
+/*
+ * pathSmoother_mex.cpp
+ *
+ * MEX gateway: [path, u, info] = pathSmoother_mex(waypoints, options)
+ *
+ * waypoints is N x 2 or N x 3 (further columns are ignored), options is
+ * [spacing, turnRadius, maxTurnAngle] (meters, meters, degrees). path is
+ * the M x 2 or M x 3 curve of pathSmooth.cpp, u the M x 1 fractional
+ * 0-based waypoint index of every point (to carry extra columns along).
+ * info has fillets, tightTurns, dubinsTurns and minRadius.
+ *
+ */
+
+/* Include files */
+#include "mexUtil.h"
+#include "pathSmooth.h"
+
+/* Function Definitions */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  static const char *errId = "pathSmoother:InvalidInput";
+  static const char *fields[] = {"fillets", "tightTurns", "dubinsTurns",
+                                 "minRadius"};
+  SmoothOptions opt;
+  SmoothStats stats;
+  const double *wp;
+  const double *options;
+  const char *err = "";
+  std::size_t n;
+  std::size_t count;
+  int dims;
+  if (nrhs != 2) {
+    mexErrMsgIdAndTxt(errId, "Usage: [path, u, info] = pathSmoother_mex("
+                             "waypoints, options)");
+  }
+  if (nlhs > 3) {
+    mexErrMsgIdAndTxt(errId, "Too many output arguments");
+  }
+  wp = mexDoubleArray(prhs[0], "waypoints", errId);
+  n = mxGetM(prhs[0]);
+  if (mxGetNumberOfDimensions(prhs[0]) != 2 || mxGetN(prhs[0]) < 2) {
+    mexErrMsgIdAndTxt(errId, "waypoints must be N x 2 or N x 3");
+  }
+  dims = mxGetN(prhs[0]) >= 3 ? 3 : 2;
+  options = mexDoubleArray(prhs[1], "options", errId);
+  if (mxGetNumberOfElements(prhs[1]) != 3) {
+    mexErrMsgIdAndTxt(errId, "options must be [spacing, turnRadius, "
+                             "maxTurnAngle]");
+  }
+  opt.spacing = options[0];
+  opt.radius = options[1];
+  opt.maxTurn = options[2];
+
+  if (!pathSmoothCount(wp, n, dims, opt, count, &err)) {
+    mexErrMsgIdAndTxt(errId, "%s", err);
+  }
+  plhs[0] = mxCreateDoubleMatrix(count, dims, mxREAL);
+  plhs[1] = mxCreateDoubleMatrix(count, 1, mxREAL);
+  if (!pathSmooth(wp, n, dims, opt, mxGetDoubles(plhs[0]),
+                  mxGetDoubles(plhs[1]), count, stats, &err)) {
+    mxDestroyArray(plhs[0]);
+    mxDestroyArray(plhs[1]);
+    mexErrMsgIdAndTxt(errId, "%s", err);
+  }
+  if (nlhs < 3) {
+    return;
+  }
+  plhs[2] = mxCreateStructMatrix(1, 1, 4, fields);
+  mxSetField(plhs[2], 0, "fillets",
+             mxCreateDoubleScalar((double)stats.fillets));
+  mxSetField(plhs[2], 0, "tightTurns",
+             mxCreateDoubleScalar((double)stats.tightTurns));
+  mxSetField(plhs[2], 0, "dubinsTurns",
+             mxCreateDoubleScalar((double)stats.dubinsTurns));
+  mxSetField(plhs[2], 0, "minRadius", mxCreateDoubleScalar(stats.minRadius));
+}
+
+/* End of pathSmoother_mex.cpp */
@@ -0,0 +1,446 @@
+/*
+ * pathValidate.cpp
+ *
+ * Fused obstacle / AGL / climb / turn pass for pathValidator.m (see
+ * pathValidate.h).
+ *
+ */
+
+/* Include files */
+#include "pathValidate.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <new>
+
+/* Variable Definitions */
+static const std::size_t pathBlock = 2048; /* points per terrain batch */
+
+/* Function Declarations */
+static void pathReserve(PathReport &rep, std::size_t n);
+static bool pathClip(double a, double da, double lo, double hi, double &t0,
+                     double &t1);
+static bool pathCellBlocked(const AstarObstacles &obs, int64_t ci,
+                            int64_t cj, const int64_t ends[4]);
+static bool pathSegmentBlocked(const AstarObstacles &obs, const double *p,
+                               const double *q);
+static double pathClamp01(double v);
+static bool pathPieceLow(const DemGrid &dem, const double *p, const double *q,
+                         double ta, double tb, double clearance);
+static bool pathSegmentLow(const DemGrid &dem, const double *p,
+                           const double *q, double clearance,
+                           int64_t &pieces);
+
+/* Function Definitions */
+/*  Room for a few percent of violations before any buffer has to grow */
+static void pathReserve(PathReport &rep, std::size_t n)
+{
+  const std::size_t guess = std::min<std::size_t>(n, 1024 + n / 32);
+  rep.collisions.clear();
+  rep.crossings.clear();
+  rep.lowPoints.clear();
+  rep.turns.clear();
+  rep.turnDeg.clear();
+  rep.collisions.reserve(guess);
+  rep.crossings.reserve(guess);
+  rep.lowPoints.reserve(guess);
+  rep.turns.reserve(guess);
+  rep.turnDeg.reserve(guess);
+  rep.steep.clear();
+  rep.steepDeg.clear();
+  rep.lowLegs.clear();
+  rep.steep.reserve(guess);
+  rep.steepDeg.reserve(guess);
+  rep.lowLegs.reserve(guess);
+}
+
+/*  Narrow [t0, t1] to where a + t da lies in [lo, hi] */
+static bool pathClip(double a, double da, double lo, double hi, double &t0,
+                     double &t1)
+{
+  double ta;
+  double tb;
+  if (da == 0.0) {
+    return a >= lo && a <= hi;
+  }
+  ta = (lo - a) / da;
+  tb = (hi - a) / da;
+  if (ta > tb) {
+    std::swap(ta, tb);
+  }
+  t0 = std::max(t0, ta);
+  t1 = std::min(t1, tb);
+  return t0 <= t1;
+}
+
+/*  Blocked cell other than the end cells ends = {i0, j0, i1, j1} */
+static bool pathCellBlocked(const AstarObstacles &obs, int64_t ci,
+                            int64_t cj, const int64_t ends[4])
+{
+  if (ci < 0 || ci >= obs.cols || cj < 0 || cj >= obs.rows ||
+      (ci == ends[0] && cj == ends[1]) || (ci == ends[2] && cj == ends[3])) {
+    return false;
+  }
+  return obs.cells[(std::size_t)ci * (std::size_t)obs.rows +
+                   (std::size_t)cj] != 0;
+}
+
+/*
+ *  Supercover walk of p -> q ([x, y]) over the nearest-cell obstacle grid
+ *  (cell c covers (c - 1/2, c + 1/2) res), clipped to the grid first.
+ */
+static bool pathSegmentBlocked(const AstarObstacles &obs, const double *p,
+                               const double *q)
+{
+  const double u1 = (p[0] - obs.x0) / obs.res;
+  const double v1 = (p[1] - obs.y0) / obs.res;
+  const double du = (q[0] - obs.x0) / obs.res - u1;
+  const double dv = (q[1] - obs.y0) / obs.res - v1;
+  double t0 = 0.0;
+  double t1 = 1.0;
+  double a;
+  double b;
+  double da;
+  double db;
+  double tMaxI;
+  double tMaxJ;
+  double tDeltaI;
+  double tDeltaJ;
+  int64_t ends[4];
+  int64_t ci;
+  int64_t cj;
+  int64_t ei;
+  int64_t ej;
+  int64_t stepI;
+  int64_t stepJ;
+  if (obs.cells == NULL || !(std::fabs(du) + std::fabs(dv) < 1e15) ||
+      !(std::fabs(u1) + std::fabs(v1) < 1e15) ||
+      !pathClip(u1, du, -0.5, (double)obs.cols - 0.5, t0, t1) ||
+      !pathClip(v1, dv, -0.5, (double)obs.rows - 0.5, t0, t1)) {
+    return false;
+  }
+  ends[0] = (int64_t)std::round(u1);
+  ends[1] = (int64_t)std::round(v1);
+  ends[2] = (int64_t)std::round(u1 + du);
+  ends[3] = (int64_t)std::round(v1 + dv);
+  if (std::abs(ends[2] - ends[0]) + std::abs(ends[3] - ends[1]) <= 1) {
+    return false; /* same or side-by-side end cells: nothing in between */
+  }
+
+  /*  Shifted by a half so that cells are floor() */
+  a = u1 + t0 * du + 0.5;
+  b = v1 + t0 * dv + 0.5;
+  da = (t1 - t0) * du;
+  db = (t1 - t0) * dv;
+  ci = (int64_t)std::floor(a);
+  cj = (int64_t)std::floor(b);
+  ei = (int64_t)std::floor(a + da);
+  ej = (int64_t)std::floor(b + db);
+  stepI = (ei > ci) - (ei < ci);
+  stepJ = (ej > cj) - (ej < cj);
+  tDeltaI = stepI != 0 ? 1.0 / std::fabs(da) : HUGE_VAL;
+  tDeltaJ = stepJ != 0 ? 1.0 / std::fabs(db) : HUGE_VAL;
+  tMaxI = stepI > 0 ? ((double)ci + 1.0 - a) / da
+                    : (stepI < 0 ? (a - (double)ci) / -da : HUGE_VAL);
+  tMaxJ = stepJ > 0 ? ((double)cj + 1.0 - b) / db
+                    : (stepJ < 0 ? (b - (double)cj) / -db : HUGE_VAL);
+
+  if (pathCellBlocked(obs, ci, cj, ends)) {
+    return true;
+  }
+  while (ci != ei || cj != ej) {
+    if (cj == ej || (ci != ei && tMaxI < tMaxJ)) {
+      ci += stepI;
+      tMaxI += tDeltaI;
+    } else if (ci == ei || tMaxJ < tMaxI) {
+      cj += stepJ;
+      tMaxJ += tDeltaJ;
+    } else {
+      /*  Exactly through a corner: both side cells are touched */
+      if (pathCellBlocked(obs, ci + stepI, cj, ends) ||
+          pathCellBlocked(obs, ci, cj + stepJ, ends)) {
+        return true;
+      }
+      ci += stepI;
+      cj += stepJ;
+      tMaxI += tDeltaI;
+      tMaxJ += tDeltaJ;
+    }
+    if (pathCellBlocked(obs, ci, cj, ends)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static double pathClamp01(double v)
+{
+  return v < 0.0 ? 0.0 : (v > 1.0 ? 1.0 : v);
+}
+
+/*
+ *  True if p -> q ([x, y, z]) passes below terrain + clearance for some t
+ *  in [ta, tb], a piece inside one DEM cell (or beyond one edge of the
+ *  grid, where demInterpolate clamps). Z is column-major.
+ */
+static bool pathPieceLow(const DemGrid &dem, const double *p, const double *q,
+                         double ta, double tb, double clearance)
+{
+  const double tm = 0.5 * (ta + tb);
+  const double um = (p[0] + tm * (q[0] - p[0]) - dem.xMin) / dem.resolution;
+  const double vm = (p[1] + tm * (q[1] - p[1]) - dem.yMin) / dem.resolution;
+  const int32_t i = (int32_t)std::min(
+      std::max(std::floor(um), 0.0), (double)dem.cols - 2.0);
+  const int32_t j = (int32_t)std::min(
+      std::max(std::floor(vm), 0.0), (double)dem.rows - 2.0);
+  const double *c = dem.Z + (std::size_t)i * dem.rows + j;
+  const double z00 = c[0];
+  const double z01 = c[1];
+  const double z10 = c[dem.rows];
+  const double z11 = c[dem.rows + 1];
+  const double za = p[2] + ta * (q[2] - p[2]);
+  const double zb = p[2] + tb * (q[2] - p[2]);
+  double fa;
+  double fb;
+  double ga;
+  double gb;
+  double df;
+  double dg;
+  double A;
+  double B;
+  double C;
+  double g0;
+  double g1;
+  double g2;
+  double s;
+  double lo;
+
+  if (std::max(std::max(z00, z01), std::max(z10, z11)) + clearance <=
+      std::min(za, zb)) {
+    return false; /* above the highest corner */
+  }
+
+  /*  Cell fractions at both ends; linear in t within the piece */
+  fa = pathClamp01((p[0] + ta * (q[0] - p[0]) - dem.xMin) / dem.resolution -
+                   (double)i);
+  fb = pathClamp01((p[0] + tb * (q[0] - p[0]) - dem.xMin) / dem.resolution -
+                   (double)i);
+  ga = pathClamp01((p[1] + ta * (q[1] - p[1]) - dem.yMin) / dem.resolution -
+                   (double)j);
+  gb = pathClamp01((p[1] + tb * (q[1] - p[1]) - dem.yMin) / dem.resolution -
+                   (double)j);
+  df = fb - fa;
+  dg = gb - ga;
+
+  /*  g(s) = z(s) - terrain(s) - clearance, s in [0, 1] over the piece */
+  A = z10 - z00;
+  B = z01 - z00;
+  C = z00 - z10 - z01 + z11;
+  g0 = za - (z00 + A * fa + B * ga + C * fa * ga) - clearance;
+  g1 = (zb - za) - (A * df + B * dg + C * (fa * dg + ga * df));
+  g2 = -C * df * dg;
+  lo = std::min(g0, g0 + g1 + g2);
+  if (g2 > 0.0) {
+    s = -g1 / (2.0 * g2);
+    if (s > 0.0 && s < 1.0) {
+      lo = std::min(lo, g0 + s * (g1 + s * g2));
+    }
+  }
+  return lo < 0.0;
+}
+
+/*
+ *  Cut p -> q at the post lines it crosses inside the grid and test each
+ *  piece; pieces counts them.
+ */
+static bool pathSegmentLow(const DemGrid &dem, const double *p,
+                           const double *q, double clearance,
+                           int64_t &pieces)
+{
+  const double u1 = (p[0] - dem.xMin) / dem.resolution;
+  const double v1 = (p[1] - dem.yMin) / dem.resolution;
+  const double du = (q[0] - dem.xMin) / dem.resolution - u1;
+  const double dv = (q[1] - dem.yMin) / dem.resolution - v1;
+  double ku;
+  double kv;
+  double kuEnd;
+  double kvEnd;
+  double su;
+  double sv;
+  double tu;
+  double tv;
+  double ta = 0.0;
+  double tb;
+  if (!(std::fabs(u1) + std::fabs(v1) + std::fabs(du) + std::fabs(dv) <
+        1e15) ||
+      !(p[2] == p[2] && q[2] == q[2])) {
+    return false;
+  }
+
+  /*  Post lines k crossed, first to last along the segment */
+  su = du > 0.0 ? 1.0 : -1.0;
+  sv = dv > 0.0 ? 1.0 : -1.0;
+  ku = du > 0.0 ? std::max(std::floor(u1) + 1.0, 0.0)
+                : std::min(std::ceil(u1) - 1.0, (double)dem.cols - 1.0);
+  kuEnd = du > 0.0 ? std::min(std::ceil(u1 + du) - 1.0, (double)dem.cols - 1.0)
+                   : std::max(std::floor(u1 + du) + 1.0, 0.0);
+  kv = dv > 0.0 ? std::max(std::floor(v1) + 1.0, 0.0)
+                : std::min(std::ceil(v1) - 1.0, (double)dem.rows - 1.0);
+  kvEnd = dv > 0.0 ? std::min(std::ceil(v1 + dv) - 1.0, (double)dem.rows - 1.0)
+                   : std::max(std::floor(v1 + dv) + 1.0, 0.0);
+
+  for (;;) {
+    tu = (du != 0.0 && su * (kuEnd - ku) >= 0.0) ? (ku - u1) / du : 2.0;
+    tv = (dv != 0.0 && sv * (kvEnd - kv) >= 0.0) ? (kv - v1) / dv : 2.0;
+    tb = std::min(std::min(tu, tv), 1.0);
+    if (tb > ta) {
+      pieces++;
+      if (pathPieceLow(dem, p, q, ta, tb, clearance)) {
+        return true;
+      }
+    }
+    if (tb >= 1.0) {
+      return false;
+    }
+    if (tu <= tb) {
+      ku += su;
+    }
+    if (tv <= tb) {
+      kv += sv;
+    }
+    ta = tb;
+  }
+}
+
+bool pathValidate(const DemGrid &dem, const AstarObstacles &obs,
+                  const double *path, std::size_t n, int dims,
+                  const PathLimits &lim, double *terrain, PathReport &rep,
+                  const char **err)
+{
+  const double inf = std::numeric_limits<double>::infinity();
+  const double deg = 180.0 / 3.14159265358979323846;
+  const double tanClimb = std::tan(lim.maxClimb / deg);
+  /*  Pre-filters with a little slack, the exact test decides */
+  const double ratioGate = tanClimb - 1e-12 * std::fabs(tanClimb);
+  const double cosGate =
+      lim.maxTurn < 0.0 ? 2.0 : std::cos(lim.maxTurn / deg) + 1e-12;
+  const double *px = path;
+  const double *py = path + n;
+  const double *pz = (dims >= 3) ? path + 2 * n : NULL;
+  double maxRatio = 0.0;
+  double minCos = 1.0;
+  double dz;
+  double a[3]; /* segment ends [x, y, z] */
+  double e[3];
+  double ex = 0.0; /* previous segment, for the turn test */
+  double ey = 0.0;
+  double en = 0.0;
+  double dx;
+  double dy;
+  double dxy;
+  double c;
+  std::size_t b;
+  std::size_t end;
+  std::size_t i;
+
+  if (n > (std::size_t)INT32_MAX) {
+    *err = "path has too many points";
+    return false;
+  }
+  try {
+    pathReserve(rep, n);
+  } catch (const std::bad_alloc &) {
+    *err = "out of memory";
+    return false;
+  }
+  rep.length = 0.0;
+  rep.minAGL = inf;
+  rep.maxSlope = 0.0;
+  rep.maxTurn = 0.0;
+  rep.terrainCells = 0;
+
+  try {
+    for (b = 0; b < n; b = end) {
+      end = std::min(n, b + pathBlock);
+      demInterpolateBatch(dem, px + b, py + b, terrain + b, end - b);
+
+      for (i = b; i < end; i++) {
+        /*  Check 1: nearest obstacle cell */
+        if (astarObstacleAt(obs, px[i], py[i])) {
+          rep.collisions.push_back((int32_t)i);
+        }
+
+        /*  Check 2: AGL */
+        if (pz != NULL) {
+          if (pz[i] < terrain[i] + lim.minAGL - 1.0) {
+            rep.lowPoints.push_back((int32_t)i);
+          }
+          if (i + 1 < n) {
+            rep.minAGL = std::min(rep.minAGL, pz[i] - terrain[i]);
+          }
+        }
+        if (i == 0) {
+          continue;
+        }
+
+        /*  Check 3: climb of segment i - 1 -> i */
+        dx = px[i] - px[i - 1];
+        dy = py[i] - py[i - 1];
+        dxy = std::sqrt(dx * dx + dy * dy);
+        dz = pz != NULL ? pz[i] - pz[i - 1] : 0.0;
+        rep.length += std::sqrt(dxy * dxy + dz * dz);
+        if (dxy > 0.0) {
+          c = std::fabs(dz) / dxy;
+          maxRatio = std::max(maxRatio, c);
+          if (c > ratioGate && std::atan(c) * deg > lim.maxClimb) {
+            rep.steep.push_back((int32_t)(i - 1));
+            rep.steepDeg.push_back(std::atan(c) * deg);
+          }
+        }
+
+        /*  Whole segment: obstacle cells crossed, terrain under the leg */
+        a[0] = px[i - 1];
+        a[1] = py[i - 1];
+        e[0] = px[i];
+        e[1] = py[i];
+        if (pathSegmentBlocked(obs, a, e)) {
+          rep.crossings.push_back((int32_t)(i - 1));
+        }
+        if (pz != NULL) {
+          a[2] = pz[i - 1];
+          e[2] = pz[i];
+          if (pathSegmentLow(dem, a, e, lim.minAGL - 1.0,
+                             rep.terrainCells)) {
+            rep.lowLegs.push_back((int32_t)(i - 1));
+          }
+        }
+
+        /*  Check 4: turn at point i - 1, between the last two segments */
+        if (i >= 2 && en > 0.1 && dxy > 0.1) {
+          c = (ex * dx + ey * dy) / (en * dxy);
+          minCos = std::min(minCos, c);
+          if (c < cosGate) {
+            c = std::atan2(std::fabs(ex * dy - ey * dx), ex * dx + ey * dy) *
+                deg;
+            if (c > lim.maxTurn) {
+              rep.turns.push_back((int32_t)(i - 1));
+              rep.turnDeg.push_back(c);
+            }
+          }
+        }
+        ex = dx;
+        ey = dy;
+        en = dxy;
+      }
+    }
+  } catch (const std::bad_alloc &) {
+    *err = "out of memory";
+    return false;
+  }
+
+  rep.maxSlope = std::atan(maxRatio) * deg;
+  rep.maxTurn = std::acos(std::max(-1.0, std::min(1.0, minCos))) * deg;
+  return true;
+}
+
+/* End of pathValidate.cpp */
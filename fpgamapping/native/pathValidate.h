@@ -0,0 +1,82 @@
+/*
+ * pathValidate.h
+ *
+ * Checks 1-4 and the statistics of pathValidator.m in one streaming pass:
+ * the path is taken in blocks of points, the terrain under a block is
+ * interpolated once (demInterpolateBatch), and each point is then tested
+ * for an obstacle, minimum AGL, the climb angle of the segment it ends and
+ * the turn it makes, while the numbers for the statistics accumulate.
+ *
+ * The pass checks the path as flown. When any point is below the floor,
+ * pathValidator.m replaces Z with the climb-limited terrain-following
+ * profile of altitudeProfile.m and runs the pass again on that path, so
+ * the climb checks, leg checks and statistics it reports are always
+ * those of the profile that is flown.
+ *
+ * Violations are stored as indices (plus the angle for slopes and turns)
+ * in buffers reserved up front. The angle tests compare |dz| / dxy with
+ * tan(maxClimb) and the cosine of the turn with cos(maxTurn), so trig
+ * runs only on violations and on the maxima at the end.
+ *
+ * Segments are checked whole, not just at their end points:
+ *
+ *   obstacles - a supercover walk (Amanatides-Woo, both side cells where
+ *               the line passes exactly through a corner) visits every
+ *               obstacle cell the segment touches; blocked cells other
+ *               than the two end cells (Check 1 has those) flag it.
+ *   terrain   - the segment is cut where it crosses DEM post lines, so
+ *               each piece lies in one bilinear cell. A piece whose lower
+ *               end clears the highest corner of its cell is accepted at
+ *               once; otherwise the clearance along it, a quadratic in
+ *               the segment parameter, is minimised exactly.
+ *
+ * Neither walk samples, so a sparse path is checked as tightly as a
+ * densified one, and a leg that clips the corner of a blocked cell or
+ * dips into a ridge between vertices is caught.
+ *
+ */
+
+#pragma once
+
+/* Include files */
+#include "astarTraversability.h"
+#include "demKernel.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Type Definitions */
+struct PathLimits {
+  double minAGL;   /* meters; points and legs below minAGL - 1 m violate */
+  double maxClimb; /* degrees */
+  double maxTurn;  /* degrees */
+};
+
+struct PathReport {
+  std::vector<int32_t> collisions; /* 0-based points in a blocked cell */
+  std::vector<int32_t> lowPoints;  /* 0-based points below the floor */
+  std::vector<int32_t> turns;      /* 0-based interior points */
+  std::vector<double> turnDeg;
+  std::vector<int32_t> steep; /* 0-based segments (first point) */
+  std::vector<double> steepDeg;
+  std::vector<int32_t> crossings; /* segments through a blocked cell */
+  std::vector<int32_t> lowLegs;   /* segments dipping below the floor */
+  int64_t terrainCells;           /* DEM cell pieces examined */
+  double length;
+  double minAGL; /* over every point but the last, Inf for 2-D paths */
+  double maxSlope;
+  double maxTurn;
+};
+
+/* Function Declarations */
+/*
+ * path is n x dims (dims 2 or 3, column-major); terrain receives the n
+ * elevations under it. obs.cells == NULL skips the obstacle check; 2-D
+ * paths skip the AGL check and have no climb.
+ */
+bool pathValidate(const DemGrid &dem, const AstarObstacles &obs,
+                  const double *path, std::size_t n, int dims,
+                  const PathLimits &lim, double *terrain, PathReport &rep,
+                  const char **err);
+
+/* End of pathValidate.h */
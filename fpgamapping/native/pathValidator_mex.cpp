@@ -0,0 +1,150 @@
+/*
+ * pathValidator_mex.cpp
+ *
+ * MEX gateway: [terrainZ, report] = pathValidator_mex(path, demData,
+ *                                                     obstacles, limits)
+ *
+ * Checks 1-4 and the statistics of pathValidator.m in one pass
+ * (pathValidate.cpp). path is N x 2 or N x 3, limits is [minAGL,
+ * maxClimbAngle, maxTurnAngle] (degrees), obstacles the planners' struct
+ * ([] for none). terrainZ is the N x 1 terrain under the path. report has
+ *
+ *   collisions     - K x 1 points in a blocked obstacle cell
+ *   altitudeTooLow - K x 3 [point, z, terrain + minAGL] below minAGL - 1 m
+ *   slopeTooSteep  - K x 3 [segment, climb angle, maxClimbAngle]
+ *   turnsTooSharp  - K x 3 [point, turn angle, maxTurnAngle]
+ *   pathLength, minAGL, maxSlope, maxTurnAngle - statistics
+ *   segmentCollisions  - K x 1 segments passing through a blocked cell
+ *                        between their end points
+ *   segmentsBelowAGL   - K x 1 segments that dip below minAGL - 1 m
+ *                        between their end points
+ *   terrainCells       - number of DEM cell pieces the leg check examined
+ *
+ * Indices are 1-based; a segment is numbered by its first point. Every
+ * field describes the path as given: pathValidator.m re-runs the check
+ * after altitudeProfile.m has replaced the Z of a path with low points.
+ *
+ */
+
+/* Include files */
+#include "mexUtil.h"
+#include "pathValidate.h"
+
+/* Function Declarations */
+static mxArray *pathIndexColumn(const std::vector<int32_t> &idx);
+static mxArray *pathAngleRows(const std::vector<int32_t> &idx,
+                              const std::vector<double> &angle,
+                              double limit);
+
+/* Function Definitions */
+static mxArray *pathIndexColumn(const std::vector<int32_t> &idx)
+{
+  mxArray *a = mxCreateDoubleMatrix(idx.size(), 1, mxREAL);
+  double *d = mxGetDoubles(a);
+  std::size_t k;
+  for (k = 0; k < idx.size(); k++) {
+    d[k] = (double)idx[k] + 1.0;
+  }
+  return a;
+}
+
+/*  K x 3 [index, angle, limit] */
+static mxArray *pathAngleRows(const std::vector<int32_t> &idx,
+                              const std::vector<double> &angle,
+                              double limit)
+{
+  const std::size_t n = idx.size();
+  mxArray *a = mxCreateDoubleMatrix(n, 3, mxREAL);
+  double *d = mxGetDoubles(a);
+  std::size_t k;
+  for (k = 0; k < n; k++) {
+    d[k] = (double)idx[k] + 1.0;
+    d[n + k] = angle[k];
+    d[2 * n + k] = limit;
+  }
+  return a;
+}
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  static const char *errId = "pathValidator:InvalidInput";
+  static const char *fields[] = {"collisions",       "altitudeTooLow",
+                                 "slopeTooSteep",    "turnsTooSharp",
+                                 "pathLength",       "minAGL",
+                                 "maxSlope",         "maxTurnAngle",
+                                 "segmentCollisions", "segmentsBelowAGL",
+                                 "terrainCells"};
+  std::vector<uint8_t> cells;
+  AstarObstacles obs;
+  PathLimits lim;
+  PathReport rep;
+  DemGrid dem;
+  mxArray *low;
+  const double *path;
+  const double *limits;
+  const char *err = "";
+  double *d;
+  std::size_t n;
+  std::size_t k;
+  int dims;
+  if (nrhs != 4) {
+    mexErrMsgIdAndTxt(errId, "Usage: [terrainZ, report] = pathValidator_mex("
+                             "path, demData, obstacles, limits)");
+  }
+  if (nlhs > 2) {
+    mexErrMsgIdAndTxt(errId, "Too many output arguments");
+  }
+  path = mexDoubleArray(prhs[0], "path", errId);
+  n = mxGetM(prhs[0]);
+  dims = mxGetN(prhs[0]) >= 3 ? 3 : (int)mxGetN(prhs[0]);
+  if (mxGetNumberOfDimensions(prhs[0]) != 2 || dims < 2) {
+    mexErrMsgIdAndTxt(errId, "path must be N x 2 or N x 3");
+  }
+  dem = mexDemGridFromStruct(prhs[1], errId);
+  obs = mexAstarObstacles(prhs[2], cells, errId);
+  limits = mexDoubleArray(prhs[3], "limits", errId);
+  if (mxGetNumberOfElements(prhs[3]) != 3) {
+    mexErrMsgIdAndTxt(errId, "limits must be [minAGL, maxClimbAngle, "
+                             "maxTurnAngle]");
+  }
+  lim.minAGL = limits[0];
+  lim.maxClimb = limits[1];
+  lim.maxTurn = limits[2];
+
+  plhs[0] = mxCreateDoubleMatrix(n, 1, mxREAL);
+  if (!pathValidate(dem, obs, path, n, dims, lim, mxGetDoubles(plhs[0]), rep,
+                    &err)) {
+    mxDestroyArray(plhs[0]);
+    mexErrMsgIdAndTxt(errId, "%s", err);
+  }
+  if (nlhs < 2) {
+    return;
+  }
+
+  low = mxCreateDoubleMatrix(rep.lowPoints.size(), 3, mxREAL);
+  d = mxGetDoubles(low);
+  for (k = 0; k < rep.lowPoints.size(); k++) {
+    d[k] = (double)rep.lowPoints[k] + 1.0;
+    d[rep.lowPoints.size() + k] = path[2 * n + rep.lowPoints[k]];
+    d[2 * rep.lowPoints.size() + k] =
+        mxGetDoubles(plhs[0])[rep.lowPoints[k]] + lim.minAGL;
+  }
+
+  plhs[1] = mxCreateStructMatrix(1, 1, 11, fields);
+  mxSetField(plhs[1], 0, "collisions", pathIndexColumn(rep.collisions));
+  mxSetField(plhs[1], 0, "altitudeTooLow", low);
+  mxSetField(plhs[1], 0, "slopeTooSteep",
+             pathAngleRows(rep.steep, rep.steepDeg, lim.maxClimb));
+  mxSetField(plhs[1], 0, "turnsTooSharp",
+             pathAngleRows(rep.turns, rep.turnDeg, lim.maxTurn));
+  mxSetField(plhs[1], 0, "pathLength", mxCreateDoubleScalar(rep.length));
+  mxSetField(plhs[1], 0, "minAGL", mxCreateDoubleScalar(rep.minAGL));
+  mxSetField(plhs[1], 0, "maxSlope", mxCreateDoubleScalar(rep.maxSlope));
+  mxSetField(plhs[1], 0, "maxTurnAngle", mxCreateDoubleScalar(rep.maxTurn));
+  mxSetField(plhs[1], 0, "segmentCollisions", pathIndexColumn(rep.crossings));
+  mxSetField(plhs[1], 0, "segmentsBelowAGL", pathIndexColumn(rep.lowLegs));
+  mxSetField(plhs[1], 0, "terrainCells",
+             mxCreateDoubleScalar((double)rep.terrainCells));
+}
+
+/* End of pathValidator_mex.cpp */
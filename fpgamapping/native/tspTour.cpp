@@ -0,0 +1,790 @@
+/*
+ * tspTour.cpp
+ *
+ * Nearest-neighbour construction and 2-opt / Or-opt improvement for
+ * tspNearestNeighbor.m (see tspTour.h).
+ *
+ */
+
+/* Include files */
+#include "tspTour.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <random>
+#include <thread>
+
+/* Type Definitions */
+struct TspGrid {
+  double xMin;
+  double yMin;
+  double h; /* cell edge */
+  int32_t gw;
+  int32_t gh;
+  std::vector<int32_t> cellStart; /* gw * gh + 1 */
+  std::vector<int32_t> items;     /* waypoints grouped by cell */
+  std::vector<int32_t> cellOf;
+};
+
+struct TspShared {
+  const double *pts;
+  int32_t n;
+  int dims;
+  TspOptions opt;
+  TspGrid grid;
+  int32_t k;                /* candidates per waypoint */
+  std::vector<int32_t> nbr; /* n x k, nearest first */
+  double eps;               /* meters a move must gain */
+  bool hasDeadline;
+  std::chrono::steady_clock::time_point deadline;
+};
+
+/*  Unvisited waypoints during construction, per start */
+struct TspBuild {
+  TspGrid grid;               /* of the unvisited waypoints, rebuilt */
+  std::vector<int32_t> count; /* unvisited in each cell, at its front */
+  std::vector<int32_t> slot;  /* index of each waypoint in grid.items */
+  int32_t remaining;
+};
+
+/*  Cycle through the dummy waypoint n */
+struct TspState {
+  int32_t size; /* n + 1 */
+  std::vector<int32_t> tour;
+  std::vector<int32_t> pos;
+  std::deque<int32_t> queue;
+  std::vector<uint8_t> queued; /* don't-look bit clear */
+};
+
+struct TspResult {
+  std::vector<int32_t> order;
+  double greedyLength;
+  double length;
+  int64_t iterations;
+  int64_t twoOptMoves;
+  int64_t orOptMoves;
+  bool timedOut;
+  bool ran;
+};
+
+struct TspPool {
+  const TspShared *shared;
+  std::vector<TspResult> results;
+  std::atomic<int32_t> next;
+  std::atomic<bool> failed;
+  std::mutex errLock;
+  const char *err;
+
+  TspPool() : shared(NULL), next(0), failed(false), err("") {}
+};
+
+/* Function Declarations */
+static double tspDist(const TspShared &sh, int32_t a, int32_t b);
+static int32_t tspCell(const TspGrid &g, double x, double y);
+static void tspGridBuild(const TspShared &sh,
+                         const std::vector<int32_t> &ids, TspGrid &g);
+template <class F>
+static void tspRing(const TspGrid &g, int32_t c, int32_t r, F visit);
+static void tspCandidates(TspShared &sh);
+static int32_t tspNearestFree(const TspShared &sh, TspBuild &b, int32_t from,
+                              bool second);
+static void tspBuildReset(const TspShared &sh,
+                          const std::vector<int32_t> &ids, TspBuild &b);
+static void tspTake(TspBuild &b, int32_t w);
+static void tspConstruct(const TspShared &sh, uint32_t seed, bool randomize,
+                         std::vector<int32_t> &path);
+static double tspLength(const TspShared &sh, const std::vector<int32_t> &p);
+static bool tspFixed(const TspShared &sh, int32_t a, int32_t b);
+static int32_t tspSucc(const TspState &st, int32_t a);
+static int32_t tspPred(const TspState &st, int32_t a);
+static void tspPush(const TspShared &sh, TspState &st, int32_t a);
+static void tspReverse(TspState &st, int32_t from, int32_t to);
+static bool tspTwoOpt(const TspShared &sh, TspState &st, int32_t a);
+static void tspMoveSegment(TspState &st, int32_t s1, int32_t len, int32_t u,
+                           int32_t w, bool reversed);
+static bool tspOrOpt(const TspShared &sh, TspState &st, int32_t a);
+static void tspImprove(const TspShared &sh, const std::vector<int32_t> &path,
+                       TspResult &res);
+static void tspRunWorker(TspPool *pool);
+
+/* Function Definitions */
+static double tspDist(const TspShared &sh, int32_t a, int32_t b)
+{
+  const double *p = sh.pts;
+  const int32_t n = sh.n;
+  double dx;
+  double dy;
+  double dz;
+  if (a >= n || b >= n) {
+    return 0.0; /* the dummy */
+  }
+  dx = p[a] - p[b];
+  dy = p[n + a] - p[n + b];
+  dz = sh.dims >= 3 ? p[2 * n + a] - p[2 * n + b] : 0.0;
+  return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+/*
+ * Clamped in double first: after a rebuild on a clustered remainder an
+ * outlier can lie far more than 2^31 cells off the grid
+ */
+static int32_t tspCell(const TspGrid &g, double x, double y)
+{
+  const double fx = std::min(std::max((x - g.xMin) / g.h, 0.0),
+                             (double)(g.gw - 1));
+  const double fy = std::min(std::max((y - g.yMin) / g.h, 0.0),
+                             (double)(g.gh - 1));
+  return (int32_t)fy * g.gw + (int32_t)fx;
+}
+
+/*
+ * Grid over the waypoints ids, about two per cell, counting-sorted into
+ * cellStart / items; cellOf is indexed by waypoint
+ */
+static void tspGridBuild(const TspShared &sh,
+                         const std::vector<int32_t> &ids, TspGrid &g)
+{
+  const double *x = sh.pts;
+  const double *y = sh.pts + sh.n;
+  const int32_t m = (int32_t)ids.size();
+  double xMax = x[ids[0]];
+  double yMax = y[ids[0]];
+  double w;
+  double hgt;
+  int32_t i;
+  int32_t c;
+  g.xMin = xMax;
+  g.yMin = yMax;
+  for (i = 1; i < m; i++) {
+    g.xMin = std::min(g.xMin, x[ids[i]]);
+    g.yMin = std::min(g.yMin, y[ids[i]]);
+    xMax = std::max(xMax, x[ids[i]]);
+    yMax = std::max(yMax, y[ids[i]]);
+  }
+  w = xMax - g.xMin;
+  hgt = yMax - g.yMin;
+  g.h = std::max(std::sqrt(2.0 * w * hgt / m), 2.0 * std::max(w, hgt) / m);
+  if (!(g.h > 0.0)) {
+    g.h = 1.0; /* all waypoints coincide */
+  }
+  g.gw = (int32_t)(w / g.h) + 1;
+  g.gh = (int32_t)(hgt / g.h) + 1;
+
+  g.cellOf.resize(sh.n);
+  g.cellStart.assign((std::size_t)g.gw * g.gh + 1, 0);
+  g.items.resize(m);
+  for (i = 0; i < m; i++) {
+    g.cellOf[ids[i]] = tspCell(g, x[ids[i]], y[ids[i]]);
+    g.cellStart[g.cellOf[ids[i]] + 1]++;
+  }
+  for (c = 0; c < g.gw * g.gh; c++) {
+    g.cellStart[c + 1] += g.cellStart[c];
+  }
+  std::vector<int32_t> fill(g.cellStart.begin(), g.cellStart.end() - 1);
+  for (i = 0; i < m; i++) {
+    g.items[fill[g.cellOf[ids[i]]]++] = ids[i];
+  }
+}
+
+/*  Cells at Chebyshev distance r from cell c */
+template <class F>
+static void tspRing(const TspGrid &g, int32_t c, int32_t r, F visit)
+{
+  const int32_t cx = c % g.gw;
+  const int32_t cy = c / g.gw;
+  int32_t x;
+  int32_t y;
+  int32_t step;
+  for (y = std::max(cy - r, 0); y <= std::min(cy + r, g.gh - 1); y++) {
+    step = (y == cy - r || y == cy + r) ? 1 : 2 * r;
+    for (x = cx - r; x <= cx + r; x += step) {
+      if (x >= 0 && x < g.gw) {
+        visit(y * g.gw + x);
+      }
+    }
+  }
+}
+
+/*
+ * k nearest waypoints of every waypoint. Ring r + 1 is at least r cell
+ * edges away, so the search stops once the k-th best is that close.
+ */
+static void tspCandidates(TspShared &sh)
+{
+  const TspGrid &g = sh.grid;
+  const int32_t k = sh.k;
+  const int32_t maxR = std::max(g.gw, g.gh);
+  std::vector<double> bestD(k + 1);
+  int32_t *best;
+  int32_t found;
+  int32_t i;
+  int32_t r;
+  sh.nbr.assign((std::size_t)sh.n * k, -1);
+  for (i = 0; i < sh.n && k > 0; i++) {
+    best = &sh.nbr[(std::size_t)i * k];
+    found = 0;
+    for (r = 0; r <= maxR; r++) {
+      tspRing(g, g.cellOf[i], r, [&](int32_t c) {
+        int32_t t;
+        int32_t m;
+        int32_t w;
+        double d;
+        for (t = g.cellStart[c]; t < g.cellStart[c + 1]; t++) {
+          w = g.items[t];
+          d = tspDist(sh, i, w);
+          if (w == i || (found == k && d >= bestD[k - 1])) {
+            continue;
+          }
+          m = found < k ? found++ : k - 1;
+          while (m > 0 && bestD[m - 1] > d) {
+            bestD[m] = bestD[m - 1];
+            best[m] = best[m - 1];
+            m--;
+          }
+          bestD[m] = d;
+          best[m] = w;
+        }
+      });
+      if (found == k && bestD[k - 1] <= r * g.h) {
+        break;
+      }
+    }
+  }
+}
+
+/*  Nearest unvisited waypoint, or the second nearest when asked */
+static int32_t tspNearestFree(const TspShared &sh, TspBuild &b, int32_t from,
+                              bool second)
+{
+  const TspGrid &g = b.grid;
+  const int32_t maxR = std::max(g.gw, g.gh);
+  const int32_t c0 = tspCell(g, sh.pts[from], sh.pts[sh.n + from]);
+  const int32_t need = (second && b.remaining >= 2) ? 2 : 1;
+  double bestD[2] = {std::numeric_limits<double>::infinity(),
+                     std::numeric_limits<double>::infinity()};
+  int32_t best[2] = {-1, -1};
+  int32_t r;
+  for (r = 0; r <= maxR; r++) {
+    tspRing(g, c0, r, [&](int32_t c) {
+      int32_t t;
+      int32_t w;
+      double d;
+      for (t = g.cellStart[c]; t < g.cellStart[c] + b.count[c]; t++) {
+        w = g.items[t];
+        d = tspDist(sh, from, w);
+        if (d < bestD[0]) {
+          bestD[1] = bestD[0];
+          best[1] = best[0];
+          bestD[0] = d;
+          best[0] = w;
+        } else if (d < bestD[1]) {
+          bestD[1] = d;
+          best[1] = w;
+        }
+      }
+    });
+    if (best[need - 1] >= 0 && bestD[need - 1] <= r * g.h) {
+      break;
+    }
+  }
+  return need == 2 ? best[1] : best[0];
+}
+
+static void tspBuildReset(const TspShared &sh,
+                          const std::vector<int32_t> &ids, TspBuild &b)
+{
+  TspGrid &g = b.grid;
+  int32_t c;
+  int32_t t;
+  tspGridBuild(sh, ids, g);
+  b.count.resize(g.cellStart.size() - 1);
+  b.slot.resize(sh.n);
+  for (c = 0; c + 1 < (int32_t)g.cellStart.size(); c++) {
+    b.count[c] = g.cellStart[c + 1] - g.cellStart[c];
+    for (t = g.cellStart[c]; t < g.cellStart[c + 1]; t++) {
+      b.slot[g.items[t]] = t;
+    }
+  }
+  b.remaining = (int32_t)ids.size();
+}
+
+/*  Swap-remove w from the unvisited front of its cell */
+static void tspTake(TspBuild &b, int32_t w)
+{
+  TspGrid &g = b.grid;
+  const int32_t c = g.cellOf[w];
+  const int32_t last = g.cellStart[c] + b.count[c] - 1;
+  const int32_t moved = g.items[last];
+  g.items[b.slot[w]] = moved;
+  b.slot[moved] = b.slot[w];
+  g.items[last] = w;
+  b.slot[w] = last;
+  b.count[c]--;
+  b.remaining--;
+}
+
+/*
+ * Nearest-neighbour tour from opt.start. Once the unvisited waypoints fill
+ * an eighth of the cells they get a grid of their own, so the rings never
+ * cross large emptied areas; the rebuilds halve in size and add up to O(n).
+ */
+static void tspConstruct(const TspShared &sh, uint32_t seed, bool randomize,
+                         std::vector<int32_t> &path)
+{
+  std::mt19937 rng(seed);
+  std::vector<int32_t> ids(sh.n);
+  TspBuild b;
+  int32_t c;
+  int32_t t;
+  int32_t step;
+  for (step = 0; step < sh.n; step++) {
+    ids[step] = step;
+  }
+  tspBuildReset(sh, ids, b);
+  path.resize(sh.n);
+  path[0] = sh.opt.start;
+  tspTake(b, path[0]);
+  for (step = 1; step < sh.n; step++) {
+    if (b.remaining >= 64 && 8 * (std::size_t)b.remaining < b.count.size()) {
+      ids.clear();
+      for (c = 0; c < (int32_t)b.count.size(); c++) {
+        for (t = 0; t < b.count[c]; t++) {
+          ids.push_back(b.grid.items[b.grid.cellStart[c] + t]);
+        }
+      }
+      tspBuildReset(sh, ids, b);
+    }
+    path[step] = tspNearestFree(sh, b, path[step - 1],
+                                randomize && (rng() & 7) == 0);
+    tspTake(b, path[step]);
+  }
+}
+
+static double tspLength(const TspShared &sh, const std::vector<int32_t> &p)
+{
+  double len = 0.0;
+  std::size_t i;
+  for (i = 1; i < p.size(); i++) {
+    len += tspDist(sh, p[i - 1], p[i]);
+  }
+  return len;
+}
+
+/*  The edge dummy - start keeps the start first */
+static bool tspFixed(const TspShared &sh, int32_t a, int32_t b)
+{
+  return (a == sh.n && b == sh.opt.start) || (b == sh.n && a == sh.opt.start);
+}
+
+static int32_t tspSucc(const TspState &st, int32_t a)
+{
+  const int32_t p = st.pos[a] + 1;
+  return st.tour[p == st.size ? 0 : p];
+}
+
+static int32_t tspPred(const TspState &st, int32_t a)
+{
+  const int32_t p = st.pos[a];
+  return st.tour[p == 0 ? st.size - 1 : p - 1];
+}
+
+static void tspPush(const TspShared &sh, TspState &st, int32_t a)
+{
+  if (a < sh.n && !st.queued[a]) {
+    st.queued[a] = 1;
+    st.queue.push_back(a);
+  }
+}
+
+/*  Reverse from .. to (successor order), or the rest if that is shorter */
+static void tspReverse(TspState &st, int32_t from, int32_t to)
+{
+  const int32_t n = st.size;
+  int32_t i = st.pos[from];
+  int32_t j = st.pos[to];
+  int32_t len = (j - i + n) % n + 1;
+  int32_t k;
+  int32_t a;
+  int32_t b;
+  if (2 * len > n) {
+    k = i;
+    i = j + 1 == n ? 0 : j + 1;
+    j = k == 0 ? n - 1 : k - 1;
+    len = n - len;
+  }
+  for (k = 0; k < len / 2; k++) {
+    a = st.tour[i];
+    b = st.tour[j];
+    st.tour[i] = b;
+    st.pos[b] = i;
+    st.tour[j] = a;
+    st.pos[a] = j;
+    i = i + 1 == n ? 0 : i + 1;
+    j = j == 0 ? n - 1 : j - 1;
+  }
+}
+
+/*
+ * Replace (a, b) and (c, d) by (a, c) and (b, d), b and d on the same side
+ * of a and c, for c among a's candidates closer than b
+ */
+static bool tspTwoOpt(const TspShared &sh, TspState &st, int32_t a)
+{
+  const int32_t *cand = &sh.nbr[(std::size_t)a * sh.k];
+  int32_t dir;
+  int32_t b;
+  int32_t c;
+  int32_t d;
+  int32_t m;
+  double dab;
+  double g1;
+  for (dir = 0; dir < 2; dir++) {
+    b = dir == 0 ? tspSucc(st, a) : tspPred(st, a);
+    if (tspFixed(sh, a, b)) {
+      continue;
+    }
+    dab = tspDist(sh, a, b);
+    for (m = 0; m < sh.k && cand[m] >= 0; m++) {
+      c = cand[m];
+      g1 = dab - tspDist(sh, a, c);
+      if (g1 <= sh.eps) {
+        break;
+      }
+      d = dir == 0 ? tspSucc(st, c) : tspPred(st, c);
+      if (c == b || d == a || tspFixed(sh, c, d)) {
+        continue;
+      }
+      if (g1 + tspDist(sh, c, d) - tspDist(sh, b, d) > sh.eps) {
+        if (dir == 0) {
+          tspReverse(st, b, c);
+        } else {
+          tspReverse(st, a, d);
+        }
+        tspPush(sh, st, a);
+        tspPush(sh, st, b);
+        tspPush(sh, st, c);
+        tspPush(sh, st, d);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/*
+ * Move the len waypoints from s1 on between u and w = succ(u), shifting
+ * whichever of the two stretches in between is shorter
+ */
+static void tspMoveSegment(TspState &st, int32_t s1, int32_t len, int32_t u,
+                           int32_t w, bool reversed)
+{
+  const int32_t n = st.size;
+  const int32_t i = st.pos[s1];
+  int32_t seg[3];
+  int32_t k1;
+  int32_t k2;
+  int32_t t;
+  int32_t p;
+  int32_t x;
+  for (t = 0; t < len; t++) {
+    seg[reversed ? len - 1 - t : t] = st.tour[(i + t) % n];
+  }
+  k1 = (st.pos[u] - (i + len) + 2 * n) % n + 1; /* succ(s2) .. u */
+  k2 = (i - 1 - st.pos[w] + 2 * n) % n + 1;     /* w .. pred(s1) */
+  if (k1 <= k2) {
+    for (t = 0; t < k1; t++) {
+      x = st.tour[(i + len + t) % n];
+      p = (i + t) % n;
+      st.tour[p] = x;
+      st.pos[x] = p;
+    }
+    p = i + k1;
+  } else {
+    for (t = 0; t < k2; t++) {
+      x = st.tour[(i - 1 - t + n) % n];
+      p = (i + len - 1 - t + n) % n;
+      st.tour[p] = x;
+      st.pos[x] = p;
+    }
+    p = i - k2 + n;
+  }
+  for (t = 0; t < len; t++) {
+    st.tour[(p + t) % n] = seg[t];
+    st.pos[seg[t]] = (p + t) % n;
+  }
+}
+
+/*
+ * Or-opt: lift the 1-3 waypoints s1 = a .. s2 out from between p and nx
+ * and put them, either way round, next to a candidate of s1 or s2
+ */
+static bool tspOrOpt(const TspShared &sh, TspState &st, int32_t a)
+{
+  const int32_t n = st.size;
+  int32_t len;
+  int32_t s2;
+  int32_t p;
+  int32_t nx;
+  int32_t e;
+  int32_t end;
+  int32_t side;
+  int32_t m;
+  int32_t c;
+  int32_t u;
+  int32_t w;
+  bool fwd;
+  bool bad;
+  const int32_t *cand;
+  double removeGain;
+  double add;
+  for (len = 1; len <= 3 && len + 3 <= n; len++) {
+    s2 = st.tour[(st.pos[a] + len - 1) % n];
+    bad = false;
+    for (m = 0; m < len; m++) {
+      bad = bad || st.tour[(st.pos[a] + m) % n] == sh.n;
+    }
+    p = tspPred(st, a);
+    nx = tspSucc(st, s2);
+    if (bad || tspFixed(sh, p, a) || tspFixed(sh, s2, nx)) {
+      continue;
+    }
+    removeGain = tspDist(sh, p, a) + tspDist(sh, s2, nx) - tspDist(sh, p, nx);
+    if (removeGain <= sh.eps) {
+      continue;
+    }
+    for (e = 0; e < 2; e++) {
+      end = e == 0 ? a : s2;
+      cand = &sh.nbr[(std::size_t)end * sh.k];
+      for (m = 0; m < sh.k && cand[m] >= 0; m++) {
+        c = cand[m];
+        if (tspDist(sh, end, c) >= removeGain) {
+          break;
+        }
+        if ((st.pos[c] - st.pos[a] + n) % n < len) {
+          continue;
+        }
+        for (side = 0; side < 2; side++) {
+          u = side == 0 ? c : tspPred(st, c);
+          w = side == 0 ? tspSucc(st, c) : c;
+          if ((st.pos[u] - st.pos[a] + n) % n < len ||
+              (st.pos[w] - st.pos[a] + n) % n < len || tspFixed(sh, u, w)) {
+            continue;
+          }
+          /*  end sits next to c: forward when s1 follows u or s2 leads w */
+          fwd = (end == a) == (side == 0);
+          add = (fwd ? tspDist(sh, u, a) + tspDist(sh, s2, w)
+                     : tspDist(sh, u, s2) + tspDist(sh, a, w)) -
+                tspDist(sh, u, w);
+          if (removeGain - add > sh.eps) {
+            tspMoveSegment(st, a, len, u, w, !fwd);
+            tspPush(sh, st, p);
+            tspPush(sh, st, nx);
+            tspPush(sh, st, a);
+            tspPush(sh, st, s2);
+            tspPush(sh, st, u);
+            tspPush(sh, st, w);
+            return true;
+          }
+        }
+      }
+    }
+  }
+  return false;
+}
+
+static void tspImprove(const TspShared &sh, const std::vector<int32_t> &path,
+                       TspResult &res)
+{
+  TspState st;
+  int32_t a;
+  int32_t i;
+  int32_t p;
+  st.size = sh.n + 1;
+  st.tour.resize(st.size);
+  st.pos.resize(st.size);
+  st.queued.assign(sh.n, 0);
+  st.tour[0] = sh.n;
+  for (i = 0; i < sh.n; i++) {
+    st.tour[i + 1] = path[i];
+  }
+  for (i = 0; i < st.size; i++) {
+    st.pos[st.tour[i]] = i;
+  }
+  for (i = 0; i < sh.n && sh.n >= 3; i++) {
+    tspPush(sh, st, path[i]);
+  }
+
+  while (!st.queue.empty()) {
+    if ((res.iterations & 127) == 0 && sh.hasDeadline &&
+        std::chrono::steady_clock::now() > sh.deadline) {
+      res.timedOut = true;
+      break;
+    }
+    a = st.queue.front();
+    st.queue.pop_front();
+    st.queued[a] = 0;
+    res.iterations++;
+    if (tspTwoOpt(sh, st, a)) {
+      res.twoOptMoves++;
+    } else if (tspOrOpt(sh, st, a)) {
+      res.orOptMoves++;
+    }
+  }
+
+  /*  Unroll the cycle from the start, away from the dummy */
+  res.order.resize(sh.n);
+  p = st.pos[sh.n];
+  if (tspSucc(st, sh.n) == sh.opt.start) {
+    for (i = 0; i < sh.n; i++) {
+      p = p + 1 == st.size ? 0 : p + 1;
+      res.order[i] = st.tour[p];
+    }
+  } else {
+    for (i = 0; i < sh.n; i++) {
+      p = p == 0 ? st.size - 1 : p - 1;
+      res.order[i] = st.tour[p];
+    }
+  }
+  res.length = tspLength(sh, res.order);
+}
+
+static void tspRunWorker(TspPool *pool)
+{
+  const TspShared &sh = *pool->shared;
+  std::vector<int32_t> path;
+  int32_t s;
+  while (!pool->failed.load() &&
+         (s = pool->next.fetch_add(1)) < (int32_t)pool->results.size()) {
+    TspResult &res = pool->results[s];
+    if (s > 0 && sh.hasDeadline &&
+        std::chrono::steady_clock::now() > sh.deadline) {
+      continue; /* start 0 always runs */
+    }
+    try {
+      tspConstruct(sh, sh.opt.seed + (uint32_t)s, s > 0, path);
+      res.greedyLength = tspLength(sh, path);
+      tspImprove(sh, path, res);
+      res.ran = true;
+    } catch (const std::bad_alloc &) {
+      std::lock_guard<std::mutex> guard(pool->errLock);
+      pool->err = "out of memory";
+      pool->failed.store(true);
+    }
+  }
+}
+
+bool tspTour(const double *pts, std::size_t n, int dims,
+             const TspOptions &opt, std::vector<int32_t> &order,
+             TspStats &stats, const char **err)
+{
+  const std::chrono::steady_clock::time_point t0 =
+      std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  TspShared sh;
+  TspPool pool;
+  std::size_t nWorkers;
+  std::size_t t;
+  std::size_t i;
+  double lo;
+  double hi;
+  double diag2 = 0.0;
+  int d;
+  int nThreads = opt.nThreads;
+  stats = TspStats();
+  stats.bestStart = -1;
+  if (n < 1 || n > (std::size_t)std::numeric_limits<int32_t>::max() - 1) {
+    *err = "waypoint count out of range";
+    return false;
+  }
+  if (opt.start < 0 || (std::size_t)opt.start >= n) {
+    *err = "start must be a waypoint index";
+    return false;
+  }
+  for (i = 0; i < n * (std::size_t)dims; i++) {
+    if (!std::isfinite(pts[i])) {
+      *err = "waypoints must be finite";
+      return false;
+    }
+  }
+  /*  A gain is a sum of four distances, each rounded to a few ulps of the
+   *  extent: smaller gains are noise and could make moves cycle forever */
+  for (d = 0; d < std::min(dims, 3); d++) {
+    lo = *std::min_element(pts + d * n, pts + (d + 1) * n);
+    hi = *std::max_element(pts + d * n, pts + (d + 1) * n);
+    diag2 += (hi - lo) * (hi - lo);
+  }
+  sh.pts = pts;
+  sh.n = (int32_t)n;
+  sh.dims = dims;
+  sh.opt = opt;
+  sh.eps = std::max(1e-9, 1e-12 * std::sqrt(diag2));
+  sh.k = (int32_t)std::min<std::size_t>(std::max(opt.neighbors, 1), n - 1);
+  sh.hasDeadline = opt.budgetUs < std::numeric_limits<double>::infinity();
+  if (sh.hasDeadline) {
+    sh.deadline = t0 + std::chrono::microseconds(
+                           (int64_t)std::max(opt.budgetUs, 0.0));
+  }
+  try {
+    order.resize(n);
+    for (i = 0; i < n; i++) {
+      order[i] = (int32_t)i;
+    }
+    tspGridBuild(sh, order, sh.grid);
+    tspCandidates(sh);
+    pool.results.resize(std::max(opt.starts, 1));
+  } catch (const std::bad_alloc &) {
+    *err = "out of memory";
+    return false;
+  }
+  pool.shared = &sh;
+
+  if (nThreads < 1) {
+    nThreads = (int)std::thread::hardware_concurrency();
+  }
+  nWorkers = nThreads < 1 ? 1 : (std::size_t)nThreads;
+  nWorkers = std::min(nWorkers, pool.results.size());
+
+  /*  Worker 0 runs on the calling thread; if threads cannot be created it
+   *  simply takes more of the starts */
+  for (t = 1; t < nWorkers; t++) {
+    try {
+      threads.push_back(std::thread(tspRunWorker, &pool));
+    } catch (...) {
+      break;
+    }
+  }
+  tspRunWorker(&pool);
+  for (t = 0; t < threads.size(); t++) {
+    threads[t].join();
+  }
+  if (pool.failed.load()) {
+    *err = pool.err;
+    return false;
+  }
+
+  for (i = 0; i < pool.results.size(); i++) {
+    const TspResult &res = pool.results[i];
+    if (!res.ran) {
+      continue;
+    }
+    stats.startsRun++;
+    stats.iterations += res.iterations;
+    stats.twoOptMoves += res.twoOptMoves;
+    stats.orOptMoves += res.orOptMoves;
+    stats.timedOut = stats.timedOut || res.timedOut;
+    if (stats.bestStart < 0 || res.length < stats.length) {
+      stats.bestStart = (int32_t)i;
+      stats.length = res.length;
+    }
+  }
+  stats.greedyLength = pool.results[0].greedyLength;
+  order.swap(pool.results[stats.bestStart].order);
+  return true;
+}
+
+/* End of tspTour.cpp */
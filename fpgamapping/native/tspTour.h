@@ -0,0 +1,67 @@
+/*
+ * tspTour.h
+ *
+ * Waypoint ordering for tspNearestNeighbor.m: an open tour that starts at
+ * a given waypoint and may end anywhere, as short as a wall-clock budget
+ * allows.
+ *
+ *   construction - nearest neighbour, with the waypoints bucketed in a
+ *                  uniform grid (about two per cell) so each step only
+ *                  searches rings of cells around the current waypoint
+ *                  and visited waypoints are swap-removed from their cell.
+ *   improvement  - 2-opt and Or-opt (segments of 1-3 waypoints, either
+ *                  orientation) restricted to each waypoint's nearest
+ *                  candidates, driven by a queue of waypoints whose
+ *                  don't-look bit is clear. A move re-queues only the end
+ *                  points of the edges it changed.
+ *
+ * The open tour is kept as a cycle through a dummy waypoint that is at
+ * distance 0 from every other one; the edge dummy - start is never
+ * removed, so start stays first and the free end is whatever follows the
+ * dummy the other way. Reversals on the cycle take the shorter side.
+ *
+ * Several starts run in parallel on a small thread pool: start 0 is the
+ * plain nearest-neighbour tour, the others take the second nearest
+ * waypoint now and then (seeded), and the shortest improved tour wins.
+ * Distances are 3-D when the waypoints have a Z column.
+ *
+ */
+
+#pragma once
+
+/* Include files */
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Type Definitions */
+struct TspOptions {
+  int32_t start;     /* 0-based first waypoint */
+  int32_t neighbors; /* candidates per waypoint */
+  int32_t starts;    /* initial tours improved */
+  int nThreads;      /* < 1 for all cores */
+  double budgetUs;   /* wall clock in microseconds, Inf = none */
+  uint32_t seed;
+};
+
+struct TspStats {
+  double greedyLength; /* nearest-neighbour tour (start 0) */
+  double length;       /* best improved tour */
+  int64_t iterations;  /* waypoints taken off the queue, all starts */
+  int64_t twoOptMoves; /* all starts */
+  int64_t orOptMoves;  /* all starts */
+  int32_t bestStart;
+  int32_t startsRun;
+  bool timedOut; /* some start stopped on the budget */
+};
+
+/* Function Declarations */
+/*
+ * pts is n x dims, column-major (dims 2 or 3); order receives the n
+ * 0-based waypoints in visiting order.
+ */
+bool tspTour(const double *pts, std::size_t n, int dims,
+             const TspOptions &opt, std::vector<int32_t> &order,
+             TspStats &stats, const char **err);
+
+/* End of tspTour.h */
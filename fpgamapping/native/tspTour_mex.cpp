@@ -0,0 +1,120 @@
+/*
+ * tspTour_mex.cpp
+ *
+ * MEX gateway: [order, info] = tspTour_mex(points, startIdx, options)
+ *
+ * points is N x 2 or N x 3 (further columns are ignored; with a Z column
+ * distances are 3-D), startIdx the 1-based first waypoint and options
+ * [neighbors, starts, nThreads, budgetUs, seed]. order is the N x 1
+ * 1-based visiting order (tspTour.cpp). info has greedyLength, length,
+ * iterations, twoOptMoves, orOptMoves, bestStart (1-based), startsRun
+ * and timedOut. startIdx and the options other than budgetUs (>= 0, Inf
+ * for none) must be whole numbers in range; nThreads 0 uses all cores.
+ *
+ */
+
+/* Include files */
+#include "mexUtil.h"
+#include "tspTour.h"
+#include <algorithm>
+#include <cmath>
+
+/* Function Declarations */
+static double tspIntegerArg(double v, double lo, double hi, const char *name,
+                            const char *errId);
+
+/* Function Definitions */
+/*
+ * v as a whole number in [lo, hi], raising errId otherwise (NaN included)
+ */
+static double tspIntegerArg(double v, double lo, double hi, const char *name,
+                            const char *errId)
+{
+  if (!(v >= lo && v <= hi) || v != std::floor(v)) {
+    mexErrMsgIdAndTxt(errId, "%s must be a whole number in [%.0f, %.0f]",
+                      name, lo, hi);
+  }
+  return v;
+}
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  static const char *errId = "tspNearestNeighbor:InvalidInput";
+  static const char *fields[] = {"greedyLength", "length",     "iterations",
+                                 "twoOptMoves",  "orOptMoves", "bestStart",
+                                 "startsRun",    "timedOut"};
+  std::vector<int32_t> order;
+  TspOptions opt;
+  TspStats stats;
+  const double *pts;
+  const double *o;
+  const char *err = "";
+  double *d;
+  std::size_t n;
+  std::size_t k;
+  int dims;
+  if (nrhs != 3) {
+    mexErrMsgIdAndTxt(errId, "Usage: [order, info] = tspTour_mex(points, "
+                             "startIdx, options)");
+  }
+  if (nlhs > 2) {
+    mexErrMsgIdAndTxt(errId, "Too many output arguments");
+  }
+  pts = mexDoubleArray(prhs[0], "points", errId);
+  n = mxGetM(prhs[0]);
+  dims = mxGetN(prhs[0]) >= 3 ? 3 : (int)mxGetN(prhs[0]);
+  if (mxGetNumberOfDimensions(prhs[0]) != 2 || dims < 2 || n < 1) {
+    mexErrMsgIdAndTxt(errId, "points must be N x 2 or N x 3");
+  }
+  o = mexDoubleArray(prhs[2], "options", errId);
+  if (mxGetNumberOfElements(prhs[2]) != 5) {
+    mexErrMsgIdAndTxt(errId, "options must be [neighbors, starts, nThreads, "
+                             "budgetUs, seed]");
+  }
+  if (mxGetNumberOfElements(prhs[1]) != 1) {
+    mexErrMsgIdAndTxt(errId, "startIdx must be a scalar");
+  }
+  opt.start = (int32_t)tspIntegerArg(
+                  mexDoubleArray(prhs[1], "startIdx", errId)[0], 1.0,
+                  (double)std::min<std::size_t>(n, INT32_MAX), "startIdx",
+                  errId) -
+              1;
+  opt.neighbors =
+      (int32_t)tspIntegerArg(o[0], 1.0, INT32_MAX, "neighbors", errId);
+  opt.starts = (int32_t)tspIntegerArg(o[1], 1.0, 4096.0, "starts", errId);
+  opt.nThreads = (int)tspIntegerArg(o[2], 0.0, 1024.0, "nThreads", errId);
+  if (!(o[3] >= 0.0)) {
+    mexErrMsgIdAndTxt(errId, "budgetUs must be non-negative or Inf");
+  }
+  opt.budgetUs = o[3];
+  opt.seed = (uint32_t)tspIntegerArg(o[4], 0.0, UINT32_MAX, "seed", errId);
+
+  if (!tspTour(pts, n, dims, opt, order, stats, &err)) {
+    mexErrMsgIdAndTxt(errId, "%s", err);
+  }
+  plhs[0] = mxCreateDoubleMatrix(n, 1, mxREAL);
+  d = mxGetDoubles(plhs[0]);
+  for (k = 0; k < n; k++) {
+    d[k] = (double)order[k] + 1.0;
+  }
+  if (nlhs < 2) {
+    return;
+  }
+  plhs[1] = mxCreateStructMatrix(1, 1, 8, fields);
+  mxSetField(plhs[1], 0, "greedyLength",
+             mxCreateDoubleScalar(stats.greedyLength));
+  mxSetField(plhs[1], 0, "length", mxCreateDoubleScalar(stats.length));
+  mxSetField(plhs[1], 0, "iterations",
+             mxCreateDoubleScalar((double)stats.iterations));
+  mxSetField(plhs[1], 0, "twoOptMoves",
+             mxCreateDoubleScalar((double)stats.twoOptMoves));
+  mxSetField(plhs[1], 0, "orOptMoves",
+             mxCreateDoubleScalar((double)stats.orOptMoves));
+  mxSetField(plhs[1], 0, "bestStart",
+             mxCreateDoubleScalar((double)stats.bestStart + 1.0));
+  mxSetField(plhs[1], 0, "startsRun",
+             mxCreateDoubleScalar((double)stats.startsRun));
+  mxSetField(plhs[1], 0, "timedOut", mxCreateLogicalScalar(stats.timedOut));
+}
+
+/* End of tspTour_mex.cpp */
@@ -0,0 +1,91 @@
+%% obstacleZones.m
+% Keep custom no-fly zones in a tiled layer that later edits update in
+% place (see obstacleZonesUpdate), instead of rebuilding obstacleGrid
+%
+% Project: Drone Pathfinding with Coverage Path Planning
+% Module: A* Pathfinding - Module 3
+% Date: 2025-12-13
+% Compatibility: MATLAB 2023b+
+
+function zones = obstacleZones(demData, customObstacles, params, baseGrid)
+    %OBSTACLEZONES Rasterize no-fly zones into an incremental layer
+    %
+    % Syntax:
+    %   zones = obstacleZones(demData, customObstacles, params)
+    %   zones = obstacleZones(demData, customObstacles, params, baseGrid)
+    %
+    % Inputs:
+    %   demData         - DEM structure (.Z, .resolution, .xMin, .yMin)
+    %   customObstacles - struct with circles / rectangles / polygons, as
+    %                     for obstacleGrid ([] for none yet)
+    %   params          - struct, optionally with zoneTileSize (posts,
+    %                     default 64)
+    %   baseGrid        - (optional) obstacle grid without the zones, e.g.
+    %                     obstacleGrid(demData, params); default all free
+    %
+    % Outputs:
+    %   zones - struct for obstacleZonesUpdate and obstacleZonesFree:
+    %           .handle - uint64 layer handle
+    %           .ids    - [Kx1] zone ids, circles, rectangles, polygons
+    %                     (circle and rectangle rows with a NaN get none)
+    %           .base   - logical baseGrid
+    %           .grid   - logical obstacle grid, base | zones
+    %
+    % Zones live in an R-tree over their bounding boxes. The layer is cut
+    % into square tiles of zoneTileSize posts; adding or removing a zone
+    % redraws only the tiles under its box, from the zones the tree finds
+    % there, so an update costs the area it touches rather than zones x
+    % grid size.
+    %
+    % Example:
+    %   [obsGrid, ~] = obstacleGrid(demData, params);
+    %   zones = obstacleZones(demData, customObstacles, params, obsGrid);
+    %   obstacles.grid = zones.grid;
+    %   planner = astarIncremental(goalPoint, demData, obstacles, params);
+    %   % ... a temporary flight restriction appears
+    %   tfr.circles = [500500, 5400500, 250];
+    %   [zones, changed] = obstacleZonesUpdate(zones, tfr);
+    %   [path, stats] = astarIncrementalPlan(planner, startPoint, changed);
+    %   obstacleZonesFree(zones);
+
+    persistent useMex
+    if isempty(useMex)
+        useMex = (exist('obstacleZones_mex', 'file') == 3);
+    end
+
+    if nargin < 3
+        error('obstacleZones:MissingInput', ...
+              'Requires demData, customObstacles and params');
+    end
+    if ~useMex
+        error('obstacleZones:NoNative', ...
+              'The zone layer needs obstacleZones_mex; run build_native');
+    end
+
+    [rows, cols] = size(demData.Z);
+    if nargin < 4 || isempty(baseGrid)
+        baseGrid = false(rows, cols);
+    end
+    if ~isequal(size(baseGrid), [rows, cols])
+        error('obstacleZones:SizeMismatch', ...
+              'baseGrid must be the size of demData.Z');
+    end
+
+    tileSize = 64;
+    if isfield(params, 'zoneTileSize')
+        tileSize = params.zoneTileSize;
+    end
+
+    handle = obstacleZones_mex('create', demData, tileSize);
+    try
+        ids = obstacleZones_mex('add', handle, customObstacles);
+        zoneGrid = obstacleZones_mex('update', handle);
+    catch err
+        obstacleZones_mex('free', handle);
+        rethrow(err);
+    end
+
+    base = logical(baseGrid);
+    zones = struct('handle', handle, 'ids', ids, 'base', base, ...
+                   'grid', base | zoneGrid);
+end
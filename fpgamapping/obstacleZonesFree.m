@@ -0,0 +1,19 @@
+%% obstacleZonesFree.m
+% Release a zone layer made by obstacleZones
+%
+% Project: Drone Pathfinding with Coverage Path Planning
+% Module: A* Pathfinding - Module 3
+% Date: 2025-12-13
+% Compatibility: MATLAB 2023b+
+
+function obstacleZonesFree(zones)
+    %OBSTACLEZONESFREE Release a zone layer (freeing twice is harmless)
+    %
+    % Syntax:
+    %   obstacleZonesFree(zones)
+
+    if isstruct(zones) && isfield(zones, 'handle') && ...
+       isa(zones.handle, 'uint64')
+        obstacleZones_mex('free', zones.handle);
+    end
+end
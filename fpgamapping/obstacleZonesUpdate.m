@@ -0,0 +1,54 @@
+%% obstacleZonesUpdate.m
+% Add and remove no-fly zones of an obstacleZones layer, redrawing only
+% the tiles they cover
+%
+% Project: Drone Pathfinding with Coverage Path Planning
+% Module: A* Pathfinding - Module 3
+% Date: 2025-12-13
+% Compatibility: MATLAB 2023b+
+
+function [zones, changedCells, newIds] = obstacleZonesUpdate(zones, added, removedIds)
+    %OBSTACLEZONESUPDATE Apply zone edits and report the cells that flipped
+    %
+    % Syntax:
+    %   [zones, changedCells, newIds] = obstacleZonesUpdate(zones, added)
+    %   [zones, changedCells, newIds] = obstacleZonesUpdate(zones, added, removedIds)
+    %
+    % Inputs:
+    %   zones      - struct from obstacleZones
+    %   added      - struct with circles / rectangles / polygons to add
+    %                ([] for none)
+    %   removedIds - ids from zones.ids (or an earlier newIds) to remove
+    %
+    % Outputs:
+    %   zones        - zones with .ids and .grid updated
+    %   changedCells - [Kx3] [row, col, blocked] cells of zones.grid that
+    %                  changed, the changedCells of astarIncrementalPlan
+    %   newIds       - [Mx1] ids of the added zones
+    %
+    % Posts blocked in zones.base never change, whatever the zones do.
+    % An id in removedIds that is not in the layer raises
+    % obstacleZones:UnknownZone before any zone is removed.
+
+    if nargin < 2
+        error('obstacleZonesUpdate:MissingInput', 'Requires zones and added');
+    end
+    if nargin < 3
+        removedIds = [];
+    end
+
+    if ~isempty(removedIds)
+        obstacleZones_mex('remove', zones.handle, double(removedIds(:)));
+        zones.ids = zones.ids(~ismember(zones.ids, removedIds));
+    end
+    newIds = obstacleZones_mex('add', zones.handle, added);
+    zones.ids = [zones.ids; newIds];
+
+    [zoneGrid, changedCells] = obstacleZones_mex('update', zones.handle);
+    if ~isempty(changedCells)
+        free = ~zones.base(sub2ind(size(zones.base), ...
+                                   changedCells(:, 1), changedCells(:, 2)));
+        changedCells = changedCells(free, :);
+    end
+    zones.grid = zones.base | zoneGrid;
+end
@@ -52,22 +52,44 @@ function params = parameters()
     params.demType = 'hills';                % Synthetic terrain type: 'flat', 'slope', 'hills', 'random'
     params.demResolution = 10;               % DEM grid resolution (meters)
     params.demFile = 'synthetic_dem_hills.mat'; % Path to DEM file (auto-generated if missing)
+                                             % .mat, .asc or memory-mapped .demt tiles
     params.generateDEM = true;               % Auto-generate DEM if file not found
+    params.demLayout = 'column';             % Resident DEM layout: 'column' or 'tiled'
+                                             % ('tiled' = cache-blocked, for large DEMs)
     params.minAGL = 120;                     % Minimum altitude above ground level (meters)
                                              % Drone maintains this AGL over terrain
     
     %% Path Smoothing Configuration (Module 2 - Optional)
     params.smoothPath = true;                % Enable path smoothing
-    params.smoothMethod = 'spline';          % 'linear', 'spline', 'bezier'
-    params.smoothDensity = 15;               % Interpolation points per segment
+    params.smoothMethod = 'spline';          % 'linear', 'spline', 'dubins' (turn-radius bounded, opt-in)
+    params.smoothDensity = 15;               % Interpolation points per segment ('linear', 'spline')
+    params.smoothSpacing = 5;                % 'dubins': max distance between output points (meters)
+    params.minTurnRadius = 20;               % 'dubins': turn radius for corners and row ends (meters)
     
     %% A* Pathfinding Configuration (Module 3)
     params.useAStar = true;                  % Enable A* pathfinding
     params.maxSlope = 30;                    % Max terrain slope (degrees)
     params.maxClimbAngle = 20;               % Max climb/descent angle (degrees)
+    params.altitudeSampleStep = 0;           % altitudeProfile: even terrain samples along legs (m, 0 = DEM resolution); cell edges are always sampled
     params.maxTurnAngle = 60;                % Max turn angle (degrees)
     params.obstacleBuffer = 30;              % Safety buffer around obstacles (meters)
-    params.astarHeuristic = 'euclidean';     % 'euclidean', 'manhattan', 'diagonal'
+    params.obstacleThreads = 0;              % obstacleGrid slope/buffer threads (0 = all cores)
+    params.zoneTileSize = 64;                % obstacleZones redraw tile edge (DEM posts)
+    params.astarHeuristic = 'euclidean';     % 'euclidean', 'manhattan', 'diagonal', 'alt' (landmarks)
+    params.astarMaxExpansions = 100000;      % Node budget before returning best partial path
+    params.astarMode = 'astar';              % 'astar', 'jps' (occupancy only), 'hpa' (hierarchical), 'ara' (anytime)
+    params.astarTimeBudget = Inf;            % 'ara': wall-clock budget per query (microseconds)
+    params.araWeight = 3.0;                  % 'ara': first heuristic weight
+    params.araWeightStep = 0.5;              % 'ara': weight decrease after each improved path
+    params.hpaClusterSize = 16;              % HPA* cluster edge (DEM posts)
+    params.altLandmarks = 8;                 % ALT heuristic: landmark distance fields (cached beside demFile)
+    params.astarThreads = 0;                 % Stage 6 re-planning threads (0 = all cores)
+    params.tspNeighbors = 8;                 % Terrain cost matrix: nearest waypoints kept per waypoint
+    params.tspSearchRadius = Inf;            % Terrain cost matrix: distance field radius (m)
+    params.tspCandidates = 10;               % Waypoint ordering: 2-opt/Or-opt candidates per waypoint
+    params.tspStarts = 4;                    % Waypoint ordering: initial tours improved in parallel
+    params.tspThreads = 0;                   % Waypoint ordering threads (0 = all cores)
+    params.tspTimeBudget = 2e6;              % Waypoint ordering wall-clock budget (microseconds)
     
     %% Mission Planning Configuration (Module 4)
     params.missionName = 'Terrain Survey Mission 001';
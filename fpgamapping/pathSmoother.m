@@ -1,6 +1,6 @@
 %% pathSmoother.m
 % Smooth path between waypoints for realistic drone trajectory
-% Creates intermediate points with spline curves
+% Creates intermediate points with spline curves or turn-radius fillets
 %
 % Project: Drone Pathfinding with Coverage Path Planning
 % Module: Coverage Path Planning - Module 2
@@ -18,7 +18,24 @@ function [smoothedPath, smoothStats] = pathSmoother(waypoints, params, method)
     % Inputs:
     %   waypoints - [Nx2] or [Nx3] or [Nx4+] matrix of waypoints
     %   params    - struct with smoothing configuration
-    %   method    - 'linear' (default), 'spline' interpolation
+    %   method    - 'linear', 'spline' interpolation or 'dubins' turns
+    %               (default params.smoothMethod, else 'spline')
+    %
+    % 'dubins' rounds every corner with a fillet of params.minTurnRadius
+    % and turns boustrophedon row ends that are closer than two radii with
+    % the shortest Dubins path, then samples the curve params.smoothSpacing
+    % apart, closer on arcs so no two output chords turn by more than
+    % params.maxTurnAngle. Fillets that do not fit their legs shrink (see
+    % smoothStats.tightTurns). It runs in pathSmoother_mex when that has
+    % been built with build_native; the MATLAB fallback rounds every corner
+    % with a fillet and has no Dubins row-end turns. Both turn a waypoint
+    % where the path reverses with a bulb of arcs at the full radius and
+    % measure turns across runs of coincident waypoints. Columns after Z
+    % follow the source waypoint index.
+    %
+    % 'linear' and 'spline' add params.smoothDensity points per segment;
+    % the spline is fitted over overlapping windows of waypoints into a
+    % preallocated output, so memory stays linear in the path length.
     %
     % Outputs:
     %   smoothedPath - densified waypoint matrix with smooth interpolation
@@ -28,13 +45,19 @@ function [smoothedPath, smoothStats] = pathSmoother(waypoints, params, method)
     %   [smoothed, stats] = pathSmoother(waypoints, params);
     %   [smoothed, stats] = pathSmoother(waypoints, params, 'spline');
     
+    persistent useMex
+    if isempty(useMex)
+        useMex = (exist('pathSmoother_mex', 'file') == 3);
+    end
+    
     %% Input validation
     if nargin < 2
         error('pathSmoother:MissingInput', 'Requires waypoints and params');
     end
     
     if nargin < 3
-        method = 'spline';
+        method = ifthenelse(isfield(params, 'smoothMethod'), ...
+                            params.smoothMethod, 'spline');
     end
     
     if ~isnumeric(waypoints) || size(waypoints, 1) < 2
@@ -43,10 +66,10 @@ function [smoothedPath, smoothStats] = pathSmoother(waypoints, params, method)
     end
     
     method = lower(char(method));
-    validMethods = {'linear', 'spline'};
+    validMethods = {'linear', 'spline', 'dubins'};
     if ~ismember(method, validMethods)
         error('pathSmoother:InvalidMethod', ...
-              'method must be linear or spline (bezier in future)');
+              'method must be linear, spline or dubins');
     end
     
     %% Determine dimensionality
@@ -66,22 +89,50 @@ function [smoothedPath, smoothStats] = pathSmoother(waypoints, params, method)
         density = 10;  % Default: 10 points per segment
     end
     
-    fprintf('Interpolation density: %d points per segment\n', density);
+    spacing = ifthenelse(isfield(params, 'smoothSpacing'), params.smoothSpacing, 5);
+    radius = ifthenelse(isfield(params, 'minTurnRadius'), params.minTurnRadius, 20);
+    maxTurn = ifthenelse(isfield(params, 'maxTurnAngle'), params.maxTurnAngle, 60);
+    
+    if strcmp(method, 'dubins')
+        fprintf('Turn radius: %.1f m, spacing: %.1f m, max turn: %.1f°\n', ...
+                radius, spacing, maxTurn);
+    else
+        fprintf('Interpolation density: %d points per segment\n', density);
+    end
     
     %% Apply smoothing based on method
     tic;
     
+    turnInfo = struct('fillets', 0, 'tightTurns', 0, 'dubinsTurns', 0, ...
+                      'minRadius', Inf);
     switch method
         case 'linear'
             smoothedPath = smoothLinear(waypoints, density);
         case 'spline'
             smoothedPath = smoothSpline(waypoints, density);
+        case 'dubins'
+            if useMex
+                [smoothedPath, u, turnInfo] = pathSmoother_mex( ...
+                    double(waypoints(:, 1:min(3, waypointDim))), ...
+                    [spacing, radius, maxTurn]);
+                if waypointDim > 3
+                    smoothedPath = [smoothedPath, interp1( ...
+                        (0:size(waypoints, 1) - 1)', waypoints(:, 4:end), u)];
+                end
+            else
+                [smoothedPath, turnInfo] = smoothFillets(waypoints, spacing, ...
+                                                         radius, maxTurn);
+            end
     end
     
     elapsed = toc;
     
     %% Calculate statistics
     smoothStats = calculateSmoothStats(waypoints, smoothedPath, elapsed, method);
+    smoothStats.fillets = turnInfo.fillets;
+    smoothStats.tightTurns = turnInfo.tightTurns;
+    smoothStats.dubinsTurns = turnInfo.dubinsTurns;
+    smoothStats.minRadius = turnInfo.minRadius;
     
     %% Display results
     fprintf('Results:\n');
@@ -94,6 +145,14 @@ function [smoothedPath, smoothStats] = pathSmoother(waypoints, params, method)
             (smoothStats.smoothedLength - smoothStats.originalLength) / ...
             smoothStats.originalLength * 100);
     fprintf('  Max curvature: %.4f rad\n', smoothStats.maxCurvature);
+    if strcmp(method, 'dubins')
+        fprintf('  Fillets: %d, Dubins row-end turns: %d\n', ...
+                smoothStats.fillets, smoothStats.dubinsTurns);
+        if smoothStats.tightTurns > 0
+            fprintf('  ⚠ %d corners below the turn radius (min %.1f m)\n', ...
+                    smoothStats.tightTurns, smoothStats.minRadius);
+        end
+    end
     fprintf('  Compute time: %.4f seconds\n', elapsed);
     fprintf('====================\n\n');
     
@@ -104,88 +163,165 @@ function smoothedPath = smoothLinear(waypoints, density)
     %SMOOTHLINEAR Create intermediate points with linear interpolation
     
     n = size(waypoints, 1);
-    smoothedPath = [];
     
-    for i = 1:n - 1
-        % Current and next waypoint
-        p1 = waypoints(i, :);
-        p2 = waypoints(i+1, :);
-        
-        % Linear interpolation: t from 0 to 1
-        t = linspace(0, 1, density + 1)';
-        segment = zeros(density + 1, size(waypoints, 2));
-        
-        for d = 1:size(waypoints, 2)
-            segment(:, d) = p1(d) + t * (p2(d) - p1(d));
-        end
-        
-        % Append (skip last point to avoid duplication)
-        if i < n - 1
-            smoothedPath = [smoothedPath; segment(1:end-1, :)];
-        else
-            smoothedPath = [smoothedPath; segment];
-        end
-    end
+    % density points per segment plus the last waypoint, in one pass
+    t = (0:(n-1)*density)' / density;
+    seg = min(floor(t), n - 2) + 1;
+    f = t - (seg - 1);
+    smoothedPath = waypoints(seg, :) + f .* (waypoints(seg + 1, :) - waypoints(seg, :));
 end
 
 %% Method 2: Spline interpolation (cubic)
 function smoothedPath = smoothSpline(waypoints, density)
     %SMOOTHSPLINE Create intermediate points with cubic spline
+    %   Fitted over windows of waypoints with a margin either side (the
+    %   influence of a far waypoint on a cubic spline decays geometrically),
+    %   so no spline is larger than one window.
     
     n = size(waypoints, 1);
+    window = 256;
+    margin = 8;
     
     % Parameter for spline: 0 to n-1 (arc length approximation)
-    t_orig = (0:n-1)';
-    t_smooth = linspace(0, n-1, (n-1)*density + 1)';
-    
-    % Build smoothed path - interpolate each column
+    t_smooth = (0:(n-1)*density)' / density;
     smoothedPath = zeros(length(t_smooth), size(waypoints, 2));
     
-    for col = 1:size(waypoints, 2)
+    for w0 = 0:window:n - 2
+        w1 = min(w0 + window, n - 1);
+        lo = max(w0 - margin, 0);
+        hi = min(w1 + margin, n - 1);
+        rows = (w0*density + 1):(w1*density + (w1 == n - 1));
+        
         % Use MATLAB's spline function for cubic spline interpolation
-        smoothedPath(:, col) = spline(t_orig, waypoints(:, col), t_smooth);
+        smoothedPath(rows, :) = spline((lo:hi)', waypoints(lo+1:hi+1, :)', ...
+                                       t_smooth(rows))';
     end
 end
 
-%% Helper: Calculate smoothing statistics
-function smoothStats = calculateSmoothStats(waypoints, smoothedPath, elapsed, method)
-    %CALCULATESMOOOTHSTATS Compute smoothing quality metrics
+%% Method 3: Turn-radius fillets (fallback for pathSmoother_mex)
+function [smoothedPath, info] = smoothFillets(waypoints, spacing, radius, maxTurn)
+    %SMOOTHFILLETS Round every corner with a circular fillet
+    %   Fillets that overlap on a leg share it in proportion and get a
+    %   smaller radius. A waypoint where the path turns back on itself
+    %   gets a bulb of arcs instead, and a run of coincident waypoints
+    %   turns as its last one. Arcs are sampled at most 0.999*maxTurn of
+    %   heading apart; every output row is written into a preallocated
+    %   matrix.
     
-    % Original path length
-    originalLength = 0;
-    for i = 1:size(waypoints, 1) - 1
-        dx = waypoints(i+1, :) - waypoints(i, :);
-        originalLength = originalLength + norm(dx);
-    end
+    tiny = 1e-9;
+    dTurn = 0.999 * maxTurn * pi / 180;
+    reverse = pi - 1e-3;
+    
+    d = diff(waypoints(:, 1:2), 1, 1);
+    waypoints = waypoints([hypot(d(:, 1), d(:, 2)) > tiny; true], :);
+    n = size(waypoints, 1);
+    d = diff(waypoints(:, 1:2), 1, 1);
+    L = hypot(d(:, 1), d(:, 2));
+    h = atan2(d(:, 2), d(:, 1));
+    
+    % Signed turn and full-radius tangent length at every waypoint
+    turn = zeros(n, 1);
+    turn(2:n-1) = mod(h(2:end) - h(1:end-1) + pi, 2*pi) - pi;
+    turn(abs(turn) <= tiny) = 0;
+    T = radius * tan(min(abs(turn), reverse) / 2);
+    T(abs(turn) >= reverse) = 0;
     
-    % Smoothed path length
-    smoothedLength = 0;
-    for i = 1:size(smoothedPath, 1) - 1
-        dx = smoothedPath(i+1, :) - smoothedPath(i, :);
-        smoothedLength = smoothedLength + norm(dx);
+    % Each fillet takes at most its share of either leg
+    legSum = T(1:n-1) + T(2:n);
+    share = ones(n - 1, 1);
+    share(legSum > L) = L(legSum > L) ./ legSum(legSum > L);
+    T = T .* min([1; share], [share; 1]);
+    isFillet = T > 0;
+    R = inf(n, 1);
+    R(isFillet) = T(isFillet) ./ tan(abs(turn(isFillet)) / 2);
+    
+    % Points per straight and per arc, then one preallocated output
+    lenS = L - T(1:n-1) - T(2:n);
+    mS = max(1, ceil(lenS / spacing - 1e-9)) .* (lenS > tiny);
+    lenA = R .* abs(turn);
+    mA = zeros(n, 1);
+    mA(isFillet) = max(1, ceil(lenA(isFillet) ./ ...
+                       min(spacing, dTurn * R(isFillet)) - 1e-9));
+    mA(lenA <= tiny) = 0;
+    
+    % Reversals: arcs of 60, 300 and 60 degrees at the full radius
+    isBulb = abs(turn) >= reverse & radius > 0;
+    bulbStep = min(spacing, dTurn * radius);
+    bulbArc = [-1; 5; -1] * pi / 3;
+    mB = zeros(3, 1);
+    if any(isBulb)
+        mB = max(1, ceil(abs(bulbArc) * radius / bulbStep - 1e-9));
     end
     
-    % Calculate curvature at points (2D only)
-    maxCurvature = 0;
-    for i = 2:min(size(smoothedPath, 1) - 1, size(smoothedPath, 1) - 1)
-        p1 = smoothedPath(i-1, 1:2);
-        p2 = smoothedPath(i, 1:2);
-        p3 = smoothedPath(i+1, 1:2);
-        
-        v1 = p2 - p1;
-        v2 = p3 - p2;
-        
-        % Curvature angle
-        if norm(v1) > 1e-6 && norm(v2) > 1e-6
-            angle = atan2(v2(2), v2(1)) - atan2(v1(2), v1(1));
-            curvature = abs(angle);
-            if curvature > pi
-                curvature = 2*pi - curvature;
+    smoothedPath = zeros(1 + sum(mS) + sum(mA) + nnz(isBulb) * sum(mB), ...
+                         size(waypoints, 2));
+    smoothedPath(1, :) = waypoints(1, :);
+    k = 1;
+    for i = 1:n - 1
+        if mS(i) > 0
+            t = (1:mS(i))' / mS(i);
+            a = T(i) / L(i);
+            b = 1 - T(i+1) / L(i);
+            f = a + (b - a) * t;
+            smoothedPath(k+1:k+mS(i), :) = waypoints(i, :) + ...
+                f .* (waypoints(i+1, :) - waypoints(i, :));
+            k = k + mS(i);
+        end
+        v = i + 1;
+        if mA(v) > 0
+            % Arc from the tangent point on leg i to the one on leg v
+            c0 = waypoints(v, :) + (waypoints(i, :) - waypoints(v, :)) * T(v) / L(i);
+            c1 = waypoints(v, :) + (waypoints(v+1, :) - waypoints(v, :)) * T(v) / L(v);
+            t = (1:mA(v))' / mA(v);
+            kappa = sign(turn(v)) / R(v);
+            hs = h(i) + kappa * lenA(v) * t;
+            rows = k+1:k+mA(v);
+            smoothedPath(rows, :) = c0 + t .* (c1 - c0);
+            smoothedPath(rows, 1) = c0(1) + (sin(hs) - sin(h(i))) / kappa;
+            smoothedPath(rows, 2) = c0(2) - (cos(hs) - cos(h(i))) / kappa;
+            k = k + mA(v);
+        end
+        if isBulb(v)
+            % Turn away from the reversal, around and back onto the waypoint
+            side = sign(turn(v));
+            c0 = waypoints(v, 1:2);
+            h0 = h(i);
+            rows = k+1:k+sum(mB);
+            smoothedPath(rows, :) = repmat(waypoints(v, :), sum(mB), 1);
+            for j = 1:3
+                kappa = side * sign(bulbArc(j)) / radius;
+                hs = h0 + side * bulbArc(j) * (1:mB(j))' / mB(j);
+                smoothedPath(k+1:k+mB(j), 1) = c0(1) + (sin(hs) - sin(h0)) / kappa;
+                smoothedPath(k+1:k+mB(j), 2) = c0(2) - (cos(hs) - cos(h0)) / kappa;
+                c0 = smoothedPath(k+mB(j), 1:2);
+                h0 = hs(end);
+                k = k + mB(j);
             end
-            maxCurvature = max(maxCurvature, curvature);
         end
     end
     
+    info = struct('fillets', nnz(mA), ...
+                  'tightTurns', nnz(mA > 0 & R < radius * (1 - 1e-9)), ...
+                  'dubinsTurns', nnz(isBulb), ...
+                  'minRadius', min([Inf; R(mA > 0)]));
+end
+
+%% Helper: Calculate smoothing statistics
+function smoothStats = calculateSmoothStats(waypoints, smoothedPath, elapsed, method)
+    %CALCULATESMOOOTHSTATS Compute smoothing quality metrics
+    
+    % Original and smoothed path length
+    originalLength = sum(vecnorm(diff(waypoints, 1, 1), 2, 2));
+    smoothedLength = sum(vecnorm(diff(smoothedPath, 1, 1), 2, 2));
+    
+    % Curvature angle between consecutive segments (2D only)
+    v = diff(smoothedPath(:, 1:2), 1, 1);
+    segLen = vecnorm(v, 2, 2);
+    curvature = abs(diff(atan2(v(:, 2), v(:, 1))));
+    curvature(curvature > pi) = 2*pi - curvature(curvature > pi);
+    valid = segLen(1:end-1) > 1e-6 & segLen(2:end) > 1e-6;
+    maxCurvature = max([0; curvature(valid)]);
+    
     smoothStats = struct(...
         'method', method, ...
         'originalWaypoints', size(waypoints, 1), ...
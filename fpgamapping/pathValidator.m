@@ -8,22 +8,46 @@
 % Date: 2025-11-12
 % Compatibility: MATLAB 2023b+
 
-function [isValid, violations, stats] = pathValidator(path, demData, obstacles, params)
+function [isValid, violations, stats] = pathValidator(path, demData, obstacles, params, pyramid)
     %PATHVALIDATOR Validate path for safety and feasibility
     %
     % Syntax:
     %   [isValid, violations, stats] = pathValidator(path, demData, obstacles, params)
+    %   [isValid, violations, stats] = pathValidator(..., pyramid)
     %
     % Inputs:
     %   path      - [Nx2] or [Nx3] waypoint path
     %   demData   - struct from generateSyntheticDEM
     %   obstacles - struct with obstacle grid ([] if none)
     %   params    - struct with validation thresholds
+    %   pyramid   - demPyramid(demData) (optional, built here if omitted)
     %
     % Outputs:
     %   isValid    - true if path passes all checks
     %   violations - struct with detailed violation list
-    %   stats      - struct with path statistics
+    %   stats      - struct with path statistics (pathLength, minAGL,
+    %                maxSlope and maxTurnAngle in degrees, safetyScore)
+    %
+    % Checks 1-4 run as one pass over the path in pathValidator_mex when
+    % it has been built with build_native: the terrain under each point is
+    % interpolated once and every constraint and statistic is evaluated
+    % together, with violations collected in preallocated buffers. Without
+    % it the same checks run vectorized over the whole path. When points
+    % sit below minAGL the altitudes are replaced by altitudeProfile (the
+    % lowest profile that keeps minAGL along every leg within
+    % maxClimbAngle) and the checks run again, so the slope, turn and
+    % statistics results describe the adjusted path.
+    %
+    % Legs are checked whole rather than at their waypoints: a grid walk
+    % visits every obstacle cell a leg passes through, and the native
+    % pass finds the exact lowest clearance of each leg over the bilinear
+    % DEM cells it crosses. Sparse paths therefore need no densifying
+    % before validation.
+    
+    persistent useMex
+    if isempty(useMex)
+        useMex = (exist('pathValidator_mex', 'file') == 3);
+    end
     
     if nargin < 4
         error('pathValidator:MissingInput', 'Requires all 4 arguments');
@@ -38,6 +62,8 @@ function [isValid, violations, stats] = pathValidator(path, demData, obstacles,
         'altitudeTooLow', [], ...
         'slopeTooSteep', [], ...
         'turnsTooSharp', [], ...
+        'segmentCollisions', [], ...
+        'segmentsBelowAGL', [], ...
         'totalViolations', 0 ...
     );
     
@@ -47,103 +73,92 @@ function [isValid, violations, stats] = pathValidator(path, demData, obstacles,
     maxTurn = ifthenelse(isfield(params, 'maxTurnAngle'), ...
                          params.maxTurnAngle, 60);
     
+    %% Checks 1-4: one pass over the path
+    % Terrain is sampled once per point; obstacle, AGL, climb and turn
+    % tests and the statistics all come out of the same pass
+    report = checkPath(path, demData, obstacles, minAGL, maxSlope, maxTurn, useMex);
+    
     %% Check 1: Obstacle collisions
     fprintf('\nCheck 1: Obstacle collisions...\n');
-    collisionCount = 0;
-    collisionPoints = [];
-    
-    if ~isempty(obstacles) && isfield(obstacles, 'grid')
-        obsGrid = obstacles.grid;
-        resolution = obstacles.resolution;
-        xMin = obstacles.bounds(1);
-        yMin = obstacles.bounds(3);
-        
-        for i = 1:size(path, 1)
-            x = path(i, 1);
-            y = path(i, 2);
-            
-            % Convert to grid indices
-            xIdx = round((x - xMin) / resolution) + 1;
-            yIdx = round((y - yMin) / resolution) + 1;
-            
-            if xIdx >= 1 && xIdx <= size(obsGrid, 2) && ...
-               yIdx >= 1 && yIdx <= size(obsGrid, 1)
-                if obsGrid(yIdx, xIdx) > 0
-                    collisionCount = collisionCount + 1;
-                    collisionPoints = [collisionPoints; path(i, 1:2)];
-                end
-            end
-        end
-    end
+    collisionCount = numel(report.collisions);
     
     if collisionCount > 0
         fprintf('  ✗ Obstacle collisions: %d points\n', collisionCount);
-        violations.obstacleCollisions = collisionPoints;
+        violations.obstacleCollisions = path(report.collisions, 1:2);
         violations.totalViolations = violations.totalViolations + collisionCount;
     else
         fprintf('  ✓ No obstacle collisions\n');
     end
     
+    % Legs through blocked cells between their waypoints
+    segmentCollisions = report.segmentCollisions;
+    if ~isempty(segmentCollisions)
+        fprintf('  ✗ Legs crossing obstacle cells: %d\n', numel(segmentCollisions));
+        violations.segmentCollisions = segmentCollisions;
+        violations.totalViolations = violations.totalViolations + numel(segmentCollisions);
+    end
+    
   %% Check 2: Altitude safety (AGL) - FIXED
 fprintf('Check 2: Altitude safety (AGL)...\n');
-altitudeViolations = [];
 
 % IMPORTANT: A* returns path at terrain elevation
 % We need to LIFT it to terrain + minAGL
 if size(path, 2) >= 3
-    for i = 1:size(path, 1)
-        terrainZ = demInterpolate(demData, path(i, 1), path(i, 2));
-        requiredZ = terrainZ + minAGL;
-        
-        % Check if path Z is below required altitude
-        if path(i, 3) < requiredZ - 1  % 1m tolerance
-            % Path is too low - need to RAISE it
-            altitudeViolations = [altitudeViolations; i, path(i, 3), requiredZ];
-        end
-    end
+    altitudeViolations = report.altitudeTooLow;
     
     if ~isempty(altitudeViolations)
         fprintf('  ⚠ Altitude violations detected\n');
         fprintf('    Points below minAGL: %d\n', size(altitudeViolations, 1));
         fprintf('    Adjusting path altitude...\n');
         
-        % AUTOMATICALLY FIX the path: raise to terrain + minAGL
-        for i = 1:size(path, 1)
-            terrainZ = demInterpolate(demData, path(i, 1), path(i, 2));
-            path(i, 3) = terrainZ + minAGL;
-        end
+        % AUTOMATICALLY FIX the path: lowest terrain-following profile
+        % that also respects the climb limit, then re-check it
+        [path(:, 3), profileInfo] = altitudeProfile(path, demData, params);
+        report = checkPath(path, demData, obstacles, minAGL, maxSlope, ...
+                           maxTurn, useMex);
         
-        fprintf('    ✓ Path adjusted to %.0f m AGL\n', minAGL);
+        fprintf('    ✓ Path adjusted to >= %.0f m AGL, climb <= %.0f° (%d legs lifted)\n', ...
+                minAGL, maxSlope, profileInfo.legsLifted);
     else
         fprintf('  ✓ All points maintain minimum AGL\n');
     end
+    
+    % Terrain between waypoints: the native pass already minimised the
+    % clearance of every leg cell by cell; otherwise coarse pyramid levels
+    % clear most legs without touching the full-resolution DEM
+    if isfield(report, 'segmentsBelowAGL')
+        segmentViolations = report.segmentsBelowAGL;
+        lookupNote = sprintf('%d DEM cells examined', report.terrainCells);
+    else
+        if nargin < 5 || isempty(pyramid)
+            pyramid = demPyramid(demData);
+        end
+        segmentViolations = [];
+        fineQueries = 0;
+        for i = 1:size(path, 1) - 1
+            [legClear, n] = demSegmentClear(pyramid, demData, path(i, 1:3), ...
+                                            path(i+1, 1:3), minAGL - 1);
+            fineQueries = fineQueries + n;
+            if ~legClear
+                segmentViolations = [segmentViolations; i]; %#ok<AGROW>
+            end
+        end
+        lookupNote = sprintf('%d fine DEM lookups', fineQueries);
+    end
+    violations.segmentsBelowAGL = segmentViolations;
+    if ~isempty(segmentViolations)
+        fprintf('  ⚠ Legs dipping below minAGL between waypoints: %d\n', ...
+                numel(segmentViolations));
+    else
+        fprintf('  ✓ All legs clear terrain (%s)\n', lookupNote);
+    end
 else
     fprintf('  ⚠ Warning: Path missing Z coordinates\n');
 end
 
     %% Check 3: Slope constraint
     fprintf('Check 3: Slope constraint...\n');
-    slopeViolations = [];
-    
-    for i = 1:size(path, 1) - 1
-        p1 = path(i, :);
-        p2 = path(i+1, :);
-        
-        if size(path, 2) >= 3
-            dz = p2(3) - p1(3);
-        else
-            dz = 0;
-        end
-        
-        dx = norm(p2(1:2) - p1(1:2));
-        
-        if dx > 0
-            slope = atan(abs(dz) / dx) * 180 / pi;
-            if slope > maxSlope
-                slopeViolations = [slopeViolations; i, slope, maxSlope];
-            end
-        end
-    end
+    slopeViolations = report.slopeTooSteep;
     
     if ~isempty(slopeViolations)
         fprintf('  ✗ Slope violations: %d segments\n', size(slopeViolations, 1));
@@ -155,26 +170,7 @@ end
     
     %% Check 4: Turn angles
     fprintf('Check 4: Turn angle constraint...\n');
-    turnViolations = [];
-    
-    for i = 2:size(path, 1) - 1
-        v1 = path(i, 1:2) - path(i-1, 1:2);
-        v2 = path(i+1, 1:2) - path(i, 1:2);
-        
-        if norm(v1) > 0.1 && norm(v2) > 0.1
-            angle1 = atan2(v1(2), v1(1));
-            angle2 = atan2(v2(2), v2(1));
-            
-            turnAngle = abs(angle2 - angle1) * 180 / pi;
-            if turnAngle > 180
-                turnAngle = 360 - turnAngle;
-            end
-            
-            if turnAngle > maxTurn
-                turnViolations = [turnViolations; i, turnAngle, maxTurn];
-            end
-        end
-    end
+    turnViolations = report.turnsTooSharp;
     
     if ~isempty(turnViolations)
         fprintf('  ✗ Turn violations: %d points\n', size(turnViolations, 1));
@@ -187,28 +183,12 @@ end
     %% Calculate path statistics
     fprintf('\nCalculating statistics...\n');
     
-    pathLength = 0;
-    minAGLValue = inf;
-    maxSlope = 0;
-    maxTurnAngle = 0;
-    
-    for i = 1:size(path, 1) - 1
-        dx = path(i+1, :) - path(i, :);
-        pathLength = pathLength + norm(dx);
-        
-        if size(path, 2) >= 3
-            terrainZ = demInterpolate(demData, path(i, 1), path(i, 2));
-            agl = path(i, 3) - terrainZ;
-            minAGLValue = min(minAGLValue, agl);
-        end
-    end
-    
     stats = struct(...
-        'pathLength', pathLength, ...
+        'pathLength', report.pathLength, ...
         'numWaypoints', size(path, 1), ...
-        'minAGL', minAGLValue, ...
-        'maxSlope', maxSlope, ...
-        'maxTurnAngle', maxTurnAngle, ...
+        'minAGL', report.minAGL, ...
+        'maxSlope', report.maxSlope, ...
+        'maxTurnAngle', report.maxTurnAngle, ...
         'safetyScore', calculateSafetyScore(violations, size(path, 1)) ...
     );
     
@@ -220,6 +200,153 @@ end
     fprintf('===================\n\n');
 end
 
+%% Helper: Checks 1-4 and statistics, native or vectorized
+function report = checkPath(path, demData, obstacles, minAGL, maxSlope, ...
+                            maxTurn, useMex)
+    %CHECKPATH One pass of Checks 1-4 over the path
+    if useMex && isa(demData.Z, 'double') && min(size(demData.Z)) >= 2 && ...
+       size(path, 2) >= 2
+        [~, report] = pathValidator_mex(double(path), demData, ...
+                                        obstacles, [minAGL, maxSlope, maxTurn]);
+    else
+        [~, report] = validatePoints(path, demData, obstacles, ...
+                                     minAGL, maxSlope, maxTurn);
+    end
+end
+
+%% Helper: Checks 1-4 and statistics, vectorized
+function [terrainZ, report] = validatePoints(path, demData, obstacles, ...
+                                             minAGL, maxSlope, maxTurn)
+    %VALIDATEPOINTS MATLAB version of pathValidator_mex
+    
+    numPoints = size(path, 1);
+    terrainZ = demInterpolateBatch(demData, path(:, 1), path(:, 2));
+    
+    % Check 1: nearest obstacle cell of every point, then every cell each
+    % leg passes through
+    collisions = zeros(0, 1);
+    segmentCollisions = zeros(0, 1);
+    if ~isempty(obstacles) && isfield(obstacles, 'grid')
+        obsGrid = obstacles.grid;
+        xIdx = round((path(:, 1) - obstacles.bounds(1)) / obstacles.resolution) + 1;
+        yIdx = round((path(:, 2) - obstacles.bounds(3)) / obstacles.resolution) + 1;
+        inside = find(xIdx >= 1 & xIdx <= size(obsGrid, 2) & ...
+                      yIdx >= 1 & yIdx <= size(obsGrid, 1));
+        hit = obsGrid(sub2ind(size(obsGrid), yIdx(inside), xIdx(inside))) > 0;
+        collisions = inside(hit);
+        segmentCollisions = segmentCrossings(path, obstacles);
+    end
+    
+    % Check 2: points below minAGL (1 m tolerance); the caller replaces Z
+    % with altitudeProfile and checks again when there are any
+    altitudeTooLow = zeros(0, 3);
+    if size(path, 2) >= 3
+        low = find(path(:, 3) < terrainZ + minAGL - 1);
+        altitudeTooLow = [low, path(low, 3), terrainZ(low) + minAGL];
+    end
+    
+    % Check 3: climb angle of every segment
+    steps = diff(path, 1, 1);
+    run = sqrt(steps(:, 1).^2 + steps(:, 2).^2);
+    if size(path, 2) >= 3
+        rise = abs(steps(:, 3));
+    else
+        rise = zeros(size(run));
+    end
+    slope = atan(rise ./ run) * 180 / pi;
+    slope(~(run > 0)) = NaN;
+    steep = find(slope > maxSlope);
+    slopeTooSteep = [steep, slope(steep), repmat(maxSlope, numel(steep), 1)];
+    
+    % Check 4: turn at every interior point between legs over 0.1 m
+    heading = atan2(steps(:, 2), steps(:, 1));
+    turn = abs(diff(heading)) * 180 / pi;
+    turn(turn > 180) = 360 - turn(turn > 180);
+    turn(~(run(1:end-1) > 0.1 & run(2:end) > 0.1)) = NaN;
+    sharp = find(turn > maxTurn);
+    turnsTooSharp = [sharp + 1, turn(sharp), repmat(maxTurn, numel(sharp), 1)];
+    
+    % Statistics
+    minAGLValue = inf;
+    if size(path, 2) >= 3 && numPoints > 1
+        minAGLValue = min(path(1:end-1, 3) - terrainZ(1:end-1));
+    end
+    
+    report = struct(...
+        'collisions', collisions, ...
+        'altitudeTooLow', altitudeTooLow, ...
+        'slopeTooSteep', slopeTooSteep, ...
+        'turnsTooSharp', turnsTooSharp, ...
+        'pathLength', sum(sqrt(sum(steps.^2, 2))), ...
+        'minAGL', minAGLValue, ...
+        'maxSlope', max([0; slope(~isnan(slope))]), ...
+        'maxTurnAngle', max([0; turn(~isnan(turn))]), ...
+        'segmentCollisions', segmentCollisions ...
+    );
+end
+
+%% Helper: Legs through blocked obstacle cells
+function crossings = segmentCrossings(path, obstacles)
+    %SEGMENTCROSSINGS Supercover walk of every leg over the obstacle grid
+    % Visits each cell a leg touches (both side cells where it passes
+    % exactly through a corner); blocked cells other than the two end
+    % cells, which Check 1 already covers, flag the leg.
+    
+    obsGrid = obstacles.grid;
+    [rows, cols] = size(obsGrid);
+    u = (path(:, 1) - obstacles.bounds(1)) / obstacles.resolution;
+    v = (path(:, 2) - obstacles.bounds(3)) / obstacles.resolution;
+    crossings = zeros(0, 1);
+    
+    for k = 1:numel(u) - 1
+        a = [u(k), v(k)] + 0.5;
+        d = [u(k+1), v(k+1)] + 0.5 - a;
+        if ~all(isfinite([a, d]))
+            continue;
+        end
+        cell = floor(a);
+        last = floor(a + d);
+        ends = [cell; last];
+        if sum(abs(last - cell)) <= 1
+            continue;   % same or side-by-side cells: nothing in between
+        end
+        
+        step = sign(d);
+        tDelta = abs(1 ./ d);
+        tMax = inf(1, 2);
+        tMax(step > 0) = (cell(step > 0) + 1 - a(step > 0)) ./ d(step > 0);
+        tMax(step < 0) = (cell(step < 0) - a(step < 0)) ./ d(step < 0);
+        
+        blocked = false;
+        for s = 1:sum(abs(last - cell))
+            if tMax(1) < tMax(2)
+                cell(1) = cell(1) + step(1);
+                tMax(1) = tMax(1) + tDelta(1);
+            elseif tMax(2) < tMax(1)
+                cell(2) = cell(2) + step(2);
+                tMax(2) = tMax(2) + tDelta(2);
+            else
+                blocked = cellBlocked([cell(1) + step(1), cell(2)]) || ...
+                          cellBlocked([cell(1), cell(2) + step(2)]);
+                cell = cell + step;
+                tMax = tMax + tDelta;
+            end
+            blocked = blocked || cellBlocked(cell);
+            if blocked || isequal(cell, last)
+                break;
+            end
+        end
+        if blocked
+            crossings(end+1, 1) = k; %#ok<AGROW>
+        end
+    end
+    
+    function b = cellBlocked(c)
+        b = c(1) >= 0 && c(1) < cols && c(2) >= 0 && c(2) < rows && ...
+            ~ismember(c, ends, 'rows') && obsGrid(c(2) + 1, c(1) + 1) > 0;
+    end
+end
+
 %% Helper: Calculate safety score
 function score = calculateSafetyScore(violations, numWaypoints)
     %CALCULATESAFETYSCORE Calculate 0-100 safety score
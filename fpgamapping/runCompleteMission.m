@@ -59,11 +59,10 @@ function [missionData, missionReport] = runCompleteMission(params, missionType)
         if params.useDEM
             if params.generateDEM && ~exist(params.demFile, 'file')
                 demData = generateSyntheticDEM(surveyArea, params.demResolution, params.demType);
+                demData.layout = params.demLayout;
             else
-                demData = load(params.demFile);
-                if isstruct(demData) && isfield(demData, 'demData')
-                    demData = demData.demData;
-                end
+                % .demt files are cropped to the survey area on import
+                demData = demImport(params.demFile, 'auto', params.demLayout, surveyArea);
             end
         else
             % Flat terrain fallback
@@ -71,7 +70,11 @@ function [missionData, missionReport] = runCompleteMission(params, missionType)
         end
         
         missionData.demData = demData;
-        fprintf('  ✓ Terrain loaded (%.2f sec)\n\n', toc);
+        
+        % Min/max/mean pyramid for coarse-to-fine terrain checks
+        missionData.demPyramid = demPyramid(demData);
+        fprintf('  ✓ Terrain loaded, %d pyramid levels (%.2f sec)\n\n', ...
+                numel(missionData.demPyramid), toc);
         
         %% Stage 2: Generate Waypoint Grid
         fprintf('Stage 2/9: Generating waypoint grid...\n');
@@ -145,16 +148,42 @@ function [missionData, missionReport] = runCompleteMission(params, missionType)
         tic;
         
         if params.useAStar && obsInfo.obstacleCells > 0
-            % Apply A* between consecutive waypoints
+            % Re-plan every stretch of legs that crosses an obstacle cell
             obstacles = struct('grid', obsGrid, 'resolution', obsInfo.resolution, ...
                              'bounds', obsInfo.bounds);
-            finalPath = smoothedPath;
-            fprintf('  ✓ A* applied for obstacle avoidance (%.2f sec)\n\n', toc);
+            if isfield(params, 'astarHeuristic') && ...
+               strcmpi(params.astarHeuristic, 'alt') && ...
+               ~(isfield(params, 'astarMode') && ...
+                 ismember(lower(char(params.astarMode)), {'jps', 'hpa'})) && ...
+               exist('astarPathfinding_mex', 'file') == 3
+                % One set of landmark tables for every span of the mission;
+                % astarReplanSegments starts the spans on DEM posts to use it
+                obstacles.landmarks = astarLandmarks(demData, obstacles, params);
+            end
+            [finalPath, replanStats] = astarReplanSegments(smoothedPath, demData, ...
+                                                           obstacles, params);
+            missionData.replanStats = replanStats;
+            fprintf('  ✓ A* re-planned %d of %d blocked spans, %d from cache (%.2f sec)\n', ...
+                    replanStats.replanned, replanStats.spans, replanStats.cached, toc);
+            if replanStats.failed > 0
+                fprintf('  ⚠ %d spans have no detour and keep their straight legs\n', ...
+                        replanStats.failed);
+            end
+            fprintf('\n');
         else
             finalPath = smoothedPath;
             fprintf('  ○ A* skipped (no obstacles) (%.2f sec)\n\n', toc);
         end
         
+        % Terrain-following altitudes: lowest profile that keeps minAGL
+        % along every leg without exceeding the climb limit
+        if params.useDEM && size(finalPath, 2) >= 3
+            [finalPath(:, 3), profileInfo] = altitudeProfile(finalPath, demData, params);
+            missionData.altitudeProfile = profileInfo;
+            fprintf('  ✓ Altitude profile: %d terrain samples, %d legs lifted\n\n', ...
+                    profileInfo.samples, profileInfo.legsLifted);
+        end
+        
         missionData.finalPath = finalPath;
         
         %% Stage 7: Path Validation
@@ -163,7 +192,8 @@ function [missionData, missionReport] = runCompleteMission(params, missionType)
         
         obstacles = struct('grid', obsGrid, 'resolution', obsInfo.resolution, ...
                          'bounds', obsInfo.bounds);
-        [isValid, violations, valStats] = pathValidator(finalPath, demData, obstacles, params);
+        [isValid, violations, valStats] = pathValidator(finalPath, demData, obstacles, params, ...
+                                                        missionData.demPyramid);
         
         missionData.validation = struct('isValid', isValid, 'violations', violations, 'stats', valStats);
         
@@ -6,10 +6,12 @@ function run_hdl_workflow()
     % Load DEM to define test variables
     load('synthetic_dem_hills.mat', 'demData');
 
-    % Define fixed-point test input argument types
-    Z_grid = fi(zeros(101,101), 1, 16, 8);
-    x_norm = fi(0, 0, 16, 8);
-    y_norm = fi(0, 0, 16, 8);
+    % Define fixed-point test input argument types (sized from the DEM)
+    [rows, cols] = size(demData.Z);
+    idxBits = max(8, ceil(log2(max(rows, cols))));
+    Z_grid = fi(zeros(rows, cols), 1, 16, 8);
+    x_norm = fi(0, 0, idxBits + 8, 8);
+    y_norm = fi(0, 0, idxBits + 8, 8);
 
     % Run test bench first
     test_demInterpolate_hdl();
@@ -0,0 +1,203 @@
+%% test_astar_parity.m
+% Native planners against plain A* on random start / goal pairs,
+% including starts and goals on obstacle cells and between DEM posts
+
+clear all; close all; clc;
+
+fprintf('\n========================================\n');
+fprintf('A* PARITY TEST\n');
+fprintf('========================================\n\n');
+
+testsPassed = 0;
+totalTests = 5;
+numPairs = 200;
+
+%% Test 1: Setup
+fprintf('--- Test 1: DEM, Walls and Landmarks ---\n');
+try
+    if exist('astarPathfinding_mex', 'file') ~= 3
+        error('astarParity:NoNative', 'run build_native first');
+    end
+    params = parameters();
+    params.maxSlope = 30;
+    surveyArea = defineSurveyArea(params);
+    demData = generateSyntheticDEM(surveyArea, 10, 'hills');
+    [rows, cols] = size(demData.Z);
+    res = demData.resolution;
+
+    % Long walls with a few gaps, so detours are far above Euclidean
+    rng(7);
+    blocked = false(rows, cols);
+    for w = 1:6
+        if mod(w, 2)
+            gaps = randi(rows, 1, 2);
+            blocked(all(abs((1:rows)' - gaps) > 2, 2), randi(cols)) = true;
+        else
+            gaps = randi(cols, 1, 2);
+            blocked(randi(rows), all(abs((1:cols)' - gaps) > 2, 2)) = true;
+        end
+    end
+    obstacles = struct('grid', blocked, 'resolution', res, 'bounds', ...
+                       [demData.xMin, demData.xMax, demData.yMin, demData.yMax]);
+    params.altCacheFile = '';
+    obstacles.landmarks = astarLandmarks(demData, obstacles, params);
+
+    % Post pairs; every third start and fifth goal on a blocked cell,
+    % every fourth pair shifted off the posts
+    [bi, bj] = find(blocked);
+    [fi, fj] = find(~blocked);
+    pairs = zeros(numPairs, 4);
+    for k = 1:numPairs
+        s = randi(numel(fi));
+        g = randi(numel(fi));
+        pairs(k, :) = [fj(s), fi(s), fj(g), fi(g)];
+        if mod(k, 3) == 0
+            s = randi(numel(bi));
+            pairs(k, 1:2) = [bj(s), bi(s)];
+        end
+        if mod(k, 5) == 0
+            g = randi(numel(bi));
+            pairs(k, 3:4) = [bj(g), bi(g)];
+        end
+    end
+    pairs = [demData.xMin, demData.yMin, demData.xMin, demData.yMin] + ...
+            (pairs - 1) * res;
+    offPost = mod((1:numPairs)', 4) == 0;
+    pairs(offPost, :) = pairs(offPost, :) + 0.37 * res;
+
+    fprintf('✓ %dx%d DEM, %d blocked cells, %d landmarks, %d pairs\n', ...
+            rows, cols, nnz(blocked), numel(obstacles.landmarks.posts), numPairs);
+    testsPassed = testsPassed + 1;
+catch ME
+    fprintf('✗ FAILED: %s\n', ME.message);
+end
+fprintf('\n');
+
+%% Test 2: Plain A* Reference
+fprintf('--- Test 2: Plain A* Reference ---\n');
+try
+    refStatus = zeros(numPairs, 1);
+    refLength = zeros(numPairs, 1);
+    for k = 1:numPairs
+        [xy, ~, refStatus(k)] = astarPathfinding_mex(pairs(k, 1:2), ...
+            pairs(k, 3:4), demData, obstacles, params.maxSlope, Inf, ...
+            'astar', 'euclidean');
+        refLength(k) = sum(vecnorm(diff(xy, 1, 1), 2, 2));
+    end
+    fprintf('✓ %d / %d pairs connected\n', nnz(refStatus == 0), numPairs);
+    testsPassed = testsPassed + 1;
+catch ME
+    fprintf('✗ FAILED: %s\n', ME.message);
+end
+fprintf('\n');
+
+%% Test 3: ALT Matches A*
+fprintf('--- Test 3: ALT Heuristic ---\n');
+try
+    bad = 0;
+    for k = 1:numPairs
+        [xy, ~, status] = astarPathfinding_mex(pairs(k, 1:2), ...
+            pairs(k, 3:4), demData, obstacles, params.maxSlope, Inf, ...
+            'astar', 'alt');
+        len = sum(vecnorm(diff(xy, 1, 1), 2, 2));
+        if status ~= refStatus(k) || abs(len - refLength(k)) > 1e-6
+            bad = bad + 1;
+            fprintf('  pair %d: status %d / %d, length %.2f / %.2f m\n', ...
+                    k, status, refStatus(k), len, refLength(k));
+        end
+    end
+    if bad == 0
+        fprintf('✓ Same status and length on all %d pairs\n', numPairs);
+        testsPassed = testsPassed + 1;
+    else
+        fprintf('✗ %d pairs differ from plain A*\n', bad);
+    end
+catch ME
+    fprintf('✗ FAILED: %s\n', ME.message);
+end
+fprintf('\n');
+
+%% Test 4: ALT Under ARA*
+fprintf('--- Test 4: ALT Heuristic, Anytime Search ---\n');
+try
+    % ARA* ends on the cheapest node of the goal circle, so its own
+    % Euclidean run is the reference
+    bad = 0;
+    schedule = [1, 0.5, Inf];    % weight 1: one optimal pass
+    for k = 1:numPairs
+        [xy, ~, araStatus] = astarPathfinding_mex(pairs(k, 1:2), ...
+            pairs(k, 3:4), demData, obstacles, params.maxSlope, Inf, ...
+            'ara', 'euclidean', schedule);
+        araLength = sum(vecnorm(diff(xy, 1, 1), 2, 2));
+        [xy, ~, status] = astarPathfinding_mex(pairs(k, 1:2), ...
+            pairs(k, 3:4), demData, obstacles, params.maxSlope, Inf, ...
+            'ara', 'alt', schedule);
+        len = sum(vecnorm(diff(xy, 1, 1), 2, 2));
+        if status ~= araStatus || status ~= refStatus(k) || ...
+                abs(len - araLength) > 1e-6
+            bad = bad + 1;
+            fprintf('  pair %d: status %d / %d, length %.2f / %.2f m\n', ...
+                    k, status, araStatus, len, araLength);
+        end
+    end
+    if bad == 0
+        fprintf('✓ Same status and length on all %d pairs\n', numPairs);
+        testsPassed = testsPassed + 1;
+    else
+        fprintf('✗ %d pairs differ from plain A*\n', bad);
+    end
+catch ME
+    fprintf('✗ FAILED: %s\n', ME.message);
+end
+fprintf('\n');
+
+%% Test 5: HPA* Connects the Same Pairs
+fprintf('--- Test 5: Hierarchical A* ---\n');
+try
+    % HPA* snaps both ends to posts, so only on-post pairs compare; its
+    % paths cross clusters at transitions and may be somewhat longer
+    bad = 0;
+    worst = 1;
+    hpaParams = params;
+    hpaParams.hpaClusterSize = 8;
+    hpaObstacles = obstacles;
+    hpaObstacles.hierarchy = astarHierarchy(demData, obstacles, hpaParams);
+    hpaCleanup = onCleanup(@() astarHierarchyFree(hpaObstacles.hierarchy));
+    for k = find(~offPost)'
+        [xy, ~, status] = astarPathfinding_mex(pairs(k, 1:2), ...
+            pairs(k, 3:4), demData, hpaObstacles, params.maxSlope, Inf, ...
+            'hpa', 'euclidean');
+        len = sum(vecnorm(diff(xy, 1, 1), 2, 2));
+        if status ~= refStatus(k) || (status == 0 && len < refLength(k) - res)
+            bad = bad + 1;
+            fprintf('  pair %d: status %d / %d, length %.2f / %.2f m\n', ...
+                    k, status, refStatus(k), len, refLength(k));
+        elseif status == 0 && refLength(k) > 10 * res
+            worst = max(worst, len / refLength(k));
+        end
+    end
+    clear hpaCleanup;
+    if bad == 0
+        fprintf('✓ Same status on all %d on-post pairs, worst %.3f x A*\n', ...
+                nnz(~offPost), worst);
+        testsPassed = testsPassed + 1;
+    else
+        fprintf('✗ %d pairs differ from plain A*\n', bad);
+    end
+catch ME
+    fprintf('✗ FAILED: %s\n', ME.message);
+end
+fprintf('\n');
+
+%% Summary
+fprintf('========================================\n');
+fprintf('A* PARITY SUMMARY\n');
+fprintf('========================================\n');
+fprintf('Tests Passed: %d / %d\n\n', testsPassed, totalTests);
+
+if testsPassed == totalTests
+    fprintf('✅ A* PARITY PASSED\n');
+else
+    fprintf('⚠ A* PARITY INCOMPLETE\n');
+end
+fprintf('========================================\n\n');
@@ -6,6 +6,8 @@ function test_demInterpolate_hdl()
     % Load DEM data
     load('synthetic_dem_hills.mat', 'demData');
     Z_double = demData.Z;
+    [rows, cols] = size(Z_double);
+    idxBits = max(8, ceil(log2(max(rows, cols))));
 
     % Convert DEM grid to fixed-point
     Z_grid_fi = fi(Z_double, 1, 16, 8);
@@ -20,15 +22,15 @@ function test_demInterpolate_hdl()
     ];
 
     for k = 1:size(testPoints,1)
-        x_norm = fi(testPoints(k,1), 0, 16, 8);
-        y_norm = fi(testPoints(k,2), 0, 16, 8);
+        x_norm = fi(testPoints(k,1), 0, idxBits + 8, 8);
+        y_norm = fi(testPoints(k,2), 0, idxBits + 8, 8);
 
         % Call HDL kernel
         z_hdl = demInterpolate_hdl(Z_grid_fi, x_norm, y_norm);
 
         % Reference value from full demInterpolate()
-        x_actual = demData.X(1,1) + double(testPoints(k,1)) * demData.resolution;
-        y_actual = demData.Y(1,1) + double(testPoints(k,2)) * demData.resolution;
+        x_actual = demData.xMin + double(testPoints(k,1)) * demData.resolution;
+        y_actual = demData.yMin + double(testPoints(k,2)) * demData.resolution;
         z_ref = demInterpolate(demData, x_actual, y_actual);
 
         % Display errors
@@ -8,7 +8,7 @@ fprintf('TEST 1: demInterpolate.m Compatibility\n');
 fprintf('========================================\n\n');
 
 testsPassed = 0;
-totalTests = 6;
+totalTests = 14;
 
 %% Test 1.1: Basic Function Call
 fprintf('--- Test 1.1: Basic Function Call ---\n');
@@ -162,13 +162,247 @@ catch ME
 end
 fprintf('\n');
 
+%% Test 1.7: Batched Interpolation
+fprintf('--- Test 1.7: Batched Interpolation ---\n');
+try
+    % Random interior points plus boundary, outside and NaN queries
+    numPts = 10000;
+    xq = [rand(numPts, 1) * 1000 + 500000; 500000; 501000; 499990; 501050; NaN];
+    yq = [rand(numPts, 1) * 1000 + 5400000; 5400000; 5401000; 5399990; 5401050; 5400500];
+    
+    tic;
+    zBatch = demInterpolateBatch(demData, xq, yq);
+    batchTime = toc;
+    
+    tic;
+    zLoop = zeros(size(xq));
+    for i = 1:numel(xq) - 1
+        zLoop(i) = demInterpolate(demData, xq(i), yq(i));
+    end
+    zLoop(end) = NaN;
+    loopTime = toc;
+    
+    if isequaln(zBatch, zLoop)
+        fprintf('✓ Batch matches per-point calls (%d points)\n', numel(xq));
+        fprintf('  Speedup: %.1fx\n', loopTime / max(batchTime, eps));
+        testsPassed = testsPassed + 1;
+    else
+        fprintf('✗ Max mismatch: %.3g m\n', max(abs(zBatch - zLoop)));
+    end
+catch ME
+    fprintf('✗ FAILED: %s\n', ME.message);
+end
+fprintf('\n');
+
+%% Test 1.8: Resident DEM Handle
+fprintf('--- Test 1.8: Resident DEM Handle ---\n');
+try
+    h = demLoad(demData);
+    
+    % Many small queries, the A* pattern that suffered from marshalling
+    numIter = 1000;
+    zHandle = zeros(numIter, 1);
+    tic;
+    for i = 1:numIter
+        zHandle(i) = demQuery(h, xq(i), yq(i));
+    end
+    handleTime = toc;
+    demFree(h);
+    demFree(h);  % second free is a no-op
+    
+    if isequal(zHandle, zBatch(1:numIter))
+        fprintf('✓ demLoad/demQuery/demFree match batch results\n');
+        fprintf('  Per-query cost: %.2f us\n', handleTime / numIter * 1e6);
+        testsPassed = testsPassed + 1;
+    else
+        fprintf('✗ Handle results differ from batch results\n');
+    end
+catch ME
+    fprintf('✗ FAILED: %s\n', ME.message);
+end
+fprintf('\n');
+
+%% Test 1.9: Non-101x101 Grid
+fprintf('--- Test 1.9: Arbitrary Grid Size ---\n');
+try
+    % Rectangular grid with an origin away from the synthetic DEM
+    rows = 37;
+    cols = 53;
+    [Xg, Yg] = meshgrid(1000 + (0:cols-1) * 5, 2000 + (0:rows-1) * 5);
+    odd = struct('Z', sin(Xg / 40) .* cos(Yg / 30) * 50, ...
+                 'resolution', 5, 'xMin', 1000, 'yMin', 2000);
+    
+    xo = 1000 + rand(500, 1) * (cols - 1) * 5;
+    yo = 2000 + rand(500, 1) * (rows - 1) * 5;
+    zRef = interp2(Xg, Yg, odd.Z, xo, yo, 'linear');
+    zScalar = arrayfun(@(k) demInterpolate(odd, xo(k), yo(k)), (1:500)');
+    zOdd = demInterpolateBatch(odd, xo, yo);
+    
+    % Far corner clamps onto the last cell instead of indexing past it
+    zCorner = demInterpolate(odd, 1000 + (cols - 1) * 5, 2000 + (rows - 1) * 5);
+    
+    if max(abs(zScalar - zRef)) < 1e-9 && isequal(zOdd, zScalar) && ...
+       abs(zCorner - odd.Z(end, end)) < 1e-9
+        fprintf('✓ %dx%d grid matches interp2 (scalar and batch)\n', rows, cols);
+        testsPassed = testsPassed + 1;
+    else
+        fprintf('✗ %dx%d grid results differ from interp2\n', rows, cols);
+    end
+catch ME
+    fprintf('✗ FAILED: %s\n', ME.message);
+end
+fprintf('\n');
+
+%% Test 1.10: Compact DEM (implicit coordinates)
+fprintf('--- Test 1.10: Compact DEM ---\n');
+try
+    compactDem = demCompact(demData);
+    zCompact = demInterpolateBatch(compactDem, xq, yq);
+    [xv, yv] = demCoordinates(compactDem);
+    legacyInfo = whos('demData');
+    compactInfo = whos('compactDem');
+    
+    if ~isfield(compactDem, 'X') && isequaln(zCompact, zBatch) && ...
+       numel(xv) == compactDem.cols && numel(yv) == compactDem.rows
+        fprintf('✓ Compact DEM gives identical elevations\n');
+        fprintf('  Memory: %.0f KB -> %.0f KB\n', ...
+                legacyInfo.bytes / 1024, compactInfo.bytes / 1024);
+        testsPassed = testsPassed + 1;
+    else
+        fprintf('✗ Compact DEM results differ\n');
+    end
+catch ME
+    fprintf('✗ FAILED: %s\n', ME.message);
+end
+fprintf('\n');
+
+%% Test 1.11: Tiled Resident Layout
+fprintf('--- Test 1.11: Tiled Resident Layout ---\n');
+try
+    hTiled = demLoad(odd, 'tiled');
+    hColumn = demLoad(odd, 'column');
+    zTiled = demQuery(hTiled, xo, yo);
+    zColumn = demQuery(hColumn, xo, yo);
+    demFree(hTiled);
+    demFree(hColumn);
+    
+    if isequal(zTiled, zColumn) && isequal(zTiled, zOdd)
+        fprintf('✓ Tiled layout matches column-major lookups\n');
+        testsPassed = testsPassed + 1;
+    else
+        fprintf('✗ Tiled layout results differ\n');
+    end
+catch ME
+    fprintf('✗ FAILED: %s\n', ME.message);
+end
+fprintf('\n');
+
+%% Test 1.12: Memory-Mapped Tile File
+fprintf('--- Test 1.12: Memory-Mapped .demt File ---\n');
+try
+    if exist('demHandle_mex', 'file') ~= 3
+        fprintf('⚠ Skipped: run build_native first\n');
+    else
+        tileFile = [tempname '.demt'];
+        demWriteTiles(odd, tileFile, 16);
+        [hFile, info] = demLoad(tileFile);
+        zFile = demQuery(hFile, xo, yo);
+        demFree(hFile);
+        
+        % Crop to an interior box: window plus one post of margin
+        box = struct('xMin', 1050, 'xMax', 1100, 'yMin', 2030, 'yMax', 2060);
+        cropped = demImport(tileFile, 'auto', 'column', box);
+        delete(tileFile);
+        c0 = round((cropped.xMin - 1000) / 5) + 1;
+        r0 = round((cropped.yMin - 2000) / 5) + 1;
+        zSub = odd.Z(r0:r0+cropped.rows-1, c0:c0+cropped.cols-1);
+        
+        if isequal(zFile, zOdd) && info.tileSize == 16 && ...
+           isequal(cropped.Z, zSub) && cropped.xMin <= box.xMin && ...
+           cropped.xMax >= box.xMax
+            fprintf('✓ Mapped lookups and cropped import match in-memory DEM\n');
+            testsPassed = testsPassed + 1;
+        else
+            fprintf('✗ .demt results differ from in-memory DEM\n');
+        end
+    end
+catch ME
+    fprintf('✗ FAILED: %s\n', ME.message);
+end
+fprintf('\n');
+
+%% Test 1.13: ESRI ASCII Grid Import
+fprintf('--- Test 1.13: ESRI ASCII Grid Import ---\n');
+try
+    ascFile = [tempname '.asc'];
+    zAsc = odd.Z;
+    zAsc(3, 7) = -9999;
+    fid = fopen(ascFile, 'w');
+    fprintf(fid, 'ncols %d\nnrows %d\nxllcorner 1000\nyllcorner 2000\n', cols, rows);
+    fprintf(fid, 'cellsize 5\nNODATA_value -9999\n');
+    fprintf(fid, [repmat('%.17g ', 1, cols) '\n'], flipud(zAsc)');
+    fclose(fid);
+    imported = demImport(ascFile);
+    delete(ascFile);
+    zAsc(3, 7) = NaN;
+    
+    if isequaln(imported.Z, zAsc) && imported.xMin == 1000 && imported.yMin == 2000
+        fprintf('✓ ASCII grid round-trips exactly (nodata -> NaN)\n');
+        testsPassed = testsPassed + 1;
+    else
+        fprintf('✗ ASCII grid import differs\n');
+    end
+catch ME
+    fprintf('✗ FAILED: %s\n', ME.message);
+end
+fprintf('\n');
+
+%% Test 1.14: Elevation Pyramid
+fprintf('--- Test 1.14: Min/Max/Mean Pyramid ---\n');
+try
+    pyr = demPyramid(demData);
+    boundsOk = true;
+    for k = 1:numel(pyr)
+        for trial = 1:20
+            bx = sort(demData.xMin + rand(1, 2) * (demData.xMax - demData.xMin));
+            by = sort(demData.yMin + rand(1, 2) * (demData.yMax - demData.yMin));
+            [lo, hi] = demPyramidRange(pyr(k), bx, by);
+            [sx, sy] = meshgrid(linspace(bx(1), bx(2), 15), linspace(by(1), by(2), 15));
+            zs = demInterpolateBatch(demData, sx, sy);
+            boundsOk = boundsOk && all(zs(:) >= lo) && all(zs(:) <= hi);
+        end
+    end
+    
+    % Levels are DEM structs: interpolating at a cell centre gives its mean
+    zCentre = demInterpolate(pyr(1), pyr(1).xMin, pyr(1).yMin);
+    
+    % High leg accepted at a coarse level; a leg through the terrain is not
+    top = demData.maxElevation + 200;
+    [highClear, highQueries] = demSegmentClear(pyr, demData, ...
+        [demData.xMin, demData.yMin, top], [demData.xMax, demData.yMax, top], 120);
+    lowClear = demSegmentClear(pyr, demData, ...
+        [demData.xMin, demData.yMin, demData.minElevation], ...
+        [demData.xMax, demData.yMax, demData.minElevation], 120);
+    
+    if boundsOk && abs(zCentre - pyr(1).Z(1, 1)) < 1e-9 && ...
+       highClear && highQueries == 0 && ~lowClear
+        fprintf('✓ %d levels; bounds hold, coarse accept/reject works\n', numel(pyr));
+        testsPassed = testsPassed + 1;
+    else
+        fprintf('✗ Pyramid bounds or clearance results wrong\n');
+    end
+catch ME
+    fprintf('✗ FAILED: %s\n', ME.message);
+end
+fprintf('\n');
+
 %% Summary
 fprintf('========================================\n');
 fprintf('TEST 1 SUMMARY\n');
 fprintf('========================================\n');
 fprintf('Tests Passed: %d / %d\n\n', testsPassed, totalTests);
 
-if testsPassed >= 5
+if testsPassed >= 13
     fprintf('✅ TEST 1 PASSED\n');
     fprintf('demInterpolate.m is compatible with existing code!\n');
 else
@@ -8,26 +8,50 @@
 % Date: 2025-11-12
 % Compatibility: MATLAB 2023b+
 
-function [optimizedWaypoints, tspStats] = tspNearestNeighbor(waypoints, startIdx)
+function [optimizedWaypoints, tspStats] = tspNearestNeighbor(waypoints, startIdx, costMatrix, params)
     %TSPNEARESTNEIGHBOR Optimize waypoint order using greedy TSP algorithm
     %
     % Syntax:
     %   [optimizedWaypoints, tspStats] = tspNearestNeighbor(waypoints)
     %   [optimizedWaypoints, tspStats] = tspNearestNeighbor(waypoints, startIdx)
+    %   [optimizedWaypoints, tspStats] = tspNearestNeighbor(waypoints, startIdx, costMatrix)
+    %   [optimizedWaypoints, tspStats] = tspNearestNeighbor(waypoints, startIdx, [], params)
     %
     % Inputs:
     %   waypoints - [Nx2] or [Nx3] or [Nx4+] matrix
     %              Must include [X, Y] in first 2 columns
     %              Additional columns (Z, order, etc.) preserved
     %   startIdx  - (optional) Starting waypoint index (default: 1)
+    %   costMatrix - (optional) [NxN] sparse terrain costs from
+    %              astarCostMatrix; the next waypoint is the cheapest
+    %              stored unvisited one, and straight-line distance is
+    %              only used when none of the current row is left
+    %   params     - (optional) struct with tspCandidates, tspStarts,
+    %              tspThreads and tspTimeBudget (microseconds)
     %
     % Outputs:
     %   optimizedWaypoints - Same format as input, reordered by TSP
-    %   tspStats - struct with optimization statistics
+    %   tspStats - struct with optimization statistics, including the
+    %              local-search iterations and improving moves
+    %
+    % Without a cost matrix the order comes from tspTour_mex when it has
+    % been built with build_native: a grid-bucketed nearest-neighbour tour
+    % improved by 2-opt and Or-opt moves over each waypoint's nearest
+    % candidates (don't-look bits), from several starts in parallel within
+    % the time budget. Otherwise, and for terrain costs, the greedy tour is
+    % returned as is. Distances are 3-D when waypoints have a Z column.
     %
     % Example:
     %   [optimized, stats] = tspNearestNeighbor(waypoints);
     %   [optimized, stats] = tspNearestNeighbor(waypoints, 100);
+    %   C = astarCostMatrix(waypoints, demData, obstacles, params);
+    %   [optimized, stats] = tspNearestNeighbor(waypoints, 1, C);
+    %   [optimized, stats] = tspNearestNeighbor(waypoints, 1, [], params);
+    
+    persistent useMex
+    if isempty(useMex)
+        useMex = (exist('tspTour_mex', 'file') == 3);
+    end
     
     %% Input validation
     if nargin < 1
@@ -38,6 +62,14 @@ function [optimizedWaypoints, tspStats] = tspNearestNeighbor(waypoints, startIdx
         startIdx = 1;
     end
     
+    if nargin < 3
+        costMatrix = [];
+    end
+    
+    if nargin < 4
+        params = struct();
+    end
+    
     if ~isnumeric(waypoints) || size(waypoints, 1) < 2
         error('tspNearestNeighbor:InvalidWaypoints', ...
               'waypoints must be Nx2+ matrix with N >= 2');
@@ -53,6 +85,11 @@ function [optimizedWaypoints, tspStats] = tspNearestNeighbor(waypoints, startIdx
               'startIdx must be between 1 and %d', size(waypoints, 1));
     end
     
+    if ~isempty(costMatrix) && ~isequal(size(costMatrix), size(waypoints, 1) * [1 1])
+        error('tspNearestNeighbor:InvalidCostMatrix', ...
+              'costMatrix must be %d x %d', size(waypoints, 1), size(waypoints, 1));
+    end
+    
     %% Calculate original path distance
     tic;
     originalDistance = calculatePathDistance(waypoints);
@@ -63,8 +100,26 @@ function [optimizedWaypoints, tspStats] = tspNearestNeighbor(waypoints, startIdx
     fprintf('Starting waypoint: %d\n', startIdx);
     fprintf('Original path distance: %.1f m\n', originalDistance);
     
-    %% Run nearest neighbor algorithm
-    [orderedIdx, visitOrder] = nearestNeighborTSP(waypoints, startIdx);
+    %% Build and improve the tour
+    search = struct('iterations', 0, 'twoOptMoves', 0, 'orOptMoves', 0, ...
+                    'startsRun', 0, 'timedOut', false);
+    terrainSteps = 0;
+    if useMex && isempty(costMatrix)
+        options = [ifthenelse(isfield(params, 'tspCandidates'), params.tspCandidates, 10), ...
+                   ifthenelse(isfield(params, 'tspStarts'), params.tspStarts, 4), ...
+                   ifthenelse(isfield(params, 'tspThreads'), params.tspThreads, 0), ...
+                   ifthenelse(isfield(params, 'tspTimeBudget'), params.tspTimeBudget, Inf), 1];
+        [orderedIdx, search] = tspTour_mex(double(waypoints(:, 1:min(3, end))), ...
+                                           double(startIdx), options);
+        algorithm = 'nn_2opt_oropt';
+        fprintf('Greedy tour distance: %.1f m\n', search.greedyLength);
+        fprintf('Local search: %d iterations, %d 2-opt + %d Or-opt moves (%d starts%s)\n', ...
+                search.iterations, search.twoOptMoves, search.orOptMoves, ...
+                search.startsRun, ifthenelse(search.timedOut, ', budget reached', ''));
+    else
+        [orderedIdx, ~, terrainSteps] = nearestNeighborTSP(waypoints, startIdx, costMatrix);
+        algorithm = 'nearest_neighbor';
+    end
     
     %% Build optimized waypoints with new order
     optimizedWaypoints = waypoints(orderedIdx, :);
@@ -91,19 +146,27 @@ function [optimizedWaypoints, tspStats] = tspNearestNeighbor(waypoints, startIdx
         'computeTime', computeTime, ...
         'startIdx', startIdx, ...
         'numWaypoints', size(waypoints, 1), ...
-        'algorithm', 'nearest_neighbor' ...
+        'terrainSteps', terrainSteps, ...
+        'iterations', search.iterations, ...
+        'improvements', search.twoOptMoves + search.orOptMoves, ...
+        'twoOptMoves', search.twoOptMoves, ...
+        'orOptMoves', search.orOptMoves, ...
+        'starts', search.startsRun, ...
+        'timedOut', search.timedOut, ...
+        'algorithm', algorithm ...
     );
     
 end
 
 %% Helper: Nearest Neighbor TSP
-function [orderedIdx, visitOrder] = nearestNeighborTSP(waypoints, startIdx)
+function [orderedIdx, visitOrder, terrainSteps] = nearestNeighborTSP(waypoints, startIdx, costMatrix)
     %NEARESTNEIGHBORTSP Greedy TSP using nearest unvisited neighbor
     
     n = size(waypoints, 1);
     visited = false(n, 1);
     orderedIdx = zeros(n, 1);
     visitOrder = zeros(n, 1);
+    terrainSteps = 0;
     
     % Start at specified waypoint
     currentIdx = startIdx;
@@ -113,7 +176,15 @@ function [orderedIdx, visitOrder] = nearestNeighborTSP(waypoints, startIdx)
     
     % Iteratively visit nearest unvisited neighbor
     for step = 2:n
-        nearestIdx = findNearestUnvisited(waypoints, currentIdx, visited);
+        nearestIdx = [];
+        if ~isempty(costMatrix)
+            nearestIdx = findCheapestUnvisited(costMatrix, currentIdx, visited);
+        end
+        if isempty(nearestIdx)
+            nearestIdx = findNearestUnvisited(waypoints, currentIdx, visited);
+        else
+            terrainSteps = terrainSteps + 1;
+        end
         visited(nearestIdx) = true;
         orderedIdx(step) = nearestIdx;
         visitOrder(nearestIdx) = step;
@@ -122,34 +193,31 @@ function [orderedIdx, visitOrder] = nearestNeighborTSP(waypoints, startIdx)
     
 end
 
+%% Helper: Find cheapest unvisited waypoint in a sparse cost row
+function nearestIdx = findCheapestUnvisited(costMatrix, currentIdx, visited)
+    %FINDCHEAPESTUNVISITED Lowest stored cost, [] when the row has none left
+    
+    % The matrix is symmetric, and sparse columns are cheap to read
+    [idx, ~, cost] = find(costMatrix(:, currentIdx));
+    open = ~visited(idx);
+    idx = idx(open);
+    cost = cost(open);
+    nearestIdx = [];
+    if ~isempty(idx)
+        [~, best] = min(cost);
+        nearestIdx = idx(best);
+    end
+end
+
 %% Helper: Find nearest unvisited waypoint
 function nearestIdx = findNearestUnvisited(waypoints, currentIdx, visited)
     %FINDNEARESTUNVISITED Find closest unvisited waypoint
     
-    current = waypoints(currentIdx, 1:2);
-    
-    % Calculate distances to all unvisited waypoints
-    distances = zeros(size(waypoints, 1), 1);
-    
-    for i = 1:size(waypoints, 1)
-        if ~visited(i)
-            dx = waypoints(i, 1) - current(1);
-            dy = waypoints(i, 2) - current(2);
-            
-            % For 3D: include elevation in distance
-            if size(waypoints, 2) >= 3
-                dz = waypoints(i, 3) - current(1)*0;  % Z from destination
-                if i > 1
-                    dz = waypoints(i, 3) - waypoints(currentIdx, 3);
-                end
-                distances(i) = sqrt(dx^2 + dy^2 + dz^2);
-            else
-                distances(i) = sqrt(dx^2 + dy^2);
-            end
-        else
-            distances(i) = inf;  % Mark visited as unreachable
-        end
-    end
+    % For 3D: include elevation in distance, from the current waypoint
+    dims = min(3, size(waypoints, 2));
+    steps = waypoints(:, 1:dims) - waypoints(currentIdx, 1:dims);
+    distances = sqrt(sum(steps.^2, 2));
+    distances(visited) = inf;  % Mark visited as unreachable
     
     % Return index of nearest unvisited
     [~, nearestIdx] = min(distances);
@@ -177,3 +245,12 @@ function totalDistance = calculatePathDistance(waypoints)
         end
     end
 end
+
+%% Helper: Conditional value
+function result = ifthenelse(condition, trueVal, falseVal)
+    if condition
+        result = trueVal;
+    else
+        result = falseVal;
+    end
+end
@@ -43,6 +43,7 @@ function figHandle = visualizeMissionDashboard(missionData, params, saveToFile)
     %% Extract data
     demData = missionData.demData;
     path = missionData.finalPath;
+    [xGrid, yGrid] = demCoordinates(demData);
     
     %% Create figure
     figHandle = figure('Name', 'Mission Dashboard', 'NumberTitle', 'off', ...
@@ -50,7 +51,7 @@ function figHandle = visualizeMissionDashboard(missionData, params, saveToFile)
     
     %% Panel 1: 3D Mission Overview (subplot 1)
     subplot(2, 3, 1);
-    surf(demData.X, demData.Y, demData.Z, 'EdgeColor', 'none', 'FaceAlpha', 0.8);
+    surf(xGrid, yGrid, demData.Z, 'EdgeColor', 'none', 'FaceAlpha', 0.8);
     hold on;
     
     % Flight path
@@ -77,7 +78,7 @@ function figHandle = visualizeMissionDashboard(missionData, params, saveToFile)
     
     %% Panel 2: 2D Top-Down View (subplot 2)
     subplot(2, 3, 2);
-    contourf(demData.X, demData.Y, demData.Z, 20, 'LineColor', 'none');
+    contourf(xGrid, yGrid, demData.Z, 20, 'LineColor', 'none');
     hold on;
     
     % Flight path